@@ -1,6 +1,8 @@
 QT       += core gui
 QT += sql printsupport widgets
 LIBS += -lglut -lGL -lGLU
+# shm_open() for glove-shm
+unix:LIBS += -lrt
 
 DEFINES += OPENGL
 
@@ -20,12 +22,31 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    glovesource.cpp \
+    handrenderer.cpp \
     main.cpp \
     mainwindow.cpp \
-    oglwidget.cpp
+    oglwidget.cpp \
+    ../arduino-serial/arduino-serial-lib.c \
+    ../arduino-serial/glove-align.cpp \
+    ../arduino-serial/glove-calib.cpp \
+    ../arduino-serial/glove-fusion.cpp \
+    ../arduino-serial/glove-interp.cpp \
+    ../arduino-serial/glove-kinematics.cpp \
+    ../arduino-serial/glove-metrics.cpp \
+    ../arduino-serial/glove-pick.cpp \
+    ../arduino-serial/glove-record.cpp \
+    ../arduino-serial/glove-replay.cpp \
+    ../arduino-serial/glove-sample.cpp \
+    ../arduino-serial/glove-shm.cpp \
+    ../arduino-serial/glove-stream.cpp \
+    ../arduino-serial/glove-trace.cpp \
+    ../arduino-serial/glove-yaw.cpp
 
 HEADERS += \
     arduino.h \
+    glovesource.h \
+    handrenderer.h \
     mainwindow.h \
     oglwidget.h
 
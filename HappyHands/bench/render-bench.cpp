@@ -0,0 +1,495 @@
+/*
+ * render-bench
+ * ------------
+ *
+ * Headless render cost of the hand viewers.  Every scene renders the
+ * same glove session, one session frame per rendered frame, into an
+ * offscreen FBO on a surfaceless EGL context.  Mesa llvmpipe is fine, so
+ * it runs on CI boxes with no display.
+ *
+ *   hands-instanced   OGLWidget's HandRenderer, GL 3.3 instanced path
+ *   hands-immediate   the same, its immediate-mode path (bench only)
+ *   p5hand            gyroArduino/p5hand, 8 LEDs plus axes
+ *   tetrahedron       gyroArduino/Tetrahedron's scene
+ *
+ * irrGyro is not covered: it needs Irrlicht's own device and window.
+ *
+ * Per frame it records wall time to glFinish(), process CPU time over
+ * the same span (llvmpipe's threads included), draw calls and
+ * primitives.  Draw calls are counted by wrapping glBegin(), glDraw*()
+ * and glCallList(s)() in this executable, which also catches GLU's.
+ * Primitives come from a GL_PRIMITIVES_GENERATED query, so they count
+ * what GL was asked to draw: a quad of GLU's quad strips is one, as is a
+ * line segment of a p5hand label.  For the instanced path every one is a
+ * triangle.
+ *
+ *   make && ./render-bench -n 500 -j bench.json
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <vector>
+#include <algorithm>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <GL/glut.h>
+
+#include "../handrenderer.h"
+#include "../../arduino-serial/glove-fusion.h"
+#include "../../arduino-serial/glove-record.h"
+#include "../../arduino-serial/glove-synth.h"
+#include "../../gyroArduino/p5hand/p5hand.h"
+#include "../../gyroArduino/Tetrahedron/tetrahedronscene.h"
+
+static void usage(void)
+{
+    printf("Usage: render-bench [OPTIONS]\n"
+    "\n"
+    "Options:\n"
+    "  -n, --frames=num           Frames per scene (default 300)\n"
+    "  -W, --width=px             Framebuffer width (default 640)\n"
+    "  -H, --height=px            Framebuffer height (default 480)\n"
+    "  -s, --scene=name           Run only this scene, may be repeated\n"
+    "                             (hands-instanced, hands-immediate, p5hand, tetrahedron)\n"
+    "  -i, --input=session        Glove session, text or recording (default: synthetic)\n"
+    "  -j, --json=file            Per-frame results as JSON, '-' for stdout\n"
+    "  -o, --output=prefix        Save each scene's last frame as <prefix>-<scene>.ppm\n"
+    "\n");
+    exit(EXIT_SUCCESS);
+}
+
+static void error(const char* msg)
+{
+    fprintf(stderr, "%s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+static double clock_ms(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+//
+// draw call counting: these override libGL's entry points for the whole
+// process (link with -rdynamic) and forward to the real ones
+//
+static int draw_calls;
+
+#define FORWARD(name, proto, args) \
+    extern "C" void name proto \
+    { \
+        typedef void (*fn_t) proto; \
+        static fn_t real = (fn_t)dlsym(RTLD_NEXT, #name); \
+        draw_calls++; \
+        real args; \
+    }
+
+FORWARD(glBegin, (GLenum mode), (mode))
+FORWARD(glCallList, (GLuint list), (list))
+FORWARD(glCallLists, (GLsizei n, GLenum type, const void* lists), (n, type, lists))
+FORWARD(glDrawArrays, (GLenum mode, GLint first, GLsizei count), (mode, first, count))
+FORWARD(glDrawElements, (GLenum mode, GLsizei count, GLenum type, const void* indices),
+        (mode, count, type, indices))
+FORWARD(glDrawArraysInstanced, (GLenum mode, GLint first, GLsizei count, GLsizei n),
+        (mode, first, count, n))
+FORWARD(glDrawElementsInstanced, (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei n),
+        (mode, count, type, indices, n))
+FORWARD(glDrawElementsInstancedBaseVertex,
+        (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei n, GLint base),
+        (mode, count, type, indices, n, base))
+
+//
+// p5hand labels use GLUT stroke fonts, and freeglut refuses to draw them
+// before glutInit(), which needs an X display.  Same drawing, straight
+// from freeglut's exported font tables (fg_internal.h layout).  Other
+// GLUTs draw strokes without glutInit() and keep their own.
+//
+#ifdef FREEGLUT
+struct stroke_vertex { GLfloat x, y; };
+struct stroke_strip  { int n; const stroke_vertex* v; };
+struct stroke_char   { GLfloat right; int n; const stroke_strip* strips; };
+struct stroke_font   { char* name; int quantity; GLfloat height; const stroke_char** chars; };
+extern "C" stroke_font fgStrokeRoman, fgStrokeMonoRoman;
+
+extern "C" void glutStrokeCharacter(void* font_id, int c)
+{
+    const stroke_font* font = font_id == GLUT_STROKE_MONO_ROMAN ? &fgStrokeMonoRoman : &fgStrokeRoman;
+    if (c < 0 || c >= font->quantity || font->chars[c] == NULL) return;
+    const stroke_char* sc = font->chars[c];
+    for (int i = 0; i < sc->n; i++) {
+        glBegin(GL_LINE_STRIP);
+        for (int j = 0; j < sc->strips[i].n; j++)
+            glVertex2f(sc->strips[i].v[j].x, sc->strips[i].v[j].y);
+        glEnd();
+    }
+    glTranslatef(sc->right, 0, 0);
+}
+#endif
+
+// surfaceless EGL display, one per process
+static EGLDisplay display(void)
+{
+    static EGLDisplay dpy = EGL_NO_DISPLAY;
+    if (dpy != EGL_NO_DISPLAY) return dpy;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    dpy = get_platform_display ? get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL)
+                               : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, NULL, NULL)) error("couldn't open an EGL display");
+    eglBindAPI(EGL_OPENGL_API);
+    return dpy;
+}
+
+// core 3.3 for the instanced path, compatibility for everything else
+static EGLContext make_context(int core)
+{
+    EGLDisplay dpy = display();
+    EGLint cattr[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig cfg;
+    EGLint n = 0;
+    eglChooseConfig(dpy, cattr, &cfg, 1, &n);
+    EGLint attr[] = {
+        EGL_CONTEXT_MAJOR_VERSION, core ? 3 : 2,
+        EGL_CONTEXT_MINOR_VERSION, core ? 3 : 1,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, core ? EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT
+                                              : EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext ctx = eglCreateContext(dpy, n ? cfg : (EGLConfig)0, EGL_NO_CONTEXT, attr);
+    if (ctx == EGL_NO_CONTEXT) error("couldn't create a GL context");
+    if (!eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx)) error("couldn't make the context current");
+    return ctx;
+}
+
+// every frame of the session as two hands; a one-hand session is
+// mirrored onto the left
+static std::vector<glove_hand_pose_t> session_frames(const char* input, int nframes)
+{
+    glove_session_t ss;
+    if (input) {
+        // text, or a glove-record file straight from the mapping
+        int rc = glove_rec_probe(input) ? glove_rec_load(input, &ss, NULL) : glove_session_load(input, &ss);
+        if (rc != 0) error("couldn't load session");
+    } else {
+        glove_synth_params_t par;
+        glove_synth_defaults(&par);
+        par.duration_s = nframes / par.rate_hz + 1;
+        if (glove_synth_session(&par, &ss) != 0) error("out of memory");
+    }
+    int nsensors = 0;
+    for (int i = 0; i < ss.nsamples; i++)
+        if (ss.samples[i].sensor >= nsensors) nsensors = ss.samples[i].sensor + 1;
+    if (nsensors < 6) error("session needs the palm and five fingers");
+
+    std::vector<glove_hand_pose_t> frames;
+    glove_fusion_t fu[GLOVE_MAX_SENSORS];
+    glove_quat_t q[GLOVE_MAX_SENSORS];
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) {
+        glove_fusion_init(&fu[k], GLOVE_FUSION_ALPHA);
+        q[k] = glove_quat_identity();
+    }
+    for (int i = 0; i < ss.nsamples && (int)frames.size() < nframes * 2; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        glove_fusion_update(&fu[s->sensor], s);
+        q[s->sensor] = fu[s->sensor].q;
+        if (s->sensor != nsensors - 1) continue;
+        glove_hand_pose_t right, left;
+        glove_kin_hand(q, 6, glove_vec3(0.12f, 0, 0), 0, &right);
+        glove_kin_hand(nsensors >= 12 ? q + 6 : q, 6, glove_vec3(-0.12f, 0, 0), 1, &left);
+        frames.push_back(right);
+        frames.push_back(left);
+    }
+    glove_session_free(&ss);
+    if (frames.empty()) error("session too short");
+    return frames;
+}
+
+//
+// scenes
+//
+struct scene {
+    const char* name;
+    int core;
+    void (*init)(int width, int height);
+    void (*frame)(const glove_hand_pose_t* hands, int i);
+    void (*release)(void);
+};
+
+static HandRenderer hand_renderer;
+static float hand_vp[16];
+
+static void hands_init(HandRenderer::Path path, int width, int height)
+{
+    if (!hand_renderer.init(path)) error(hand_renderer.errorString());
+    float proj[16], view[16];
+    const float eye[3] = { 0, -0.35f, 0.30f }, center[3] = { 0, 0.08f, 0 }, up[3] = { 0, 0, 1 };
+    HandRenderer::perspective(45, (float)width / height, 0.01f, 10, proj);
+    HandRenderer::lookAt(eye, center, up, view);
+    HandRenderer::multiply(proj, view, hand_vp);
+}
+
+static void instanced_init(int width, int height) { hands_init(HandRenderer::Instanced, width, height); }
+static void immediate_init(int width, int height) { hands_init(HandRenderer::Immediate, width, height); }
+static void hands_frame(const glove_hand_pose_t* hands, int) { hand_renderer.draw(hands, 2, hand_vp); }
+static void hands_release(void) { hand_renderer.release(); }
+
+// p5hand's LEDs: wrist, the five fingertips, index and little knuckles;
+// metres relative to the wrist, in p5hand's y up frame
+static void p5hand_init(int width, int height)
+{
+    render_init();
+    render_reshape(width, height);
+    render_show(1, 1);
+}
+
+static void p5hand_frame(const glove_hand_pose_t* hands, int)
+{
+    static const int leds[P5HAND_LEDS] = { 0, 4, 8, 12, 16, 20, 5, 17 };
+    const glove_vec3_t w = hands[0].joints[0];
+    p5hand_position[0] = w.x;
+    p5hand_position[1] = w.z;
+    p5hand_position[2] = -w.y;
+    for (int i = 0; i < P5HAND_LEDS; i++) {
+        glove_vec3_t d = glove_vec3_sub(hands[0].joints[leds[i]], w);
+        p5hand_led[i][0] = d.x;
+        p5hand_led[i][1] = d.z;
+        p5hand_led[i][2] = -d.y;
+    }
+    render_frame();
+}
+
+static void no_release(void) {}
+
+static TetrahedronScene tetrahedron;
+
+static void tetrahedron_init(int width, int height)
+{
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    TetrahedronScene::frustum(width, height);
+    glEnable(GL_CULL_FACE);
+    glShadeModel(GL_FLAT);
+}
+
+static void tetrahedron_frame(const glove_hand_pose_t*, int i)
+{
+    tetrahedron.rotationY = -57.0f + i;
+    tetrahedron.draw();
+}
+
+static const scene scenes[] = {
+    { "hands-instanced", 1, instanced_init,   hands_frame,       hands_release },
+    { "hands-immediate", 0, immediate_init,   hands_frame,       hands_release },
+    { "p5hand",          0, p5hand_init,      p5hand_frame,      render_release },
+    { "tetrahedron",     0, tetrahedron_init, tetrahedron_frame, no_release },
+};
+static const int nscenes = sizeof(scenes) / sizeof(scenes[0]);
+
+struct result {
+    const char* name;
+    std::vector<double> ms;           // whole frame, to glFinish()
+    std::vector<double> cpu_ms;       // process CPU time over the same span
+    std::vector<double> submit_ms;    // issuing the frame
+    std::vector<int> draw_calls, primitives;
+};
+
+// last frame as a binary PPM, to check the scenes draw what they should
+static void save_ppm(const char* prefix, const char* name, int width, int height)
+{
+    std::vector<unsigned char> px(width * height * 4);
+    char path[256];
+    snprintf(path, sizeof(path), "%s-%s.ppm", prefix, name);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, px.data());
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) {
+        perror("render-bench: Unable to write frame");
+        return;
+    }
+    fprintf(fp, "P6\n%d %d\n255\n", width, height);
+    for (int y = height - 1; y >= 0; y--)
+        for (int x = 0; x < width; x++) fwrite(&px[(y * width + x) * 4], 1, 3, fp);
+    fclose(fp);
+}
+
+static void run(const scene* sc, const std::vector<glove_hand_pose_t>& frames,
+                int width, int height, const char* output, result* r)
+{
+    EGLContext ctx = make_context(sc->core);
+    GLuint fbo, rb[2], query;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(2, rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, rb[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rb[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, rb[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rb[1]);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) error("framebuffer incomplete");
+    glGenQueries(1, &query);
+
+    glViewport(0, 0, width, height);
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0, 0, 0, 1);
+    sc->init(width, height);
+
+    int n = frames.size() / 2;
+    *r = result();
+    r->name = sc->name;
+    for (int i = 0; i < n; i++) {
+        GLuint prims = 0;
+        draw_calls = 0;
+        glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+        double t0 = clock_ms(CLOCK_MONOTONIC), c0 = clock_ms(CLOCK_PROCESS_CPUTIME_ID);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        sc->frame(&frames[i * 2], i);
+        double t1 = clock_ms(CLOCK_MONOTONIC);
+        int calls = draw_calls;
+        glEndQuery(GL_PRIMITIVES_GENERATED);
+        glFinish();
+        r->ms.push_back(clock_ms(CLOCK_MONOTONIC) - t0);
+        r->cpu_ms.push_back(clock_ms(CLOCK_PROCESS_CPUTIME_ID) - c0);
+        r->submit_ms.push_back(t1 - t0);
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT, &prims);
+        r->draw_calls.push_back(calls);
+        r->primitives.push_back(prims);
+    }
+    if (output) save_ppm(output, sc->name, width, height);
+
+    sc->release();
+    glDeleteQueries(1, &query);
+    glDeleteRenderbuffers(2, rb);
+    glDeleteFramebuffers(1, &fbo);
+    eglMakeCurrent(display(), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display(), ctx);
+}
+
+static double percentile(std::vector<double> v, double p)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(p * (v.size() - 1) + 0.5)];
+}
+
+static double mean(const std::vector<double>& v)
+{
+    double sum = 0;
+    for (size_t i = 0; i < v.size(); i++) sum += v[i];
+    return v.empty() ? 0 : sum / v.size();
+}
+
+template <class T>
+static void json_array(FILE* fp, const char* key, const std::vector<T>& v, const char* fmt)
+{
+    fprintf(fp, "      \"%s\": [", key);
+    for (size_t i = 0; i < v.size(); i++) {
+        if (i) fputs(i % 16 ? ", " : ",\n        ", fp);
+        fprintf(fp, fmt, v[i]);
+    }
+    fputs("]", fp);
+}
+
+static void write_json(FILE* fp, const char* renderer, const char* input, int width, int height,
+                       const std::vector<result>& results)
+{
+    fprintf(fp, "{\n  \"renderer\": \"%s\",\n  \"input\": \"%s\",\n  \"width\": %d,\n  \"height\": %d,\n"
+                "  \"scenes\": [\n", renderer, input ? input : "synthetic", width, height);
+    for (size_t i = 0; i < results.size(); i++) {
+        const result& x = results[i];
+        fprintf(fp, "    {\n      \"name\": \"%s\",\n      \"frames\": %d,\n", x.name, (int)x.ms.size());
+        fprintf(fp, "      \"mean_ms\": %.4f,\n      \"p50_ms\": %.4f,\n      \"p95_ms\": %.4f,\n"
+                    "      \"mean_cpu_ms\": %.4f,\n",
+                mean(x.ms), percentile(x.ms, 0.5), percentile(x.ms, 0.95), mean(x.cpu_ms));
+        json_array(fp, "frame_ms", x.ms, "%.4f");       fputs(",\n", fp);
+        json_array(fp, "cpu_ms", x.cpu_ms, "%.4f");     fputs(",\n", fp);
+        json_array(fp, "submit_ms", x.submit_ms, "%.4f"); fputs(",\n", fp);
+        json_array(fp, "draw_calls", x.draw_calls, "%d"); fputs(",\n", fp);
+        json_array(fp, "prims", x.primitives, "%d");
+        fprintf(fp, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fputs("  ]\n}\n", fp);
+}
+
+int main(int argc, char* argv[])
+{
+    int nframes = 300, width = 640, height = 480, opt;
+    const char* output = NULL;
+    const char* input = NULL;
+    const char* json = NULL;
+    std::vector<const scene*> selected;
+    static struct option loptions[] = {
+        {"help",   no_argument,       0, 'h'},
+        {"frames", required_argument, 0, 'n'},
+        {"width",  required_argument, 0, 'W'},
+        {"height", required_argument, 0, 'H'},
+        {"scene",  required_argument, 0, 's'},
+        {"input",  required_argument, 0, 'i'},
+        {"json",   required_argument, 0, 'j'},
+        {"output", required_argument, 0, 'o'},
+        {NULL,     0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "hn:W:H:s:i:j:o:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'n': nframes = strtol(optarg, NULL, 10); break;
+        case 'W': width   = strtol(optarg, NULL, 10); break;
+        case 'H': height  = strtol(optarg, NULL, 10); break;
+        case 'i': input   = optarg; break;
+        case 'j': json    = optarg; break;
+        case 'o': output  = optarg; break;
+        case 's': {
+            int k = 0;
+            while (k < nscenes && strcmp(optarg, scenes[k].name) != 0) k++;
+            if (k == nscenes) error("unknown scene");
+            selected.push_back(&scenes[k]);
+            break;
+        }
+        default:  usage();
+        }
+    }
+    if (nframes < 1 || width < 1 || height < 1) error("bad frame count or size");
+    if (selected.empty())
+        for (int k = 0; k < nscenes; k++) selected.push_back(&scenes[k]);
+
+    std::vector<glove_hand_pose_t> frames = session_frames(input, nframes);
+    std::vector<result> results(selected.size());
+    for (size_t k = 0; k < selected.size(); k++)
+        run(selected[k], frames, width, height, output, &results[k]);
+
+    EGLContext ctx = make_context(0);
+    char renderer[256];
+    snprintf(renderer, sizeof(renderer), "%s", (const char*)glGetString(GL_RENDERER));
+    eglMakeCurrent(display(), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display(), ctx);
+
+    FILE* out = stdout;
+    if (json && strcmp(json, "-") == 0) out = stderr;     // keep stdout clean for the JSON
+    fprintf(out, "# %s, %dx%d, %d frames of %s\n", renderer, width, height,
+            (int)frames.size() / 2, input ? input : "a synthetic session");
+    fprintf(out, "# scene            mean_ms   p50_ms   p95_ms   cpu_ms  submit_ms  draws/frame  prims/frame\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const result& x = results[i];
+        fprintf(out, "%-16s %9.3f %8.3f %8.3f %8.3f %10.3f %12d %12d\n", x.name, mean(x.ms),
+                percentile(x.ms, 0.5), percentile(x.ms, 0.95), mean(x.cpu_ms), mean(x.submit_ms),
+                x.draw_calls.back(), x.primitives.back());
+    }
+
+    if (json) {
+        FILE* fp = strcmp(json, "-") == 0 ? stdout : fopen(json, "w");
+        if (fp == NULL) error("couldn't write the JSON file");
+        write_json(fp, renderer, input, width, height, results);
+        if (fp != stdout) fclose(fp);
+    }
+    eglTerminate(display());
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "glovesource.h"
+#include "../arduino-serial/arduino-serial-lib.h"
+#include "../arduino-serial/glove-replay.h"
+#include "../arduino-serial/glove-shm.h"
+
+GloveSource::GloveSource(QObject *parent)
+    : QThread(parent), m_stop(false), m_recenter(false), m_notified(false)
+{
+    glove_handoff_init(&m_handoff);
+}
+
+GloveSource::~GloveSource()
+{
+    stop();
+}
+
+void GloveSource::open(const QString &port, int baud)
+{
+    stop();
+    m_port = port;
+    m_baud = baud;
+    m_stop = false;
+    m_notified = false;
+    glove_handoff_init(&m_handoff);
+    start();
+}
+
+void GloveSource::stop()
+{
+    m_stop = true;
+    wait();
+}
+
+void GloveSource::recenter()
+{
+    m_recenter = true;
+}
+
+bool GloveSource::latest(const glove_frame_t **frame)
+{
+    // clear first: a frame published after this gets its own frameReady()
+    m_notified = false;
+    return glove_handoff_latest(&m_handoff, frame);
+}
+
+void GloveSource::run()
+{
+    // a glove-record file instead of a port plays back at real time
+    // through the same stream; "shm:" or "shm:/name" takes a glove-tool
+    // broker's frames, fused and yaw corrected by the broker
+    QByteArray path = m_port.toLocal8Bit();
+    bool shared = m_port.startsWith("shm:");
+    bool replay = !shared && glove_rec_probe(path.constData());
+    glove_replay_t rp;
+    glove_shm_t shm;
+    int fd = -1;
+    if (shared ? glove_shm_open(&shm, path.length() > 4 ? path.constData() + 4 : NULL) != 0
+        : replay ? glove_replay_open(&rp, path.constData()) != 0
+                 : (fd = serialport_init(path.constData(), m_baud)) == -1) {
+        emit failed(tr("couldn't open %1").arg(m_port));
+        return;
+    }
+
+    glove_stream_t st;
+    glove_stream_init(&st);
+    st.trace = m_trace;
+    st.metrics = m_metrics;
+    if (m_metrics && m_opens++) glove_metrics_add(m_metrics, GLOVE_METRIC_RECONNECTS, 1);
+    // short poll timeout, it is how quickly stop() gets noticed
+    while (!m_stop) {
+        if (m_recenter.exchange(false))
+            glove_stream_recenter(&st);
+        int n = shared ? glove_shm_poll(&shm, 50, &m_handoff)
+              : replay ? glove_replay_poll(&rp, &st, 50, &m_handoff)
+                       : glove_stream_poll(&st, fd, 50, &m_handoff);
+        if (n < 0) {
+            emit failed((replay ? tr("end of %1") : tr("lost %1")).arg(m_port));
+            break;
+        }
+        if (n > 0 && !m_notified.exchange(true))
+            emit frameReady();
+    }
+    if (shared) glove_shm_close(&shm);
+    else if (replay) glove_replay_close(&rp);
+    else serialport_close(fd);
+}
@@ -0,0 +1,59 @@
+#ifndef GLOVESOURCE_H
+#define GLOVESOURCE_H
+
+#include <QThread>
+#include <atomic>
+#include "../arduino-serial/glove-interp.h"
+
+// Reads the glove on its own thread so the GUI never waits on the serial
+// port.  Every sample is fused there and handed to the GUI through a
+// lock-free triple buffer (glove-stream.h); frameReady() is emitted at
+// most once until the GUI has picked the frame up, so a fast glove
+// can't flood the event queue.
+class GloveSource : public QThread
+{
+    Q_OBJECT
+
+public:
+    GloveSource(QObject *parent = 0);
+    ~GloveSource();
+
+    // port is a serial device, a glove-record file to play back, or
+    // "shm:" for a glove-tool broker's shared memory ("shm:/name")
+    void open(const QString &port, int baud);
+    void stop();
+    // forget the neutral finger splay, the next flat hand records it again
+    void recenter();
+    // trace every sample into trace (glove-trace.h) from the next open();
+    // it must outlive the thread
+    void setTrace(glove_trace_t *trace) { m_trace = trace; }
+    // keep the reader's metrics (glove-metrics.h) from the next open(); a
+    // second open() counts as a reconnect
+    void setMetrics(glove_metrics_t *metrics) { m_metrics = metrics; }
+
+    // GUI thread: newest frame, true if it is new since the last call
+    bool latest(const glove_frame_t **frame);
+    // GUI thread: frame, from latest(), and every sample published since
+    // the one ip took last
+    void interpolate(glove_interp_t *ip, const glove_frame_t *frame) { glove_interp_take(ip, &m_handoff, frame); }
+
+signals:
+    void frameReady();
+    void failed(const QString &why);
+
+protected:
+    void run();
+
+private:
+    QString m_port;
+    int m_baud = 115200;
+    std::atomic<bool> m_stop;
+    std::atomic<bool> m_recenter;
+    std::atomic<bool> m_notified;   // frameReady() sent, not picked up yet
+    glove_handoff_t m_handoff;
+    glove_trace_t *m_trace = nullptr;
+    glove_metrics_t *m_metrics = nullptr;
+    int m_opens = 0;
+};
+
+#endif // GLOVESOURCE_H
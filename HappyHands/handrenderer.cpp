@@ -0,0 +1,330 @@
+#include "handrenderer.h"
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+// uniform block slots: joints first, bones from BoneSlot
+static const int JointSlot = 0;
+static const int BoneSlot = 64;
+static const int Slots = 128;
+
+static const char *vertexSource =
+    "#version 330 core\n"
+    "layout(location = 0) in vec3 position;\n"
+    "layout(location = 1) in vec3 normal;\n"
+    "layout(std140) uniform Instances { mat4 model[128]; };\n"
+    "uniform mat4 viewProj;\n"
+    "uniform int first;\n"
+    "uniform vec3 color;\n"
+    "out vec3 shade;\n"
+    "void main() {\n"
+    "    mat4 m = model[first + gl_InstanceID];\n"
+    "    vec3 n = normalize(mat3(m) * normal);\n"
+    "    float d = max(dot(n, normalize(vec3(0.3, -0.5, 1.0))), 0.0);\n"
+    "    shade = color * (0.25 + 0.75 * d);\n"
+    "    gl_Position = viewProj * m * vec4(position, 1.0);\n"
+    "}\n";
+
+static const char *fragmentSource =
+    "#version 330 core\n"
+    "in vec3 shade;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragColor = vec4(shade, 1.0);\n"
+    "}\n";
+
+static const float jointColor[3] = { 0.9f, 0.6f, 0.2f };
+static const float boneColor[3]  = { 0.8f, 0.8f, 0.85f };
+
+HandRenderer::HandRenderer()
+{
+}
+
+HandRenderer::~HandRenderer()
+{
+    // GL objects need the context; the owner calls release() while it is current
+}
+
+bool HandRenderer::init(Path path)
+{
+    m_path = path;
+    if (path == Immediate) {
+#ifdef HANDRENDERER_LIBGL
+        return true;
+#else
+        m_error = "immediate mode is only built into render-bench";
+        return false;
+#endif
+    }
+    if (!initializeOpenGLFunctions()) {
+        m_error = "no OpenGL 3.3 core context";
+        return false;
+    }
+    return initInstanced();
+}
+
+unsigned HandRenderer::compile(unsigned type, const char *source)
+{
+    GLuint s = glCreateShader(type);
+    glShaderSource(s, 1, &source, NULL);
+    glCompileShader(s);
+    GLint ok = 0;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        m_error = type == GL_VERTEX_SHADER ? "vertex shader failed to compile"
+                                          : "fragment shader failed to compile";
+        glDeleteShader(s);
+        return 0;
+    }
+    return s;
+}
+
+// unit sphere and unit cylinder (radius 1, y 0..1), position + normal
+static void buildMeshes(std::vector<float> &v, std::vector<unsigned short> &idx, int *cylinderBase, int *cylinderOffset)
+{
+    const int ss = HandRenderer::SphereSlices, st = HandRenderer::SphereStacks;
+    for (int i = 0; i <= st; i++) {
+        float phi = M_PI * i / st;
+        for (int j = 0; j <= ss; j++) {
+            float th = 2 * M_PI * j / ss;
+            float n[3] = { sinf(phi) * cosf(th), cosf(phi), sinf(phi) * sinf(th) };
+            v.insert(v.end(), { n[0], n[1], n[2], n[0], n[1], n[2] });
+        }
+    }
+    for (int i = 0; i < st; i++) {
+        for (int j = 0; j < ss; j++) {
+            unsigned short a = i * (ss + 1) + j, b = a + ss + 1;
+            idx.insert(idx.end(), { a, (unsigned short)(a + 1), b, b, (unsigned short)(a + 1), (unsigned short)(b + 1) });
+        }
+    }
+
+    // cylinder: side ring pairs, then the two caps, indices relative to its base vertex
+    const int cs = HandRenderer::CylinderSlices;
+    *cylinderBase = v.size() / 6;
+    *cylinderOffset = idx.size();
+    for (int j = 0; j <= cs; j++) {
+        float th = 2 * M_PI * j / cs, c = cosf(th), s = sinf(th);
+        v.insert(v.end(), { c, 0, s, c, 0, s });
+        v.insert(v.end(), { c, 1, s, c, 0, s });
+    }
+    for (int j = 0; j < cs; j++) {
+        unsigned short a = j * 2;
+        idx.insert(idx.end(), { a, (unsigned short)(a + 2), (unsigned short)(a + 1),
+                                (unsigned short)(a + 1), (unsigned short)(a + 2), (unsigned short)(a + 3) });
+    }
+    for (int cap = 0; cap < 2; cap++) {
+        unsigned short centre = v.size() / 6 - *cylinderBase;
+        float y = (float)cap, ny = cap ? 1.0f : -1.0f;
+        v.insert(v.end(), { 0, y, 0, 0, ny, 0 });
+        for (int j = 0; j <= cs; j++) {
+            float th = 2 * M_PI * j / cs;
+            v.insert(v.end(), { cosf(th), y, sinf(th), 0, ny, 0 });
+        }
+        for (int j = 0; j < cs; j++) {
+            unsigned short a = centre + 1 + j;
+            if (cap) idx.insert(idx.end(), { centre, (unsigned short)(a + 1), a });
+            else     idx.insert(idx.end(), { centre, a, (unsigned short)(a + 1) });
+        }
+    }
+}
+
+bool HandRenderer::initInstanced()
+{
+    GLuint vs = compile(GL_VERTEX_SHADER, vertexSource);
+    GLuint fs = vs ? compile(GL_FRAGMENT_SHADER, fragmentSource) : 0;
+    if (!vs || !fs) {
+        if (vs) glDeleteShader(vs);
+        return false;
+    }
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vs);
+    glAttachShader(m_program, fs);
+    glLinkProgram(m_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        m_error = "shader program failed to link";
+        release();
+        return false;
+    }
+    m_viewProjLoc = glGetUniformLocation(m_program, "viewProj");
+    m_firstLoc = glGetUniformLocation(m_program, "first");
+    m_colorLoc = glGetUniformLocation(m_program, "color");
+    glUniformBlockBinding(m_program, glGetUniformBlockIndex(m_program, "Instances"), 0);
+
+    std::vector<float> v;
+    std::vector<unsigned short> idx;
+    buildMeshes(v, idx, &m_cylinderBase, &m_cylinderOffset);
+    m_sphereIndices = m_cylinderOffset;
+    m_cylinderIndices = idx.size() - m_cylinderOffset;
+
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+    glGenBuffers(1, &m_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &m_ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned short), idx.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)(3 * sizeof(float)));
+    glBindVertexArray(0);
+
+    glGenBuffers(1, &m_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, Slots * 16 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    if (glGetError() != GL_NO_ERROR) {
+        m_error = "GL error while creating buffers";
+        release();
+        return false;
+    }
+    return true;
+}
+
+void HandRenderer::release()
+{
+    if (m_program) glDeleteProgram(m_program);
+    if (m_vao) glDeleteVertexArrays(1, &m_vao);
+    if (m_vbo) glDeleteBuffers(1, &m_vbo);
+    if (m_ibo) glDeleteBuffers(1, &m_ibo);
+    if (m_ubo) glDeleteBuffers(1, &m_ubo);
+    m_program = m_vao = m_vbo = m_ibo = m_ubo = 0;
+}
+
+void HandRenderer::draw(const glove_hand_pose_t *hands, int nhands, const float viewProj[16])
+{
+    if (nhands > MaxHands) nhands = MaxHands;
+    m_drawCalls = m_triangles = 0;
+    if (m_path == Instanced && m_program) drawInstanced(hands, nhands, viewProj);
+#ifdef HANDRENDERER_LIBGL
+    else if (m_path == Immediate) drawImmediate(hands, nhands, viewProj);
+#endif
+}
+
+void HandRenderer::drawInstanced(const glove_hand_pose_t *hands, int nhands, const float viewProj[16])
+{
+    float m[Slots][16];
+    int joints = 0, bones = 0;
+    for (int h = 0; h < nhands; h++) {
+        for (int j = 0; j < GLOVE_KIN_JOINTS; j++, joints++)
+            glove_kin_joint_matrix(hands[h].joints[j], hands[h].joint_radius[j], m[JointSlot + joints]);
+        for (int b = 0; b < GLOVE_KIN_BONES; b++, bones++)
+            glove_kin_bone_matrix(&hands[h].bones[b], m[BoneSlot + bones]);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, JointSlot * 64, joints * 64, m[JointSlot]);
+    glBufferSubData(GL_UNIFORM_BUFFER, BoneSlot * 64, bones * 64, m[BoneSlot]);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_ubo);
+
+    glUseProgram(m_program);
+    glUniformMatrix4fv(m_viewProjLoc, 1, GL_FALSE, viewProj);
+    glBindVertexArray(m_vao);
+
+    glUniform1i(m_firstLoc, JointSlot);
+    glUniform3fv(m_colorLoc, 1, jointColor);
+    glDrawElementsInstanced(GL_TRIANGLES, m_sphereIndices, GL_UNSIGNED_SHORT, (void *)0, joints);
+
+    glUniform1i(m_firstLoc, BoneSlot);
+    glUniform3fv(m_colorLoc, 1, boneColor);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_cylinderIndices, GL_UNSIGNED_SHORT,
+                                      (void *)(m_cylinderOffset * sizeof(unsigned short)), bones, m_cylinderBase);
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    m_drawCalls = 2;
+    m_triangles = (joints * m_sphereIndices + bones * m_cylinderIndices) / 3;
+}
+
+#ifdef HANDRENDERER_LIBGL
+// as p5hand does it: a fresh quadric and full tessellation per object
+void HandRenderer::drawImmediate(const glove_hand_pose_t *hands, int nhands, const float viewProj[16])
+{
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(viewProj);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_COLOR_MATERIAL);
+    glEnable(GL_NORMALIZE);         // the model matrices scale
+    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+
+    int calls = 0, tris = 0;
+    float m[16];
+    for (int h = 0; h < nhands; h++) {
+        glColor3fv(jointColor);
+        for (int j = 0; j < GLOVE_KIN_JOINTS; j++) {
+            glove_kin_joint_matrix(hands[h].joints[j], hands[h].joint_radius[j], m);
+            glPushMatrix();
+            glMultMatrixf(m);
+            GLUquadric *q = gluNewQuadric();
+            gluSphere(q, 1, SphereSlices, SphereStacks);
+            gluDeleteQuadric(q);
+            glPopMatrix();
+            calls += SphereStacks;
+            tris += SphereSlices * SphereStacks * 2;
+        }
+        glColor3fv(boneColor);
+        for (int b = 0; b < GLOVE_KIN_BONES; b++) {
+            glove_kin_bone_matrix(&hands[h].bones[b], m);
+            glPushMatrix();
+            glMultMatrixf(m);
+            glRotatef(-90, 1, 0, 0);        // glu cylinders run along +z
+            GLUquadric *q = gluNewQuadric();
+            gluCylinder(q, 1, 1, 1, CylinderSlices, 1);
+            gluDisk(q, 0, 1, CylinderSlices, 1);
+            glTranslatef(0, 0, 1);
+            gluDisk(q, 0, 1, CylinderSlices, 1);
+            gluDeleteQuadric(q);
+            glPopMatrix();
+            calls += 3;
+            tris += CylinderSlices * 4;
+        }
+    }
+    glDisable(GL_LIGHTING);
+    m_drawCalls = calls;
+    m_triangles = tris;
+}
+#endif
+
+void HandRenderer::perspective(float fovyDeg, float aspect, float zNear, float zFar, float m[16])
+{
+    float f = 1.0f / tanf(fovyDeg * (float)M_PI / 360.0f);
+    memset(m, 0, 16 * sizeof(float));
+    m[0] = f / aspect;
+    m[5] = f;
+    m[10] = (zFar + zNear) / (zNear - zFar);
+    m[11] = -1;
+    m[14] = 2 * zFar * zNear / (zNear - zFar);
+}
+
+void HandRenderer::lookAt(const float eye[3], const float center[3], const float up[3], float m[16])
+{
+    glove_vec3_t e = glove_vec3(eye[0], eye[1], eye[2]);
+    glove_vec3_t f = glove_vec3_sub(glove_vec3(center[0], center[1], center[2]), e);
+    f = glove_vec3_scale(f, 1.0f / glove_vec3_len(f));
+    glove_vec3_t s = glove_vec3_cross(f, glove_vec3(up[0], up[1], up[2]));
+    s = glove_vec3_scale(s, 1.0f / glove_vec3_len(s));
+    glove_vec3_t u = glove_vec3_cross(s, f);
+    float r[16] = { s.x, u.x, -f.x, 0,  s.y, u.y, -f.y, 0,  s.z, u.z, -f.z, 0,
+                    -glove_vec3_dot(s, e), -glove_vec3_dot(u, e), glove_vec3_dot(f, e), 1 };
+    memcpy(m, r, sizeof(r));
+}
+
+void HandRenderer::multiply(const float a[16], const float b[16], float out[16])
+{
+    float r[16];
+    for (int c = 0; c < 4; c++)
+        for (int row = 0; row < 4; row++)
+            r[c * 4 + row] = a[row] * b[c * 4] + a[4 + row] * b[c * 4 + 1]
+                           + a[8 + row] * b[c * 4 + 2] + a[12 + row] * b[c * 4 + 3];
+    memcpy(out, r, sizeof(r));
+}
@@ -0,0 +1,80 @@
+#ifndef HANDRENDERER_H
+#define HANDRENDERER_H
+
+#include "../arduino-serial/glove-kinematics.h"
+
+#ifdef HANDRENDERER_LIBGL
+// bench/render-bench, without Qt: Mesa's libGL exports every entry point,
+// so the calls go straight to it
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <GL/glu.h>
+struct HandRendererFunctions {
+    bool initializeOpenGLFunctions() { return true; }
+};
+#else
+#include <QOpenGLFunctions_3_3_Core>
+typedef QOpenGLFunctions_3_3_Core HandRendererFunctions;
+#endif
+
+// Draws up to two hands from glove-kinematics poses.
+//
+// Instanced: GL 3.3 core, resolved through QOpenGLFunctions_3_3_Core.
+// Sphere and cylinder meshes live in one static VBO; every frame the bone
+// and joint matrices go into one uniform buffer and the hands are two
+// instanced draws, all joints of both hands in one and all bones in the
+// other.
+//
+// Immediate: the old way (glBegin, a gluQuadric per object per frame,
+// like p5hand), kept for comparison in bench/render-bench only.  It needs
+// a compatibility context, so it is built with HANDRENDERER_LIBGL alone.
+class HandRenderer : protected HandRendererFunctions
+{
+public:
+    enum Path { Instanced, Immediate };
+
+    static const int MaxHands = 2;
+    static const int SphereSlices = 16, SphereStacks = 12;
+    static const int CylinderSlices = 16;
+
+    HandRenderer();
+    ~HandRenderer();
+
+    // with the target context current; false if the path can't run here,
+    // and draw() then draws nothing
+    bool init(Path path);
+    void release();
+    Path path() const { return m_path; }
+    const char *errorString() const { return m_error; }
+
+    void draw(const glove_hand_pose_t *hands, int nhands, const float viewProj[16]);
+
+    // what the last draw() submitted
+    int drawCalls() const { return m_drawCalls; }
+    int triangles() const { return m_triangles; }
+
+    // column-major helpers for callers without a matrix library
+    static void perspective(float fovyDeg, float aspect, float zNear, float zFar, float m[16]);
+    static void lookAt(const float eye[3], const float center[3], const float up[3], float m[16]);
+    static void multiply(const float a[16], const float b[16], float out[16]);
+
+private:
+    unsigned compile(unsigned type, const char *source);
+    bool initInstanced();
+    void drawInstanced(const glove_hand_pose_t *hands, int nhands, const float viewProj[16]);
+#ifdef HANDRENDERER_LIBGL
+    void drawImmediate(const glove_hand_pose_t *hands, int nhands, const float viewProj[16]);
+#endif
+
+    Path m_path = Instanced;
+    const char *m_error = "";
+    unsigned m_program = 0, m_vao = 0, m_vbo = 0, m_ibo = 0, m_ubo = 0;
+    int m_viewProjLoc = -1, m_firstLoc = -1, m_colorLoc = -1;
+    int m_sphereIndices = 0, m_cylinderIndices = 0, m_cylinderBase = 0, m_cylinderOffset = 0;
+    int m_drawCalls = 0, m_triangles = 0;
+};
+
+#endif // HANDRENDERER_H
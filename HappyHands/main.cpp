@@ -1,11 +1,52 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QSurfaceFormat>
+#include <string.h>
 
 int main(int argc, char *argv[])
 {
+    // OGLWidget paces itself on frameSwapped, which needs vsync.  3.3 core
+    // for the instanced hand renderer; macOS has no newer compatibility
+    // context
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setSwapInterval(1);
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setDepthBufferSize(24);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    // --trace=file: per-stage latency on exit, and a Chrome trace JSON;
+    // --metrics=socket: Prometheus text for a scraper while running
+    const char *tracePath = NULL, *metricsPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--trace=", 8) == 0) tracePath = argv[i] + 8;
+        if (strncmp(argv[i], "--metrics=", 10) == 0) metricsPath = argv[i] + 10;
+    }
+    static glove_trace_t trace;
+    if (tracePath && glove_trace_init(&trace, 0) != 0) return 1;
+    static glove_metrics_t metrics;
+    glove_metrics_init(&metrics);
+    if (metricsPath && glove_metrics_serve(&metrics, metricsPath) != 0) {
+        perror(metricsPath);
+        return 1;
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
-    w.show();
-    return a.exec();
+    int rc;
+    {
+        MainWindow w;
+        if (tracePath) w.setTrace(&trace);
+        if (metricsPath) w.setMetrics(&metrics);
+        w.show();
+        rc = a.exec();
+    }   // the glove thread is stopped with the window
+    glove_metrics_close(&metrics);
+
+    if (tracePath) {
+        glove_trace_report(&trace, stdout);
+        if (glove_trace_write_json(&trace, tracePath) != 0) perror(tracePath);
+        glove_trace_free(&trace);
+    }
+    return rc;
 }
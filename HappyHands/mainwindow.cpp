@@ -1,14 +1,37 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 //#include <oglwidget.h>
-#include <arduino.h>
+#include "glovesource.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , m_glove(new GloveSource(this))
 {
     ui->setupUi(this);
 
+    // the serial port is read on GloveSource's thread, never on this one
+    connect(m_glove, &GloveSource::failed, this, [this](const QString &why) {
+        ui->statusbar->showMessage(why);
+    });
+    connect(m_glove, &QThread::finished, this, &MainWindow::gloveStopped);
+    gloveStopped();
+
+#ifdef OPENGL
+    ui->openGLWidget->setSource(m_glove);
+    ui->openGLWidget->setInterpolationDelay(ui->delayBox->value());
+    connect(ui->delayBox, QOverload<int>::of(&QSpinBox::valueChanged), ui->openGLWidget, &OGLWidget::setInterpolationDelay);
+    connect(ui->openGLWidget, &OGLWidget::frameStats, this, [this](double frameMs, double latencyMs) {
+        // latency includes the smoothing delay; "late" says it is too short
+        QString msg = QString("frame %1 ms  latency %2 ms  smoothing %3 ms, %4% late")
+                      .arg(frameMs, 0, 'f', 1).arg(latencyMs, 0, 'f', 1)
+                      .arg(ui->openGLWidget->interpolationDelayMs(), 0, 'f', 0)
+                      .arg(ui->openGLWidget->interpolationLate() * 100, 0, 'f', 1);
+        int joint = ui->openGLWidget->pointedJoint();
+        if (joint >= 0) msg += QString("  pointing at left joint %1").arg(joint);
+        ui->statusbar->showMessage(msg);
+    });
+#endif
 
 #ifdef OPENGL3
   //  widget = new IrrlichtWidget( ui->tabWidget->findChild<QWidget *>("irrRenderWidget0") );
@@ -32,11 +55,49 @@ widget2->resize(ui->openGLWidget->width(),ui->openGLWidget->height());
 
 MainWindow::~MainWindow()
 {
+    m_glove->stop();
     delete ui;
 }
 
 
+void MainWindow::setTrace(glove_trace_t *trace)
+{
+    m_glove->setTrace(trace);
+#ifdef OPENGL
+    ui->openGLWidget->setTrace(trace);
+#endif
+}
+
+void MainWindow::setMetrics(glove_metrics_t *metrics)
+{
+    m_glove->setMetrics(metrics);
+#ifdef OPENGL
+    ui->openGLWidget->setMetrics(metrics);
+#endif
+}
+
 void MainWindow::on_pushButton_clicked()
 {
-    main3();
+    // this used to run arduino.h's main3(), a blocking read loop, right
+    // here on the GUI thread; now it re-zeroes the live fingers' splay
+    m_glove->recenter();
+    ui->statusbar->showMessage(tr("hold the hand flat to recenter the fingers"));
+}
+
+void MainWindow::on_startButton_clicked()
+{
+    m_glove->open(ui->portEdit->text(), ui->baudBox->currentText().toInt());
+    ui->startButton->setEnabled(false);
+    ui->stopButton->setEnabled(true);
+}
+
+void MainWindow::on_stopButton_clicked()
+{
+    m_glove->stop();
+}
+
+void MainWindow::gloveStopped()
+{
+    ui->startButton->setEnabled(true);
+    ui->stopButton->setEnabled(false);
 }
@@ -2,6 +2,10 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include "../arduino-serial/glove-metrics.h"
+#include "../arduino-serial/glove-trace.h"
+
+class GloveSource;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -15,10 +19,19 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // trace the glove from the next start to its swaps (--trace)
+    void setTrace(glove_trace_t *trace);
+    // keep the pipeline's metrics from the next start (--metrics)
+    void setMetrics(glove_metrics_t *metrics);
+
 private slots:
     void on_pushButton_clicked();
+    void on_startButton_clicked();
+    void on_stopButton_clicked();
+    void gloveStopped();
 
 private:
     Ui::MainWindow *ui;
+    GloveSource *m_glove;
 };
 #endif // MAINWINDOW_H
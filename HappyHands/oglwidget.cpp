@@ -1,6 +1,5 @@
 #ifdef OPENGL
 #include "oglwidget.h"
-#include <QThread>
 #include <qevent.h>
 //https://stackoverflow.com/questions/31522637/how-do-i-render-a-triangle-in-qopenglwidget/31524956
 OGLWidget::OGLWidget(QWidget *parent)
@@ -14,49 +13,175 @@ OGLWidget::OGLWidget(QWidget *parent)
 
         this->installEventFilter(this);
 
+    // both hands at rest until the glove says otherwise
+    glove_quat_t rest[6];
+    for (int k = 0; k < 6; k++) rest[k] = glove_quat_identity();
+    for (int h = 0; h < HandRenderer::MaxHands; h++)
+        glove_kin_hand(rest, 6, glove_vec3(h ? -0.12f : 0.12f, 0, 0), h, &m_hands[h]);
+    glove_interp_init(&m_interp, GLOVE_INTERP_DELAY_MS);
+
+    connect(this, &QOpenGLWidget::frameSwapped, this, &OGLWidget::onFrameSwapped);
 }
 
 OGLWidget::~OGLWidget()
 {
-
+    makeCurrent();
+    m_renderer.release();
+    doneCurrent();
 }
 
 void OGLWidget::initializeGL()
 {
+    initializeOpenGLFunctions();
     glClearColor(0,0,0,1);
     glEnable(GL_DEPTH_TEST);
-    glEnable(GL_LIGHT0);
-    glEnable(GL_LIGHTING);
-    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
-    glEnable(GL_COLOR_MATERIAL);
+
+    // the hands light themselves in the shader; without the 3.3 core
+    // context main.cpp asks for there is nothing to draw them with
+    if (!m_renderer.init(HandRenderer::Instanced))
+        qWarning("OGLWidget: %s, hands are not drawn", m_renderer.errorString());
 }
 
-void OGLWidget::paintGL()
+void OGLWidget::setHandPose(int hand, const glove_quat_t *q, int nsensors, qint64 inputNs)
 {
-            QThread::usleep(8000);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (hand < 0 || hand >= HandRenderer::MaxHands) return;
+    glove_kin_hand(q, nsensors, glove_vec3(hand ? -0.12f : 0.12f, 0, 0), hand, &m_hands[hand]);
+    pointCursor();
+    notifySample(inputNs);
+}
 
-    glBegin(GL_TRIANGLES);
-        glColor3f(1.0, 0.0, 0.0);
-        glVertex3f(-0.5, -0.5, 0);
-        glColor3f(0.0, 1.0, 0.0);
-        glVertex3f( 0.5, -0.5, 0);
-        glColor3f(0.0, 0.0, 1.0);
-        glVertex3f( 0.0,  0.5, 0);
-    glEnd();
+// a ray from the right index tip along its last bone, against the left
+// hand's joints padded by a centimetre; the hands move every pose, so
+// the pick set is refilled with them
+void OGLWidget::pointCursor()
+{
+    const glove_hand_pose_t *right = &m_hands[0];
+    glove_vec3_t dip = right->joints[1 + 1 * 4 + 2], tip = right->joints[1 + 1 * 4 + 3];
+    glove_vec3_t d = glove_vec3_sub(tip, dip);
+    float len = glove_vec3_len(d);
+    m_pointed = -1;
+    if (len <= 0) return;
+    glove_ray_t ray;
+    ray.o = tip;
+    ray.d = glove_vec3_scale(d, 1 / len);
+    glove_pick_init(&m_pick);
+    glove_pick_add_hand(&m_pick, 0, &m_hands[1], 0.01f);
+    m_pointed = glove_pick_ray(&m_pick, &ray, nullptr);
+}
 
+void OGLWidget::setSource(GloveSource *source)
+{
+    if (m_source) disconnect(m_source, nullptr, this, nullptr);
+    m_source = source;
+    if (m_source) connect(m_source, &GloveSource::frameReady, this, [this]() { notifySample(); });
+    glove_interp_init(&m_interp, interpolationDelayMs());
+}
+
+void OGLWidget::setInterpolationDelay(double ms)
+{
+    glove_interp_set_delay(&m_interp, ms);
+    scheduleFrame();
+}
+
+qint64 OGLWidget::clockNs()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) clock.start();
+    return clock.nsecsElapsed();
+}
+
+void OGLWidget::notifySample(qint64 inputNs)
+{
+    if (!m_dirty) m_inputNs = inputNs ? inputNs : clockNs();
+    m_dirty = true;
+    scheduleFrame();
+}
+
+void OGLWidget::setAnimating(bool on)
+{
+    m_animating = on;
+    if (on) scheduleFrame();
+}
+
+// at most one update() in flight: anything arriving meanwhile is picked
+// up by the repaint onFrameSwapped() asks for
+void OGLWidget::scheduleFrame()
+{
+    if (m_pending) return;
+    m_pending = true;
+    update();
+}
+
+void OGLWidget::onFrameSwapped()
+{
+    qint64 now = clockNs();
+    if (m_lastSwapNs) m_frameMs = (now - m_lastSwapNs) * 1e-6;
+    m_lastSwapNs = now;
+    if (m_spanPainted) {
+        m_span.t[GLOVE_TRACE_PRESENT] = glove_monotonic_ns();
+        glove_trace_frame(m_trace, &m_span);
+        m_spanPainted = false;
+    }
+    if (m_paintedInputNs) {
+        m_latencyMs = (now - m_paintedInputNs) * 1e-6;
+        m_paintedInputNs = 0;
+    }
+    emit frameStats(m_frameMs, m_latencyMs);
+
+    m_pending = false;
+    if (m_dirty || m_animating || m_interpMoving) scheduleFrame();
+    else m_lastSwapNs = 0;          // idle, the next frame time starts afresh
+}
+
+void OGLWidget::paintGL()
+{
+    if (m_dirty) m_paintedInputNs = m_inputNs;
+    m_dirty = false;
+
+    const glove_frame_t *f;
+    if (m_source) {
+        bool fresh = m_source->latest(&f);
+        if (m_metrics && f->seq) glove_stream_drawn(m_metrics, f, &m_drawnSeq);
+        // traced: the newest sample, the first time a paint takes it
+        if (m_trace && f->seq && f->trace.id != m_span.id) {
+            m_span = f->trace;
+            m_span.t[GLOVE_TRACE_TAKE] = glove_monotonic_ns();
+            m_spanPainted = true;
+        }
+        const glove_quat_t *q = f->q;
+        glove_quat_t smooth[GLOVE_MAX_SENSORS];
+        if (m_interp.delay_ns > 0) {
+            m_source->interpolate(&m_interp, f);
+            bool moving = glove_interp_at(&m_interp, glove_monotonic_ns(), smooth);
+            // one more paint after the last step lands exactly on the newest
+            fresh = fresh || moving || m_interpMoving;
+            m_interpMoving = moving;
+            q = smooth;
+        }
+        if (fresh) {
+            for (int h = 0; h < HandRenderer::MaxHands && h * GLOVE_HAND_SENSORS < f->nsensors; h++)
+                glove_kin_hand(&q[h * GLOVE_HAND_SENSORS], qMin(GLOVE_HAND_SENSORS, f->nsensors - h * GLOVE_HAND_SENSORS),
+                               glove_vec3(h ? -0.12f : 0.12f, 0, 0), h, &m_hands[h]);
+            pointCursor();
+            // the reader stamps on CLOCK_MONOTONIC, move that onto clockNs();
+            // interpolated, what is shown is the delay old
+            m_paintedInputNs = clockNs() - (m_interp.delay_ns > 0 ? m_interp.delay_ns
+                                                                  : glove_monotonic_ns() - f->recv_ns);
+        }
+    }
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    m_renderer.draw(m_hands, HandRenderer::MaxHands, m_viewProj);
+    if (m_spanPainted) m_span.t[GLOVE_TRACE_SUBMIT] = glove_monotonic_ns();
 }
 
 void OGLWidget::resizeGL(int w, int h)
 {
     glViewport(0,0,w,h);
-   //     glViewport( 0, 0, w, qMax( h, 1 ) );
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(45, (float)w/h, 0.01, 100.0);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    gluLookAt(0,0,5,0,0,0,0,1,0);
+    float proj[16], view[16];
+    const float eye[3] = { 0, -0.35f, 0.30f }, center[3] = { 0, 0.08f, 0 }, up[3] = { 0, 0, 1 };
+    HandRenderer::perspective(45, (float)w / qMax(h, 1), 0.01f, 10, proj);
+    HandRenderer::lookAt(eye, center, up, view);
+    HandRenderer::multiply(proj, view, m_viewProj);
 }
 
 
@@ -4,20 +4,97 @@
 
 #include <QWidget>
 #include <QOpenGLWidget>
-#include <GL/glu.h>
-#include <GL/gl.h>
+#include <QOpenGLFunctions>
+#include <QElapsedTimer>
+#include "handrenderer.h"
+#include "glovesource.h"
+#include "../arduino-serial/glove-interp.h"
+#include "../arduino-serial/glove-pick.h"
 
-class OGLWidget : public QOpenGLWidget
+// Repaints only when something changed: a new glove sample or a running
+// animation.  Frames are paced by frameSwapped (vsync with swap interval
+// 1, see main.cpp), so an idle glove costs no CPU at all.
+//
+// With an interpolation delay the live hands are drawn as they were that
+// long ago, slerped between samples (glove-interp), and repainted every
+// vsync until they have caught up with the newest sample.
+//
+// The right index finger is the glove cursor: each new pose casts a ray
+// off its last bone and picks against the left hand's joints.
+class OGLWidget : public QOpenGLWidget, protected QOpenGLFunctions
 {
+    Q_OBJECT
+
 public:
     OGLWidget(QWidget *parent = 0);
     ~OGLWidget();
 
+    // monotonic clock the input timestamps are taken on, nanoseconds
+    static qint64 clockNs();
+
+    double frameTimeMs() const { return m_frameMs; }     // last swap to swap
+    double latencyMs() const   { return m_latencyMs; }   // oldest unshown sample to present
+    void setAnimating(bool on);
+    bool animating() const     { return m_animating; }
+
+    // orientations for one hand, q[0] palm then Thumb..Little; repaints
+    void setHandPose(int hand, const glove_quat_t *q, int nsensors, qint64 inputNs = 0);
+    // draw the hands from a live glove; each paint takes its newest frame
+    void setSource(GloveSource *source);
+    // 0 draws the newest sample as it comes; the delay adds to latencyMs()
+    void setInterpolationDelay(double ms);
+    double interpolationDelayMs() const { return m_interp.delay_ns * 1e-6; }
+    // share of paints that ran out of samples: raise the delay
+    double interpolationLate() const    { return m_interp.renders ? (double)m_interp.late / m_interp.renders : 0; }
+    // follow each new glove frame to its swap, into the source's trace
+    void setTrace(glove_trace_t *trace) { m_trace = trace; }
+    // count frames drawn and sample age into the source's metrics
+    void setMetrics(glove_metrics_t *metrics) { m_metrics = metrics; }
+    // left hand joint the glove cursor points at, -1 for none
+    int pointedJoint() const            { return m_pointed; }
+
+public slots:
+    // a new sample is ready to draw; inputNs is when it was captured on
+    // clockNs(), 0 for "now"
+    void notifySample(qint64 inputNs = 0);
+    void scheduleFrame();
+
+signals:
+    void frameStats(double frameMs, double latencyMs);
+
 protected:
     void initializeGL();
     void resizeGL(int w, int h);
     void paintGL();
          bool eventFilter( QObject *o, QEvent *e );
+
+private slots:
+    void onFrameSwapped();
+
+private:
+    void pointCursor();
+
+    bool   m_pending = false;       // update() issued, frame not presented yet
+    bool   m_dirty = false;         // something new since the last paint
+    bool   m_animating = false;
+    bool   m_interpMoving = false;  // interpolated hands not at the newest sample yet
+    qint64 m_inputNs = 0;           // oldest sample not yet painted
+    qint64 m_paintedInputNs = 0;    // ... and the one in the frame being swapped
+    qint64 m_lastSwapNs = 0;
+    GloveSource *m_source = nullptr;
+    glove_interp_t m_interp;
+    HandRenderer m_renderer;
+    glove_hand_pose_t m_hands[HandRenderer::MaxHands];
+    float m_viewProj[16];
+    double m_frameMs = 0;
+    double m_latencyMs = 0;
+    glove_trace_t *m_trace = nullptr;
+    glove_trace_span_t m_span = {}; // the frame being swapped, if m_spanPainted
+    bool   m_spanPainted = false;
+    glove_metrics_t *m_metrics = nullptr;
+    uint32_t m_drawnSeq = 0;
+    glove_pick_t m_pick;            // the left hand's joints, as last posed
+    int    m_pointed = -1;
 };
 
 #endif // OGLWIDGET_H
@@ -0,0 +1,221 @@
+//
+// arduino-serial-analyze -- what a serial link delivers, and when
+//
+
+#include "arduino-serial-analyze.h"
+#include "arduino-serial-lib.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+static void series_add(serial_series_t* s, float v)
+{
+    if (s->n == s->max) {
+        int max = s->max ? s->max * 2 : 4096;
+        float* p = (float*)realloc(s->v, max * sizeof(float));
+        if (!p) return;                 // keep what fits
+        s->v = p;
+        s->max = max;
+    }
+    s->v[s->n++] = v;
+}
+
+static int cmp_float(const void* a, const void* b)
+{
+    float x = *(const float*)a, y = *(const float*)b;
+    return x < y ? -1 : x > y;
+}
+
+// p of a sorted copy; 0 for none
+static void percentiles(const serial_series_t* s, const float* p, int np, float* out)
+{
+    float* v = s->n ? (float*)malloc(s->n * sizeof(float)) : NULL;
+    if (v) {
+        memcpy(v, s->v, s->n * sizeof(float));
+        qsort(v, s->n, sizeof(float), cmp_float);
+    }
+    for (int i = 0; i < np; i++) out[i] = v ? v[(int)(p[i] * (s->n - 1) + 0.5f)] : 0;
+    free(v);
+}
+
+int serial_analyze(int fd, int baud, char eolchar, double secs,
+                   volatile int* stop, serial_stats_t* st)
+{
+    memset(st, 0, sizeof(*st));
+    st->baud = baud;
+    st->low_latency = serialport_low_latency(fd, -1);
+
+    char line[SERIAL_ANALYZE_LINE_MAX];
+    int len = 0, rc = 0;
+    long prev = -1, top = 0;
+    double t0 = now_us(), end = t0 + secs * 1e6, last_frame = 0, last_wake = 0;
+    while (!(stop && *stop)) {
+        double t = now_us();
+        if (t >= end) break;
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ms = (int)((end - t) / 1000) + 1;
+        int n = poll(&pfd, 1, ms < 100 ? ms : 100);
+        if (n < 0 && errno != EINTR) { rc = -1; break; }
+        if (n <= 0) continue;
+
+        // what had piled up before this wakeup, then take it
+        t = now_us();
+        int queued = 0;
+        ioctl(fd, TIOCINQ, &queued);
+        char buf[4096];
+        n = read(fd, buf, sizeof(buf));
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+        if (n <= 0) { rc = -1; break; }
+        st->reads++;
+        st->bytes += n;
+        series_add(&st->read_bytes, n);
+        series_add(&st->queued, queued);
+        if (last_wake) series_add(&st->wake_us, t - last_wake);
+        last_wake = t;
+
+        for (int i = 0; i < n; i++) {
+            if (buf[i] != eolchar) {
+                if (len < SERIAL_ANALYZE_LINE_MAX - 1) line[len++] = buf[i];
+                else len = SERIAL_ANALYZE_LINE_MAX;         // too long
+                continue;
+            }
+            if (len == 0) continue;                         // blank, or the \n of \r\n
+            st->frames++;
+            if (last_frame) series_add(&st->arrival_us, t - last_frame);
+            last_frame = t;
+
+            long seq = -1;
+            if (len < SERIAL_ANALYZE_LINE_MAX) {
+                line[len] = 0;
+                seq = line[0] >= '0' && line[0] <= '9' ? strtol(line, NULL, 10) : -1;
+            }
+            len = 0;
+            if (seq < 0) {
+                st->bad++;
+                continue;
+            }
+            if (seq > top) top = seq;
+            if (prev >= 0) st->lost += (seq - prev - 1 + (top + 1)) % (top + 1);
+            prev = seq;
+        }
+    }
+    st->secs = (now_us() - t0) * 1e-6;
+    return rc;
+}
+
+void serial_stats_free(serial_stats_t* st)
+{
+    free(st->arrival_us.v);
+    free(st->wake_us.v);
+    free(st->read_bytes.v);
+    free(st->queued.v);
+    memset(st, 0, sizeof(*st));
+}
+
+//
+// reports
+//
+
+static const float pct[] = { 0.5f, 0.9f, 0.99f, 1.0f };
+
+// the line time of bytes, in ms: 8N1 is ten bits a byte
+static float line_ms(const serial_stats_t* st, float bytes)
+{
+    return st->baud > 0 ? bytes * 10 * 1000 / st->baud : 0;
+}
+
+static void row(FILE* fp, const char* name, const serial_series_t* s, float scale)
+{
+    float v[4];
+    percentiles(s, pct, 4, v);
+    fprintf(fp, "  %-20s %9.3f %9.3f %9.3f %9.3f\n", name, v[0] * scale, v[1] * scale, v[2] * scale, v[3] * scale);
+}
+
+static void histogram(FILE* fp, const char* title, const char* unit, const serial_series_t* s)
+{
+    unsigned count[SERIAL_ANALYZE_BUCKETS] = { 0 }, most = 0;
+    int lo = SERIAL_ANALYZE_BUCKETS, hi = -1;
+    for (int i = 0; i < s->n; i++) {
+        int b = 0;
+        while (b < SERIAL_ANALYZE_BUCKETS - 1 && s->v[i] >= (float)(1u << b)) b++;
+        if (++count[b] > most) most = count[b];
+        if (b < lo) lo = b;
+        if (b > hi) hi = b;
+    }
+    if (hi < 0) return;
+    fprintf(fp, "%s\n", title);
+    for (int b = lo; b <= hi; b++) {
+        char bar[41];
+        int w = (int)(40.0 * count[b] / most + 0.5);
+        memset(bar, '#', w);
+        bar[w] = 0;
+        fprintf(fp, "  < %8u %-2s |%-40s %u\n", 1u << b, unit, bar, count[b]);
+    }
+}
+
+void serial_stats_print(FILE* fp, const serial_stats_t* st)
+{
+    double secs = st->secs > 0 ? st->secs : 1;
+    fprintf(fp, "port:     %d baud, low latency %s, %.1f s\n", st->baud,
+            st->low_latency < 0 ? "n/a" : st->low_latency ? "on" : "off", st->secs);
+    fprintf(fp, "bytes:    %llu, %.0f B/s", (unsigned long long)st->bytes, st->bytes / secs);
+    if (st->baud > 0) fprintf(fp, " (%.0f%% of the line rate)", 100 * st->bytes / secs / (st->baud / 10.0));
+    fprintf(fp, "\nframes:   %llu, %.1f/s; %llu bad; %llu lost by sequence (%.2f%%)\n",
+            (unsigned long long)st->frames, st->frames / secs, (unsigned long long)st->bad,
+            (unsigned long long)st->lost, st->frames ? 100.0 * st->lost / (st->frames + st->lost) : 0);
+    fprintf(fp, "reads:    %llu, %.1f B each\n", (unsigned long long)st->reads,
+            st->reads ? (double)st->bytes / st->reads : 0);
+    fprintf(fp, "  %-20s %9s %9s %9s %9s\n", "", "p50", "p90", "p99", "max");
+    row(fp, "arrival ms", &st->arrival_us, 1e-3f);
+    row(fp, "wakeup ms", &st->wake_us, 1e-3f);
+    row(fp, "read bytes", &st->read_bytes, 1);
+    row(fp, "queued bytes", &st->queued, 1);
+    row(fp, "queued line ms", &st->queued, line_ms(st, 1));
+    histogram(fp, "frame arrival gaps:", "us", &st->arrival_us);
+    histogram(fp, "bytes queued at wakeup (TIOCINQ):", "B", &st->queued);
+}
+
+static void compare_row(FILE* fp, const char* name, const serial_series_t* a,
+                        const serial_series_t* b, float scale)
+{
+    float va[4], vb[4];
+    percentiles(a, pct, 4, va);
+    percentiles(b, pct, 4, vb);
+    fprintf(fp, "  %-20s %9.3f %9.3f   %9.3f %9.3f\n", name, va[0] * scale, va[2] * scale, vb[0] * scale, vb[2] * scale);
+}
+
+void serial_stats_compare(FILE* fp, const serial_stats_t* before, const serial_stats_t* after)
+{
+    const serial_stats_t* r[2] = { before, after };
+    fprintf(fp, "  %-20s %19s   %19s\n", "", "before", "after");
+    fprintf(fp, "  %-20s %19s   %19s\n", "low latency",
+            before->low_latency < 0 ? "n/a" : before->low_latency ? "on" : "off",
+            after->low_latency < 0 ? "n/a" : after->low_latency ? "on" : "off");
+    double v[2][3];
+    for (int i = 0; i < 2; i++) {
+        double secs = r[i]->secs > 0 ? r[i]->secs : 1;
+        v[i][0] = r[i]->bytes / secs;
+        v[i][1] = r[i]->frames / secs;
+        v[i][2] = r[i]->frames ? 100.0 * r[i]->lost / (r[i]->frames + r[i]->lost) : 0;
+    }
+    fprintf(fp, "  %-20s %19.0f   %19.0f\n", "bytes/s", v[0][0], v[1][0]);
+    fprintf(fp, "  %-20s %19.1f   %19.1f\n", "frames/s", v[0][1], v[1][1]);
+    fprintf(fp, "  %-20s %19.2f   %19.2f\n", "lost %", v[0][2], v[1][2]);
+    fprintf(fp, "  %-20s %9s %9s   %9s %9s\n", "", "p50", "p99", "p50", "p99");
+    compare_row(fp, "arrival ms", &before->arrival_us, &after->arrival_us, 1e-3f);
+    compare_row(fp, "wakeup ms", &before->wake_us, &after->wake_us, 1e-3f);
+    compare_row(fp, "read bytes", &before->read_bytes, &after->read_bytes, 1);
+    compare_row(fp, "queued bytes", &before->queued, &after->queued, 1);
+}
@@ -0,0 +1,66 @@
+//
+// arduino-serial-analyze -- what a serial link delivers, and when
+//
+// Reads a port for a while and keeps, per frame (a line up to eolchar)
+// and per wakeup (a read() after poll()):
+//
+//   arrival    time between frames completing
+//   reads      bytes each wakeup got, and how far apart the wakeups were
+//   queued     bytes the kernel already held at wakeup (TIOCINQ), and the
+//              line time they stand for: how long the oldest had waited
+//              at least, had it come in at the line rate
+//   loss       frames missing by sequence: the first field of every line
+//              counts up and wraps at the largest value seen, so both the
+//              glove's sensor ids (0..5) and a plain counter work
+//
+// USB serial adapters hand bytes over in bursts: an FTDI chip holds them
+// until 62 bytes or its 16 ms latency timer.  That shows as few, large
+// reads and frames arriving in clumps.  ASYNC_LOW_LATENCY
+// (serialport_low_latency()) cuts the timer to 1 ms; analyzing before and
+// after prints the difference side by side.
+//
+
+
+#ifndef __ARDUINO_SERIAL_ANALYZE_H__
+#define __ARDUINO_SERIAL_ANALYZE_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define SERIAL_ANALYZE_LINE_MAX 256
+#define SERIAL_ANALYZE_BUCKETS  24      // log2 buckets: us for times, bytes for sizes
+
+typedef struct {
+    int       n, max;
+    float*    v;
+} serial_series_t;
+
+typedef struct {
+    // setup
+    int       baud;
+    int       low_latency;              // 1, 0, or -1 if the port has no such flag
+    double    secs;
+    // totals
+    uint64_t  bytes;
+    uint64_t  frames;
+    uint64_t  bad;                      // no sequence number, or too long
+    uint64_t  lost;                     // by sequence
+    uint64_t  reads;
+    // per frame / per wakeup
+    serial_series_t arrival_us;         // frame to frame
+    serial_series_t wake_us;            // wakeup to wakeup
+    serial_series_t read_bytes;         // per wakeup
+    serial_series_t queued;             // TIOCINQ at wakeup
+} serial_stats_t;
+
+// read fd for secs (or until stop is set) and fill st; 0, or -1 on a read
+// error (what was measured up to then is kept)
+int  serial_analyze(int fd, int baud, char eolchar, double secs,
+                    volatile int* stop, serial_stats_t* st);
+void serial_stats_free(serial_stats_t* st);
+
+// the report, with histograms; and two runs side by side
+void serial_stats_print(FILE* fp, const serial_stats_t* st);
+void serial_stats_compare(FILE* fp, const serial_stats_t* before, const serial_stats_t* after);
+
+#endif
@@ -13,6 +13,9 @@
 #include <termios.h>  // POSIX terminal control definitions 
 #include <string.h>   // String function definitions 
 #include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
 
 // uncomment this to debug reads
 //#define SERIALPORTDEBUG 
@@ -56,6 +59,24 @@ int serialport_init(const char* serialport, int baud)
     case 38400:  brate=B38400;  break;
     case 57600:  brate=B57600;  break;
     case 115200: brate=B115200; break;
+#ifdef B230400
+    case 230400: brate=B230400; break;
+#endif
+#ifdef B460800
+    case 460800: brate=B460800; break;
+#endif
+#ifdef B500000
+    case 500000: brate=B500000; break;
+#endif
+#ifdef B921600
+    case 921600: brate=B921600; break;
+#endif
+#ifdef B1000000
+    case 1000000: brate=B1000000; break;
+#endif
+#ifdef B2000000
+    case 2000000: brate=B2000000; break;
+#endif
     }
     cfsetispeed(&toptions, brate);
     cfsetospeed(&toptions, brate);
@@ -148,3 +169,25 @@ int serialport_flush(int fd)
     sleep(2); //required to make flush work, for some reason
     return tcflush(fd, TCIOFLUSH);
 }
+
+//
+// ASYNC_LOW_LATENCY asks the driver to push received bytes up at once;
+// on FTDI it drops the USB latency timer from 16 ms to 1 ms.  Linux only.
+// on -1 only asks.  returns the previous setting (0 or 1), or -1 if the
+// port has none (a pty, or not Linux)
+int serialport_low_latency(int fd, int on)
+{
+#if defined(__linux__) && defined(TIOCGSERIAL)
+    struct serial_struct ss;
+    if (ioctl(fd, TIOCGSERIAL, &ss) < 0) return -1;
+    int was = (ss.flags & ASYNC_LOW_LATENCY) != 0;
+    if (on < 0) return was;
+    if (on) ss.flags |= ASYNC_LOW_LATENCY;
+    else ss.flags &= ~ASYNC_LOW_LATENCY;
+    if (ioctl(fd, TIOCSSERIAL, &ss) < 0) return -1;
+    return was;
+#else
+    (void)fd; (void)on;
+    return -1;
+#endif
+}
@@ -43,8 +43,15 @@
  *  Added --timeout option
  *  Added -q/-quiet option
  *
+ * Link analysis:
+ *  Added --analyze: arrival jitter, throughput, loss by sequence and
+ *  kernel queueing (TIOCINQ) with histograms (arduino-serial-analyze.h)
+ *  Added --lowlatency: ASYNC_LOW_LATENCY on USB serial; analyzing again
+ *  afterwards prints both runs side by side
+ *
 
 ./arduino-serial -p /dev/ttyUSB0 -b 9600 -r
+./arduino-serial -b 115200 -p /dev/ttyUSB0 -L 0 -a 10 -L 1 -a 10
 
  */
 
@@ -53,8 +60,10 @@
 #include <string.h>   // String function definitions
 #include <unistd.h>   // for usleep()
 #include <getopt.h>
+#include <signal.h>
 
 #include "arduino-serial-lib.h"
+#include "arduino-serial-analyze.h"
 
 
 //
@@ -76,6 +85,10 @@ void usage(void)
     "  -e  --eolchar=char         Specify EOL char for reads (default '\\n')\n"
     "  -t  --timeout=millis       Timeout for reads in millisecs (default 5000)\n"
     "  -q  --quiet                Don't print out as much info\n"
+    "  -a  --analyze=secs         Measure the link for secs (Ctrl-C ends early); print\n"
+    "                             arrival jitter, throughput, loss by the lines' first\n"
+    "                             field and kernel queueing, vs the previous -a if any\n"
+    "  -L  --lowlatency=0|1       Set ASYNC_LOW_LATENCY on a USB serial port (Linux)\n"
     "\n"
     "Note: Order is important. Set '-b' baudrate before opening port'-p'. \n"
     "      Used to make series of actions: '-d 2000 -s hello -d 100 -r' \n"
@@ -87,15 +100,20 @@ void usage(void)
 //
 void error(char* msg)
 {
+    fflush(stdout);
     fprintf(stderr, "%s\n",msg);
     exit(EXIT_FAILURE);
 }
 
-int main()
+static volatile int stop_analyze = 0;
+static void on_sigint(int sig)
 {
+    (void)sig;
+    stop_analyze = 1;
+}
 
-const char *argv1[]={“appname”,”-p /dev/ttyUSB0”,”-r”,"-b 9600",”null”};
-int argc1 = sizeof(argv1) / sizeof(char*) – 1;
+int main(int argc, char *argv[])
+{
 
     const int buf_max = 256;
 
@@ -107,6 +125,8 @@ int argc1 = sizeof(argv1) / sizeof(char*) – 1;
     int timeout = 5000;
     char buf[buf_max];
     int rc,n;
+    serial_stats_t stats[2];
+    int analyzed = 0;
 
     if (argc==1) {
         usage();
@@ -128,11 +148,13 @@ int argc1 = sizeof(argv1) / sizeof(char*) – 1;
         {"eolchar",    required_argument, 0, 'e'},
         {"timeout",    required_argument, 0, 't'},
         {"quiet",      no_argument,       0, 'q'},
+        {"analyze",    required_argument, 0, 'a'},
+        {"lowlatency", required_argument, 0, 'L'},
         {NULL,         0,                 0, 0}
     };
 
     while(1) {
-        opt = getopt_long (argc, argv, "hp:b:s:S:i:rFn:d:qe:t:",
+        opt = getopt_long (argc, argv, "hp:b:s:S:i:rFn:d:qe:t:a:L:",
                            loptions, &option_index);
         if (opt==-1) break;
         switch (opt) {
@@ -213,6 +235,32 @@ int argc1 = sizeof(argv1) / sizeof(char*) – 1;
             if( !quiet ) printf("flushing receive buffer\n");
             serialport_flush(fd);
             break;
+        case 'L':
+            if( fd == -1 ) error("serial port not opened");
+            n = strtol(optarg, NULL, 10) != 0;
+            rc = serialport_low_latency(fd, n);
+            if( rc == -1 ) fprintf(stderr, "no ASYNC_LOW_LATENCY on %s (a pty, or not Linux)\n", serialport);
+            else if( !quiet ) printf("low latency %s (was %s)\n", n ? "on" : "off", rc ? "on" : "off");
+            break;
+        case 'a': {
+            if( fd == -1 ) error("serial port not opened");
+            // the previous run is kept to compare against
+            serial_stats_t* st = &stats[analyzed % 2];
+            if( analyzed >= 2 ) serial_stats_free(st);
+            stop_analyze = 0;
+            signal(SIGINT, on_sigint);
+            if( !quiet ) printf("analyzing %s for %s s\n", serialport, optarg);
+            rc = serial_analyze(fd, baudrate, eolchar, strtod(optarg, NULL), &stop_analyze, st);
+            signal(SIGINT, SIG_DFL);
+            serial_stats_print(stdout, st);
+            if( analyzed ) {
+                printf("against the previous run:\n");
+                serial_stats_compare(stdout, &stats[(analyzed - 1) % 2], st);
+            }
+            analyzed++;
+            if( rc == -1 ) error("error reading");
+            break;
+        }
 
         }
     }
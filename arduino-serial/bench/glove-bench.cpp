@@ -0,0 +1,596 @@
+/*
+ * glove-bench
+ * -----------
+ *
+ * Microbenchmarks for the host data path, one per hot stage, all over
+ * the same fixed input (bench/session.txt, twelve sensors at 100 Hz):
+ *
+ *   parse           glove_sample_parse(), one line
+ *   stream          lines through glove_stream_poll() from a pipe: the
+ *                   read(), line splitting, parse, fusion and publish
+ *   stream-metrics  the same with glove-metrics kept, not scraped
+ *   codec-decode    a glove-codec block back to samples, per read, with
+ *   codec-decode-scalar      and without the SSE path
+ *   fusion          glove_fusion_update(), one read of one sensor
+ *   kinematics      glove_kin_hand(), one hand
+ *   handoff         publish a frame and take it, on one thread
+ *   handoff-threads publish while another thread keeps taking
+ *   record          glove_rec_write(), one read into the mapped file
+ *   shm-publish     glove_shm_publish(), one read into the broker's ring
+ *   shm-latest      glove_shm_latest(), the pose, from a client mapping
+ *   shm-history     glove_shm_read(), one read of the ring's history
+ *   shm-process     age of a read when a client process gets it, one
+ *   pipe-process    published every 20 us; and the same through a pipe
+ *
+ * There is no framing below lines: the glove speaks text, and the packed
+ * block is the binary format the host decodes.
+ *
+ * Every benchmark does a fixed number of operations per run, so the
+ * output has the same shape from run to run and machine to machine; only
+ * the times move.  Each runs once to warm up and then -r times; the JSON
+ * gives the median, min and max nanoseconds per operation, and MB/s of
+ * the bytes each operation stands for (line text, or 40 byte records).
+ * Keys come in a fixed order and numbers with fixed decimals, so two
+ * runs diff line by line:
+ *
+ *   make bench > before.json
+ *   ... change something ...
+ *   make bench > after.json && diff before.json after.json
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "../glove-sample.h"
+#include "../glove-codec.h"
+#include "../glove-fusion.h"
+#include "../glove-kinematics.h"
+#include "../glove-record.h"
+#include "../glove-shm.h"
+#include "../glove-stream.h"
+
+#define BENCH_VERSION   1
+
+static void usage(void)
+{
+    printf("Usage: glove-bench [OPTIONS]\n"
+    "\n"
+    "Options:\n"
+    "  -i, --input=session        Fixed input (default bench/session.txt)\n"
+    "  -r, --runs=num             Timed runs per benchmark (default 9)\n"
+    "  -b, --bench=name           Run only this benchmark, may be repeated\n"
+    "  -o, --output=file          JSON here instead of stdout\n"
+    "\n");
+    exit(EXIT_SUCCESS);
+}
+
+static void error(const char* msg)
+{
+    fprintf(stderr, "%s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+// the input, as lines and as parsed samples
+typedef struct {
+    const char*              path;
+    std::vector<char>        text;
+    std::vector<std::string> lines;     // sample lines, no newline
+    uint64_t                 line_bytes;
+    glove_session_t          ss;
+    uint32_t                 fnv;       // of the file, to tell inputs apart
+} input_t;
+
+typedef struct {
+    const char* name;
+    const char* op;                     // what one operation is
+    long        ops;                    // per run
+    double      bytes;                  // per operation, 0 if none
+    std::vector<double> ns;             // per operation, one per run
+} result_t;
+
+// anything a benchmark computes ends up here, so none of it is dead code
+static volatile uint64_t sink;
+
+static uint64_t float_bits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, 4);
+    return u;
+}
+
+//
+// benchmarks: each does r->ops operations and returns the nanoseconds
+// they took; setup stays outside the clock
+//
+
+static int64_t bench_parse(const input_t* in, result_t* r)
+{
+    int n = (int)in->lines.size();
+    uint64_t acc = 0;
+    int64_t t0 = glove_monotonic_ns();
+    for (long i = 0; i < r->ops; i++) {
+        glove_sample_t s;
+        if (glove_sample_parse(in->lines[i % n].c_str(), &s) == 0) acc += s.t_us + float_bits(s.g[2]);
+    }
+    int64_t dt = glove_monotonic_ns() - t0;
+    sink += acc;
+    return dt;
+}
+
+static int64_t bench_stream(const input_t* in, result_t* r, glove_metrics_t* metrics)
+{
+    static glove_stream_t st;
+    static glove_handoff_t h;
+    int fds[2];
+    if (pipe(fds) != 0) error("pipe");
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    glove_stream_init(&st);
+    glove_handoff_init(&h);
+    st.metrics = metrics;
+
+    // fill the pipe, then drain it through the stream with the clock
+    // running; pipe writes are outside it
+    const char* p = in->text.data();
+    size_t len = in->text.size(), off = 0;
+    long fed = 0;
+    int64_t dt = 0;
+    while (fed < r->ops) {
+        ssize_t w;
+        while ((w = write(fds[1], p + off, len - off)) > 0)
+            if ((off += w) == len) off = 0;
+        int64_t t0 = glove_monotonic_ns();
+        int n;
+        while ((n = glove_stream_poll(&st, fds[0], 0, &h)) > 0) fed += n;
+        dt += glove_monotonic_ns() - t0;
+        if (n < 0) error("stream");
+    }
+    close(fds[0]);
+    close(fds[1]);
+    sink += st.cur.seq;
+    // whole pipefuls: scale to the operations asked for
+    return (int64_t)((double)dt * r->ops / fed);
+}
+
+static int64_t bench_codec(const input_t* in, result_t* r, int simd)
+{
+    static glove_codec_t c;
+    static glove_sample_t out[GLOVE_CODEC_BLOCK];
+    int n = in->ss.nsamples < GLOVE_CODEC_BLOCK ? in->ss.nsamples : GLOVE_CODEC_BLOCK;
+    std::vector<uint8_t> block(glove_codec_bound(n));
+    if (glove_codec_init(&c, GLOVE_CODEC_VARINT) != 0) error("out of memory");
+    long len = glove_codec_encode(&c, in->ss.samples, n, block.data(), block.size());
+    if (len < 0) error("codec");
+    int was = glove_codec_simd(simd);
+
+    long blocks = (r->ops + n - 1) / n;
+    uint64_t acc = 0;
+    int64_t t0 = glove_monotonic_ns();
+    for (long i = 0; i < blocks; i++) {
+        int got;
+        if (glove_codec_decode(&c, block.data(), len, out, &got) < 0) error("codec");
+        acc += out[got - 1].t_us;
+    }
+    int64_t dt = glove_monotonic_ns() - t0;
+    glove_codec_simd(was);
+    glove_codec_free(&c);
+    sink += acc;
+    return (int64_t)((double)dt * r->ops / (blocks * n));
+}
+
+static int64_t bench_fusion(const input_t* in, result_t* r)
+{
+    glove_fusion_t f[GLOVE_MAX_SENSORS];
+    for (int i = 0; i < GLOVE_MAX_SENSORS; i++) glove_fusion_init(&f[i], GLOVE_FUSION_ALPHA);
+    // the input over and over, time carried on so no gap restarts fusion
+    const glove_session_t* ss = &in->ss;
+    uint64_t span = ss->samples[ss->nsamples - 1].t_us - ss->samples[0].t_us + 10000;
+    int64_t t0 = glove_monotonic_ns();
+    for (long i = 0; i < r->ops; i++) {
+        glove_sample_t s = ss->samples[i % ss->nsamples];
+        s.t_us += (i / ss->nsamples) * span;
+        glove_fusion_update(&f[s.sensor], &s);
+    }
+    int64_t dt = glove_monotonic_ns() - t0;
+    sink += float_bits(f[0].q.w);
+    return dt;
+}
+
+static int64_t bench_kinematics(const input_t* in, result_t* r)
+{
+    // the orientations the input fuses to, one hand's six per pose
+    glove_fusion_t f[GLOVE_MAX_SENSORS];
+    std::vector<glove_quat_t> q;
+    for (int i = 0; i < GLOVE_MAX_SENSORS; i++) glove_fusion_init(&f[i], GLOVE_FUSION_ALPHA);
+    for (int i = 0; i < in->ss.nsamples; i++) {
+        const glove_sample_t* s = &in->ss.samples[i];
+        glove_fusion_update(&f[s->sensor], s);
+        if (s->sensor % GLOVE_HAND_SENSORS == GLOVE_HAND_SENSORS - 1)
+            for (int k = 0; k < GLOVE_HAND_SENSORS; k++) q.push_back(f[s->sensor - GLOVE_HAND_SENSORS + 1 + k].q);
+    }
+    int poses = (int)(q.size() / GLOVE_HAND_SENSORS);
+    glove_hand_pose_t pose;
+    uint64_t acc = 0;
+    int64_t t0 = glove_monotonic_ns();
+    for (long i = 0; i < r->ops; i++) {
+        int k = (int)(i % poses);
+        glove_kin_hand(&q[k * GLOVE_HAND_SENSORS], GLOVE_HAND_SENSORS, glove_vec3(0.12f, 0, 0), k & 1, &pose);
+        acc += float_bits(pose.joints[GLOVE_KIN_JOINTS - 1].x);
+    }
+    int64_t dt = glove_monotonic_ns() - t0;
+    sink += acc;
+    return dt;
+}
+
+static int64_t bench_handoff(const input_t*, result_t* r)
+{
+    static glove_handoff_t h;
+    const glove_frame_t* f;
+    glove_handoff_init(&h);
+    uint64_t acc = 0;
+    int64_t t0 = glove_monotonic_ns();
+    for (long i = 0; i < r->ops; i++) {
+        glove_handoff_back(&h)->seq = (uint32_t)i;
+        glove_handoff_publish(&h);
+        acc += glove_handoff_latest(&h, &f) + f->seq;
+    }
+    int64_t dt = glove_monotonic_ns() - t0;
+    sink += acc;
+    return dt;
+}
+
+static int64_t bench_handoff_threads(const input_t*, result_t* r)
+{
+    static glove_handoff_t h;
+    glove_handoff_init(&h);
+    std::atomic<bool> done(false), ready(false);
+    std::atomic<uint64_t> taken(0);
+    std::thread reader([&]() {
+        const glove_frame_t* f;
+        uint64_t n = 0;
+        ready = true;
+        while (!done) n += glove_handoff_latest(&h, &f);
+        taken = n;
+    });
+    while (!ready) {}
+
+    // a whole frame written each time, as the stream does
+    int64_t t0 = glove_monotonic_ns();
+    for (long i = 0; i < r->ops; i++) {
+        glove_frame_t* f = glove_handoff_back(&h);
+        f->seq = (uint32_t)i;
+        for (int k = 0; k < GLOVE_MAX_SENSORS; k++) f->q[k].w = (float)i;
+        glove_handoff_publish(&h);
+    }
+    int64_t dt = glove_monotonic_ns() - t0;
+    done = true;
+    reader.join();
+    sink += taken;
+    return dt;
+}
+
+static int64_t bench_record(const input_t* in, result_t* r)
+{
+    char path[256];
+    const char* tmp = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/glove-bench-%d.rec", tmp ? tmp : "/tmp", (int)getpid());
+    glove_rec_t rec;
+    if (glove_rec_open(&rec, path, NULL) != 0) error("couldn't create the recording");
+    const glove_session_t* ss = &in->ss;
+    int64_t t0 = glove_monotonic_ns();
+    for (long i = 0; i < r->ops; i++)
+        glove_rec_write(&rec, &ss->samples[i % ss->nsamples]);
+    int64_t dt = glove_monotonic_ns() - t0;
+    sink += rec.nsamples;
+    glove_rec_close(&rec);
+    unlink(path);
+    return dt;
+}
+
+// a segment of the benchmark's own, so a running broker is left alone
+static void bench_shm_create(glove_shm_t* m, char* name, size_t len)
+{
+    snprintf(name, len, "/glove-bench-%d", (int)getpid());
+    if (glove_shm_create(m, name, GLOVE_SHM_SLOTS) != 0) error("couldn't create the shared memory");
+}
+
+// the frame a sample makes, for publishing: only its hand is read
+static void bench_frame(glove_frame_t* f)
+{
+    memset(f, 0, sizeof(*f));
+    f->nsensors = GLOVE_MAX_SENSORS;
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) f->q[k] = glove_quat_identity();
+}
+
+static int64_t bench_shm_publish(const input_t* in, result_t* r)
+{
+    static glove_shm_t m;
+    static glove_frame_t f;
+    char name[64];
+    bench_shm_create(&m, name, sizeof(name));
+    bench_frame(&f);
+    const glove_session_t* ss = &in->ss;
+    int64_t t0 = glove_monotonic_ns();
+    for (long i = 0; i < r->ops; i++) {
+        const glove_sample_t* s = &ss->samples[i % ss->nsamples];
+        f.q[s->sensor].w = (float)i;
+        glove_shm_publish(&m, s, &f);
+    }
+    int64_t dt = glove_monotonic_ns() - t0;
+    sink += glove_shm_head(&m);
+    glove_shm_close(&m);
+    return dt;
+}
+
+static int64_t bench_shm_reads(const input_t* in, result_t* r, int history)
+{
+    static glove_shm_t m, c;
+    static glove_frame_t f;
+    static glove_shm_entry_t out[256];
+    char name[64];
+    bench_shm_create(&m, name, sizeof(name));
+    if (glove_shm_open(&c, name) != 0) error("couldn't map the shared memory");
+    bench_frame(&f);
+    const glove_session_t* ss = &in->ss;
+    for (long i = 0; i < GLOVE_SHM_SLOTS; i++) glove_shm_publish(&m, &ss->samples[i % ss->nsamples], &f);
+
+    // the whole ring, 256 at a time, or the pose; through the read-only mapping
+    uint64_t acc = 0, next = 0;
+    long done = 0;
+    glove_shm_pose_t p;
+    int64_t t0 = glove_monotonic_ns();
+    while (done < r->ops) {
+        if (history) {
+            int n = glove_shm_read(&c, next, out, 256, &next);
+            if (n == 0) next = 0;
+            acc += out[n ? n - 1 : 0].s.t_us;
+            done += n;
+        } else {
+            acc += (glove_shm_latest(&c, &p) == 1) + p.n;
+            done++;
+        }
+    }
+    int64_t dt = glove_monotonic_ns() - t0;
+    sink += acc;
+    glove_shm_close(&c);
+    glove_shm_close(&m);
+    return (int64_t)((double)dt * r->ops / done);
+}
+
+// One sample every SHM_PERIOD_NS to a reader in another process, which
+// takes the age of each it gets: publish to read, through shared memory
+// or, for comparison, a pipe.  Both sides yield while they wait, so on one
+// core they hand it to each other and on more they spin.  The time
+// returned is the age summed over ops; the reader may miss a sample in
+// shared memory, the mean is over those it got.
+#define SHM_PERIOD_NS   20000
+
+static int64_t bench_process(const input_t* in, result_t* r, int use_pipe)
+{
+    static glove_shm_t m;
+    static glove_frame_t f;
+    char name[64];
+    int data[2], result[2];
+    if (pipe(result) != 0 || (use_pipe && pipe(data) != 0)) error("pipe");
+    if (!use_pipe) bench_shm_create(&m, name, sizeof(name));
+    bench_frame(&f);
+
+    pid_t pid = fork();
+    if (pid < 0) error("fork");
+    if (pid == 0) {
+        double sum = 0;
+        long got = 0;
+        if (use_pipe) {
+            glove_shm_entry_t e;
+            while (got < r->ops && read(data[0], &e, sizeof(e)) == (ssize_t)sizeof(e)) {
+                sum += glove_monotonic_ns() - e.pub_ns;
+                got++;
+            }
+        } else {
+            static glove_shm_t c;
+            if (glove_shm_open(&c, name) != 0) _exit(1);
+            uint64_t seen = 0, head;
+            while ((head = glove_shm_head(&c)) < (uint64_t)r->ops) {
+                if (head == seen) {
+                    sched_yield();
+                    continue;
+                }
+                const glove_shm_entry_t* e = glove_shm_peek(&c, head - 1);
+                int64_t pub = e ? e->pub_ns : 0;
+                if (e && glove_shm_held(&c, head - 1)) {
+                    sum += glove_monotonic_ns() - pub;
+                    got++;
+                }
+                seen = head;
+            }
+            glove_shm_close(&c);
+        }
+        double mean = got ? sum / got : 0;
+        _exit(write(result[1], &mean, sizeof(mean)) == sizeof(mean) ? 0 : 1);
+    }
+
+    const glove_session_t* ss = &in->ss;
+    int64_t due = glove_monotonic_ns() + SHM_PERIOD_NS;
+    for (long i = 0; i < r->ops; i++) {
+        while (glove_monotonic_ns() < due) sched_yield();
+        due += SHM_PERIOD_NS;
+        const glove_sample_t* s = &ss->samples[i % ss->nsamples];
+        if (use_pipe) {
+            glove_shm_entry_t e = { (uint64_t)i, glove_monotonic_ns(), *s, f.q[s->sensor] };
+            if (write(data[1], &e, sizeof(e)) != (ssize_t)sizeof(e)) error("pipe");
+        } else {
+            glove_shm_publish(&m, s, &f);
+        }
+    }
+    double mean = 0;
+    if (read(result[0], &mean, sizeof(mean)) != sizeof(mean) || mean <= 0) error("the reader process failed");
+    waitpid(pid, NULL, 0);
+    close(result[0]);
+    close(result[1]);
+    if (use_pipe) {
+        close(data[0]);
+        close(data[1]);
+    } else {
+        glove_shm_close(&m);
+    }
+    return (int64_t)(mean * r->ops);
+}
+
+//
+// driver
+//
+
+typedef struct {
+    const char* name;
+    const char* op;
+    long        ops;
+    int         bytes;                  // 1: bytes of a line; 2: a record; 0: none
+    int64_t   (*run)(const input_t*, result_t*);
+} bench_t;
+
+static int64_t bench_stream_plain(const input_t* in, result_t* r) { return bench_stream(in, r, NULL); }
+static int64_t bench_stream_metrics(const input_t* in, result_t* r)
+{
+    static glove_metrics_t m;
+    glove_metrics_init(&m);
+    return bench_stream(in, r, &m);
+}
+static int64_t bench_shm_latest(const input_t* in, result_t* r)  { return bench_shm_reads(in, r, 0); }
+static int64_t bench_shm_history(const input_t* in, result_t* r) { return bench_shm_reads(in, r, 1); }
+static int64_t bench_shm_process(const input_t* in, result_t* r) { return bench_process(in, r, 0); }
+static int64_t bench_pipe_process(const input_t* in, result_t* r) { return bench_process(in, r, 1); }
+static int64_t bench_codec_simd(const input_t* in, result_t* r)   { return bench_codec(in, r, 1); }
+static int64_t bench_codec_scalar(const input_t* in, result_t* r) { return bench_codec(in, r, 0); }
+
+// ops are fixed: changing one changes what the numbers mean
+static const bench_t benches[] = {
+    { "parse",               "line",   200000,  1, bench_parse },
+    { "stream",              "line",   200000,  1, bench_stream_plain },
+    { "stream-metrics",      "line",   200000,  1, bench_stream_metrics },
+    { "codec-decode",        "read",   2000000, 2, bench_codec_simd },
+    { "codec-decode-scalar", "read",   2000000, 2, bench_codec_scalar },
+    { "fusion",              "read",   1000000, 0, bench_fusion },
+    { "kinematics",          "hand",   200000,  0, bench_kinematics },
+    { "handoff",             "frame",  2000000, 0, bench_handoff },
+    { "handoff-threads",     "frame",  500000,  0, bench_handoff_threads },
+    { "record",              "read",   1000000, 2, bench_record },
+    { "shm-publish",         "read",   1000000, 0, bench_shm_publish },
+    { "shm-latest",          "pose",   1000000, 0, bench_shm_latest },
+    { "shm-history",         "read",   2000000, 0, bench_shm_history },
+    { "shm-process",         "read",   20000,   0, bench_shm_process },
+    { "pipe-process",        "read",   20000,   0, bench_pipe_process },
+};
+
+static void load_input(const char* path, input_t* in)
+{
+    in->path = path;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) error("couldn't open the input");
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) in->text.insert(in->text.end(), buf, buf + n);
+    fclose(fp);
+
+    in->fnv = 2166136261u;
+    for (char c : in->text) in->fnv = (in->fnv ^ (uint8_t)c) * 16777619u;
+    in->line_bytes = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < in->text.size(); i++) {
+        if (in->text[i] != '\n') continue;
+        if (in->text[start] != '#') {
+            in->lines.push_back(std::string(&in->text[start], i - start));
+            in->line_bytes += i - start + 1;
+        }
+        start = i + 1;
+    }
+    if (glove_session_load(path, &in->ss) != 0 || in->ss.nsamples == 0 || in->lines.empty())
+        error("no samples in the input");
+}
+
+static void write_json(FILE* fp, const input_t* in, int runs, const std::vector<result_t>& res)
+{
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"version\": %d,\n", BENCH_VERSION);
+    fprintf(fp, "  \"input\": { \"path\": \"%s\", \"lines\": %d, \"bytes\": %d, \"fnv1a\": \"%08x\" },\n",
+            in->path, (int)in->lines.size(), (int)in->text.size(), in->fnv);
+    fprintf(fp, "  \"runs\": %d,\n", runs);
+    fprintf(fp, "  \"simd\": %s,\n", glove_codec_simd(1) ? "true" : "false");
+    fprintf(fp, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < res.size(); i++) {
+        const result_t* r = &res[i];
+        std::vector<double> ns = r->ns;
+        std::sort(ns.begin(), ns.end());
+        double median = ns[ns.size() / 2];
+        fprintf(fp, "    { \"name\": \"%s\", \"op\": \"%s\", \"ops\": %ld, "
+                "\"ns_per_op\": { \"median\": %.1f, \"min\": %.1f, \"max\": %.1f }, \"mb_per_s\": ",
+                r->name, r->op, r->ops, median, ns.front(), ns.back());
+        if (r->bytes > 0) fprintf(fp, "%.1f", r->bytes / median * 1e3);
+        else fprintf(fp, "null");
+        fprintf(fp, " }%s\n", i + 1 < res.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+int main(int argc, char* argv[])
+{
+    const char* input = "bench/session.txt";
+    const char* out = NULL;
+    std::vector<const char*> only;
+    int runs = 9, opt;
+    static struct option loptions[] = {
+        {"help",   no_argument,       0, 'h'},
+        {"input",  required_argument, 0, 'i'},
+        {"runs",   required_argument, 0, 'r'},
+        {"bench",  required_argument, 0, 'b'},
+        {"output", required_argument, 0, 'o'},
+        {NULL,     0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "hi:r:b:o:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'i': input = optarg; break;
+        case 'r': runs = strtol(optarg, NULL, 10); break;
+        case 'b': only.push_back(optarg); break;
+        case 'o': out = optarg; break;
+        default:  usage();
+        }
+    }
+    if (runs < 1) error("need at least one run");
+
+    static input_t in;
+    load_input(input, &in);
+    double line_bytes = (double)in.line_bytes / in.lines.size();
+
+    std::vector<result_t> res;
+    for (const bench_t& b : benches) {
+        if (!only.empty() && std::none_of(only.begin(), only.end(),
+                                          [&](const char* n) { return strcmp(n, b.name) == 0; }))
+            continue;
+        result_t r;
+        r.name = b.name;
+        r.op = b.op;
+        r.ops = b.ops;
+        r.bytes = b.bytes == 1 ? line_bytes : b.bytes == 2 ? sizeof(glove_rec_sample_t) : 0;
+        b.run(&in, &r);                 // warm up
+        for (int i = 0; i < runs; i++) r.ns.push_back((double)b.run(&in, &r) / r.ops);
+        res.push_back(r);
+    }
+    if (res.empty()) error("no such benchmark");
+
+    FILE* fp = out ? fopen(out, "w") : stdout;
+    if (!fp) error("couldn't write the output");
+    write_json(fp, &in, runs, res);
+    if (out) fclose(fp);
+    glove_session_free(&in.ss);
+    return 0;
+}
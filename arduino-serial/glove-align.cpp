@@ -0,0 +1,59 @@
+//
+// glove-align -- resample all sensors of a hand to one frame time
+//
+
+#include "glove-align.h"
+
+#include <string.h>
+
+void glove_align_init(glove_align_t* al, int nsensors)
+{
+    memset(al, 0, sizeof(*al));
+    al->nsensors = nsensors;
+}
+
+void glove_align_update(glove_align_t* al, const glove_sample_t* s, glove_quat_t q)
+{
+    int i = s->sensor;
+    if (i >= al->nsensors) return;
+    // a repeated or backwards stamp would make the slerp divide by zero
+    if (al->n[i] && s->t_us <= al->t[i][1]) {
+        al->n[i] = 0;
+    }
+    al->q[i][0] = al->q[i][1];
+    al->t[i][0] = al->t[i][1];
+    al->q[i][1] = q;
+    al->t[i][1] = s->t_us;
+    al->w[i] = glove_vec3_scale(glove_vec3(s->g[0], s->g[1], s->g[2]), GLOVE_DEG2RAD);
+    if (al->n[i] < 2) al->n[i]++;
+}
+
+uint64_t glove_align_frame_time(const glove_align_t* al)
+{
+    uint64_t t = 0;
+    for (int i = 0; i < al->nsensors; i++) {
+        if (al->n[i] < 2) return 0;
+        if (t == 0 || al->t[i][1] < t) t = al->t[i][1];
+    }
+    return t;
+}
+
+int glove_align_resample(const glove_align_t* al, uint64_t frame_us, glove_quat_t* out)
+{
+    for (int i = 0; i < al->nsensors; i++) {
+        if (al->n[i] < 2) return -1;
+        uint64_t t0 = al->t[i][0], t1 = al->t[i][1];
+        if (frame_us <= t0) {
+            out[i] = al->q[i][0];
+        } else if (frame_us <= t1) {
+            float u = (float)(frame_us - t0) / (float)(t1 - t0);
+            out[i] = glove_quat_slerp(al->q[i][0], al->q[i][1], u);
+        } else {
+            uint64_t dt = frame_us - t1;
+            if (dt > GLOVE_ALIGN_MAX_EXTRAP) dt = GLOVE_ALIGN_MAX_EXTRAP;
+            glove_vec3_t r = glove_vec3_scale(al->w[i], dt * 1e-6f);
+            out[i] = glove_quat_mul(al->q[i][1], glove_quat_from_rotvec(r));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+//
+// glove-align -- resample all sensors of a hand to one frame time
+//
+// main.ino reads the six sensors one after the other over software I2C,
+// so a "frame" is really six readings taken a few milliseconds apart.
+// Treating them as simultaneous turns a fast wrist rotation into phantom
+// finger bend.  This stage keeps the last two orientations of every sensor
+// with their own capture times and slerps each one to a common frame time;
+// past a sensor's newest sample its gyro rate carries it forward a little.
+//
+// It only deals in orientations, so it sits after glove-fusion (or
+// anything else producing a quaternion per sample).
+//
+
+
+#ifndef __GLOVE_ALIGN_H__
+#define __GLOVE_ALIGN_H__
+
+#include "glove-sample.h"
+
+#define GLOVE_ALIGN_MAX_EXTRAP  50000   // us, never extrapolate further
+
+typedef struct {
+    int          nsensors;
+    glove_quat_t q[GLOVE_MAX_SENSORS][2];   // previous, newest
+    uint64_t     t[GLOVE_MAX_SENSORS][2];
+    glove_vec3_t w[GLOVE_MAX_SENSORS];      // newest body rate, rad/s
+    int          n[GLOVE_MAX_SENSORS];      // samples seen, saturates at 2
+} glove_align_t;
+
+void glove_align_init(glove_align_t* al, int nsensors);
+// q is the orientation estimated for s (e.g. glove_fusion_t.q after update)
+void glove_align_update(glove_align_t* al, const glove_sample_t* s, glove_quat_t q);
+
+// latest frame time every sensor has reached: resampling there needs no
+// extrapolation.  0 until each sensor has two samples.
+uint64_t glove_align_frame_time(const glove_align_t* al);
+// every sensor's orientation at frame_us; -1 if not ready
+int glove_align_resample(const glove_align_t* al, uint64_t frame_us, glove_quat_t* out);
+
+#endif
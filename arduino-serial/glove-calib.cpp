@@ -0,0 +1,270 @@
+//
+// glove-calib -- six-position accelerometer calibration
+//
+
+#include "glove-calib.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SWEEP_ITERATIONS   8
+#define SWEEP_PRIOR        1e-3     // keeps the sweep from rotating M
+
+static const char* pose_names[GLOVE_CALIB_POSES] = {
+    "+X up", "-X up", "+Y up", "-Y up", "+Z up", "-Z up"
+};
+
+void glove_calib_identity(glove_calib_t* cal, int count)
+{
+    memset(cal, 0, sizeof(*cal));
+    cal->count = count;
+    for (int i = 0; i < GLOVE_MAX_SENSORS; i++)
+        cal->accel[i].m[0] = cal->accel[i].m[4] = cal->accel[i].m[8] = 1.0f;
+}
+
+void glove_calib_apply_sample(const glove_calib_t* cal, glove_sample_t* s)
+{
+    if (s->sensor < cal->count)
+        glove_calib_apply(&cal->accel[s->sensor], s->a);
+}
+
+int glove_calib_pose(const float a[3])
+{
+    int axis = 0;
+    for (int i = 1; i < 3; i++)
+        if (fabsf(a[i]) > fabsf(a[axis])) axis = i;
+    return axis * 2 + (a[axis] < 0);
+}
+
+const char* glove_calib_pose_name(int pose)
+{
+    return pose >= 0 && pose < GLOVE_CALIB_POSES ? pose_names[pose] : "?";
+}
+
+void glove_calib_fit_init(glove_calib_fit_t* fit)
+{
+    memset(fit, 0, sizeof(*fit));
+}
+
+void glove_calib_fit_free(glove_calib_fit_t* fit)
+{
+    free(fit->sweep);
+    memset(fit, 0, sizeof(*fit));
+}
+
+void glove_calib_fit_add_pose(glove_calib_fit_t* fit, const float a[3])
+{
+    int pose = glove_calib_pose(a);
+    double x[4] = { a[0], a[1], a[2], 1.0 };
+    double t[3] = { 0, 0, 0 };
+    t[pose / 2] = (pose & 1) ? -1.0 : 1.0;
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) fit->ata[r][c] += x[r] * x[c];
+        for (int c = 0; c < 3; c++) fit->atb[r][c] += x[r] * t[c];
+    }
+    fit->pose_n[pose]++;
+    for (int c = 0; c < 3; c++) fit->pose_sum[pose][c] += a[c];
+}
+
+int glove_calib_fit_add_sweep(glove_calib_fit_t* fit, const float a[3])
+{
+    if (fit->sweep_n == fit->sweep_cap) {
+        int cap = fit->sweep_cap ? fit->sweep_cap * 2 : 1024;
+        float* p = (float*)realloc(fit->sweep, cap * 3 * sizeof(float));
+        if (p == NULL) return -1;
+        fit->sweep = p;
+        fit->sweep_cap = cap;
+    }
+    memcpy(&fit->sweep[fit->sweep_n++ * 3], a, 3 * sizeof(float));
+    return 0;
+}
+
+int glove_calib_fit_complete(const glove_calib_fit_t* fit, int min_per_pose)
+{
+    for (int i = 0; i < GLOVE_CALIB_POSES; i++)
+        if (fit->pose_n[i] < min_per_pose) return 0;
+    return 1;
+}
+
+// Gaussian elimination with partial pivoting, a is n x n, b is n x m,
+// solution left in b.  Returns -1 when singular.
+static int solve(double* a, double* b, int n, int m)
+{
+    for (int col = 0; col < n; col++) {
+        int piv = col;
+        for (int r = col + 1; r < n; r++)
+            if (fabs(a[r * n + col]) > fabs(a[piv * n + col])) piv = r;
+        if (fabs(a[piv * n + col]) < 1e-12) return -1;
+        if (piv != col) {
+            for (int c = 0; c < n; c++) { double t = a[col * n + c]; a[col * n + c] = a[piv * n + c]; a[piv * n + c] = t; }
+            for (int c = 0; c < m; c++) { double t = b[col * m + c]; b[col * m + c] = b[piv * m + c]; b[piv * m + c] = t; }
+        }
+        for (int r = 0; r < n; r++) {
+            if (r == col) continue;
+            double f = a[r * n + col] / a[col * n + col];
+            if (f == 0) continue;
+            for (int c = col; c < n; c++) a[r * n + c] -= f * a[col * n + c];
+            for (int c = 0; c < m; c++)   b[r * m + c] -= f * b[col * m + c];
+        }
+    }
+    for (int r = 0; r < n; r++)
+        for (int c = 0; c < m; c++) b[r * m + c] /= a[r * n + r];
+    return 0;
+}
+
+static void refine_with_sweep(const glove_calib_fit_t* fit, glove_accel_cal_t* out)
+{
+    double p0[12], p[12];
+    for (int i = 0; i < 9; i++) p0[i] = out->m[i];
+    for (int i = 0; i < 3; i++) p0[9 + i] = out->b[i];
+    memcpy(p, p0, sizeof(p));
+    double lambda = SWEEP_PRIOR * fit->sweep_n;
+
+    for (int it = 0; it < SWEEP_ITERATIONS; it++) {
+        double h[12 * 12], g[12];
+        memset(h, 0, sizeof(h));
+        for (int i = 0; i < 12; i++) {
+            h[i * 12 + i] = lambda;
+            g[i] = -lambda * (p[i] - p0[i]);
+        }
+        for (int k = 0; k < fit->sweep_n; k++) {
+            const float* a = &fit->sweep[k * 3];
+            double y[3], j[12];
+            for (int r = 0; r < 3; r++)
+                y[r] = p[r * 3] * a[0] + p[r * 3 + 1] * a[1] + p[r * 3 + 2] * a[2] + p[9 + r];
+            double n = sqrt(y[0] * y[0] + y[1] * y[1] + y[2] * y[2]);
+            if (n < 1e-6) continue;
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) j[r * 3 + c] = y[r] / n * a[c];
+                j[9 + r] = y[r] / n;
+            }
+            double res = n - 1.0;
+            for (int r = 0; r < 12; r++) {
+                g[r] -= j[r] * res;
+                for (int c = 0; c < 12; c++) h[r * 12 + c] += j[r] * j[c];
+            }
+        }
+        if (solve(h, g, 12, 1) != 0) return;
+        for (int i = 0; i < 12; i++) p[i] += g[i];
+    }
+    for (int i = 0; i < 9; i++) out->m[i] = (float)p[i];
+    for (int i = 0; i < 3; i++) out->b[i] = (float)p[9 + i];
+}
+
+int glove_calib_fit_solve(const glove_calib_fit_t* fit, glove_accel_cal_t* out)
+{
+    double a[16], x[12];
+    memcpy(a, fit->ata, sizeof(a));
+    memcpy(x, fit->atb, sizeof(x));
+    if (solve(a, x, 4, 3) != 0) return -1;
+    // x is [a 1] -> target, 4 x 3; M is its top 3 rows transposed
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) out->m[r * 3 + c] = (float)x[c * 3 + r];
+        out->b[r] = (float)x[9 + r];
+    }
+    if (fit->sweep_n >= 12)
+        refine_with_sweep(fit, out);
+    return 0;
+}
+
+float glove_calib_pose_error(const glove_calib_fit_t* fit, const glove_accel_cal_t* c)
+{
+    float worst = 0;
+    for (int pose = 0; pose < GLOVE_CALIB_POSES; pose++) {
+        if (fit->pose_n[pose] == 0) continue;
+        float a[3];
+        for (int i = 0; i < 3; i++) a[i] = (float)(fit->pose_sum[pose][i] / fit->pose_n[pose]);
+        if (c) glove_calib_apply(c, a);
+        float n = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        float along = fabsf(a[pose / 2]) / n;
+        float e = acosf(along > 1.0f ? 1.0f : along) * GLOVE_RAD2DEG;
+        if (e > worst) worst = e;
+    }
+    return worst;
+}
+
+float glove_calib_sweep_rms(const glove_calib_fit_t* fit, const glove_accel_cal_t* c)
+{
+    double sum = 0;
+    for (int k = 0; k < fit->sweep_n; k++) {
+        float a[3];
+        memcpy(a, &fit->sweep[k * 3], sizeof(a));
+        glove_calib_apply(c, a);
+        float e = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) - 1.0f;
+        sum += e * e;
+    }
+    return fit->sweep_n ? (float)sqrt(sum / fit->sweep_n) : 0;
+}
+
+//
+static void put_f32(uint8_t* p, float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, 4);
+    p[0] = u; p[1] = u >> 8; p[2] = u >> 16; p[3] = u >> 24;
+}
+
+static float get_f32(const uint8_t* p)
+{
+    uint32_t u = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    float f;
+    memcpy(&f, &u, 4);
+    return f;
+}
+
+int glove_calib_to_blob(const glove_calib_t* cal, uint8_t* buf, int buf_max)
+{
+    int len = GLOVE_CALIB_HEADER + cal->count * GLOVE_CALIB_ENTRY;
+    if (len > buf_max) return -1;
+    memcpy(buf, "GCAL", 4);
+    buf[4] = GLOVE_CALIB_VERSION;
+    buf[5] = (uint8_t)cal->count;
+    buf[6] = buf[7] = 0;
+    uint8_t* p = buf + GLOVE_CALIB_HEADER;
+    for (int s = 0; s < cal->count; s++) {
+        for (int i = 0; i < 9; i++, p += 4) put_f32(p, cal->accel[s].m[i]);
+        for (int i = 0; i < 3; i++, p += 4) put_f32(p, cal->accel[s].b[i]);
+    }
+    return len;
+}
+
+int glove_calib_from_blob(glove_calib_t* cal, const uint8_t* buf, int len)
+{
+    if (len < GLOVE_CALIB_HEADER || memcmp(buf, "GCAL", 4) != 0) return -1;
+    if (buf[4] != GLOVE_CALIB_VERSION || buf[5] > GLOVE_MAX_SENSORS) return -1;
+    if (len < GLOVE_CALIB_HEADER + buf[5] * GLOVE_CALIB_ENTRY) return -1;
+    glove_calib_identity(cal, buf[5]);
+    const uint8_t* p = buf + GLOVE_CALIB_HEADER;
+    for (int s = 0; s < cal->count; s++) {
+        for (int i = 0; i < 9; i++, p += 4) cal->accel[s].m[i] = get_f32(p);
+        for (int i = 0; i < 3; i++, p += 4) cal->accel[s].b[i] = get_f32(p);
+    }
+    return 0;
+}
+
+int glove_calib_save(const char* path, const glove_calib_t* cal)
+{
+    uint8_t buf[GLOVE_CALIB_HEADER + GLOVE_MAX_SENSORS * GLOVE_CALIB_ENTRY];
+    int len = glove_calib_to_blob(cal, buf, sizeof(buf));
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) {
+        perror("glove_calib_save: Unable to open file");
+        return -1;
+    }
+    int ok = len > 0 && fwrite(buf, 1, len, fp) == (size_t)len;
+    fclose(fp);
+    return ok ? 0 : -1;
+}
+
+int glove_calib_load(const char* path, glove_calib_t* cal)
+{
+    uint8_t buf[GLOVE_CALIB_HEADER + GLOVE_MAX_SENSORS * GLOVE_CALIB_ENTRY];
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror("glove_calib_load: Unable to open file");
+        return -1;
+    }
+    int len = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    return glove_calib_from_blob(cal, buf, len);
+}
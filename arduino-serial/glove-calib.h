@@ -0,0 +1,89 @@
+//
+// glove-calib -- six-position accelerometer calibration
+//
+// GY521 only has additive axe/aye/aze offsets.  Scale and axis
+// misalignment go straight into the tilt angles, so instead fit
+//
+//   a_corrected = M a + b
+//
+// per sensor (3x3 M, bias b) by least squares over samples taken resting
+// in the six gravity-aligned poses (+-X, +-Y, +-Z up).  An optional free
+// rotation sweep refines it by asking |M a + b| = 1 g everywhere.
+//
+// Blob layout (little endian, what GY521::setAccelCalibration() reads):
+//
+//   0  "GCAL"
+//   4  uint8  version (1)
+//   5  uint8  sensor count
+//   6  uint16 reserved
+//   8  count x { float m[9] (row major); float b[3]; }   48 bytes each
+//
+
+
+#ifndef __GLOVE_CALIB_H__
+#define __GLOVE_CALIB_H__
+
+#include "glove-sample.h"
+
+#define GLOVE_CALIB_VERSION     1
+#define GLOVE_CALIB_HEADER      8
+#define GLOVE_CALIB_ENTRY       48
+#define GLOVE_CALIB_POSES       6
+
+typedef struct {
+    float m[9];
+    float b[3];
+} glove_accel_cal_t;
+
+typedef struct {
+    int               count;
+    glove_accel_cal_t accel[GLOVE_MAX_SENSORS];
+} glove_calib_t;
+
+// least squares accumulator for one sensor
+typedef struct {
+    double   ata[4][4];         // sum of [a 1]^T [a 1]
+    double   atb[4][3];         // sum of [a 1]^T target
+    int      pose_n[GLOVE_CALIB_POSES];
+    double   pose_sum[GLOVE_CALIB_POSES][3];
+    float*   sweep;             // free-rotation samples, 3 floats each
+    int      sweep_n, sweep_cap;
+} glove_calib_fit_t;
+
+void glove_calib_identity(glove_calib_t* cal, int count);
+
+// one matrix-vector multiply, in place
+static inline void glove_calib_apply(const glove_accel_cal_t* c, float a[3])
+{
+    float x = a[0], y = a[1], z = a[2];
+    a[0] = c->m[0] * x + c->m[1] * y + c->m[2] * z + c->b[0];
+    a[1] = c->m[3] * x + c->m[4] * y + c->m[5] * z + c->b[1];
+    a[2] = c->m[6] * x + c->m[7] * y + c->m[8] * z + c->b[2];
+}
+
+void glove_calib_apply_sample(const glove_calib_t* cal, glove_sample_t* s);
+
+// 0..5 for +X -X +Y -Y +Z -Z up, from a resting reading
+int  glove_calib_pose(const float a[3]);
+const char* glove_calib_pose_name(int pose);
+
+void glove_calib_fit_init(glove_calib_fit_t* fit);
+void glove_calib_fit_free(glove_calib_fit_t* fit);
+// a resting sample, its pose is taken from the dominant axis
+void glove_calib_fit_add_pose(glove_calib_fit_t* fit, const float a[3]);
+int  glove_calib_fit_add_sweep(glove_calib_fit_t* fit, const float a[3]);
+int  glove_calib_fit_complete(const glove_calib_fit_t* fit, int min_per_pose);
+// returns 0, or -1 if the poses don't pin down M
+int  glove_calib_fit_solve(const glove_calib_fit_t* fit, glove_accel_cal_t* out);
+// worst angle between a pose's mean reading (corrected by c, if given)
+// and the true gravity direction, in degrees: the tilt error left over
+float glove_calib_pose_error(const glove_calib_fit_t* fit, const glove_accel_cal_t* c);
+// rms of |M a + b| - 1 over the sweep samples, in g
+float glove_calib_sweep_rms(const glove_calib_fit_t* fit, const glove_accel_cal_t* c);
+
+int  glove_calib_to_blob(const glove_calib_t* cal, uint8_t* buf, int buf_max);
+int  glove_calib_from_blob(glove_calib_t* cal, const uint8_t* buf, int len);
+int  glove_calib_save(const char* path, const glove_calib_t* cal);
+int  glove_calib_load(const char* path, glove_calib_t* cal);
+
+#endif
@@ -0,0 +1,596 @@
+//
+// glove-codec -- compact storage for long recordings
+//
+
+#include "glove-codec.h"
+#include "glove-record.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#define GLOVE_CODEC_SSE 1
+#endif
+#ifdef GLOVE_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef GLOVE_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static_assert(sizeof(glove_codec_block_t) == 32, "block header layout");
+
+// the plain form is the recording's record, which has no padding to leak
+#define RAW_SIZE(n)     ((size_t)(n) * sizeof(glove_rec_sample_t))
+
+static const float pow10f[GLOVE_CODEC_MAX_DECIMALS + 1] = { 1, 10, 100, 1e3f, 1e4f, 1e5f, 1e6f };
+
+static int use_simd = -1;
+
+int glove_codec_simd(int enable)
+{
+#ifdef GLOVE_CODEC_SSE
+    use_simd = enable && __builtin_cpu_supports("ssse3");
+#else
+    use_simd = 0;
+#endif
+    return use_simd;
+}
+
+//
+// Stream VByte
+//
+
+typedef struct {
+    uint8_t shuffle[256][16];           // per control byte: data bytes to four uint32s
+    uint8_t length[256];                // and how many data bytes the four take
+} svb_tables_t;
+
+static svb_tables_t build_tables(void)
+{
+    svb_tables_t t;
+    for (int c = 0; c < 256; c++) {
+        int at = 0;
+        for (int i = 0; i < 4; i++) {
+            int len = ((c >> (2 * i)) & 3) + 1;
+            for (int b = 0; b < 4; b++)
+                t.shuffle[c][4 * i + b] = b < len ? at + b : 0x80;     // 0x80 zeroes the byte
+            at += len;
+        }
+        t.length[c] = at;
+    }
+    return t;
+}
+
+static const svb_tables_t& tables(void)
+{
+    static const svb_tables_t t = build_tables();
+    return t;
+}
+
+static int svb_length(uint32_t v)
+{
+    return v < (1u << 8) ? 1 : v < (1u << 16) ? 2 : v < (1u << 24) ? 3 : 4;
+}
+
+// v[0..n) as control bytes then data bytes; returns the end
+static uint8_t* svb_encode(const uint32_t* v, int n, uint8_t* out)
+{
+    uint8_t* ctrl = out;
+    uint8_t* data = out + (n + 3) / 4;
+    memset(ctrl, 0, (n + 3) / 4);
+    for (int i = 0; i < n; i++) {
+        int len = svb_length(v[i]);
+        ctrl[i / 4] |= (len - 1) << (i % 4 * 2);
+        for (uint32_t x = v[i]; len--; x >>= 8) *data++ = (uint8_t)x;
+    }
+    return data;
+}
+
+// values i..n, one at a time; returns past their data, NULL if it runs
+// past end
+static const uint8_t* svb_decode_tail(const uint8_t* ctrl, const uint8_t* data, const uint8_t* end,
+                                      uint32_t* v, int i, int n)
+{
+    for (; i < n; i++) {
+        int len = ((ctrl[i / 4] >> (i % 4 * 2)) & 3) + 1;
+        if (len > end - data) return NULL;
+        uint32_t x = 0;
+        for (int b = 0; b < len; b++) x |= (uint32_t)data[b] << (8 * b);
+        v[i] = x;
+        data += len;
+    }
+    return data;
+}
+
+#ifdef GLOVE_CODEC_SSE
+__attribute__((target("ssse3")))
+static const uint8_t* svb_decode_ssse3(const uint8_t* ctrl, const uint8_t* data, const uint8_t* end,
+                                       uint32_t* v, int n)
+{
+    const svb_tables_t& t = tables();
+    int i = 0;
+    // four at a time while a 16 byte load stays inside the block
+    for (; i + 4 <= n && end - data >= 16; i += 4) {
+        uint8_t c = ctrl[i / 4];
+        __m128i x = _mm_loadu_si128((const __m128i*)data);
+        __m128i s = _mm_loadu_si128((const __m128i*)t.shuffle[c]);
+        _mm_storeu_si128((__m128i*)(v + i), _mm_shuffle_epi8(x, s));
+        data += t.length[c];
+    }
+    return svb_decode_tail(ctrl, data, end, v, i, n);
+}
+#endif
+
+static const uint8_t* svb_decode(const uint8_t* p, const uint8_t* end, uint32_t* v, int n)
+{
+    const uint8_t* data = p + (n + 3) / 4;
+    if ((n + 3) / 4 > end - p) return NULL;
+#ifdef GLOVE_CODEC_SSE
+    if (use_simd) return svb_decode_ssse3(p, data, end, v, n);
+#endif
+    return svb_decode_tail(p, data, end, v, 0, n);
+}
+
+//
+// deltas and counts
+//
+
+static inline uint32_t zigzag(int32_t d)
+{
+    return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+}
+
+static inline uint32_t unzigzag(uint32_t z)
+{
+    return (z >> 1) ^ (0u - (z & 1));
+}
+
+// zigzagged deltas back to running sums from 0, in place; sums wrap
+static void undelta(uint32_t* v, int n)
+{
+    int i = 0;
+    uint32_t sum = 0;
+#ifdef GLOVE_CODEC_SSE
+    if (use_simd) {
+        __m128i run = _mm_setzero_si128(), one = _mm_set1_epi32(1);
+        for (; i + 4 <= n; i += 4) {
+            __m128i z = _mm_loadu_si128((const __m128i*)(v + i));
+            __m128i d = _mm_xor_si128(_mm_srli_epi32(z, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(z, one)));
+            d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+            d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+            d = _mm_add_epi32(d, run);
+            _mm_storeu_si128((__m128i*)(v + i), d);
+            run = _mm_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        sum = (uint32_t)_mm_cvtsi128_si32(run);
+    }
+#endif
+    for (; i < n; i++) v[i] = sum += unzigzag(v[i]);
+}
+
+static inline float count_to_float(int32_t q, float scale)
+{
+    return q == GLOVE_CODEC_NEG_ZERO ? -0.0f : (float)q / scale;
+}
+
+// the same division four at a time, so both paths give the same floats
+static void dequantize(const uint32_t* q, int n, float scale, float* out)
+{
+    int i = 0;
+#ifdef GLOVE_CODEC_SSE
+    if (use_simd) {
+        __m128 s = _mm_set1_ps(scale), negzero = _mm_set1_ps(-0.0f);
+        __m128i nz = _mm_set1_epi32(GLOVE_CODEC_NEG_ZERO);
+        for (; i + 4 <= n; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(q + i));
+            __m128 f = _mm_div_ps(_mm_cvtepi32_ps(x), s);
+            __m128 m = _mm_castsi128_ps(_mm_cmpeq_epi32(x, nz));
+            _mm_storeu_ps(out + i, _mm_or_ps(_mm_andnot_ps(m, f), _mm_and_ps(m, negzero)));
+        }
+    }
+#endif
+    for (; i < n; i++) out[i] = count_to_float((int32_t)q[i], scale);
+}
+
+// v as a count of 10^-decimals; 0 if that doesn't give v back exactly
+static int to_count(float v, int decimals, int32_t* q)
+{
+    if (v == 0 && signbit(v)) {
+        *q = GLOVE_CODEC_NEG_ZERO;
+        return 1;
+    }
+    double x = rint((double)v * pow10f[decimals]);
+    if (!(fabs(x) < (1 << 24))) return 0;          // and NaN
+    *q = (int32_t)x;
+    float back = count_to_float(*q, pow10f[decimals]);
+    return memcmp(&back, &v, sizeof(v)) == 0;
+}
+
+// fewest decimals, at least 'from', that hold v; -1 if none do
+static int decimals_of(float v, int from)
+{
+    int32_t q;
+    for (int d = from; d <= GLOVE_CODEC_MAX_DECIMALS; d++)
+        if (to_count(v, d, &q)) return d;
+    return -1;
+}
+
+static float axis_of(const glove_sample_t* s, int axis)
+{
+    return axis < 3 ? s->a[axis] : s->g[axis - 3];
+}
+
+//
+// blocks
+//
+
+// the columns of s[0..n) at out; bytes written, or -1 if they can't hold
+// the block exactly
+static long pack_columns(glove_codec_t* c, const glove_sample_t* s, int n,
+                         glove_codec_block_t* b, uint8_t* out)
+{
+    int adec = 0, gdec = 0;
+    for (int i = 0; i < n; i++)
+        for (int k = 0; k < 3; k++) {
+            if ((adec = decimals_of(s[i].a[k], adec)) < 0) return -1;
+            if ((gdec = decimals_of(s[i].g[k], gdec)) < 0) return -1;
+        }
+
+    // where each sensor's run starts in the axis columns
+    int start[GLOVE_MAX_SENSORS + 1] = { 0 }, at[GLOVE_MAX_SENSORS];
+    for (int i = 0; i < n; i++) {
+        if (s[i].sensor >= GLOVE_MAX_SENSORS) return -1;
+        start[s[i].sensor + 1]++;
+    }
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) start[k + 1] += start[k];
+
+    uint8_t* p = out;
+    uint32_t* v = c->values;
+    for (int i = 0; i < n; i++) *p++ = s[i].sensor;
+
+    uint32_t prev = 0;
+    for (int i = 0; i < n; i++) {
+        int64_t off = (int64_t)(s[i].t_us - s[0].t_us);
+        if (off < INT32_MIN || off > INT32_MAX) return -1;
+        v[i] = zigzag((int32_t)((uint32_t)off - prev));
+        prev = (uint32_t)off;
+    }
+    p = svb_encode(v, n, p);
+
+    for (int axis = 0; axis < 6; axis++) {
+        int dec = axis < 3 ? adec : gdec;
+        uint32_t last[GLOVE_MAX_SENSORS] = { 0 };
+        memcpy(at, start, sizeof(at));
+        for (int i = 0; i < n; i++) {
+            int32_t q;
+            int k = s[i].sensor;
+            if (!to_count(axis_of(&s[i], axis), dec, &q)) return -1;
+            v[at[k]++] = zigzag((int32_t)((uint32_t)q - last[k]));
+            last[k] = (uint32_t)q;
+        }
+        p = svb_encode(v, n, p);
+    }
+    b->a_decimals = adec;
+    b->g_decimals = gdec;
+    return p - out;
+}
+
+static int unpack_columns(glove_codec_t* c, const uint8_t* p, size_t len,
+                          const glove_codec_block_t* b, glove_sample_t* s)
+{
+    int n = b->count;
+    const uint8_t* end = p + len;
+    const uint8_t* sensors = p;
+    if (b->a_decimals > GLOVE_CODEC_MAX_DECIMALS || b->g_decimals > GLOVE_CODEC_MAX_DECIMALS ||
+        len < (size_t)n)
+        return -1;
+
+    int start[GLOVE_MAX_SENSORS + 1] = { 0 }, at[GLOVE_MAX_SENSORS];
+    for (int i = 0; i < n; i++) {
+        if (sensors[i] >= GLOVE_MAX_SENSORS) return -1;
+        start[sensors[i] + 1]++;
+    }
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) start[k + 1] += start[k];
+    p += n;
+
+    if ((p = svb_decode(p, end, c->offsets, n)) == NULL) return -1;
+    undelta(c->offsets, n);
+    for (int axis = 0; axis < 6; axis++) {
+        if ((p = svb_decode(p, end, c->values, n)) == NULL) return -1;
+        for (int k = 0; k < GLOVE_MAX_SENSORS; k++)
+            undelta(c->values + start[k], start[k + 1] - start[k]);
+        dequantize(c->values, n, pow10f[axis < 3 ? b->a_decimals : b->g_decimals], c->decoded[axis]);
+    }
+    if (p != end) return -1;
+
+    // back to capture order
+    memcpy(at, start, sizeof(at));
+    for (int i = 0; i < n; i++) {
+        int k = sensors[i], j = at[k]++;
+        s[i].t_us = b->first_t_us + (int64_t)(int32_t)c->offsets[i];
+        s[i].sensor = k;
+        s[i].a[0] = c->decoded[0][j];
+        s[i].a[1] = c->decoded[1][j];
+        s[i].a[2] = c->decoded[2][j];
+        s[i].g[0] = c->decoded[3][j];
+        s[i].g[1] = c->decoded[4][j];
+        s[i].g[2] = c->decoded[5][j];
+    }
+    return 0;
+}
+
+size_t glove_codec_bound(int n)
+{
+    return sizeof(glove_codec_block_t) + RAW_SIZE(n);
+}
+
+long glove_codec_encode(glove_codec_t* c, const glove_sample_t* s, int n, uint8_t* out, size_t out_max)
+{
+    if (n < 0 || n > GLOVE_CODEC_BLOCK || out_max < glove_codec_bound(n)) return -1;
+    glove_codec_block_t b;
+    memset(&b, 0, sizeof(b));
+    memcpy(b.magic, "GBLK", 4);
+    b.count = n;
+    b.first_t_us = n ? s[0].t_us : 0;
+    uint8_t* payload = out + sizeof(b);
+
+    // the columns go straight out unless a compressor has them next
+    long len = -1;
+    if (c->method != GLOVE_CODEC_RAW) {
+        int direct = c->method == GLOVE_CODEC_VARINT;
+        len = pack_columns(c, s, n, &b, direct ? payload : c->columns);
+        if (len > (long)RAW_SIZE(n)) len = -1;
+    }
+    if (len >= 0) {
+        b.method = GLOVE_CODEC_VARINT;
+        b.columns = b.size = len;
+        long packed = 0;
+#ifdef GLOVE_HAVE_LZ4
+        if (c->method == GLOVE_CODEC_LZ4)
+            packed = LZ4_compress_default((const char*)c->columns, (char*)payload, len, len - 1);
+#endif
+#ifdef GLOVE_HAVE_ZSTD
+        if (c->method == GLOVE_CODEC_ZSTD) {
+            size_t z = ZSTD_compress(payload, len - 1, c->columns, len, c->level);
+            packed = ZSTD_isError(z) ? 0 : (long)z;
+        }
+#endif
+        if (packed > 0) {
+            b.method = c->method;
+            b.size = packed;
+        } else if (c->method != GLOVE_CODEC_VARINT) {
+            memcpy(payload, c->columns, len);
+        }
+    } else {
+        b.method = GLOVE_CODEC_RAW;
+        b.size = RAW_SIZE(n);
+        for (int i = 0; i < n; i++) {
+            glove_rec_sample_t r;
+            memset(&r, 0, sizeof(r));
+            r.t_us = s[i].t_us;
+            r.sensor = s[i].sensor;
+            memcpy(r.a, s[i].a, sizeof(r.a));
+            memcpy(r.g, s[i].g, sizeof(r.g));
+            memcpy(payload + RAW_SIZE(i), &r, sizeof(r));
+        }
+    }
+    memcpy(out, &b, sizeof(b));
+    return sizeof(b) + b.size;
+}
+
+long glove_codec_decode(glove_codec_t* c, const uint8_t* p, size_t avail, glove_sample_t* s, int* n)
+{
+    glove_codec_block_t b;
+    if (avail < sizeof(b)) return -1;
+    memcpy(&b, p, sizeof(b));
+    if (memcmp(b.magic, "GBLK", 4) != 0 || b.count > GLOVE_CODEC_BLOCK ||
+        b.size > avail - sizeof(b) || b.columns > RAW_SIZE(GLOVE_CODEC_BLOCK))
+        return -1;
+    const uint8_t* payload = p + sizeof(b);
+
+    switch (b.method) {
+    case GLOVE_CODEC_RAW:
+        if (b.size != RAW_SIZE(b.count)) return -1;
+        for (uint32_t i = 0; i < b.count; i++) {
+            glove_rec_sample_t r;
+            memcpy(&r, payload + RAW_SIZE(i), sizeof(r));
+            if (r.sensor >= GLOVE_MAX_SENSORS) return -1;
+            s[i].t_us = r.t_us;
+            s[i].sensor = r.sensor;
+            memcpy(s[i].a, r.a, sizeof(s[i].a));
+            memcpy(s[i].g, r.g, sizeof(s[i].g));
+        }
+        break;
+    case GLOVE_CODEC_VARINT:
+        if (b.columns != b.size || unpack_columns(c, payload, b.size, &b, s) != 0) return -1;
+        break;
+#ifdef GLOVE_HAVE_LZ4
+    case GLOVE_CODEC_LZ4:
+        if (LZ4_decompress_safe((const char*)payload, (char*)c->columns, b.size, b.columns) != (int)b.columns ||
+            unpack_columns(c, c->columns, b.columns, &b, s) != 0)
+            return -1;
+        break;
+#endif
+#ifdef GLOVE_HAVE_ZSTD
+    case GLOVE_CODEC_ZSTD:
+        if (ZSTD_decompress(c->columns, b.columns, payload, b.size) != b.columns ||
+            unpack_columns(c, c->columns, b.columns, &b, s) != 0)
+            return -1;
+        break;
+#endif
+    default:
+        return -1;                      // or a compressor this build lacks
+    }
+    *n = b.count;
+    return sizeof(b) + b.size;
+}
+
+//
+// setup
+//
+
+static const char* method_names[] = { "raw", "varint", "lz4", "zstd" };
+
+int glove_codec_method(const char* name)
+{
+    for (int i = 0; i < 4; i++)
+        if (strcmp(name, method_names[i]) == 0) return i;
+    return -1;
+}
+
+const char* glove_codec_method_name(int method)
+{
+    return method >= 0 && method < 4 ? method_names[method] : "?";
+}
+
+int glove_codec_available(int method)
+{
+    switch (method) {
+    case GLOVE_CODEC_RAW:
+    case GLOVE_CODEC_VARINT:
+        return 1;
+#ifdef GLOVE_HAVE_LZ4
+    case GLOVE_CODEC_LZ4:
+        return 1;
+#endif
+#ifdef GLOVE_HAVE_ZSTD
+    case GLOVE_CODEC_ZSTD:
+        return 1;
+#endif
+    }
+    return 0;
+}
+
+int glove_codec_init(glove_codec_t* c, int method)
+{
+    memset(c, 0, sizeof(*c));
+    if (!glove_codec_available(method)) return -1;
+    if (use_simd < 0) glove_codec_simd(1);
+    c->method = method;
+    c->level = GLOVE_CODEC_ZSTD_LEVEL;
+    c->columns = (uint8_t*)malloc(RAW_SIZE(GLOVE_CODEC_BLOCK));
+    c->values = (uint32_t*)malloc(GLOVE_CODEC_BLOCK * sizeof(uint32_t));
+    c->offsets = (uint32_t*)malloc(GLOVE_CODEC_BLOCK * sizeof(uint32_t));
+    c->decoded[0] = (float*)malloc(6 * GLOVE_CODEC_BLOCK * sizeof(float));
+    if (!c->columns || !c->values || !c->offsets || !c->decoded[0]) {
+        glove_codec_free(c);
+        return -1;
+    }
+    for (int k = 1; k < 6; k++) c->decoded[k] = c->decoded[0] + k * GLOVE_CODEC_BLOCK;
+    return 0;
+}
+
+void glove_codec_free(glove_codec_t* c)
+{
+    free(c->columns);
+    free(c->values);
+    free(c->offsets);
+    free(c->decoded[0]);
+    memset(c, 0, sizeof(*c));
+}
+
+//
+// files
+//
+
+int glove_codec_save(const char* path, const glove_session_t* ss, const glove_calib_t* cal, int method)
+{
+    glove_codec_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, GLOVE_CODEC_MAGIC, 8);
+    h.version = GLOVE_CODEC_VERSION;
+    h.endian = GLOVE_CODEC_ENDIAN;
+    h.block_size = GLOVE_CODEC_BLOCK;
+    h.nblocks = (ss->nsamples + GLOVE_CODEC_BLOCK - 1) / GLOVE_CODEC_BLOCK;
+    h.nsamples = ss->nsamples;
+    if (cal) {
+        int len = glove_calib_to_blob(cal, h.calib, sizeof(h.calib));
+        if (len < 0) { errno = EINVAL; return -1; }
+        h.calib_len = len;
+    }
+
+    glove_codec_t c;
+    if (glove_codec_init(&c, method) != 0) { errno = EINVAL; return -1; }
+    size_t max = glove_codec_bound(GLOVE_CODEC_BLOCK);
+    uint8_t* buf = (uint8_t*)malloc(max);
+    FILE* fp = buf ? fopen(path, "wb") : NULL;
+    int ok = fp && fwrite(&h, sizeof(h), 1, fp) == 1;
+    for (int i = 0; ok && i < ss->nsamples; i += GLOVE_CODEC_BLOCK) {
+        int n = ss->nsamples - i < GLOVE_CODEC_BLOCK ? ss->nsamples - i : GLOVE_CODEC_BLOCK;
+        long len = glove_codec_encode(&c, ss->samples + i, n, buf, max);
+        ok = len > 0 && fwrite(buf, len, 1, fp) == 1;
+    }
+    if (fp && fclose(fp) != 0) ok = 0;
+    free(buf);
+    glove_codec_free(&c);
+    return ok ? 0 : -1;
+}
+
+int glove_codec_probe(const char* path)
+{
+    char magic[8];
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return 0;
+    int is = fread(magic, 1, 8, fp) == 8 && memcmp(magic, GLOVE_CODEC_MAGIC, 8) == 0;
+    fclose(fp);
+    return is;
+}
+
+int glove_codec_load(const char* path, glove_session_t* ss, glove_calib_t* cal)
+{
+    memset(ss, 0, sizeof(*ss));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("glove_codec_load: Unable to open packed recording");
+        return -1;
+    }
+    struct stat st;
+    void* m = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(glove_codec_header_t))
+        m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return -1;
+
+    const glove_codec_header_t* h = (const glove_codec_header_t*)m;
+    const uint8_t* p = (const uint8_t*)m + sizeof(*h);
+    const uint8_t* end = (const uint8_t*)m + st.st_size;
+    int ok = memcmp(h->magic, GLOVE_CODEC_MAGIC, 8) == 0 && h->version == GLOVE_CODEC_VERSION &&
+             h->endian == GLOVE_CODEC_ENDIAN && h->block_size == GLOVE_CODEC_BLOCK;
+    if (ok && cal) {
+        glove_calib_identity(cal, 0);
+        if (h->calib_len && glove_calib_from_blob(cal, h->calib, h->calib_len) != 0) ok = 0;
+    }
+
+    glove_codec_t c;
+    glove_sample_t* block = (glove_sample_t*)malloc(GLOVE_CODEC_BLOCK * sizeof(glove_sample_t));
+    if (glove_codec_init(&c, GLOVE_CODEC_VARINT) != 0 || !block) ok = 0;
+    for (uint32_t k = 0; ok && k < h->nblocks; k++) {
+        int n;
+        long len = glove_codec_decode(&c, p, end - p, block, &n);
+        if (len < 0) {
+            fprintf(stderr, "glove_codec_load: block %u is damaged or needs lz4/zstd\n", k);
+            ok = 0;
+            break;
+        }
+        for (int i = 0; ok && i < n; i++) ok = glove_session_add(ss, &block[i]) == 0;
+        p += len;
+    }
+    if ((uint64_t)ss->nsamples != h->nsamples) ok = 0;
+    glove_codec_free(&c);
+    free(block);
+    munmap(m, st.st_size);
+    if (!ok) {
+        glove_session_free(ss);
+        return -1;
+    }
+    return ss->nsamples > 0 ? 0 : -1;
+}
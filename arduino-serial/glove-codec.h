@@ -0,0 +1,119 @@
+//
+// glove-codec -- compact storage for long recordings
+//
+// A recording (glove-record.h) spends 40 bytes on every read, about
+// 1.7 GB an hour for twelve sensors at 1 kHz, most of it repeating what
+// the previous read of the same sensor said.  A packed recording keeps
+// the same samples in blocks of up to BLOCK reads, column by column:
+//
+//   sensors    one byte per read
+//   time       offset from the block's first read, delta to the previous read
+//   ax .. gz   six columns, each grouped by sensor and delta coded against
+//              that sensor's previous read
+//
+// Readings are held as the decimal fixed point they arrived in: the
+// sketch prints a few decimals and strtof() turns them into the nearest
+// float, so count / 10^decimals is that same float again.  A block uses
+// the fewest decimals (per accel and per gyro) that give back every value
+// bit for bit; "-0.000" gets a count of its own.  Deltas are zigzag
+// mapped and written as Stream VByte: a control byte gives the length
+// (1..4 bytes) of four values, the values follow.  That layout is what
+// lets SSSE3 decode four values with one shuffle; the delta sums and the
+// conversion back to floats are SSE2.  Other CPUs get the scalar path,
+// which gives identical results.
+//
+// A block that can't be held exactly (more than six decimals, an
+// hour-long gap) is stored as plain records.  Blocks can also be put
+// through LZ4 or zstd when built with "make LZ4=1" or "make ZSTD=1"; a
+// block keeps whichever of the two forms is smaller.
+//
+// Packed files are a header with the calibration blob and the blocks
+// back to back, in the writer's byte order.  They are read whole, as
+// sessions; seeking and live playback stay with glove-record/replay.
+//
+
+
+#ifndef __GLOVE_CODEC_H__
+#define __GLOVE_CODEC_H__
+
+#include <stddef.h>
+
+#include "glove-sample.h"
+#include "glove-calib.h"
+
+#define GLOVE_CODEC_MAGIC       "GLOVEPAK"
+#define GLOVE_CODEC_VERSION     1
+#define GLOVE_CODEC_ENDIAN      0x01020304
+#define GLOVE_CODEC_BLOCK       4096            // reads per block
+#define GLOVE_CODEC_MAX_DECIMALS 6
+#define GLOVE_CODEC_NEG_ZERO    INT32_MIN       // the count of -0.0
+#define GLOVE_CODEC_ZSTD_LEVEL  3
+
+// how a block's payload is stored
+#define GLOVE_CODEC_RAW         0               // plain records
+#define GLOVE_CODEC_VARINT      1               // columns as above
+#define GLOVE_CODEC_LZ4         2               // columns, then LZ4
+#define GLOVE_CODEC_ZSTD        3               // columns, then zstd
+
+typedef struct {
+    char     magic[4];                  // "GBLK"
+    uint8_t  method;                    // GLOVE_CODEC_RAW ..
+    uint8_t  a_decimals, g_decimals;
+    uint8_t  reserved;
+    uint32_t count;                     // reads
+    uint32_t size;                      // payload bytes after this header
+    uint32_t columns;                   // column bytes before LZ4/zstd
+    uint32_t reserved2;
+    uint64_t first_t_us;
+} glove_codec_block_t;
+
+typedef struct {
+    char     magic[8];                  // GLOVE_CODEC_MAGIC
+    uint32_t version;
+    uint32_t endian;                    // GLOVE_CODEC_ENDIAN as the writer stored it
+    uint32_t block_size;                // GLOVE_CODEC_BLOCK
+    uint32_t nblocks;
+    uint64_t nsamples;
+    uint32_t calib_len;                 // 0 for none
+    uint8_t  calib[GLOVE_CALIB_HEADER + GLOVE_MAX_SENSORS * GLOVE_CALIB_ENTRY];
+} glove_codec_header_t;
+
+typedef struct {
+    int       method;                   // asked for when encoding
+    int       level;                    // zstd level
+    uint8_t*  columns;                  // a block's columns before LZ4/zstd
+    uint32_t* values;                   // one column, decoded
+    float*    decoded[6];               // the axis columns as floats
+    uint32_t* offsets;                  // time offsets
+} glove_codec_t;
+
+// 0, or -1 out of memory or method not built in
+int  glove_codec_init(glove_codec_t* c, int method);
+void glove_codec_free(glove_codec_t* c);
+// "raw", "varint", "lz4" or "zstd" -> GLOVE_CODEC_*, -1 if unknown
+int  glove_codec_method(const char* name);
+const char* glove_codec_method_name(int method);
+// 1 if method can be used in this build
+int  glove_codec_available(int method);
+// turn the SSE decode path on or off; returns 1 if it is in use
+int  glove_codec_simd(int enable);
+
+// largest block n reads can take, header included
+size_t glove_codec_bound(int n);
+// samples[0..n), n <= GLOVE_CODEC_BLOCK, as one block; bytes written, or
+// -1 if out_max is short of glove_codec_bound(n)
+long glove_codec_encode(glove_codec_t* c, const glove_sample_t* samples, int n,
+                        uint8_t* out, size_t out_max);
+// the block at p into samples (room for GLOVE_CODEC_BLOCK); the block's
+// size in bytes with *n reads, or -1 if it is damaged
+long glove_codec_decode(glove_codec_t* c, const uint8_t* p, size_t avail,
+                        glove_sample_t* samples, int* n);
+
+// a whole session to a packed file; cal may be NULL.  0, or -1 with errno set
+int  glove_codec_save(const char* path, const glove_session_t* ss, const glove_calib_t* cal, int method);
+// 1 if path starts like a packed file
+int  glove_codec_probe(const char* path);
+// a packed file as a session, cal as glove_rec_load(); 0, or -1
+int  glove_codec_load(const char* path, glove_session_t* ss, glove_calib_t* cal);
+
+#endif
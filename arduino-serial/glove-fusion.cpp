@@ -0,0 +1,52 @@
+//
+// glove-fusion -- per-sensor orientation filter on the host
+//
+
+#include "glove-fusion.h"
+
+void glove_fusion_init(glove_fusion_t* f, float alpha)
+{
+    f->q = glove_quat_identity();
+    f->alpha = alpha;
+    f->last_us = 0;
+    f->started = 0;
+}
+
+glove_quat_t glove_fusion_tilt(const float a[3])
+{
+    glove_vec3_t v = glove_vec3(a[0], a[1], a[2]);
+    float n = glove_vec3_len(v);
+    if (n < 1e-6f) return glove_quat_identity();
+    return glove_quat_between(glove_vec3_scale(v, 1.0f / n), glove_vec3(0, 0, 1));
+}
+
+void glove_fusion_update(glove_fusion_t* f, const glove_sample_t* s)
+{
+    if (!f->started || s->t_us <= f->last_us ||
+        s->t_us - f->last_us > GLOVE_FUSION_MAX_GAP) {
+        if (!f->started) f->q = glove_fusion_tilt(s->a);
+        f->started = 1;
+        f->last_us = s->t_us;
+        return;
+    }
+    float dt = (s->t_us - f->last_us) * 1e-6f;
+    f->last_us = s->t_us;
+
+    // gyro: body rates, integrate on the right
+    glove_vec3_t w = glove_vec3(s->g[0], s->g[1], s->g[2]);
+    f->q = glove_quat_mul(f->q, glove_quat_from_rotvec(glove_vec3_scale(w, GLOVE_DEG2RAD * dt)));
+
+    // accel: trusted less the further |a| is from 1g, i.e. the harder the
+    // hand is being pushed around
+    glove_vec3_t a = glove_vec3(s->a[0], s->a[1], s->a[2]);
+    float n = glove_vec3_len(a);
+    float trust = 1.0f - fabsf(n - 1.0f) / GLOVE_FUSION_ACC_GATE;
+    if (trust > 0) {
+        glove_vec3_t up = glove_quat_rotate(glove_quat_conj(f->q), glove_vec3(0, 0, 1));
+        glove_quat_t full = glove_quat_between(glove_vec3_scale(a, 1.0f / n), up);
+        float k = trust * (1.0f - f->alpha) * (dt * 1e6f / GLOVE_FUSION_REF_US);
+        if (k > 1.0f) k = 1.0f;
+        f->q = glove_quat_mul(f->q, glove_quat_slerp(glove_quat_identity(), full, k));
+    }
+    f->q = glove_quat_normalize(f->q);
+}
@@ -0,0 +1,34 @@
+//
+// glove-fusion -- per-sensor orientation filter on the host
+//
+// Same idea as GY521::read(): trust the gyro, pull the tilt towards the
+// accelerometer with weight (1 - alpha).  Done on a quaternion so it
+// does not fall apart near +-90 degrees the way the Euler version does.
+// Yaw is gyro only; the MPU6050 has nothing to correct it with.
+//
+
+
+#ifndef __GLOVE_FUSION_H__
+#define __GLOVE_FUSION_H__
+
+#include "glove-sample.h"
+
+#define GLOVE_FUSION_ALPHA     0.96f    // gyro weight, as in GY521::read()
+#define GLOVE_FUSION_REF_US    10000    // alpha is per GY521_THROTTLE_TIME
+#define GLOVE_FUSION_MAX_GAP   500000   // longer gaps restart integration
+#define GLOVE_FUSION_ACC_GATE  0.1f     // g off 1g where accel stops counting
+
+typedef struct {
+    glove_quat_t q;         // body -> world
+    float        alpha;
+    uint64_t     last_us;
+    int          started;
+} glove_fusion_t;
+
+void glove_fusion_init(glove_fusion_t* f, float alpha);
+void glove_fusion_update(glove_fusion_t* f, const glove_sample_t* s);
+
+// tilt-only orientation from an accelerometer reading
+glove_quat_t glove_fusion_tilt(const float a[3]);
+
+#endif
@@ -0,0 +1,355 @@
+//
+// glove-golden -- regression check of fusion and kinematics against a
+// golden trace
+//
+
+#include "glove-golden.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glove-fusion.h"
+#include "glove-stream.h"
+
+static int session_sensors(const glove_session_t* ss)
+{
+    int n = 0;
+    for (int i = 0; i < ss->nsamples; i++)
+        if (ss->samples[i].sensor >= n) n = ss->samples[i].sensor + 1;
+    return n;
+}
+
+// the pipeline the viewers run, minus the link: fuse every sample, pose
+// the hands after each read of the last sensor.  Keeps outputs in g, or
+// with g NULL folds them into sink so timing can't skip them
+static void pipeline(const glove_session_t* ss, float alpha, glove_golden_t* g, float* sink)
+{
+    glove_fusion_t fu[GLOVE_MAX_SENSORS];
+    glove_quat_t q[GLOVE_MAX_SENSORS];
+    int kept[GLOVE_MAX_SENSORS];
+    glove_hand_pose_t pose;
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) {
+        glove_fusion_init(&fu[k], alpha);
+        q[k] = glove_quat_identity();
+        kept[k] = 0;
+    }
+    int nsensors = session_sensors(ss), frames = 0;
+    int hands = nsensors > GLOVE_HAND_SENSORS ? 2 : 1;
+
+    for (int i = 0; i < ss->nsamples; i++) {
+        const glove_sample_t* s = &ss->samples[i];
+        glove_fusion_update(&fu[s->sensor], s);
+        q[s->sensor] = fu[s->sensor].q;
+        // counted per sensor: every 4th of six interleaved would keep only even ones
+        if (g && kept[s->sensor]++ % GLOVE_GOLDEN_EVERY == 0) {
+            glove_golden_fused_t* o = &g->fused[g->nfused++];
+            o->t_us = s->t_us;
+            o->sensor = s->sensor;
+            o->q = q[s->sensor];
+        }
+        if (s->sensor != nsensors - 1) continue;
+        int keep = g && frames++ % GLOVE_GOLDEN_EVERY == 0;
+        for (int h = 0; h < hands; h++) {
+            int n = nsensors - h * GLOVE_HAND_SENSORS;
+            glove_kin_hand(&q[h * GLOVE_HAND_SENSORS], n > GLOVE_HAND_SENSORS ? GLOVE_HAND_SENSORS : n,
+                           glove_vec3(h ? -0.12f : 0.12f, 0, 0), h, &pose);
+            if (keep) {
+                glove_golden_frame_t* o = &g->frames[g->nframes++];
+                o->t_us = s->t_us;
+                o->hand = (uint8_t)h;
+                for (int b = 0; b < GLOVE_KIN_BONES; b++) o->q[b] = pose.bones[b].q;
+            } else if (sink) {
+                *sink += pose.joints[GLOVE_KIN_JOINTS - 1].x;
+            }
+        }
+    }
+}
+
+int glove_golden_run(const glove_session_t* ss, float alpha, glove_golden_t* g)
+{
+    memset(g, 0, sizeof(*g));
+    g->alpha = alpha;
+    g->fused = (glove_golden_fused_t*)malloc((ss->nsamples / GLOVE_GOLDEN_EVERY + GLOVE_MAX_SENSORS + 1) *
+                                             sizeof(glove_golden_fused_t));
+    g->frames = (glove_golden_frame_t*)malloc(2 * (ss->nsamples / GLOVE_GOLDEN_EVERY + 1) *
+                                              sizeof(glove_golden_frame_t));
+    if (!g->fused || !g->frames) {
+        glove_golden_free(g);
+        return -1;
+    }
+    pipeline(ss, alpha, g, NULL);
+    return 0;
+}
+
+static int cmp_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static int cmp_float(const void* a, const void* b)
+{
+    float x = *(const float*)a, y = *(const float*)b;
+    return x < y ? -1 : x > y;
+}
+
+// where timed runs leave their outputs
+static volatile float time_sink;
+
+// fixed float work that no change to the pipeline touches: what the
+// machine is doing at the moment, to scale the pipeline's time by
+static float reference(float x)
+{
+    float y = 0;
+    for (int i = 0; i < GLOVE_GOLDEN_REF_OPS; i++) {
+        x = x * 0.9999f + 0.0001f;
+        y += sqrtf(x);
+    }
+    return y;
+}
+
+double glove_golden_time(const glove_session_t* ss, float alpha, int runs, double* ref_ns)
+{
+    double ns[64], ref[64];
+    float sink = 0;
+    if (runs > 64) runs = 64;
+    if (runs < 1 || ss->nsamples == 0) return 0;
+    pipeline(ss, alpha, NULL, &sink);       // warm up
+    for (int r = 0; r < runs; r++) {
+        long reps = 0;
+        int64_t t0 = glove_monotonic_ns(), t;
+        do {
+            pipeline(ss, alpha, NULL, &sink);
+            reps++;
+        } while ((t = glove_monotonic_ns()) - t0 < GLOVE_GOLDEN_RUN_NS);
+        ns[r] = (double)(t - t0) / ((double)reps * ss->nsamples);
+        // right after, so both see the same machine
+        t0 = glove_monotonic_ns();
+        sink += reference(sink);
+        ref[r] = (double)(glove_monotonic_ns() - t0) / GLOVE_GOLDEN_REF_OPS;
+    }
+    time_sink = sink;
+    // the fastest runs: other load only ever adds time
+    qsort(ns, runs, sizeof(double), cmp_double);
+    qsort(ref, runs, sizeof(double), cmp_double);
+    if (ref_ns) *ref_ns = ref[0];
+    return ns[0];
+}
+
+double glove_golden_slower(const glove_golden_t* golden, const glove_golden_t* now)
+{
+    if (golden->ns_per_sample <= 0 || now->ns_per_sample <= 0) return 0;
+    double r = now->ns_per_sample / golden->ns_per_sample;
+    if (golden->ref_ns > 0 && now->ref_ns > 0) r *= golden->ref_ns / now->ref_ns;
+    return r - 1;
+}
+
+void glove_golden_free(glove_golden_t* g)
+{
+    free(g->fused);
+    free(g->frames);
+    memset(g, 0, sizeof(*g));
+}
+
+//
+int glove_golden_save(const char* path, const glove_golden_t* g, const char* comment)
+{
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) return -1;
+    if (comment) fprintf(fp, "# %s\n", comment);
+    fprintf(fp, "#A:%.6f\n#N:%.1f\n#R:%.4f\n", g->alpha, g->ns_per_sample, g->ref_ns);
+    for (int i = 0; i < g->nfused; i++) {
+        const glove_golden_fused_t* f = &g->fused[i];
+        fprintf(fp, "F:%d:%llu:%.5f:%.5f:%.5f:%.5f\n", f->sensor, (unsigned long long)f->t_us,
+                f->q.w, f->q.x, f->q.y, f->q.z);
+    }
+    for (int i = 0; i < g->nframes; i++) {
+        const glove_golden_frame_t* f = &g->frames[i];
+        fprintf(fp, "K:%d:%llu", f->hand, (unsigned long long)f->t_us);
+        for (int b = 0; b < GLOVE_KIN_BONES; b++)
+            fprintf(fp, ":%.5f:%.5f:%.5f:%.5f", f->q[b].w, f->q[b].x, f->q[b].y, f->q[b].z);
+        fputc('\n', fp);
+    }
+    int failed = ferror(fp);
+    return fclose(fp) == 0 && !failed ? 0 : -1;
+}
+
+// "n:t_us" then count quaternions
+static int parse_row(const char* p, int* n, uint64_t* t_us, glove_quat_t* q, int count)
+{
+    char* end;
+    *n = (int)strtol(p, &end, 10);
+    if (end == p || *end != ':') return -1;
+    p = end + 1;
+    *t_us = strtoull(p, &end, 10);
+    if (end == p) return -1;
+    p = end;
+    for (int i = 0; i < count; i++) {
+        float v[4];
+        for (int k = 0; k < 4; k++) {
+            if (*p != ':') return -1;
+            v[k] = strtof(p + 1, &end);
+            if (end == p + 1) return -1;
+            p = end;
+        }
+        q[i] = glove_quat(v[0], v[1], v[2], v[3]);
+    }
+    return 0;
+}
+
+static int grow(void** p, int n, size_t size)
+{
+    // room for 1024 first, then doubling at each power of two past it
+    if (n != 0 && (n < 1024 || (n & (n - 1)) != 0)) return 0;
+    void* r = realloc(*p, (n ? n * 2 : 1024) * size);
+    if (r == NULL) return -1;
+    *p = r;
+    return 0;
+}
+
+int glove_golden_load(const char* path, glove_golden_t* g)
+{
+    static char line[1024];
+    int have_alpha = 0, n, rc = 0;
+    memset(g, 0, sizeof(*g));
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) return -1;
+    while (rc == 0 && fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "#A:", 3) == 0) {
+            g->alpha = strtof(line + 3, NULL);
+            have_alpha = 1;
+        } else if (strncmp(line, "#N:", 3) == 0) {
+            g->ns_per_sample = strtod(line + 3, NULL);
+        } else if (strncmp(line, "#R:", 3) == 0) {
+            g->ref_ns = strtod(line + 3, NULL);
+        } else if (strncmp(line, "F:", 2) == 0) {
+            if ((rc = grow((void**)&g->fused, g->nfused, sizeof(glove_golden_fused_t))) != 0) break;
+            glove_golden_fused_t* f = &g->fused[g->nfused];
+            rc = parse_row(line + 2, &n, &f->t_us, &f->q, 1);
+            f->sensor = (uint8_t)n;
+            g->nfused++;
+        } else if (strncmp(line, "K:", 2) == 0) {
+            if ((rc = grow((void**)&g->frames, g->nframes, sizeof(glove_golden_frame_t))) != 0) break;
+            glove_golden_frame_t* f = &g->frames[g->nframes];
+            rc = parse_row(line + 2, &n, &f->t_us, f->q, GLOVE_KIN_BONES);
+            f->hand = (uint8_t)n;
+            g->nframes++;
+        }
+    }
+    fclose(fp);
+    if (rc != 0 || !have_alpha || g->nfused == 0) {
+        glove_golden_free(g);
+        return -1;
+    }
+    return 0;
+}
+
+//
+// comparing
+//
+
+// the rotation about world z in a: what lines one heading up with another
+static glove_quat_t heading(glove_quat_t a)
+{
+    float n = sqrtf(a.w * a.w + a.z * a.z);
+    if (n < 1e-6f) return glove_quat_identity();
+    return glove_quat(a.w / n, 0, 0, a.z / n);
+}
+
+static void summarize(float* deg, int n, glove_golden_err_t* e)
+{
+    double sum = 0, max = 0;
+    e->n = n;
+    if (n == 0) {
+        e->mean = e->p95 = e->max = 0;
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        sum += deg[i];
+        if (deg[i] > max) max = deg[i];
+    }
+    qsort(deg, n, sizeof(float), cmp_float);
+    e->mean = sum / n;
+    e->p95 = deg[(int)(0.95 * (n - 1))];
+    e->max = max;
+}
+
+// fused orientations against the truth rows, each sensor's heading lined
+// up at its first sample that has truth
+static void fusion_vs_truth(const glove_session_t* ss, const glove_golden_t* g, float* deg, glove_golden_err_t* e)
+{
+    glove_quat_t off[GLOVE_MAX_SENSORS];
+    int have[GLOVE_MAX_SENSORS] = { 0 }, n = 0;
+    for (int i = 0; i < g->nfused; i++) {
+        const glove_golden_fused_t* f = &g->fused[i];
+        glove_quat_t t;
+        if (glove_session_truth_interp(ss, f->sensor, f->t_us, &t) != 0) continue;
+        if (!have[f->sensor]) {
+            off[f->sensor] = heading(glove_quat_mul(t, glove_quat_conj(f->q)));
+            have[f->sensor] = 1;
+        }
+        deg[n++] = glove_quat_angle(glove_quat_mul(off[f->sensor], f->q), t) * GLOVE_RAD2DEG;
+    }
+    summarize(deg, n, e);
+}
+
+// bones against the hands posed from the truth rows, each bone's heading
+// lined up at the first frame
+static void kin_vs_truth(const glove_session_t* ss, const glove_golden_t* g, float* deg, glove_golden_err_t* e)
+{
+    glove_quat_t off[2][GLOVE_KIN_BONES];
+    int have[2] = { 0, 0 }, n = 0;
+    int nsensors = session_sensors(ss);
+    glove_hand_pose_t pose;
+    for (int i = 0; i < g->nframes; i++) {
+        const glove_golden_frame_t* f = &g->frames[i];
+        int h = f->hand, m = nsensors - h * GLOVE_HAND_SENSORS, ok = 1;
+        if (m > GLOVE_HAND_SENSORS) m = GLOVE_HAND_SENSORS;
+        glove_quat_t t[GLOVE_HAND_SENSORS];
+        for (int k = 0; k < m && ok; k++)
+            ok = glove_session_truth_interp(ss, h * GLOVE_HAND_SENSORS + k, f->t_us, &t[k]) == 0;
+        if (!ok) continue;
+        glove_kin_hand(t, m, glove_vec3(h ? -0.12f : 0.12f, 0, 0), h, &pose);
+        for (int b = 0; b < GLOVE_KIN_BONES; b++) {
+            if (!have[h]) off[h][b] = heading(glove_quat_mul(pose.bones[b].q, glove_quat_conj(f->q[b])));
+            deg[n++] = glove_quat_angle(glove_quat_mul(off[h][b], f->q[b]), pose.bones[b].q) * GLOVE_RAD2DEG;
+        }
+        have[h] = 1;
+    }
+    summarize(deg, n, e);
+}
+
+int glove_golden_compare(const glove_session_t* ss, const glove_golden_t* golden,
+                         const glove_golden_t* now, glove_golden_cmp_t* c)
+{
+    memset(c, 0, sizeof(*c));
+    if (golden->nfused != now->nfused || golden->nframes != now->nframes) return -1;
+    int most = golden->nfused > golden->nframes * GLOVE_KIN_BONES ? golden->nfused : golden->nframes * GLOVE_KIN_BONES;
+    float* deg = (float*)malloc((most + 1) * sizeof(float));
+    if (!deg) return -1;
+
+    int n = 0, rc = 0;
+    for (int i = 0; i < now->nfused && rc == 0; i++) {
+        const glove_golden_fused_t *a = &golden->fused[i], *b = &now->fused[i];
+        if (a->t_us != b->t_us || a->sensor != b->sensor) rc = -1;
+        deg[n++] = glove_quat_angle(a->q, b->q) * GLOVE_RAD2DEG;
+    }
+    summarize(deg, n, &c->drift[GLOVE_GOLDEN_FUSION]);
+    n = 0;
+    for (int i = 0; i < now->nframes && rc == 0; i++) {
+        const glove_golden_frame_t *a = &golden->frames[i], *b = &now->frames[i];
+        if (a->t_us != b->t_us || a->hand != b->hand) rc = -1;
+        for (int k = 0; k < GLOVE_KIN_BONES; k++) deg[n++] = glove_quat_angle(a->q[k], b->q[k]) * GLOVE_RAD2DEG;
+    }
+    summarize(deg, n, &c->drift[GLOVE_GOLDEN_KIN]);
+
+    if (rc == 0 && ss->ntruth > 0) {
+        fusion_vs_truth(ss, golden, deg, &c->truth_then[GLOVE_GOLDEN_FUSION]);
+        fusion_vs_truth(ss, now, deg, &c->truth_now[GLOVE_GOLDEN_FUSION]);
+        kin_vs_truth(ss, golden, deg, &c->truth_then[GLOVE_GOLDEN_KIN]);
+        kin_vs_truth(ss, now, deg, &c->truth_now[GLOVE_GOLDEN_KIN]);
+    }
+    free(deg);
+    return rc;
+}
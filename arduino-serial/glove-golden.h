@@ -0,0 +1,105 @@
+//
+// glove-golden -- regression check of fusion and kinematics against a
+// golden trace
+//
+// A golden trace is what fusion and kinematics made of a session when
+// someone last vouched for them: the fused orientation of every
+// GLOVE_GOLDEN_EVERY-th sample, the bone orientations of every
+// GLOVE_GOLDEN_EVERY-th frame, the fusion alpha, and the ns per sample it
+// all took.  A frame is drawn after each read of the last sensor, as
+// glove-tool skin and trace draw them.
+//
+// Checking runs the session again and gives, per stage, in degrees:
+//
+//   drift      angle between the orientations now and the golden ones
+//   vs truth   angle to the truth rows, now and then, if the session has
+//              them.  Fused yaw is the gyro's only and starts wherever
+//              the first tilt put it, so each sensor's (and bone's)
+//              heading is lined up with the truth once, at its first
+//              sample; what remains is tilt error and yaw drift.
+//
+// A change to the filter (alpha, the accel gate, the integration) moves
+// drift.  Whether that is better or worse is the vs-truth delta.
+//
+// Speed is the fastest of GLOVE_GOLDEN_RUNS runs, each followed by a
+// fixed float loop that nothing in the pipeline changes.  A busy or
+// throttled machine slows both, so comparing their ratio holds still
+// where raw ns per sample moves by a quarter from one minute to the next.
+//
+// Golden files are text, "#A:alpha", "#N:ns_per_sample", "#R:ref_ns" then
+//
+//   F:sensor:t_us:qw:qx:qy:qz
+//   K:hand:t_us:qw:qx:qy:qz ... (GLOVE_KIN_BONES quaternions)
+//
+
+
+#ifndef __GLOVE_GOLDEN_H__
+#define __GLOVE_GOLDEN_H__
+
+#include "glove-sample.h"
+#include "glove-kinematics.h"
+
+#define GLOVE_GOLDEN_EVERY      4       // keep every 4th fused sample and frame
+#define GLOVE_GOLDEN_RUNS       15      // timed runs, the fastest is kept
+#define GLOVE_GOLDEN_RUN_NS     20000000 // a timed run repeats the session for at least this
+#define GLOVE_GOLDEN_REF_OPS    1000000 // steps of the reference loop after each run
+
+// stages
+#define GLOVE_GOLDEN_FUSION     0
+#define GLOVE_GOLDEN_KIN        1
+#define GLOVE_GOLDEN_STAGES     2
+
+typedef struct {
+    uint64_t     t_us;
+    uint8_t      sensor;
+    glove_quat_t q;
+} glove_golden_fused_t;
+
+typedef struct {
+    uint64_t     t_us;
+    uint8_t      hand;
+    glove_quat_t q[GLOVE_KIN_BONES];
+} glove_golden_frame_t;
+
+typedef struct {
+    float                 alpha;
+    double                ns_per_sample;
+    double                ref_ns;       // a reference loop step, timed alongside
+    int                   nfused;
+    glove_golden_fused_t* fused;
+    int                   nframes;
+    glove_golden_frame_t* frames;
+} glove_golden_t;
+
+typedef struct {
+    int    n;                           // 0: nothing to compare
+    double mean, p95, max;              // degrees
+} glove_golden_err_t;
+
+typedef struct {
+    glove_golden_err_t drift[GLOVE_GOLDEN_STAGES];
+    glove_golden_err_t truth_then[GLOVE_GOLDEN_STAGES];
+    glove_golden_err_t truth_now[GLOVE_GOLDEN_STAGES];
+} glove_golden_cmp_t;
+
+// fusion and kinematics over ss, keeping every GLOVE_GOLDEN_EVERY-th
+// output; ns_per_sample is left 0.  0, or -1 out of memory
+int    glove_golden_run(const glove_session_t* ss, float alpha, glove_golden_t* g);
+// ns per sample of the same pipeline, the fastest of runs, and of a
+// reference loop step in ref_ns; nothing kept
+double glove_golden_time(const glove_session_t* ss, float alpha, int runs, double* ref_ns);
+// now's ns per sample against golden's, both scaled by their reference
+// loop if they have one: 0.1 is 10% slower
+double glove_golden_slower(const glove_golden_t* golden, const glove_golden_t* now);
+void   glove_golden_free(glove_golden_t* g);
+
+int    glove_golden_save(const char* path, const glove_golden_t* g, const char* comment);
+// 0, or -1 if it can't be read or isn't a golden file
+int    glove_golden_load(const char* path, glove_golden_t* g);
+
+// now against golden, both run over ss; -1 if they don't line up (the
+// session isn't the one the golden trace was made from)
+int    glove_golden_compare(const glove_session_t* ss, const glove_golden_t* golden,
+                            const glove_golden_t* now, glove_golden_cmp_t* c);
+
+#endif
@@ -0,0 +1,126 @@
+//
+// glove-interp -- smooth hand motion at any display rate
+//
+
+#include "glove-interp.h"
+
+#include <string.h>
+
+void glove_interp_init(glove_interp_t* ip, float delay_ms)
+{
+    memset(ip, 0, sizeof(*ip));
+    glove_interp_set_delay(ip, delay_ms);
+}
+
+void glove_interp_set_delay(glove_interp_t* ip, float delay_ms)
+{
+    ip->delay_ns = (int64_t)(delay_ms * 1e6f);
+    ip->renders = ip->late = 0;
+}
+
+// a frame older than the last one pushed: a new stream (the glove was
+// reopened), new clock, new offset
+static void restart(glove_interp_t* ip, uint32_t seq)
+{
+    if (seq >= ip->seq) return;
+    int64_t delay = ip->delay_ns;
+    glove_interp_init(ip, 0);
+    ip->delay_ns = delay;
+}
+
+// the least delayed sample so far, let creep up in case the glove's clock
+// runs slow
+static void observe(glove_interp_t* ip, uint64_t t_us, int64_t recv_ns)
+{
+    int64_t off = recv_ns - (int64_t)t_us * 1000;
+    if (ip->offset_at_ns == 0) {
+        ip->offset_ns = off;
+    } else {
+        int64_t crept = ip->offset_ns + (int64_t)((recv_ns - ip->offset_at_ns) * GLOVE_INTERP_SLEW);
+        ip->offset_ns = off < crept ? off : crept;
+    }
+    ip->offset_at_ns = recv_ns;
+}
+
+static void add(glove_interp_t* ip, int k, uint64_t t, glove_quat_t q)
+{
+    if (t == 0) return;
+    if (ip->n[k] && t <= ip->t[k][ip->head[k]]) {
+        if (t == ip->t[k][ip->head[k]]) return;     // nothing new for this one
+        ip->n[k] = 0;                               // clock went backwards: restart
+    }
+    int i = ip->n[k] ? (ip->head[k] + 1) % GLOVE_INTERP_DEPTH : 0;
+    ip->t[k][i] = t;
+    ip->q[k][i] = q;
+    ip->head[k] = i;
+    if (ip->n[k] < GLOVE_INTERP_DEPTH) ip->n[k]++;
+    if (k >= ip->nsensors) ip->nsensors = k + 1;
+}
+
+void glove_interp_push(glove_interp_t* ip, const glove_frame_t* f)
+{
+    if (f->seq == 0 || f->seq == ip->seq) return;
+    restart(ip, f->seq);
+    ip->seq = f->seq;
+    observe(ip, f->t_us, f->recv_ns);
+    if (f->nsensors > ip->nsensors) ip->nsensors = f->nsensors;
+    for (int k = 0; k < f->nsensors; k++) add(ip, k, f->t_sensor_us[k], f->q[k]);
+}
+
+void glove_interp_take(glove_interp_t* ip, glove_handoff_t* h, const glove_frame_t* f)
+{
+    if (f->seq == 0 || f->seq == ip->seq) return;
+    restart(ip, f->seq);
+    glove_handoff_sample_t got[64];
+    int n;
+    do {
+        n = glove_handoff_samples(h, ip->seq, f->seq, got, 64);
+        for (int i = 0; i < n; i++) {
+            if (got[i].sensor >= GLOVE_MAX_SENSORS) continue;
+            observe(ip, got[i].t_us, got[i].recv_ns);
+            add(ip, got[i].sensor, got[i].t_us, got[i].q);
+            ip->seq = got[i].seq;
+        }
+    } while (n == 64 && ip->seq != f->seq);
+    glove_interp_push(ip, f);
+}
+
+int glove_interp_at(glove_interp_t* ip, int64_t render_ns, glove_quat_t* q)
+{
+    // the time to show, on the glove's clock in ns
+    int64_t want = render_ns - ip->delay_ns - ip->offset_ns;
+    int moving = 0, late = 0;
+
+    for (int k = 0; k < ip->nsensors; k++) {
+        int n = ip->n[k], i = ip->head[k];
+        if (n == 0) {
+            q[k] = glove_quat_identity();
+            continue;
+        }
+        int64_t past = want - (int64_t)ip->t[k][i] * 1000;
+        if (past >= 0) {
+            q[k] = ip->q[k][i];
+            if (past < GLOVE_INTERP_STALE_NS) late = 1;
+            continue;
+        }
+        // walk back to the sample at or before want
+        int j = i, m = 1;
+        while (m < n) {
+            int p = (j + GLOVE_INTERP_DEPTH - 1) % GLOVE_INTERP_DEPTH;
+            i = j;
+            j = p;
+            m++;
+            if ((int64_t)ip->t[k][j] * 1000 <= want) break;
+        }
+        int64_t t0 = (int64_t)ip->t[k][j] * 1000, t1 = (int64_t)ip->t[k][i] * 1000;
+        if (want <= t0 || i == j) {
+            q[k] = ip->q[k][j];                         // older than we keep
+        } else {
+            q[k] = glove_quat_slerp(ip->q[k][j], ip->q[k][i], (float)(want - t0) / (float)(t1 - t0));
+        }
+        moving = 1;
+    }
+    ip->renders++;
+    if (late) ip->late++;
+    return moving;
+}
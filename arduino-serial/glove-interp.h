@@ -0,0 +1,70 @@
+//
+// glove-interp -- smooth hand motion at any display rate
+//
+// Samples reach the host at 10..100 Hz and not evenly (VR_Gloves2 sends
+// every 500 ms), while the display refreshes at 60..144 Hz.  Drawing the
+// newest orientation makes the hand stand still for a few frames, then
+// jump.  glove-interp keeps the last few orientations of every sensor with
+// their capture times and slerps each one to the render time minus a
+// fixed delay:
+//
+//   drawn(t) = slerp of the two samples either side of t - delay
+//
+// The delay has to cover one sample interval plus transport jitter; a
+// render that runs past a sensor's newest sample holds it and is counted
+// as late, which says the delay is too short.  The delay shows up 1:1 in
+// the latency the viewer reports.
+//
+// The render thread sees one frame per paint, but a frame only holds each
+// sensor's newest sample: glove_interp_take() also goes through the
+// handoff's ring for the samples of the frames in between, so the slerp
+// runs between the samples as the glove took them.
+//
+// Capture times are on the glove's clock.  They are mapped onto
+// glove_monotonic_ns() by the smallest receive-minus-capture offset seen,
+// so USB delivering several lines in one read doesn't bunch them up.
+//
+
+
+#ifndef __GLOVE_INTERP_H__
+#define __GLOVE_INTERP_H__
+
+#include "glove-stream.h"
+
+#define GLOVE_INTERP_DEPTH      32          // samples kept per sensor, 320 ms at 100 Hz
+#define GLOVE_INTERP_DELAY_MS   30.0f       // one 100 Hz interval plus USB jitter
+#define GLOVE_INTERP_SLEW       0.01f       // offset creep, covers the resonator's drift
+#define GLOVE_INTERP_STALE_NS   1000000000  // past the newest by this much the glove
+                                            // has stopped, not the delay too short
+
+typedef struct {
+    int64_t      delay_ns;
+    int          nsensors;
+    int          n[GLOVE_MAX_SENSORS];      // samples held, up to DEPTH
+    int          head[GLOVE_MAX_SENSORS];   // index of the newest
+    uint64_t     t[GLOVE_MAX_SENSORS][GLOVE_INTERP_DEPTH];  // capture time, us
+    glove_quat_t q[GLOVE_MAX_SENSORS][GLOVE_INTERP_DEPTH];
+    int64_t      offset_ns;                 // monotonic = t_us * 1000 + offset
+    int64_t      offset_at_ns;              // when it was last lowered or crept
+    uint32_t     seq;                       // last frame pushed
+
+    // what the delay buys
+    unsigned     renders;
+    unsigned     late;                      // renders where a sensor ran out
+} glove_interp_t;
+
+void glove_interp_init(glove_interp_t* ip, float delay_ms);
+void glove_interp_set_delay(glove_interp_t* ip, float delay_ms);
+// take the new samples in a frame from glove_handoff_latest(); frames
+// already pushed are ignored, a lower seq starts over
+void glove_interp_push(glove_interp_t* ip, const glove_frame_t* f);
+// the same, with every sample h has noted since the last frame pushed
+void glove_interp_take(glove_interp_t* ip, glove_handoff_t* h, const glove_frame_t* f);
+
+// every sensor's orientation at render_ns (glove_monotonic_ns()) minus the
+// delay into q[0..nsensors); sensors never seen are identity.  Returns 1
+// while some sensor is still between samples (keep rendering), 0 once all
+// hold their newest.
+int  glove_interp_at(glove_interp_t* ip, int64_t render_ns, glove_quat_t* q);
+
+#endif
@@ -0,0 +1,101 @@
+//
+// glove-kinematics -- hand skeleton from the six sensor orientations
+//
+
+#include "glove-kinematics.h"
+#include "glove-yaw.h"
+
+#define PIP_COUPLING    0.8f
+#define DIP_COUPLING    0.55f
+
+// an adult right hand, palm frame, metres
+static const float palm_size[3] = { 0.040f, 0.090f, 0.012f };
+static const float finger_base[GLOVE_KIN_FINGERS][3] = {
+    { -0.030f, 0.020f, 0.005f },        // thumb, low on the palm
+    { -0.028f, 0.090f, 0 },
+    { -0.009f, 0.094f, 0 },
+    {  0.010f, 0.090f, 0 },
+    {  0.028f, 0.080f, 0 },
+};
+static const float finger_len[GLOVE_KIN_FINGERS][3] = {
+    { 0.046f, 0.032f, 0.027f },
+    { 0.040f, 0.024f, 0.019f },
+    { 0.045f, 0.028f, 0.021f },
+    { 0.042f, 0.026f, 0.020f },
+    { 0.033f, 0.019f, 0.018f },
+};
+static const float finger_radius[GLOVE_KIN_FINGERS] = {
+    0.010f, 0.0085f, 0.0085f, 0.008f, 0.007f
+};
+
+static void bone(glove_bone_t* b, glove_vec3_t p, glove_quat_t q, float rx, float len, float rz)
+{
+    b->p = p;
+    b->q = q;
+    b->size = glove_vec3(rx, len, rz);
+}
+
+static glove_vec3_t bone_end(const glove_bone_t* b)
+{
+    return glove_vec3_add(b->p, glove_quat_rotate(b->q, glove_vec3(0, b->size.y, 0)));
+}
+
+void glove_kin_hand(const glove_quat_t* q, int nsensors, glove_vec3_t wrist,
+                    int left, glove_hand_pose_t* out)
+{
+    float mirror = left ? -1.0f : 1.0f;
+    glove_quat_t palm = q[0];
+    bone(&out->bones[0], wrist, palm, palm_size[0], palm_size[1], palm_size[2]);
+    out->joints[0] = wrist;
+    out->joint_radius[0] = 0.014f;
+
+    for (int f = 0; f < GLOVE_KIN_FINGERS; f++) {
+        glove_vec3_t base = glove_vec3(finger_base[f][0] * mirror, finger_base[f][1], finger_base[f][2]);
+        glove_vec3_t p = glove_vec3_add(wrist, glove_quat_rotate(palm, base));
+        glove_quat_t qp = f + 1 < nsensors ? q[f + 1] : palm;
+
+        // split off the splay, what's left is the flex the other joints follow
+        float splay, flex;
+        glove_yaw_split(palm, qp, &splay, &flex);
+        glove_quat_t twist = glove_quat_axis_angle(glove_vec3(0, 0, 1), splay);
+        glove_quat_t swing = glove_quat_mul(glove_quat_conj(twist),
+                                            glove_quat_mul(glove_quat_conj(palm), qp));
+        glove_quat_t qm = glove_quat_mul(qp, glove_quat_slerp(glove_quat_identity(), swing, PIP_COUPLING));
+        glove_quat_t qd = glove_quat_mul(qm, glove_quat_slerp(glove_quat_identity(), swing, DIP_COUPLING));
+        glove_quat_t bq[3] = { qp, qm, qd };
+
+        float r = finger_radius[f];
+        for (int j = 0; j < 3; j++) {
+            glove_bone_t* b = &out->bones[1 + f * 3 + j];
+            bone(b, p, bq[j], r, finger_len[f][j], r);
+            out->joints[1 + f * 4 + j] = p;
+            out->joint_radius[1 + f * 4 + j] = r * 1.15f;
+            p = bone_end(b);
+            r *= 0.9f;
+        }
+        out->joints[1 + f * 4 + 3] = p;
+        out->joint_radius[1 + f * 4 + 3] = r;
+    }
+}
+
+// column-major, like glLoadMatrixf/glUniformMatrix4fv
+static void compose(glove_vec3_t p, glove_quat_t q, glove_vec3_t s, float m[16])
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    m[0] = (1 - 2 * (yy + zz)) * s.x; m[4] = 2 * (xy - wz) * s.y;       m[8]  = 2 * (xz + wy) * s.z;       m[12] = p.x;
+    m[1] = 2 * (xy + wz) * s.x;       m[5] = (1 - 2 * (xx + zz)) * s.y; m[9]  = 2 * (yz - wx) * s.z;       m[13] = p.y;
+    m[2] = 2 * (xz - wy) * s.x;       m[6] = 2 * (yz + wx) * s.y;       m[10] = (1 - 2 * (xx + yy)) * s.z; m[14] = p.z;
+    m[3] = 0;                         m[7] = 0;                         m[11] = 0;                         m[15] = 1;
+}
+
+void glove_kin_bone_matrix(const glove_bone_t* b, float m[16])
+{
+    compose(b->p, b->q, b->size, m);
+}
+
+void glove_kin_joint_matrix(glove_vec3_t p, float radius, float m[16])
+{
+    compose(p, glove_quat_identity(), glove_vec3(radius, radius, radius), m);
+}
@@ -0,0 +1,47 @@
+//
+// glove-kinematics -- hand skeleton from the six sensor orientations
+//
+// One IMU on the back of the hand and one on each finger's proximal
+// phalanx give the palm and five proximal bones directly.  The middle and
+// distal phalanges have no sensor; they follow the proximal flex with the
+// usual tendon coupling (PIP about 0.8, DIP about 0.55 of it).  Bones
+// point along +y of their frame, the palm normal is +z: the same frame
+// glove-synth builds finger poses in.
+//
+// The viewers draw a bone as a unit cylinder (radius 1, y from 0 to 1)
+// scaled by size and a joint as a unit sphere; glove_kin_*_matrix() give
+// the column-major model matrices for that.
+//
+
+
+#ifndef __GLOVE_KINEMATICS_H__
+#define __GLOVE_KINEMATICS_H__
+
+#include "glove-sample.h"
+
+#define GLOVE_KIN_FINGERS   5
+#define GLOVE_KIN_BONES     16      // palm + 5 fingers x 3 phalanges
+#define GLOVE_KIN_JOINTS    21      // wrist + 5 fingers x (base, PIP, DIP, tip)
+
+typedef struct {
+    glove_vec3_t p;         // start of the bone, world, metres
+    glove_quat_t q;         // bone frame -> world
+    glove_vec3_t size;      // x radius, length, z radius
+} glove_bone_t;
+
+typedef struct {
+    glove_bone_t bones[GLOVE_KIN_BONES];        // palm first, then finger by finger
+    glove_vec3_t joints[GLOVE_KIN_JOINTS];
+    float        joint_radius[GLOVE_KIN_JOINTS];
+} glove_hand_pose_t;
+
+// q[0] is the palm, q[1..5] Thumb..Little (as fused, aligned, yaw fixed);
+// fingers beyond nsensors stay straight with the palm.  left mirrors the
+// finger layout.
+void glove_kin_hand(const glove_quat_t* q, int nsensors, glove_vec3_t wrist,
+                    int left, glove_hand_pose_t* out);
+
+void glove_kin_bone_matrix(const glove_bone_t* b, float m[16]);
+void glove_kin_joint_matrix(glove_vec3_t p, float radius, float m[16]);
+
+#endif
@@ -0,0 +1,82 @@
+//
+// glove-lod -- hold a frame-time budget by turning detail knobs
+//
+
+#include "glove-lod.h"
+
+#include <string.h>
+
+void glove_lod_init(glove_lod_t* l, float target_ms)
+{
+    memset(l, 0, sizeof(*l));
+    l->target_ms = target_ms;
+    l->hold = GLOVE_LOD_RESTORE_HOLD;
+    l->since_restore = -1;
+}
+
+int glove_lod_add(glove_lod_t* l, const char* name, int max)
+{
+    if (l->nknobs >= GLOVE_LOD_MAX_KNOBS) return -1;
+    glove_lod_knob_t* k = &l->knob[l->nknobs];
+    k->name = name;
+    k->level = 0;
+    k->max = max;
+    return l->nknobs++;
+}
+
+int glove_lod_level(const glove_lod_t* l, int knob)
+{
+    return l->knob[knob].level;
+}
+
+static int turn(glove_lod_t* l, int knob, int step, glove_lod_change_t* ch)
+{
+    glove_lod_knob_t* k = &l->knob[knob];
+    ch->knob = knob;
+    ch->from = k->level;
+    ch->to = k->level + step;
+    k->level = ch->to;
+    l->since_change = 0;
+    l->under = 0;
+    return 1;
+}
+
+int glove_lod_frame(glove_lod_t* l, float frame_ms, glove_lod_change_t* ch)
+{
+    glove_lod_change_t dummy;
+    if (!ch) ch = &dummy;
+    ch->knob = -1;
+    ch->from = ch->to = 0;
+
+    l->smoothed_ms = l->frames++ ? l->smoothed_ms + (frame_ms - l->smoothed_ms) * GLOVE_LOD_ALPHA
+                                 : frame_ms;
+    l->since_change++;
+    if (l->since_restore >= 0) l->since_restore++;
+    if (l->since_change < GLOVE_LOD_SETTLE) return 0;
+
+    if (l->smoothed_ms > l->target_ms * GLOVE_LOD_OVER) {
+        // a restore we just made didn't fit: wait twice as long next time
+        if (l->since_restore >= 0 && l->since_restore < 2 * GLOVE_LOD_SETTLE && l->hold < 64 * GLOVE_LOD_RESTORE_HOLD)
+            l->hold *= 2;
+        l->since_restore = -1;
+        for (int i = 0; i < l->nknobs; i++)
+            if (l->knob[i].level < l->knob[i].max) {
+                // remember the order so restoring undoes the latest first
+                int j;
+                for (j = 0; j < l->ncheapened && l->order[j] != i; j++) ;
+                if (j == l->ncheapened) l->order[l->ncheapened++] = i;
+                return turn(l, i, 1, ch);
+            }
+        return 0;                       // nothing left to give
+    }
+
+    if (l->smoothed_ms < l->target_ms * GLOVE_LOD_HEADROOM) {
+        if (++l->under < l->hold || l->ncheapened == 0) return 0;
+        int i = l->order[l->ncheapened - 1];
+        if (l->knob[i].level == 1) l->ncheapened--;
+        l->since_restore = 0;
+        return turn(l, i, -1, ch);
+    }
+    l->under = 0;
+    return 0;
+}
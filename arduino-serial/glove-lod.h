@@ -0,0 +1,63 @@
+//
+// glove-lod -- hold a frame-time budget by turning detail knobs
+//
+// The viewer registers its knobs in the order it is willing to give them
+// up, the one it cares least about first.  Each knob has levels 0 (full
+// detail) to max (cheapest).  Every frame it reports how long the frame
+// took; the controller smooths that and, once the last change has had
+// time to show:
+//
+//   over budget       the first knob not yet at max goes one level cheaper
+//   well under it     the most recently cheapened knob goes one level back
+//
+// Restoring waits longer than shedding, and each time a restore pushes the
+// frame back over budget the wait doubles, so a viewer that sits right at
+// the edge settles instead of flapping.  glove_lod_frame() says what it
+// turned so the viewer can apply it and log it.
+//
+
+
+#ifndef __GLOVE_LOD_H__
+#define __GLOVE_LOD_H__
+
+#define GLOVE_LOD_MAX_KNOBS     8
+#define GLOVE_LOD_ALPHA         0.1f    // frame time smoothing per frame
+#define GLOVE_LOD_OVER          1.05f   // shed above target * this
+#define GLOVE_LOD_HEADROOM      0.6f    // restore below target * this
+#define GLOVE_LOD_SETTLE        30      // frames after a change before the next
+#define GLOVE_LOD_RESTORE_HOLD  120     // frames under budget before restoring
+
+typedef struct {
+    const char* name;
+    int         level;                  // 0 full detail .. max cheapest
+    int         max;
+} glove_lod_knob_t;
+
+typedef struct {
+    float target_ms;
+    float smoothed_ms;
+    int   nknobs;
+    glove_lod_knob_t knob[GLOVE_LOD_MAX_KNOBS];
+    int   order[GLOVE_LOD_MAX_KNOBS];   // knobs in the order they were cheapened
+    int   ncheapened;
+    int   since_change;                 // frames
+    int   since_restore;
+    int   under;                        // consecutive frames under the headroom
+    int   hold;                         // frames under budget needed to restore
+    int   frames;
+} glove_lod_t;
+
+// what one glove_lod_frame() did
+typedef struct {
+    int knob;                           // index, -1 if nothing changed
+    int from, to;                       // levels
+} glove_lod_change_t;
+
+void glove_lod_init(glove_lod_t* l, float target_ms);
+// returns the knob's index, or -1 when full; knobs start at level 0
+int  glove_lod_add(glove_lod_t* l, const char* name, int max);
+// one frame took frame_ms; returns 1 and fills ch when a knob moved
+int  glove_lod_frame(glove_lod_t* l, float frame_ms, glove_lod_change_t* ch);
+int  glove_lod_level(const glove_lod_t* l, int knob);
+
+#endif
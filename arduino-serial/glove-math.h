@@ -0,0 +1,172 @@
+//
+// glove-math -- small vector/quaternion helpers for the host glove pipeline
+//
+// Quaternions are (w,x,y,z), unit length, and rotate body -> world.
+// World frame is Z up, which is where a resting GY521 reports +1g.
+//
+
+
+#ifndef __GLOVE_MATH_H__
+#define __GLOVE_MATH_H__
+
+#include <math.h>
+
+#define GLOVE_PI         3.14159265358979f
+#define GLOVE_DEG2RAD    (GLOVE_PI / 180.0f)
+#define GLOVE_RAD2DEG    (180.0f / GLOVE_PI)
+#define GLOVE_GRAVITY    9.80665f       // m/s^2 per g
+
+typedef struct { float x, y, z; } glove_vec3_t;
+typedef struct { float w, x, y, z; } glove_quat_t;
+
+static inline glove_vec3_t glove_vec3(float x, float y, float z)
+{
+    glove_vec3_t v = { x, y, z };
+    return v;
+}
+
+static inline glove_vec3_t glove_vec3_add(glove_vec3_t a, glove_vec3_t b)
+{
+    return glove_vec3(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+static inline glove_vec3_t glove_vec3_sub(glove_vec3_t a, glove_vec3_t b)
+{
+    return glove_vec3(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+static inline glove_vec3_t glove_vec3_scale(glove_vec3_t a, float s)
+{
+    return glove_vec3(a.x * s, a.y * s, a.z * s);
+}
+
+static inline float glove_vec3_dot(glove_vec3_t a, glove_vec3_t b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline glove_vec3_t glove_vec3_cross(glove_vec3_t a, glove_vec3_t b)
+{
+    return glove_vec3(a.y * b.z - a.z * b.y,
+                      a.z * b.x - a.x * b.z,
+                      a.x * b.y - a.y * b.x);
+}
+
+static inline float glove_vec3_len(glove_vec3_t a)
+{
+    return sqrtf(glove_vec3_dot(a, a));
+}
+
+static inline glove_quat_t glove_quat(float w, float x, float y, float z)
+{
+    glove_quat_t q = { w, x, y, z };
+    return q;
+}
+
+static inline glove_quat_t glove_quat_identity(void)
+{
+    return glove_quat(1, 0, 0, 0);
+}
+
+static inline glove_quat_t glove_quat_conj(glove_quat_t q)
+{
+    return glove_quat(q.w, -q.x, -q.y, -q.z);
+}
+
+static inline glove_quat_t glove_quat_mul(glove_quat_t a, glove_quat_t b)
+{
+    return glove_quat(a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+                      a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                      a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                      a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w);
+}
+
+static inline float glove_quat_dot(glove_quat_t a, glove_quat_t b)
+{
+    return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline glove_quat_t glove_quat_normalize(glove_quat_t q)
+{
+    float n = sqrtf(glove_quat_dot(q, q));
+    if (n <= 0) return glove_quat_identity();
+    n = 1.0f / n;
+    return glove_quat(q.w * n, q.x * n, q.y * n, q.z * n);
+}
+
+// rotation of 'angle' radians about a (not necessarily unit) axis
+static inline glove_quat_t glove_quat_axis_angle(glove_vec3_t axis, float angle)
+{
+    float n = glove_vec3_len(axis);
+    if (n <= 1e-9f) return glove_quat_identity();
+    float s = sinf(angle * 0.5f) / n;
+    return glove_quat(cosf(angle * 0.5f), axis.x * s, axis.y * s, axis.z * s);
+}
+
+// exp map: rotation vector (radians) -> quaternion
+static inline glove_quat_t glove_quat_from_rotvec(glove_vec3_t r)
+{
+    return glove_quat_axis_angle(r, glove_vec3_len(r));
+}
+
+// log map: quaternion -> rotation vector (radians), shortest arc
+static inline glove_vec3_t glove_quat_to_rotvec(glove_quat_t q)
+{
+    if (q.w < 0) q = glove_quat(-q.w, -q.x, -q.y, -q.z);
+    float s = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z);
+    if (s <= 1e-9f) return glove_vec3(2 * q.x, 2 * q.y, 2 * q.z);
+    float a = 2.0f * atan2f(s, q.w);
+    return glove_vec3(q.x * a / s, q.y * a / s, q.z * a / s);
+}
+
+static inline glove_vec3_t glove_quat_rotate(glove_quat_t q, glove_vec3_t v)
+{
+    // v' = v + 2w(u x v) + 2u x (u x v)
+    glove_vec3_t u = glove_vec3(q.x, q.y, q.z);
+    glove_vec3_t t = glove_vec3_scale(glove_vec3_cross(u, v), 2.0f);
+    return glove_vec3_add(glove_vec3_add(v, glove_vec3_scale(t, q.w)),
+                          glove_vec3_cross(u, t));
+}
+
+// angle in radians between two orientations; atan2 of the relative
+// rotation rather than acos of the dot, which has no resolution below
+// a few hundredths of a degree in float
+static inline float glove_quat_angle(glove_quat_t a, glove_quat_t b)
+{
+    glove_quat_t r = glove_quat_mul(glove_quat_conj(a), b);
+    float v = sqrtf(r.x * r.x + r.y * r.y + r.z * r.z);
+    return 2.0f * atan2f(v, fabsf(r.w));
+}
+
+// shortest rotation taking unit vector u onto unit vector v
+static inline glove_quat_t glove_quat_between(glove_vec3_t u, glove_vec3_t v)
+{
+    glove_vec3_t c = glove_vec3_cross(u, v);
+    float d = glove_vec3_dot(u, v);
+    glove_quat_t q = glove_quat(1.0f + d, c.x, c.y, c.z);
+    if (q.w < 1e-6f) {   // opposite vectors, pick any perpendicular axis
+        c = fabsf(u.x) > 0.9f ? glove_vec3(0, 1, 0) : glove_vec3(1, 0, 0);
+        return glove_quat_axis_angle(glove_vec3_cross(u, c), GLOVE_PI);
+    }
+    return glove_quat_normalize(q);
+}
+
+static inline glove_quat_t glove_quat_slerp(glove_quat_t a, glove_quat_t b, float t)
+{
+    float d = glove_quat_dot(a, b);
+    if (d < 0) { b = glove_quat(-b.w, -b.x, -b.y, -b.z); d = -d; }
+    if (d > 0.9995f) {   // nearly parallel, nlerp is exact enough
+        return glove_quat_normalize(glove_quat(a.w + (b.w - a.w) * t,
+                                               a.x + (b.x - a.x) * t,
+                                               a.y + (b.y - a.y) * t,
+                                               a.z + (b.z - a.z) * t));
+    }
+    float th = acosf(d);
+    float s  = 1.0f / sinf(th);
+    float sa = sinf((1 - t) * th) * s;
+    float sb = sinf(t * th) * s;
+    return glove_quat(a.w * sa + b.w * sb, a.x * sa + b.x * sb,
+                      a.y * sa + b.y * sb, a.z * sa + b.z * sb);
+}
+
+#endif
@@ -0,0 +1,237 @@
+//
+// glove-metrics -- pipeline counters and histograms, served as Prometheus text
+//
+
+#include "glove-metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+
+#define GLOVE_METRICS_TEXT_MAX  8192
+
+// a scraper that hangs up early must not SIGPIPE the process it scrapes;
+// macOS has no MSG_NOSIGNAL, SO_NOSIGPIPE on the socket does it there
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL            0
+#endif
+
+// 1 ms .. 1 s: link and render delays
+static const int64_t age_bounds[] = {
+    1000000, 2000000, 5000000, 10000000, 20000000, 50000000,
+    100000000, 200000000, 500000000, 1000000000
+};
+// 50 ns .. 100 us: one sample through fusion and yaw
+static const int64_t fusion_bounds[] = {
+    50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000
+};
+
+static void define(glove_metrics_t* m, int id, const char* name, const char* help, int kind,
+                   const int64_t* bounds = NULL, int nbounds = 0)
+{
+    glove_metric_t* mt = &m->metric[id];
+    mt->name = name;
+    mt->help = help;
+    mt->kind = kind;
+    mt->bounds = bounds;
+    mt->nbounds = nbounds;
+    mt->value.store(0);
+    for (int b = 0; b <= GLOVE_METRICS_BUCKETS; b++) mt->bucket[b].store(0);
+    mt->sum_ns.store(0);
+}
+
+void glove_metrics_init(glove_metrics_t* m)
+{
+    define(m, GLOVE_METRIC_SAMPLES, "glove_samples_total",
+           "Samples read, parsed and fused.", GLOVE_METRIC_COUNTER);
+    define(m, GLOVE_METRIC_LINE_ERRORS, "glove_line_errors_total",
+           "Lines that did not parse, too long or garbled on the link.", GLOVE_METRIC_COUNTER);
+    define(m, GLOVE_METRIC_RECONNECTS, "glove_reconnects_total",
+           "Times the glove's port was opened again.", GLOVE_METRIC_COUNTER);
+    define(m, GLOVE_METRIC_QUEUE, "glove_queue_bytes",
+           "Bytes left in the serial driver after the reader's last read.", GLOVE_METRIC_GAUGE);
+    define(m, GLOVE_METRIC_FUSION, "glove_fusion_seconds",
+           "Fusion and yaw time of one sample, one sample in 16.", GLOVE_METRIC_HISTOGRAM,
+           fusion_bounds, sizeof(fusion_bounds) / sizeof(fusion_bounds[0]));
+    define(m, GLOVE_METRIC_FRAMES, "glove_frames_drawn_total",
+           "Frames drawn with a new glove frame.", GLOVE_METRIC_COUNTER);
+    define(m, GLOVE_METRIC_SKIPPED, "glove_frames_skipped_total",
+           "Glove frames overwritten before the renderer took one.", GLOVE_METRIC_COUNTER);
+    define(m, GLOVE_METRIC_AGE, "glove_sample_age_seconds",
+           "Age of the newest sample when drawn, from its arrival.", GLOVE_METRIC_HISTOGRAM,
+           age_bounds, sizeof(age_bounds) / sizeof(age_bounds[0]));
+    m->fd = -1;
+    m->wake[0] = m->wake[1] = -1;
+    m->path[0] = 0;
+    m->server = NULL;
+}
+
+void glove_metrics_observe(glove_metrics_t* m, int id, int64_t ns)
+{
+    glove_metric_t* mt = &m->metric[id];
+    int b = 0;
+    while (b < mt->nbounds && ns > mt->bounds[b]) b++;
+    mt->bucket[b].store(mt->bucket[b].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (ns > 0) mt->sum_ns.store(mt->sum_ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+}
+
+int glove_metrics_format(const glove_metrics_t* m, char* buf, int buf_max)
+{
+    static const char* kinds[] = { "counter", "gauge", "histogram" };
+    int len = 0;
+    // appends what fits; len keeps counting past the end
+#define OUT(...) len += snprintf(buf + (len < buf_max ? len : buf_max), \
+                                 len < buf_max ? buf_max - len : 0, __VA_ARGS__)
+    for (int id = 0; id < GLOVE_METRICS; id++) {
+        const glove_metric_t* mt = &m->metric[id];
+        OUT("# HELP %s %s\n# TYPE %s %s\n", mt->name, mt->help, mt->name, kinds[mt->kind]);
+        if (mt->kind != GLOVE_METRIC_HISTOGRAM) {
+            OUT("%s %llu\n", mt->name, (unsigned long long)mt->value.load(std::memory_order_relaxed));
+            continue;
+        }
+        unsigned long long count = 0;
+        for (int b = 0; b <= mt->nbounds; b++) {
+            count += mt->bucket[b].load(std::memory_order_relaxed);
+            if (b < mt->nbounds) OUT("%s_bucket{le=\"%g\"} %llu\n", mt->name, mt->bounds[b] * 1e-9, count);
+            else OUT("%s_bucket{le=\"+Inf\"} %llu\n", mt->name, count);
+        }
+        OUT("%s_sum %.9f\n%s_count %llu\n", mt->name,
+            mt->sum_ns.load(std::memory_order_relaxed) * 1e-9, mt->name, count);
+    }
+#undef OUT
+    return len;
+}
+
+//
+// the socket
+//
+
+static void serve_one(glove_metrics_t* m, int c)
+{
+    // a request, if the client sends one; socat and nc just listen
+    char req[1024];
+    int n = 0;
+    struct pollfd pfd = { c, POLLIN, 0 };
+    if (poll(&pfd, 1, 100) == 1) n = read(c, req, sizeof(req) - 1);
+    int http = n >= 4 && memcmp(req, "GET ", 4) == 0;
+
+    char text[GLOVE_METRICS_TEXT_MAX], head[128];
+    int len = glove_metrics_format(m, text, sizeof(text));
+    if (len >= (int)sizeof(text)) len = sizeof(text) - 1;
+    if (http) {
+        int hl = snprintf(head, sizeof(head), "HTTP/1.0 200 OK\r\n"
+                          "Content-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\n\r\n", len);
+        if (send(c, head, hl, MSG_NOSIGNAL) != hl) return;
+    }
+    for (int off = 0, w; off < len; off += w)
+        if ((w = send(c, text + off, len - off, MSG_NOSIGNAL)) <= 0) return;
+}
+
+static void server(glove_metrics_t* m)
+{
+    // the listening socket doesn't block, in case a client is gone again
+    // between poll() and accept()
+    struct pollfd pfd[2] = { { m->fd, POLLIN, 0 }, { m->wake[0], POLLIN, 0 } };
+    for (;;) {
+        if (poll(pfd, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (pfd[1].revents) return;     // glove_metrics_close()
+        int c = accept(m->fd, NULL, NULL);
+        if (c < 0) continue;
+        // BSD hands the listener's O_NONBLOCK on
+        fcntl(c, F_SETFL, fcntl(c, F_GETFL) & ~O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(c, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        serve_one(m, c);
+        close(c);
+    }
+}
+
+int glove_metrics_serve(glove_metrics_t* m, const char* path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    // only ever replace a socket: a mistyped path must not cost a file
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            errno = EEXIST;
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0
+        || fcntl(fd, F_SETFL, O_NONBLOCK) != 0 || pipe(m->wake) != 0) {
+        int e = errno;
+        close(fd);
+        unlink(path);
+        errno = e;
+        return -1;
+    }
+    m->fd = fd;
+    strcpy(m->path, path);
+    m->server = new std::thread(server, m);
+    return 0;
+}
+
+void glove_metrics_close(glove_metrics_t* m)
+{
+    if (m->fd < 0) return;
+    // wakes poll(); shutdown() on a listening socket doesn't, on macOS
+    char b = 0;
+    if (write(m->wake[1], &b, 1) != 1) perror("glove_metrics_close");
+    std::thread* t = (std::thread*)m->server;
+    t->join();
+    delete t;
+    close(m->wake[0]);
+    close(m->wake[1]);
+    m->wake[0] = m->wake[1] = -1;
+    close(m->fd);
+    unlink(m->path);
+    m->fd = -1;
+    m->server = NULL;
+}
+
+int glove_metrics_scrape(const char* path, char* buf, int buf_max)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    // no request: the text comes back plain
+    shutdown(fd, SHUT_WR);
+    int len = 0, n = 0;
+    while (len < buf_max - 1 && (n = read(fd, buf + len, buf_max - 1 - len)) > 0) len += n;
+    close(fd);
+    buf[len] = 0;
+    return n < 0 ? -1 : len;
+}
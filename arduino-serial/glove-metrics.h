@@ -0,0 +1,98 @@
+//
+// glove-metrics -- counters and latency histograms for a running
+// pipeline, served as Prometheus text on a Unix socket
+//
+// The registry is a fixed set: what the reader thread sees (samples, bad
+// lines, port reopens, bytes still queued in the serial driver, fusion
+// time) and what the render thread sees (frames drawn, frames it never
+// got to, how old the sample was when drawn).  Each metric has one
+// writing thread, so an update is a relaxed load and store, with no
+// lock and no read-modify-write.  Metrics sit on cache lines of their own,
+// so the two threads never share one.  Histograms have fixed buckets.
+// Fusion is timed for one sample in FUSION_EVERY, to keep the two
+// clock reads off most samples.
+//
+// glove_metrics_serve() listens on a Unix socket from a thread that sleeps
+// in poll().  Until something connects, metrics cost the updates above
+// and nothing else.  A connection gets the text exposition format, with
+// an HTTP header if it asked with GET, so any of these scrape it:
+//
+//   curl -s --unix-socket /tmp/glove.sock http://glove/metrics
+//   socat - UNIX-CONNECT:/tmp/glove.sock
+//   glove-tool metrics /tmp/glove.sock
+//
+// A scrape can catch a histogram between its bucket and its sum; the
+// next one is right again, as Prometheus expects of counters.
+//
+
+
+#ifndef __GLOVE_METRICS_H__
+#define __GLOVE_METRICS_H__
+
+#include <stdint.h>
+#include <atomic>
+
+#define GLOVE_METRICS_BUCKETS       12      // bounds per histogram, +Inf on top
+#define GLOVE_METRICS_FUSION_EVERY  16
+
+// kinds
+#define GLOVE_METRIC_COUNTER        0
+#define GLOVE_METRIC_GAUGE          1
+#define GLOVE_METRIC_HISTOGRAM      2
+
+// the metrics, and the thread that writes each
+#define GLOVE_METRIC_SAMPLES        0       // reader: samples parsed and fused (frames in)
+#define GLOVE_METRIC_LINE_ERRORS    1       // reader: lines that didn't parse; the text link's CRC errors
+#define GLOVE_METRIC_RECONNECTS     2       // reader: port reopened
+#define GLOVE_METRIC_QUEUE          3       // reader: bytes left in the serial driver after a read
+#define GLOVE_METRIC_FUSION         4       // reader: fusion and yaw time of a sample
+#define GLOVE_METRIC_FRAMES         5       // render: frames drawn with a new glove frame (frames out)
+#define GLOVE_METRIC_SKIPPED        6       // render: glove frames overwritten before one was drawn
+#define GLOVE_METRIC_AGE            7       // render: sample age when drawn, from its arrival
+#define GLOVE_METRICS               8
+
+typedef struct alignas(64) {
+    const char*           name;
+    const char*           help;
+    int                   kind;
+    const int64_t*        bounds;           // histogram: upper bounds in ns, ascending
+    int                   nbounds;
+    std::atomic<uint64_t> value;            // counter, gauge
+    std::atomic<uint64_t> bucket[GLOVE_METRICS_BUCKETS + 1];
+    std::atomic<uint64_t> sum_ns;
+} glove_metric_t;
+
+typedef struct {
+    glove_metric_t metric[GLOVE_METRICS];
+    int            fd;                      // listening socket, -1 if not serving
+    int            wake[2];                 // a byte down this pipe stops the server thread
+    char           path[108];
+    void*          server;                  // its thread
+} glove_metrics_t;
+
+void glove_metrics_init(glove_metrics_t* m);
+
+// writer side: only the metric's own thread calls these
+static inline void glove_metrics_add(glove_metrics_t* m, int id, uint64_t n)
+{
+    std::atomic<uint64_t>* v = &m->metric[id].value;
+    v->store(v->load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+static inline void glove_metrics_set(glove_metrics_t* m, int id, uint64_t value)
+{
+    m->metric[id].value.store(value, std::memory_order_relaxed);
+}
+void glove_metrics_observe(glove_metrics_t* m, int id, int64_t ns);
+
+// the exposition text into buf; its length (buf may be short of it)
+int  glove_metrics_format(const glove_metrics_t* m, char* buf, int buf_max);
+
+// listen on path (replacing a stale socket); 0, or -1 with errno set,
+// EEXIST if path is something other than a socket
+int  glove_metrics_serve(glove_metrics_t* m, const char* path);
+// stop listening and remove the socket
+void glove_metrics_close(glove_metrics_t* m);
+// connect to path and read what is served into buf; bytes read, or -1
+int  glove_metrics_scrape(const char* path, char* buf, int buf_max);
+
+#endif
@@ -0,0 +1,160 @@
+//
+// glove-pick -- analytic picking against cached geometry
+//
+
+#include "glove-pick.h"
+
+// Moller-Trumbore; distance along the ray, or -1 for a miss.  det > 0
+// when the ray sees the counter-clockwise (front) side.
+static float ray_triangle(const glove_ray_t* r, glove_vec3_t v0, glove_vec3_t e1, glove_vec3_t e2,
+                          int cull_back)
+{
+    glove_vec3_t pv = glove_vec3_cross(r->d, e2);
+    float det = glove_vec3_dot(e1, pv);
+    if (cull_back ? det < 1e-12f : fabsf(det) < 1e-12f) return -1;
+    float inv = 1.0f / det;
+    glove_vec3_t tv = glove_vec3_sub(r->o, v0);
+    float u = glove_vec3_dot(tv, pv) * inv;
+    if (u < 0 || u > 1) return -1;
+    glove_vec3_t qv = glove_vec3_cross(tv, e1);
+    float v = glove_vec3_dot(r->d, qv) * inv;
+    if (v < 0 || u + v > 1) return -1;
+    return glove_vec3_dot(e2, qv) * inv;
+}
+
+// nearest intersection in front of the origin (or the exit point from
+// inside), -1 for a miss
+static float ray_sphere(const glove_ray_t* r, glove_vec3_t c, float r2)
+{
+    glove_vec3_t oc = glove_vec3_sub(c, r->o);
+    float b = glove_vec3_dot(oc, r->d);
+    float h = r2 - (glove_vec3_dot(oc, oc) - b * b);
+    if (h < 0) return -1;
+    h = sqrtf(h);
+    return b - h >= 0 ? b - h : b + h;
+}
+
+// general 4x4 inverse by cofactors, column-major; -1 if singular
+static int invert(const float m[16], float out[16])
+{
+    float inv[16];
+    inv[0]  =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15]
+             + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4]  = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15]
+             - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8]  =  m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15]
+             + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14]
+             - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1]  = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15]
+             - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5]  =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15]
+             + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9]  = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15]
+             - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] =  m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14]
+             + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2]  =  m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15]
+             + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6]  = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15]
+             - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] =  m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15]
+             + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14]
+             - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3]  = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11]
+             - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7]  =  m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11]
+             + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11]
+             - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] =  m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10]
+             + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0) return -1;
+    det = 1.0f / det;
+    for (int i = 0; i < 16; i++) out[i] = inv[i] * det;
+    return 0;
+}
+
+static glove_vec3_t unproject(const float inv[16], float x, float y, float z)
+{
+    float w = inv[3] * x + inv[7] * y + inv[11] * z + inv[15];
+    return glove_vec3((inv[0] * x + inv[4] * y + inv[8]  * z + inv[12]) / w,
+                      (inv[1] * x + inv[5] * y + inv[9]  * z + inv[13]) / w,
+                      (inv[2] * x + inv[6] * y + inv[10] * z + inv[14]) / w);
+}
+
+void glove_pick_init(glove_pick_t* p)
+{
+    p->cull_back = 0;
+    p->ntris = 0;
+    p->nspheres = 0;
+}
+
+int glove_pick_add_triangle(glove_pick_t* p, int id, glove_vec3_t a, glove_vec3_t b, glove_vec3_t c)
+{
+    if (p->ntris >= GLOVE_PICK_MAX_TRIS) return -1;
+    int i = p->ntris++;
+    p->v0[i] = a;
+    p->e1[i] = glove_vec3_sub(b, a);
+    p->e2[i] = glove_vec3_sub(c, a);
+    p->tri_id[i] = id;
+    return 0;
+}
+
+int glove_pick_add_sphere(glove_pick_t* p, int id, glove_vec3_t c, float radius)
+{
+    if (p->nspheres >= GLOVE_PICK_MAX_SPHERES) return -1;
+    int i = p->nspheres++;
+    p->c[i] = c;
+    p->r2[i] = radius * radius;
+    p->sphere_id[i] = id;
+    return 0;
+}
+
+int glove_pick_add_hand(glove_pick_t* p, int first, const glove_hand_pose_t* hand, float slack)
+{
+    if (p->nspheres + GLOVE_KIN_JOINTS > GLOVE_PICK_MAX_SPHERES) return -1;
+    for (int j = 0; j < GLOVE_KIN_JOINTS; j++)
+        glove_pick_add_sphere(p, first + j, hand->joints[j], hand->joint_radius[j] + slack);
+    return 0;
+}
+
+int glove_pick_ray_from_screen(const float mvp[16], float x, float y,
+                               int width, int height, glove_ray_t* ray)
+{
+    float inv[16];
+    if (width <= 0 || height <= 0 || invert(mvp, inv) < 0) return -1;
+    float nx = 2.0f * x / width - 1.0f;
+    float ny = 1.0f - 2.0f * y / height;
+    glove_vec3_t n = unproject(inv, nx, ny, -1);
+    glove_vec3_t f = unproject(inv, nx, ny, 1);
+    glove_vec3_t d = glove_vec3_sub(f, n);
+    float len = glove_vec3_len(d);
+    if (!(len > 0)) return -1;
+    ray->o = n;
+    ray->d = glove_vec3_scale(d, 1.0f / len);
+    return 0;
+}
+
+int glove_pick_ray(const glove_pick_t* p, const glove_ray_t* ray, glove_hit_t* hit)
+{
+    int id = -1;
+    float best = INFINITY;
+    for (int i = 0; i < p->ntris; i++) {
+        float t = ray_triangle(ray, p->v0[i], p->e1[i], p->e2[i], p->cull_back);
+        if (t >= 0 && t < best) { best = t; id = p->tri_id[i]; }
+    }
+    for (int i = 0; i < p->nspheres; i++) {
+        float t = ray_sphere(ray, p->c[i], p->r2[i]);
+        if (t >= 0 && t < best) { best = t; id = p->sphere_id[i]; }
+    }
+    if (hit) {
+        hit->id = id;
+        hit->t = id < 0 ? -1 : best;
+        hit->p = id < 0 ? ray->o : glove_vec3_add(ray->o, glove_vec3_scale(ray->d, best));
+    }
+    return id;
+}
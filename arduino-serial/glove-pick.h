@@ -0,0 +1,69 @@
+//
+// glove-pick -- analytic picking against cached geometry
+//
+// A glove_pick_t holds the pickable things of a scene in their own model
+// frame: triangles (faces of a mesh) and spheres (hand joints, buttons).
+// Each carries the id a hit reports.  A query is a ray, usually built from
+// a cursor position and the scene's model-view-projection matrix, so
+// geometry that only moves as a whole is added once and never touched
+// again; the ray is taken into its frame instead.
+//
+// No GL is involved: a query is a few hundred flops per target, so the
+// glove cursor can be resolved against every target every frame.
+//
+
+
+#ifndef __GLOVE_PICK_H__
+#define __GLOVE_PICK_H__
+
+#include "glove-kinematics.h"
+
+#define GLOVE_PICK_MAX_TRIS     256
+#define GLOVE_PICK_MAX_SPHERES  64
+
+typedef struct {
+    glove_vec3_t o;                     // origin
+    glove_vec3_t d;                     // unit direction
+} glove_ray_t;
+
+typedef struct {
+    int          id;                    // of the nearest target, -1 for none
+    float        t;                     // distance along the ray
+    glove_vec3_t p;                     // hit point
+} glove_hit_t;
+
+typedef struct {
+    int          cull_back;             // skip triangles seen from behind, as
+                                        // glEnable(GL_CULL_FACE) with CCW fronts
+    int          ntris;
+    glove_vec3_t v0[GLOVE_PICK_MAX_TRIS];
+    glove_vec3_t e1[GLOVE_PICK_MAX_TRIS];   // v1 - v0
+    glove_vec3_t e2[GLOVE_PICK_MAX_TRIS];   // v2 - v0
+    int          tri_id[GLOVE_PICK_MAX_TRIS];
+
+    int          nspheres;
+    glove_vec3_t c[GLOVE_PICK_MAX_SPHERES];
+    float        r2[GLOVE_PICK_MAX_SPHERES];
+    int          sphere_id[GLOVE_PICK_MAX_SPHERES];
+} glove_pick_t;
+
+// empty, cull_back off
+void glove_pick_init(glove_pick_t* p);
+// return 0, or -1 when the set is full
+int  glove_pick_add_triangle(glove_pick_t* p, int id, glove_vec3_t a, glove_vec3_t b, glove_vec3_t c);
+int  glove_pick_add_sphere(glove_pick_t* p, int id, glove_vec3_t c, float radius);
+// the joints of one hand as spheres, id = first + joint index, radius
+// grown by slack (metres) so small knuckles are easy to hit
+int  glove_pick_add_hand(glove_pick_t* p, int first, const glove_hand_pose_t* hand, float slack);
+
+// ray through window pixel (x, y), origin top left like Qt's mouse
+// events, of a width x height viewport; mvp is column-major (as glLoadMatrixf)
+// and maps the pick set's frame to clip space.  -1 if mvp is singular.
+int  glove_pick_ray_from_screen(const float mvp[16], float x, float y,
+                                int width, int height, glove_ray_t* ray);
+
+// nearest target the ray hits in front of its origin; returns its id or
+// -1, and fills hit if not NULL
+int  glove_pick_ray(const glove_pick_t* p, const glove_ray_t* ray, glove_hit_t* hit);
+
+#endif
@@ -0,0 +1,120 @@
+//
+// glove-position -- palm position from accel + fused orientation
+//
+
+#include "glove-position.h"
+
+#include <string.h>
+
+#define BIAS_RATE       0.02f   // per sample, while stationary
+#define LEAK_TAU        0.25f   // s, velocity bleed past window_s
+
+void glove_position_defaults(glove_position_params_t* par)
+{
+    par->acc_thresh  = 0.02f;
+    par->gyro_thresh = 6.0f;
+    par->window_s    = 2.0f;
+    par->radius      = 1.0f;
+}
+
+void glove_position_init(glove_position_t* ps, const glove_position_params_t* par)
+{
+    memset(ps, 0, sizeof(*ps));
+    ps->par = *par;
+    ps->q = glove_quat_identity();
+    ps->confidence = 1.0f;
+}
+
+// push one sample into the detector window, return 1 if still
+static int detect_stationary(glove_position_t* ps, const glove_sample_t* s)
+{
+    float amag = sqrtf(s->a[0] * s->a[0] + s->a[1] * s->a[1] + s->a[2] * s->a[2]);
+    float gmag = sqrtf(s->g[0] * s->g[0] + s->g[1] * s->g[1] + s->g[2] * s->g[2]);
+    uint8_t spin = gmag > ps->par.gyro_thresh;
+
+    if (ps->win_n == GLOVE_POS_WINDOW) {
+        double old = ps->win_amag[ps->win_i];
+        ps->win_sum  -= old;
+        ps->win_sum2 -= old * old;
+        ps->win_spinning -= ps->win_spin[ps->win_i];
+    } else {
+        ps->win_n++;
+    }
+    ps->win_amag[ps->win_i] = amag;
+    ps->win_spin[ps->win_i] = spin;
+    ps->win_sum  += amag;
+    ps->win_sum2 += (double)amag * amag;
+    ps->win_spinning += spin;
+    ps->win_i = (ps->win_i + 1) % GLOVE_POS_WINDOW;
+    if (ps->win_i == 0) {
+        // once round the window, start the sums afresh from what it holds
+        ps->win_sum = ps->win_sum2 = 0;
+        for (int i = 0; i < ps->win_n; i++) {
+            ps->win_sum  += ps->win_amag[i];
+            ps->win_sum2 += (double)ps->win_amag[i] * ps->win_amag[i];
+        }
+    }
+
+    if (ps->win_n < GLOVE_POS_WINDOW || ps->win_spinning) return 0;
+    double mean = ps->win_sum / GLOVE_POS_WINDOW;
+    double var  = ps->win_sum2 / GLOVE_POS_WINDOW - mean * mean;
+    if (var < 0) var = 0;       // what rounding leaves of a constant |a|
+    return var < (double)ps->par.acc_thresh * ps->par.acc_thresh;
+}
+
+void glove_position_update(glove_position_t* ps, const glove_sample_t* s, glove_quat_t q)
+{
+    int still = detect_stationary(ps, s);
+    float dt = 0;
+    if (ps->last_us && s->t_us > ps->last_us)
+        dt = (s->t_us - ps->last_us) * 1e-6f;
+    ps->last_us = s->t_us;
+    if (dt > 0.1f) dt = 0;      // gap in the stream, don't integrate across it
+
+    if (still || ps->stationary) {
+        ps->q = q;
+    } else {
+        glove_vec3_t w = glove_vec3(s->g[0], s->g[1], s->g[2]);
+        ps->q = glove_quat_mul(ps->q, glove_quat_from_rotvec(glove_vec3_scale(w, GLOVE_DEG2RAD * dt)));
+    }
+
+    // gravity-free acceleration in the world frame
+    glove_vec3_t aw = glove_quat_rotate(ps->q, glove_vec3(s->a[0], s->a[1], s->a[2]));
+    aw.z -= 1.0f;
+    aw = glove_vec3_scale(aw, GLOVE_GRAVITY);
+
+    if (still) {
+        if (!ps->stationary) {
+            // end of a motion segment: velocity should be zero now, so
+            // whatever is left is drift that grew over the segment
+            if (ps->seg_t > 0 && ps->seg_t <= ps->par.window_s)
+                ps->p = glove_vec3_sub(ps->p, glove_vec3_scale(ps->v, ps->seg_tdt / ps->seg_t));
+            ps->zupts++;
+        }
+        ps->stationary = 1;
+        ps->v = glove_vec3(0, 0, 0);
+        ps->bias = glove_vec3_add(ps->bias, glove_vec3_scale(glove_vec3_sub(aw, ps->bias), BIAS_RATE));
+        ps->confidence = 1.0f;
+        return;
+    }
+
+    if (ps->stationary) {
+        ps->stationary = 0;
+        ps->seg_t = ps->seg_tdt = 0;
+    }
+    ps->seg_t   += dt;
+    ps->seg_tdt += ps->seg_t * dt;
+
+    aw = glove_vec3_sub(aw, ps->bias);
+    ps->v = glove_vec3_add(ps->v, glove_vec3_scale(aw, dt));
+    if (ps->seg_t > ps->par.window_s)
+        ps->v = glove_vec3_scale(ps->v, expf(-dt / LEAK_TAU));
+    ps->p = glove_vec3_add(ps->p, glove_vec3_scale(ps->v, dt));
+
+    float r = glove_vec3_len(ps->p);
+    if (r > ps->par.radius)
+        ps->p = glove_vec3_scale(ps->p, ps->par.radius / r);
+
+    float f = ps->seg_t / ps->par.window_s;
+    ps->confidence = f < 1.0f ? 1.0f - f * f : 0.0f;
+}
@@ -0,0 +1,60 @@
+//
+// glove-position -- palm position from accel + fused orientation
+//
+// Instead of VR_Gloves2's posx += ax - aax2, this removes gravity with the
+// fused orientation, integrates only while the hand is moving, and
+// applies a zero-velocity update (ZUPT) whenever a window of samples
+// says the hand is still.  While moving, the orientation used for gravity
+// removal is the fused one at motion start carried on by the gyro alone,
+// because the accel tilt correction is wrong exactly when the hand is
+// accelerating.  At each ZUPT the velocity error of the motion
+// segment is assumed linear and its effect on position is taken back out.
+// Segments longer than window_s are not trusted: velocity is bled off and
+// confidence drops to zero, so drift stays bounded by the workspace radius.
+//
+
+
+#ifndef __GLOVE_POSITION_H__
+#define __GLOVE_POSITION_H__
+
+#include "glove-sample.h"
+
+#define GLOVE_POS_WINDOW     32         // samples in the stationary detector
+
+typedef struct {
+    float acc_thresh;       // g, stddev of |a| allowed while still
+    float gyro_thresh;      // deg/s, max rotation rate while still
+    float window_s;         // longest motion segment we integrate fully
+    float radius;           // m, positions are clamped to this sphere
+} glove_position_params_t;
+
+typedef struct {
+    glove_position_params_t par;
+
+    glove_vec3_t p;         // m, world frame, origin at first sample
+    glove_vec3_t v;         // m/s
+    glove_vec3_t bias;      // m/s^2, world accel residual learned at rest
+    glove_quat_t q;         // orientation used to remove gravity
+    float    confidence;    // 1 right after a ZUPT, 0 when untrusted
+    int      stationary;
+    uint32_t zupts;
+
+    // stationary detector: running sums over the last GLOVE_POS_WINDOW,
+    // summed afresh each time round so rounding can't pile up
+    float    win_amag[GLOVE_POS_WINDOW];
+    uint8_t  win_spin[GLOVE_POS_WINDOW];
+    int      win_n, win_i, win_spinning;
+    double   win_sum, win_sum2;
+
+    // current motion segment
+    float    seg_t;         // s since the hand started moving
+    float    seg_tdt;       // integral of seg_t dt, for the de-drift step
+    uint64_t last_us;
+} glove_position_t;
+
+void glove_position_defaults(glove_position_params_t* par);
+void glove_position_init(glove_position_t* ps, const glove_position_params_t* par);
+// q is the fused orientation of the same sensor after this sample
+void glove_position_update(glove_position_t* ps, const glove_sample_t* s, glove_quat_t q);
+
+#endif
@@ -0,0 +1,50 @@
+//
+// glove-predict -- extrapolate a fused orientation to display time
+//
+
+#include "glove-predict.h"
+
+void glove_predict_init(glove_predict_t* p, float horizon_s, int use_accel)
+{
+    p->horizon_s = horizon_s;
+    p->use_accel = use_accel;
+    p->w  = glove_vec3(0, 0, 0);
+    p->dw = glove_vec3(0, 0, 0);
+    p->last_us = 0;
+    p->started = 0;
+}
+
+void glove_predict_update(glove_predict_t* p, const glove_sample_t* s)
+{
+    glove_vec3_t w = glove_vec3_scale(glove_vec3(s->g[0], s->g[1], s->g[2]), GLOVE_DEG2RAD);
+    if (p->started && s->t_us > p->last_us) {
+        float dt = (s->t_us - p->last_us) * 1e-6f;
+        glove_vec3_t dw = glove_vec3_scale(glove_vec3_sub(w, p->w), 1.0f / dt);
+        float k = dt / (GLOVE_PREDICT_DW_TAU + dt);
+        p->dw = glove_vec3_add(p->dw, glove_vec3_scale(glove_vec3_sub(dw, p->dw), k));
+    }
+    p->w = w;
+    p->last_us = s->t_us;
+    p->started = 1;
+}
+
+glove_quat_t glove_predict_by(const glove_predict_t* p, glove_quat_t q, float h)
+{
+    if (h <= 0 || !p->started) return q;
+    if (h > GLOVE_PREDICT_MAX) h = GLOVE_PREDICT_MAX;
+    glove_vec3_t r = glove_vec3_scale(p->w, h);
+    if (p->use_accel)
+        r = glove_vec3_add(r, glove_vec3_scale(p->dw, 0.5f * h * h));
+    return glove_quat_normalize(glove_quat_mul(q, glove_quat_from_rotvec(r)));
+}
+
+glove_quat_t glove_predict(const glove_predict_t* p, glove_quat_t q)
+{
+    return glove_predict_by(p, q, p->horizon_s);
+}
+
+glove_quat_t glove_predict_at(const glove_predict_t* p, glove_quat_t q, uint64_t display_us)
+{
+    if (display_us <= p->last_us) return q;
+    return glove_predict_by(p, q, (display_us - p->last_us) * 1e-6f);
+}
@@ -0,0 +1,44 @@
+//
+// glove-predict -- extrapolate a fused orientation to display time
+//
+// Serial transport plus rendering puts the drawn hand tens of ms behind
+// the real one.  This stage keeps the latest body rate (straight from the
+// gyro) and a smoothed angular acceleration per sensor, and rotates the
+// fused quaternion forward by the expected latency:
+//
+//   q(t + h) = q(t) * exp(w h + dw h^2 / 2)
+//
+// The horizon is tuned per setup; "glove-tool predict" prints the
+// error-vs-horizon table for a recording to pick it from.
+//
+
+
+#ifndef __GLOVE_PREDICT_H__
+#define __GLOVE_PREDICT_H__
+
+#include "glove-sample.h"
+
+#define GLOVE_PREDICT_HORIZON   0.040f  // s, serial + one 60Hz frame
+#define GLOVE_PREDICT_DW_TAU    0.030f  // s, smoothing of angular accel
+#define GLOVE_PREDICT_MAX       0.150f  // s, never extrapolate further
+
+typedef struct {
+    float        horizon_s;     // default look-ahead for glove_predict()
+    int          use_accel;     // also extrapolate angular acceleration
+    glove_vec3_t w;             // body rate, rad/s
+    glove_vec3_t dw;            // body angular acceleration, rad/s^2
+    uint64_t     last_us;
+    int          started;
+} glove_predict_t;
+
+void glove_predict_init(glove_predict_t* p, float horizon_s, int use_accel);
+void glove_predict_update(glove_predict_t* p, const glove_sample_t* s);
+
+// q is the fused orientation at the last sample; look ahead horizon_s
+glove_quat_t glove_predict_by(const glove_predict_t* p, glove_quat_t q, float horizon_s);
+// same with the tuned horizon
+glove_quat_t glove_predict(const glove_predict_t* p, glove_quat_t q);
+// to an absolute display time on the sample clock
+glove_quat_t glove_predict_at(const glove_predict_t* p, glove_quat_t q, uint64_t display_us);
+
+#endif
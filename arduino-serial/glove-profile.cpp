@@ -0,0 +1,66 @@
+//
+// glove-profile -- where the glove sketch's loop time goes
+//
+
+#include "glove-profile.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char* phase_names[] = {
+    "i2c", "math", "format", "idle", "other"
+};
+
+const char* glove_profile_phase_name(int phase)
+{
+    if (phase < 0 || phase >= GLOVE_PROFILE_PHASES) return "?";
+    return phase_names[phase];
+}
+
+int glove_profile_parse(const char* line, glove_profile_t* p)
+{
+    unsigned long long v[9];
+    if (strncmp(line, "#P:", 3) != 0) return -1;
+    const char* s = line + 3;
+    for (int i = 0; i < 9; i++) {
+        char* end;
+        if (i > 0 && *s++ != ':') return -1;
+        v[i] = strtoull(s, &end, 10);
+        if (end == s) return -1;
+        s = end;
+    }
+    memset(p, 0, sizeof(*p));
+    p->t_us = v[0];
+    p->loops = (uint32_t)v[1];
+    p->loop_us = v[2];
+    p->max_loop_us = (uint32_t)v[3];
+    uint64_t in = 0;
+    for (int ph = 0; ph < GLOVE_PROFILE_OTHER; ph++) {
+        p->us[ph] = v[4 + ph];
+        in += v[4 + ph];
+    }
+    // the phases can overrun the loops by the odd stamp
+    p->us[GLOVE_PROFILE_OTHER] = p->loop_us > in ? p->loop_us - in : 0;
+    p->probe_us = v[8];
+    return 0;
+}
+
+void glove_profile_add(glove_profile_t* sum, const glove_profile_t* p)
+{
+    sum->t_us = p->t_us;
+    sum->loops += p->loops;
+    sum->loop_us += p->loop_us;
+    if (p->max_loop_us > sum->max_loop_us) sum->max_loop_us = p->max_loop_us;
+    for (int ph = 0; ph < GLOVE_PROFILE_PHASES; ph++) sum->us[ph] += p->us[ph];
+    sum->probe_us += p->probe_us;
+}
+
+double glove_profile_share(const glove_profile_t* p, int phase)
+{
+    return p->loop_us ? (double)p->us[phase] / p->loop_us : 0;
+}
+
+double glove_profile_overhead(const glove_profile_t* p)
+{
+    return p->loop_us ? (double)p->probe_us / p->loop_us : 0;
+}
@@ -0,0 +1,58 @@
+//
+// glove-profile -- where the glove sketch's loop time goes, from the
+// "#P:" lines it sends when built with GLOVE_PROFILE
+//
+// The sketch (GY521_profile.h in gyroArduino/GY521/) sums, over about a
+// second, the microseconds each loop() spent in
+//
+//   i2c      GY521::read()'s transfer
+//   math     the rest of read()
+//   format   printing the sample lines
+//   idle     delay() or waiting for the next period
+//
+// and sends them on the sample link as
+//
+//   #P:t_us:loops:loop_us:max_loop_us:i2c_us:math_us:format_us:idle_us:probe_us
+//
+// Sample readers take it for a comment.  "other" is loop time in no phase:
+// the gesture code.  probe_us is what profiling cost the sketch over the
+// period, its extra micros() calls and the previous #P line; it is spread
+// over the phases, not one of its own.
+//
+
+
+#ifndef __GLOVE_PROFILE_H__
+#define __GLOVE_PROFILE_H__
+
+#include <stdint.h>
+
+// phases
+#define GLOVE_PROFILE_I2C       0
+#define GLOVE_PROFILE_MATH      1
+#define GLOVE_PROFILE_FORMAT    2
+#define GLOVE_PROFILE_IDLE      3
+#define GLOVE_PROFILE_OTHER     4       // loop time in none of the above
+#define GLOVE_PROFILE_PHASES    5
+
+#define GLOVE_PROFILE_BUDGET    0.02    // profiling may cost this share of loop time
+
+typedef struct {
+    uint64_t t_us;                      // glove micros() when sent
+    uint32_t loops;
+    uint64_t loop_us;                   // all loops, summed
+    uint32_t max_loop_us;
+    uint64_t us[GLOVE_PROFILE_PHASES];
+    uint64_t probe_us;
+} glove_profile_t;
+
+const char* glove_profile_phase_name(int phase);
+
+// 0, or -1 if the line is not a "#P:" line
+int  glove_profile_parse(const char* line, glove_profile_t* p);
+// accumulate p into sum (t_us is the latest)
+void glove_profile_add(glove_profile_t* sum, const glove_profile_t* p);
+// phase's share of loop time, and profiling's; 0 with no loops
+double glove_profile_share(const glove_profile_t* p, int phase);
+double glove_profile_overhead(const glove_profile_t* p);
+
+#endif
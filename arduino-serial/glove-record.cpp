@@ -0,0 +1,187 @@
+//
+// glove-record -- decoded samples to an append-only binary session
+//
+
+#include "glove-record.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// the file format depends on these
+static_assert(sizeof(glove_rec_sample_t) == 40, "record layout");
+static_assert(sizeof(glove_rec_chunk_t) == 64, "chunk header layout");
+static_assert(sizeof(glove_rec_header_t) <= GLOVE_REC_HEADER, "header page");
+
+static int preallocate(int fd, uint64_t from, uint64_t len)
+{
+#ifdef __linux__
+    int rc = posix_fallocate(fd, from, len);
+    if (rc == 0) return 0;
+    if (rc != EOPNOTSUPP && rc != EINVAL) { errno = rc; return -1; }
+#endif
+    // no fallocate here: a sparse extension still keeps mmap writes
+    // inside the file
+    return ftruncate(fd, from + len);
+}
+
+int glove_rec_open(glove_rec_t* r, const char* path, const glove_calib_t* cal)
+{
+    glove_rec_header_t h;
+    struct timespec ts;
+    memset(r, 0, sizeof(*r));
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, GLOVE_REC_MAGIC, 8);
+    h.version = GLOVE_REC_VERSION;
+    h.endian = GLOVE_REC_ENDIAN;
+    h.header_size = GLOVE_REC_HEADER;
+    h.chunk_size = GLOVE_REC_CHUNK;
+    h.chunk_header_size = sizeof(glove_rec_chunk_t);
+    h.record_size = sizeof(glove_rec_sample_t);
+    clock_gettime(CLOCK_REALTIME, &ts);
+    h.created_ns = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    strncpy(h.schema, GLOVE_REC_SCHEMA, sizeof(h.schema) - 1);
+    if (cal) {
+        int len = glove_calib_to_blob(cal, h.calib, sizeof(h.calib));
+        if (len < 0) { errno = EINVAL; return -1; }
+        h.calib_len = len;
+    }
+
+    r->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (r->fd < 0) return -1;
+    if (ftruncate(r->fd, GLOVE_REC_HEADER) != 0 ||
+        pwrite(r->fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h)) {
+        close(r->fd);
+        r->fd = -1;
+        return -1;
+    }
+    r->alloc = GLOVE_REC_HEADER;
+    return 0;
+}
+
+// the old chunk stays mapped until the new one is: if the disk is full,
+// close still knows where the recording ends
+static int next_chunk(glove_rec_t* r)
+{
+    uint64_t off = GLOVE_REC_HEADER + (uint64_t)r->nchunks * GLOVE_REC_CHUNK;
+    if (off + GLOVE_REC_CHUNK > r->alloc) {
+        if (preallocate(r->fd, r->alloc, GLOVE_REC_PREALLOC) != 0) return -1;
+        r->alloc += GLOVE_REC_PREALLOC;
+    }
+    void* m = mmap(NULL, GLOVE_REC_CHUNK, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, off);
+    if (m == MAP_FAILED) return -1;
+    // the kernel writes the finished chunk back in its own time
+    if (r->chunk) munmap(r->chunk, GLOVE_REC_CHUNK);
+    r->chunk = (glove_rec_chunk_t*)m;
+    r->rec = (glove_rec_sample_t*)(r->chunk + 1);
+    r->chunk->index = r->nchunks++;
+    r->chunk->count = 0;
+    memcpy(r->chunk->magic, "GCHK", 4);
+    return 0;
+}
+
+int glove_rec_write(glove_rec_t* r, const glove_sample_t* s)
+{
+    if (!r->chunk || r->chunk->count == GLOVE_REC_PER_CHUNK) {
+        if (next_chunk(r) != 0) {
+            r->dropped++;
+            return -1;
+        }
+    }
+    glove_rec_chunk_t* c = r->chunk;
+    glove_rec_sample_t* d = &r->rec[c->count];
+    d->t_us = s->t_us;
+    memcpy(d->a, s->a, sizeof(d->a));
+    memcpy(d->g, s->g, sizeof(d->g));
+    d->sensor = s->sensor;
+    d->flags = 0;
+    if (c->count == 0) c->first_t_us = s->t_us;
+    c->last_t_us = s->t_us;
+    // last, so a reader never counts a half-written record
+    __atomic_store_n(&c->count, c->count + 1, __ATOMIC_RELEASE);
+    r->nsamples++;
+    return 0;
+}
+
+int glove_rec_close(glove_rec_t* r)
+{
+    if (r->fd < 0) return -1;
+    uint64_t end = GLOVE_REC_HEADER;
+    if (r->chunk) {
+        end += (uint64_t)(r->nchunks - 1) * GLOVE_REC_CHUNK + sizeof(glove_rec_chunk_t) +
+               (uint64_t)r->chunk->count * sizeof(glove_rec_sample_t);
+        munmap(r->chunk, GLOVE_REC_CHUNK);
+        r->chunk = NULL;
+    }
+    int rc = ftruncate(r->fd, end) == 0 && fsync(r->fd) == 0 ? 0 : -1;
+    close(r->fd);
+    r->fd = -1;
+    return rc;
+}
+
+int glove_rec_probe(const char* path)
+{
+    char magic[8];
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return 0;
+    int is = fread(magic, 1, 8, fp) == 8 && memcmp(magic, GLOVE_REC_MAGIC, 8) == 0;
+    fclose(fp);
+    return is;
+}
+
+int glove_rec_load(const char* path, glove_session_t* ss, glove_calib_t* cal)
+{
+    memset(ss, 0, sizeof(*ss));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("glove_rec_load: Unable to open recording");
+        return -1;
+    }
+    struct stat st;
+    void* m = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= GLOVE_REC_HEADER)
+        m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return -1;
+
+    const glove_rec_header_t* h = (const glove_rec_header_t*)m;
+    const char* base = (const char*)m;
+    uint64_t size = st.st_size;
+    int ok = memcmp(h->magic, GLOVE_REC_MAGIC, 8) == 0 && h->version == GLOVE_REC_VERSION &&
+             h->endian == GLOVE_REC_ENDIAN && h->header_size == GLOVE_REC_HEADER &&
+             h->chunk_size == GLOVE_REC_CHUNK && h->chunk_header_size == sizeof(glove_rec_chunk_t) &&
+             h->record_size == sizeof(glove_rec_sample_t);
+    if (ok && cal) {
+        glove_calib_identity(cal, 0);
+        if (h->calib_len && glove_calib_from_blob(cal, h->calib, h->calib_len) != 0) ok = 0;
+    }
+
+    // chunks in order up to the first one never started (preallocated
+    // zeros) or cut short by a crash
+    for (uint64_t off = GLOVE_REC_HEADER; ok && off + sizeof(glove_rec_chunk_t) <= size;
+         off += GLOVE_REC_CHUNK) {
+        const glove_rec_chunk_t* c = (const glove_rec_chunk_t*)(base + off);
+        if (memcmp(c->magic, "GCHK", 4) != 0) break;
+        uint64_t room = (size - off - sizeof(glove_rec_chunk_t)) / sizeof(glove_rec_sample_t);
+        uint64_t n = c->count < room ? c->count : room;
+        if (n > GLOVE_REC_PER_CHUNK) n = GLOVE_REC_PER_CHUNK;
+        const glove_rec_sample_t* d = (const glove_rec_sample_t*)(c + 1);
+        for (uint64_t i = 0; i < n; i++) {
+            glove_sample_t s;
+            s.t_us = d[i].t_us;
+            s.sensor = d[i].sensor;
+            memcpy(s.a, d[i].a, sizeof(s.a));
+            memcpy(s.g, d[i].g, sizeof(s.g));
+            if (glove_session_add(ss, &s) != 0) { ok = 0; break; }
+        }
+    }
+    munmap(m, size);
+    if (!ok) glove_session_free(ss);
+    return ok && ss->nsamples > 0 ? 0 : -1;
+}
@@ -0,0 +1,96 @@
+//
+// glove-record -- decoded samples to an append-only binary session
+//
+// Text captures (cutecom's log, "arduino-serial -r > file") have to be
+// parsed again on every replay and can't be seeked.  A recording holds
+// the samples as the host decoded them, fixed size, in a file laid out
+//
+//   0                      header page: magic, record schema, calibration
+//   HEADER + i * CHUNK     chunk i: glove_rec_chunk_t, then its records
+//
+// The file is preallocated PREALLOC bytes at a time and written through a
+// mapping of the current chunk.  Writing a sample is a 40 byte copy and
+// two stores; system calls only happen every PER_CHUNK samples (about two
+// seconds for twelve sensors at 1 kHz), and nothing is allocated.  A
+// chunk's count is bumped after its record is complete, so after a crash
+// the file still reads back up to the last whole sample.  Each chunk
+// header carries its first and last capture time, a ready-made coarse
+// index for seeking.
+//
+// Fields are in the writer's byte order; the header says which.
+//
+
+
+#ifndef __GLOVE_RECORD_H__
+#define __GLOVE_RECORD_H__
+
+#include <stddef.h>
+
+#include "glove-sample.h"
+#include "glove-calib.h"
+
+#define GLOVE_REC_MAGIC         "GLOVEREC"
+#define GLOVE_REC_VERSION       1
+#define GLOVE_REC_ENDIAN        0x01020304
+#define GLOVE_REC_HEADER        4096
+#define GLOVE_REC_CHUNK         (1 << 20)
+#define GLOVE_REC_PREALLOC      (16 * GLOVE_REC_CHUNK)
+#define GLOVE_REC_SCHEMA        "t_us:u64 a:f32[3] g:f32[3] sensor:u8 flags:u8 pad:u8[6]"
+
+typedef struct {
+    uint64_t t_us;                      // capture time, unwrapped
+    float    a[3];                      // g, as read (calibration is in the header)
+    float    g[3];                      // degrees/second
+    uint8_t  sensor;
+    uint8_t  flags;                     // 0
+    uint8_t  pad[6];
+} glove_rec_sample_t;
+
+typedef struct {
+    char     magic[4];                  // "GCHK"
+    uint32_t index;                     // chunk number
+    uint32_t count;                     // records complete
+    uint32_t reserved;
+    uint64_t first_t_us, last_t_us;
+    uint8_t  pad[32];
+} glove_rec_chunk_t;
+
+#define GLOVE_REC_PER_CHUNK \
+    ((GLOVE_REC_CHUNK - sizeof(glove_rec_chunk_t)) / sizeof(glove_rec_sample_t))
+
+typedef struct {
+    char     magic[8];                  // GLOVE_REC_MAGIC
+    uint32_t version;
+    uint32_t endian;                    // GLOVE_REC_ENDIAN as the writer stored it
+    uint32_t header_size, chunk_size;
+    uint32_t chunk_header_size, record_size;
+    int64_t  created_ns;                // CLOCK_REALTIME
+    char     schema[128];               // GLOVE_REC_SCHEMA
+    uint32_t calib_len;                 // 0 for none
+    uint8_t  calib[GLOVE_CALIB_HEADER + GLOVE_MAX_SENSORS * GLOVE_CALIB_ENTRY];
+} glove_rec_header_t;
+
+typedef struct {
+    int                 fd;
+    uint32_t            nchunks;        // chunks started
+    uint64_t            alloc;          // bytes preallocated
+    glove_rec_chunk_t*  chunk;          // the current chunk's mapping
+    glove_rec_sample_t* rec;            // its records
+    uint64_t            nsamples;
+    unsigned            dropped;        // samples lost to a failed chunk switch
+} glove_rec_t;
+
+// create (truncate) path; cal may be NULL.  0, or -1 with errno set
+int  glove_rec_open(glove_rec_t* r, const char* path, const glove_calib_t* cal);
+// append one sample; -1 if it was dropped (disk full)
+int  glove_rec_write(glove_rec_t* r, const glove_sample_t* s);
+// trim the preallocation and flush; 0, or -1 if the data may be incomplete
+int  glove_rec_close(glove_rec_t* r);
+
+// 1 if path starts like a recording
+int  glove_rec_probe(const char* path);
+// the whole recording as a session; cal, if not NULL, gets the header's
+// calibration (identity for none).  0, or -1 if it isn't a recording
+int  glove_rec_load(const char* path, glove_session_t* ss, glove_calib_t* cal);
+
+#endif
@@ -0,0 +1,215 @@
+//
+// glove-replay -- play a recording back into the live pipeline
+//
+
+#include "glove-replay.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    char     magic[8];                  // GLOVE_REPLAY_IDX_MAGIC
+    uint32_t stride;
+    uint32_t reserved;
+    uint64_t records;                   // of the recording it indexes
+    uint64_t size;                      // and its length, to spot a stale index
+    uint64_t nindex;
+} idx_header_t;
+
+const glove_rec_sample_t* glove_replay_record(const glove_replay_t* rp, uint64_t i)
+{
+    uint64_t c = i / GLOVE_REC_PER_CHUNK, j = i % GLOVE_REC_PER_CHUNK;
+    return (const glove_rec_sample_t*)(rp->base + GLOVE_REC_HEADER + c * GLOVE_REC_CHUNK +
+                                       sizeof(glove_rec_chunk_t)) + j;
+}
+
+uint64_t glove_replay_first_us(const glove_replay_t* rp)
+{
+    return rp->n ? glove_replay_record(rp, 0)->t_us : 0;
+}
+
+uint64_t glove_replay_last_us(const glove_replay_t* rp)
+{
+    return rp->n ? glove_replay_record(rp, rp->n - 1)->t_us : 0;
+}
+
+static int load_index(glove_replay_t* rp, const char* path)
+{
+    idx_header_t h;
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return -1;
+    int ok = fread(&h, sizeof(h), 1, fp) == 1 && memcmp(h.magic, GLOVE_REPLAY_IDX_MAGIC, 8) == 0 &&
+             h.stride == GLOVE_REPLAY_STRIDE && h.records == rp->n && h.size == rp->size &&
+             h.nindex == rp->nindex &&
+             fread(rp->index, sizeof(uint64_t), rp->nindex, fp) == rp->nindex;
+    fclose(fp);
+    return ok ? 0 : -1;
+}
+
+static void save_index(const glove_replay_t* rp, const char* path)
+{
+    idx_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, GLOVE_REPLAY_IDX_MAGIC, 8);
+    h.stride = GLOVE_REPLAY_STRIDE;
+    h.records = rp->n;
+    h.size = rp->size;
+    h.nindex = rp->nindex;
+    // best effort: a read-only directory just means building it each time
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) return;
+    int ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+             fwrite(rp->index, sizeof(uint64_t), rp->nindex, fp) == rp->nindex;
+    if (fclose(fp) != 0 || !ok) unlink(path);
+}
+
+int glove_replay_open(glove_replay_t* rp, const char* path)
+{
+    memset(rp, 0, sizeof(*rp));
+    rp->speed = 1;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("glove_replay_open: Unable to open recording");
+        return -1;
+    }
+    struct stat st;
+    void* m = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= GLOVE_REC_HEADER)
+        m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return -1;
+    rp->base = (const char*)m;
+    rp->size = st.st_size;
+
+    const glove_rec_header_t* h = (const glove_rec_header_t*)m;
+    if (memcmp(h->magic, GLOVE_REC_MAGIC, 8) != 0 || h->version != GLOVE_REC_VERSION ||
+        h->endian != GLOVE_REC_ENDIAN || h->header_size != GLOVE_REC_HEADER ||
+        h->chunk_size != GLOVE_REC_CHUNK || h->chunk_header_size != sizeof(glove_rec_chunk_t) ||
+        h->record_size != sizeof(glove_rec_sample_t)) {
+        glove_replay_close(rp);
+        return -1;
+    }
+    glove_calib_identity(&rp->cal, 0);
+    if (h->calib_len) glove_calib_from_blob(&rp->cal, h->calib, h->calib_len);
+
+    // every chunk but the last is full; a short one ends the recording
+    for (uint64_t off = GLOVE_REC_HEADER; off + sizeof(glove_rec_chunk_t) <= rp->size;
+         off += GLOVE_REC_CHUNK) {
+        const glove_rec_chunk_t* c = (const glove_rec_chunk_t*)(rp->base + off);
+        if (memcmp(c->magic, "GCHK", 4) != 0) break;
+        uint64_t room = (rp->size - off - sizeof(glove_rec_chunk_t)) / sizeof(glove_rec_sample_t);
+        uint64_t n = c->count < room ? c->count : room;
+        if (n > GLOVE_REC_PER_CHUNK) n = GLOVE_REC_PER_CHUNK;
+        rp->n += n;
+        if (n < GLOVE_REC_PER_CHUNK) break;
+    }
+
+    rp->nindex = (rp->n + GLOVE_REPLAY_STRIDE - 1) / GLOVE_REPLAY_STRIDE;
+    rp->index = (uint64_t*)malloc((rp->nindex ? rp->nindex : 1) * sizeof(uint64_t));
+    if (!rp->index) {
+        glove_replay_close(rp);
+        return -1;
+    }
+    char idx[1024];
+    snprintf(idx, sizeof(idx), "%s.idx", path);
+    if (load_index(rp, idx) == 0) {
+        rp->index_loaded = 1;
+    } else {
+        // a running maximum: reads of different sensors can be a little
+        // out of order, the index must not be
+        uint64_t most = 0;
+        for (uint64_t i = 0; i < rp->n; i++) {
+            uint64_t t = glove_replay_record(rp, i)->t_us;
+            if (t > most) most = t;
+            if (i % GLOVE_REPLAY_STRIDE == 0) rp->index[i / GLOVE_REPLAY_STRIDE] = most;
+        }
+        save_index(rp, idx);
+    }
+    return 0;
+}
+
+void glove_replay_close(glove_replay_t* rp)
+{
+    if (rp->base) munmap((void*)rp->base, rp->size);
+    free(rp->index);
+    memset(rp, 0, sizeof(*rp));
+}
+
+uint64_t glove_replay_seek(glove_replay_t* rp, uint64_t t_us)
+{
+    // first index entry that reaches t_us; the answer is in the stride
+    // before it
+    uint64_t lo = 0, hi = rp->nindex;
+    while (lo < hi) {
+        uint64_t mid = (lo + hi) / 2;
+        if (rp->index[mid] < t_us) lo = mid + 1;
+        else hi = mid;
+    }
+    uint64_t i = 0;
+    if (lo > 0) {
+        i = (lo - 1) * GLOVE_REPLAY_STRIDE + 1;
+        while (i < rp->n && glove_replay_record(rp, i)->t_us < t_us) i++;
+    }
+    rp->pos = i;
+    rp->anchored = 0;
+    return i;
+}
+
+void glove_replay_set_speed(glove_replay_t* rp, float speed)
+{
+    rp->speed = speed;
+    rp->anchored = 0;
+}
+
+static void sleep_ns(int64_t ns)
+{
+    struct timespec ts = { (time_t)(ns / 1000000000), (long)(ns % 1000000000) };
+    nanosleep(&ts, NULL);
+}
+
+int glove_replay_next(glove_replay_t* rp, int timeout_ms, glove_sample_t* s)
+{
+    if (rp->pos >= rp->n) return -1;
+    const glove_rec_sample_t* r = glove_replay_record(rp, rp->pos);
+    if (rp->speed > 0) {
+        int64_t now = glove_monotonic_ns();
+        if (!rp->anchored) {
+            rp->anchor_ns = now;
+            rp->anchor_t_us = r->t_us;
+            rp->anchored = 1;
+        }
+        int64_t due = rp->anchor_ns + (int64_t)((int64_t)(r->t_us - rp->anchor_t_us) * 1000 / rp->speed);
+        if (due > now) {
+            if (due - now > (int64_t)timeout_ms * 1000000) {
+                if (timeout_ms > 0) sleep_ns((int64_t)timeout_ms * 1000000);
+                return 0;
+            }
+            sleep_ns(due - now);
+        }
+    }
+    s->t_us = r->t_us;
+    s->sensor = r->sensor;
+    memcpy(s->a, r->a, sizeof(s->a));
+    memcpy(s->g, r->g, sizeof(s->g));
+    rp->pos++;
+    return 1;
+}
+
+int glove_replay_poll(glove_replay_t* rp, glove_stream_t* st, int timeout_ms, glove_handoff_t* h)
+{
+    glove_sample_t s;
+    int rc = glove_replay_next(rp, timeout_ms, &s);
+    if (rc <= 0) return rc;
+    int fed = 0;
+    do {
+        glove_stream_feed(st, &s, h);
+        fed++;
+    } while (fed < GLOVE_REPLAY_BATCH && glove_replay_next(rp, 0, &s) == 1);
+    return fed;
+}
@@ -0,0 +1,69 @@
+//
+// glove-replay -- play a recording back into the live pipeline
+//
+// The recording (glove-record.h) is mapped read-only, nothing is copied.
+// Records are fixed size, so record i is found by arithmetic; a sparse
+// index of the latest capture time up to every STRIDE-th record turns a
+// seek into a binary search plus a short scan.  (Reads of different
+// sensors can be slightly out of order; a seek lands on the first record
+// at which the recording has reached the time asked for.)  The index is kept next to the recording as
+// "<file>.idx" and rebuilt when it is missing or doesn't match.
+//
+// glove_replay_poll() is the drop-in for glove_stream_poll(): it feeds
+// the samples that are due into the same glove_stream_feed() the serial
+// reader uses, paced by their capture times at 1x, any multiple, or as
+// fast as possible.  The viewers and benchmarks then run off a file
+// exactly as they do off the glove.  Away from 1x, capture times and
+// arrival no longer agree, and glove-interp's delay is no longer exact.
+//
+
+
+#ifndef __GLOVE_REPLAY_H__
+#define __GLOVE_REPLAY_H__
+
+#include "glove-record.h"
+#include "glove-stream.h"
+
+#define GLOVE_REPLAY_STRIDE     256     // records per index entry
+#define GLOVE_REPLAY_BATCH      256     // most samples one poll feeds
+#define GLOVE_REPLAY_IDX_MAGIC  "GLOVEIDX"
+
+typedef struct {
+    const char*   base;                 // the mapped recording
+    uint64_t      size;
+    uint64_t      n;                    // complete records
+    glove_calib_t cal;                  // from the header
+    uint64_t*     index;                // latest t_us up to every STRIDE-th record
+    uint64_t      nindex;
+    int           index_loaded;         // 1 if read from the .idx file
+
+    uint64_t      pos;                  // next record to play
+    float         speed;                // 1 real time, 0 as fast as possible
+    int64_t       anchor_ns;            // monotonic time record anchor_t_us plays at
+    uint64_t      anchor_t_us;
+    int           anchored;
+} glove_replay_t;
+
+// 0, or -1 if path can't be mapped or isn't a recording
+int  glove_replay_open(glove_replay_t* rp, const char* path);
+void glove_replay_close(glove_replay_t* rp);
+
+// record i, i < rp->n
+const glove_rec_sample_t* glove_replay_record(const glove_replay_t* rp, uint64_t i);
+uint64_t glove_replay_first_us(const glove_replay_t* rp);
+uint64_t glove_replay_last_us(const glove_replay_t* rp);
+
+// to the first record that reaches t_us (the end if none); playback
+// continues from there at the current speed
+uint64_t glove_replay_seek(glove_replay_t* rp, uint64_t t_us);
+void glove_replay_set_speed(glove_replay_t* rp, float speed);
+
+// the next sample once it is due, waiting up to timeout_ms for it;
+// 1, 0 on timeout, -1 at the end of the recording
+int  glove_replay_next(glove_replay_t* rp, int timeout_ms, glove_sample_t* s);
+// feed every sample due by now through glove_stream_feed(), waiting up to
+// timeout_ms for the next one; returns how many went through, 0 on
+// timeout, -1 at the end of the recording
+int  glove_replay_poll(glove_replay_t* rp, glove_stream_t* st, int timeout_ms, glove_handoff_t* h);
+
+#endif
@@ -0,0 +1,232 @@
+//
+// glove-sample -- one IMU reading as it travels through the host pipeline
+//
+
+#include "glove-sample.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char* sensor_names[] = {
+    "Main", "Thumb", "Point", "Middle", "Ring", "Little"
+};
+
+const char* glove_sensor_name(int sensor)
+{
+    if (sensor < 0 || sensor >= GLOVE_MAX_SENSORS) return "?";
+    return sensor_names[sensor % 6];
+}
+
+// read 'n' ':'-separated floats starting at p, returns end or NULL
+static const char* parse_floats(const char* p, float* out, int n)
+{
+    for (int i = 0; i < n; i++) {
+        if (*p != ':') return NULL;
+        char* end;
+        out[i] = strtof(p + 1, &end);
+        if (end == p + 1) return NULL;
+        p = end;
+    }
+    return p;
+}
+
+// "sensor:t_us" prefix shared by sample and truth lines
+static const char* parse_head(const char* p, uint8_t* sensor, uint64_t* t_us)
+{
+    char* end;
+    unsigned long id = strtoul(p, &end, 10);
+    if (end == p || *end != ':' || id >= GLOVE_MAX_SENSORS) return NULL;
+    p = end + 1;
+    unsigned long long t = strtoull(p, &end, 10);
+    if (end == p) return NULL;
+    *sensor = (uint8_t)id;
+    *t_us = t;
+    return end;
+}
+
+int glove_sample_parse(const char* line, glove_sample_t* s)
+{
+    float v[6];
+    const char* p = parse_head(line, &s->sensor, &s->t_us);
+    if (p == NULL) return -1;
+    p = parse_floats(p, v, 6);
+    if (p == NULL) return -1;
+    s->a[0] = v[0]; s->a[1] = v[1]; s->a[2] = v[2];
+    s->g[0] = v[3]; s->g[1] = v[4]; s->g[2] = v[5];
+    return 0;
+}
+
+int glove_truth_parse(const char* line, glove_truth_t* t)
+{
+    float v[7];
+    if (strncmp(line, "#T:", 3) != 0) return -1;
+    const char* p = parse_head(line + 3, &t->sensor, &t->t_us);
+    if (p == NULL) return -1;
+    p = parse_floats(p, v, 7);
+    if (p == NULL) return -1;
+    t->q = glove_quat(v[0], v[1], v[2], v[3]);
+    t->p = glove_vec3(v[4], v[5], v[6]);
+    return 0;
+}
+
+int glove_sample_sent_us(const char* line, uint32_t* sent_us)
+{
+    // past "sensor:t_us:ax:ay:az:gx:gy:gz"
+    const char* p = line;
+    for (int i = 0; i < 8; i++) {
+        p = strchr(p, ':');
+        if (p == NULL) return -1;
+        p++;
+    }
+    char* end;
+    unsigned long v = strtoul(p, &end, 10);
+    if (end == p) return -1;
+    *sent_us = (uint32_t)v;
+    return 0;
+}
+
+int glove_sample_format(const glove_sample_t* s, char* buf, int buf_max)
+{
+    return snprintf(buf, buf_max, "%d:%llu:%.5f:%.5f:%.5f:%.4f:%.4f:%.4f\n",
+                    s->sensor, (unsigned long long)s->t_us,
+                    s->a[0], s->a[1], s->a[2], s->g[0], s->g[1], s->g[2]);
+}
+
+uint64_t glove_clock_unwrap(uint64_t* last, uint64_t raw_us)
+{
+    const uint64_t wrap = 1ull << 32;
+    uint64_t t = raw_us;
+    if (raw_us < wrap) {    // 32 bit stamp, put it in the epoch nearest last
+        t = (*last & ~(wrap - 1)) | raw_us;
+        if (t + wrap / 2 < *last) t += wrap;                    // wrapped since
+        else if (t > *last + wrap / 2 && t >= wrap) t -= wrap;  // read before the wrap, arrived after
+    }
+    if (t > *last) *last = t;
+    return t;
+}
+
+int glove_session_add(glove_session_t* ss, const glove_sample_t* s)
+{
+    if (ss->nsamples == ss->samples_cap) {
+        int cap = ss->samples_cap ? ss->samples_cap * 2 : 1024;
+        glove_sample_t* p = (glove_sample_t*)realloc(ss->samples, cap * sizeof(glove_sample_t));
+        if (p == NULL) return -1;
+        ss->samples = p;
+        ss->samples_cap = cap;
+    }
+    ss->samples[ss->nsamples++] = *s;
+    return 0;
+}
+
+int glove_session_add_truth(glove_session_t* ss, const glove_truth_t* t)
+{
+    if (ss->ntruth == ss->truth_cap) {
+        int cap = ss->truth_cap ? ss->truth_cap * 2 : 1024;
+        glove_truth_t* p = (glove_truth_t*)realloc(ss->truth, cap * sizeof(glove_truth_t));
+        if (p == NULL) return -1;
+        ss->truth = p;
+        ss->truth_cap = cap;
+    }
+    ss->truth[ss->ntruth++] = *t;
+    return 0;
+}
+
+int glove_session_load(const char* path, glove_session_t* ss)
+{
+    char line[256];
+    glove_sample_t s;
+    glove_truth_t t;
+    uint64_t clock = 0;
+
+    memset(ss, 0, sizeof(*ss));
+    FILE* fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (fp == NULL) {
+        perror("glove_session_load: Unable to open session");
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#') {
+            if (glove_truth_parse(line, &t) == 0 && glove_session_add_truth(ss, &t) != 0)
+                break;
+            continue;
+        }
+        if (glove_sample_parse(line, &s) != 0) continue;
+        s.t_us = glove_clock_unwrap(&clock, s.t_us);
+        if (glove_session_add(ss, &s) != 0) break;
+    }
+    if (fp != stdin) fclose(fp);
+    return ss->nsamples > 0 ? 0 : -1;
+}
+
+int glove_session_write(FILE* fp, const glove_session_t* ss)
+{
+    char buf[256];
+    int ti = 0;
+    for (int i = 0; i < ss->nsamples; i++) {
+        const glove_sample_t* s = &ss->samples[i];
+        // keep truth lines just ahead of the sample they describe
+        while (ti < ss->ntruth && ss->truth[ti].t_us <= s->t_us) {
+            const glove_truth_t* t = &ss->truth[ti++];
+            fprintf(fp, "#T:%d:%llu:%.6f:%.6f:%.6f:%.6f:%.5f:%.5f:%.5f\n",
+                    t->sensor, (unsigned long long)t->t_us,
+                    t->q.w, t->q.x, t->q.y, t->q.z, t->p.x, t->p.y, t->p.z);
+        }
+        glove_sample_format(s, buf, sizeof(buf));
+        if (fputs(buf, fp) < 0) return -1;
+    }
+    return 0;
+}
+
+void glove_session_free(glove_session_t* ss)
+{
+    free(ss->samples);
+    free(ss->truth);
+    memset(ss, 0, sizeof(*ss));
+}
+
+const glove_truth_t* glove_session_truth_at(const glove_session_t* ss,
+                                            int sensor, uint64_t t_us)
+{
+    if (ss->ntruth == 0) return NULL;
+    int lo = 0, hi = ss->ntruth - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (ss->truth[mid].t_us < t_us) lo = mid + 1;
+        else hi = mid;
+    }
+    // truth rows are interleaved by sensor, look around the hit
+    const glove_truth_t* best = NULL;
+    uint64_t best_dt = 0;
+    int from = lo - 2 * GLOVE_MAX_SENSORS, to = lo + 2 * GLOVE_MAX_SENSORS;
+    if (from < 0) from = 0;
+    if (to > ss->ntruth) to = ss->ntruth;
+    for (int i = from; i < to; i++) {
+        const glove_truth_t* t = &ss->truth[i];
+        if (t->sensor != sensor) continue;
+        uint64_t dt = t->t_us > t_us ? t->t_us - t_us : t_us - t->t_us;
+        if (best == NULL || dt < best_dt) { best = t; best_dt = dt; }
+    }
+    return best;
+}
+
+int glove_session_truth_interp(const glove_session_t* ss, int sensor,
+                               uint64_t t_us, glove_quat_t* q)
+{
+    const glove_truth_t* hit = glove_session_truth_at(ss, sensor, t_us);
+    if (hit == NULL) return -1;
+    // the nearest row and its neighbour for the same sensor on the other side
+    int i = hit - ss->truth, step = hit->t_us <= t_us ? 1 : -1;
+    const glove_truth_t* other = NULL;
+    for (int j = i + step; j >= 0 && j < ss->ntruth && abs(j - i) <= 2 * GLOVE_MAX_SENSORS; j += step) {
+        if (ss->truth[j].sensor == sensor) { other = &ss->truth[j]; break; }
+    }
+    if (other == NULL || hit->t_us == t_us) {
+        *q = hit->q;
+        return 0;
+    }
+    const glove_truth_t* a = step > 0 ? hit : other;
+    const glove_truth_t* b = step > 0 ? other : hit;
+    float u = (float)(t_us - a->t_us) / (float)(b->t_us - a->t_us);
+    *q = glove_quat_slerp(a->q, b->q, u);
+    return 0;
+}
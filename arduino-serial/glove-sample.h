@@ -0,0 +1,80 @@
+//
+// glove-sample -- one IMU reading as it travels through the host pipeline
+//
+// Text form, one line per sensor read, same ':' separator the viewers use:
+//
+//   sensor:t_us:ax:ay:az:gx:gy:gz
+//
+// (sketches built with GLOVE_TRACE append ":sent_us", see glove-trace.h)
+//
+// accel in g, gyro in degrees/second (GY521 units), t_us is the capture
+// time in microseconds.  Lines starting with '#' are comments, except
+// "#T:" lines which carry ground truth for synthetic sessions:
+//
+//   #T:sensor:t_us:qw:qx:qy:qz:px:py:pz
+//
+
+
+#ifndef __GLOVE_SAMPLE_H__
+#define __GLOVE_SAMPLE_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "glove-math.h"
+
+#define GLOVE_MAX_SENSORS   12      // two hands of six
+#define GLOVE_PALM           0      // "Main" in main.ino
+
+typedef struct {
+    uint64_t t_us;          // capture time, microseconds
+    uint8_t  sensor;        // 0 = Main (palm), 1..5 = Thumb..Little
+    float    a[3];          // accelerometer, g
+    float    g[3];          // gyro, degrees/second
+} glove_sample_t;
+
+typedef struct {
+    uint64_t     t_us;
+    uint8_t      sensor;
+    glove_quat_t q;         // true orientation, body -> world
+    glove_vec3_t p;         // true position, metres
+} glove_truth_t;
+
+// a whole recording held in memory, for tools and tests
+typedef struct {
+    glove_sample_t* samples;
+    int             nsamples, samples_cap;
+    glove_truth_t*  truth;
+    int             ntruth, truth_cap;
+} glove_session_t;
+
+const char* glove_sensor_name(int sensor);
+
+// return 0 on success, -1 if the line is not a sample (or truth) line
+int glove_sample_parse(const char* line, glove_sample_t* s);
+int glove_truth_parse(const char* line, glove_truth_t* t);
+int glove_sample_format(const glove_sample_t* s, char* buf, int buf_max);
+// the optional trailing send stamp of a sample line, 32 bit micros();
+// 0, or -1 if the line has none
+int glove_sample_sent_us(const char* line, uint32_t* sent_us);
+
+// The sketch stamps reads with micros(), which wraps every 71.6 minutes.
+// Feed every stamp of a stream through this (one 'last' per stream, all
+// sensors share the Arduino's clock) to get a 64 bit monotonic time.
+uint64_t glove_clock_unwrap(uint64_t* last, uint64_t raw_us);
+
+int  glove_session_load(const char* path, glove_session_t* ss);
+int  glove_session_write(FILE* fp, const glove_session_t* ss);
+int  glove_session_add(glove_session_t* ss, const glove_sample_t* s);
+int  glove_session_add_truth(glove_session_t* ss, const glove_truth_t* t);
+void glove_session_free(glove_session_t* ss);
+
+// truth for 'sensor' nearest to t_us, NULL if the session has none
+const glove_truth_t* glove_session_truth_at(const glove_session_t* ss,
+                                            int sensor, uint64_t t_us);
+// true orientation slerped between the rows either side of t_us;
+// -1 if there is no truth for 'sensor' around t_us
+int glove_session_truth_interp(const glove_session_t* ss, int sensor,
+                               uint64_t t_us, glove_quat_t* q);
+
+#endif
@@ -0,0 +1,262 @@
+//
+// glove-shm -- fused samples in POSIX shared memory, one broker, any
+// number of readers
+//
+
+#include "glove-shm.h"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static size_t shm_size(uint32_t slots)
+{
+    return sizeof(glove_shm_header_t) + (size_t)slots * sizeof(glove_shm_slot_t);
+}
+
+int glove_shm_create(glove_shm_t* m, const char* name, uint32_t slots)
+{
+    if (!name) name = GLOVE_SHM_NAME;
+    if (slots == 0 || (slots & (slots - 1)) || strlen(name) >= sizeof(m->name)) {
+        errno = EINVAL;
+        return -1;
+    }
+    // a segment already there: a running broker's is left alone, a dead
+    // one's is unlinked.  Its readers keep their mapping, see the
+    // heartbeat stop and open the new one
+    glove_shm_t old;
+    if (glove_shm_open(&old, name) == 0) {
+        pid_t pid = old.hdr->pid;
+        glove_shm_close(&old);
+        if (kill(pid, 0) == 0 || errno == EPERM) {
+            errno = EBUSY;
+            return -1;
+        }
+    }
+    shm_unlink(name);
+
+    memset(m, 0, sizeof(*m));
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return -1;
+    size_t size = shm_size(slots);
+    if (ftruncate(fd, size) != 0) {
+        int e = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = e;
+        return -1;
+    }
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        int e = errno;
+        shm_unlink(name);
+        errno = e;
+        return -1;
+    }
+
+    // the file is zeros: head 0, every seqlock word 0, nothing published
+    m->hdr = (glove_shm_header_t*)p;
+    m->ring = (glove_shm_slot_t*)((char*)p + sizeof(glove_shm_header_t));
+    m->mask = slots - 1;
+    m->size = size;
+    m->writer = 1;
+    strcpy(m->name, name);
+    glove_shm_header_t* hdr = m->hdr;
+    hdr->version = GLOVE_SHM_VERSION;
+    hdr->slots = slots;
+    hdr->header_size = sizeof(glove_shm_header_t);
+    hdr->slot_size = sizeof(glove_shm_slot_t);
+    hdr->pid = getpid();
+    for (int i = 0; i < GLOVE_MAX_SENSORS; i++) hdr->pose.q[i] = glove_quat_identity();
+    hdr->beat_ns.store(glove_monotonic_ns(), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(hdr->magic, GLOVE_SHM_MAGIC, sizeof(hdr->magic));
+    return 0;
+}
+
+void glove_shm_publish(glove_shm_t* m, const glove_sample_t* s, const glove_frame_t* f)
+{
+    glove_shm_header_t* hdr = m->hdr;
+    uint64_t n = hdr->head.load(std::memory_order_relaxed);
+    int64_t now = glove_monotonic_ns();
+
+    // odd, then the data: a reader that sees any of the new data sees the
+    // odd word after it too
+    glove_shm_slot_t* sl = &m->ring[n & m->mask];
+    sl->seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    sl->e.n = n;
+    sl->e.pub_ns = now;
+    sl->e.s = *s;
+    sl->e.q = f->q[s->sensor];
+    sl->seq.store(2 * n + 2, std::memory_order_release);
+
+    glove_shm_pose_t* p = &hdr->pose;
+    hdr->pose_seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    int first = s->sensor / GLOVE_HAND_SENSORS * GLOVE_HAND_SENSORS;
+    for (int i = first; i < first + GLOVE_HAND_SENSORS && i < f->nsensors; i++) {
+        p->q[i] = f->q[i];
+        p->t_sensor_us[i] = f->t_sensor_us[i];
+    }
+    if (f->nsensors > p->nsensors) p->nsensors = f->nsensors;
+    p->n = n + 1;
+    p->t_us = s->t_us;
+    p->recv_ns = f->recv_ns;
+    p->pub_ns = now;
+    hdr->pose_seq.store(2 * n + 2, std::memory_order_release);
+
+    hdr->head.store(n + 1, std::memory_order_release);
+    hdr->beat_ns.store(now, std::memory_order_relaxed);
+}
+
+void glove_shm_beat(glove_shm_t* m)
+{
+    m->hdr->beat_ns.store(glove_monotonic_ns(), std::memory_order_relaxed);
+}
+
+int glove_shm_open(glove_shm_t* m, const char* name)
+{
+    if (!name) name = GLOVE_SHM_NAME;
+    memset(m, 0, sizeof(*m));
+    if (strlen(name) >= sizeof(m->name)) {
+        errno = EINVAL;
+        return -1;
+    }
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return -1;
+    struct stat st;
+    glove_shm_header_t* hdr = NULL;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(glove_shm_header_t)) {
+        void* p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) hdr = (glove_shm_header_t*)p;
+    }
+    close(fd);
+    if (!hdr) {
+        errno = EPROTO;
+        return -1;
+    }
+    int ok = memcmp(hdr->magic, GLOVE_SHM_MAGIC, sizeof(hdr->magic)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    ok = ok && hdr->version == GLOVE_SHM_VERSION && hdr->slots && !(hdr->slots & (hdr->slots - 1))
+            && hdr->header_size == sizeof(glove_shm_header_t) && hdr->slot_size == sizeof(glove_shm_slot_t)
+            && (size_t)st.st_size == shm_size(hdr->slots);
+    if (!ok) {
+        munmap(hdr, st.st_size);
+        errno = EPROTO;
+        return -1;
+    }
+    m->hdr = hdr;
+    m->ring = (glove_shm_slot_t*)((char*)hdr + sizeof(glove_shm_header_t));
+    m->mask = hdr->slots - 1;
+    m->size = st.st_size;
+    strcpy(m->name, name);
+    return 0;
+}
+
+void glove_shm_close(glove_shm_t* m)
+{
+    if (!m->hdr) return;
+    munmap(m->hdr, m->size);
+    if (m->writer) shm_unlink(m->name);
+    m->hdr = NULL;
+}
+
+uint64_t glove_shm_head(const glove_shm_t* m)
+{
+    return m->hdr->head.load(std::memory_order_acquire);
+}
+
+int64_t glove_shm_idle_ns(const glove_shm_t* m)
+{
+    return glove_monotonic_ns() - m->hdr->beat_ns.load(std::memory_order_relaxed);
+}
+
+//
+// readers: load the word, copy, load it again.  The copy races the
+// writer by design; the second load says whether it won
+//
+
+int glove_shm_latest(const glove_shm_t* m, glove_shm_pose_t* p)
+{
+    const glove_shm_header_t* hdr = m->hdr;
+    for (int tries = 0; ; tries++) {
+        uint64_t a = hdr->pose_seq.load(std::memory_order_acquire);
+        if (a == 0) return 0;
+        if (!(a & 1)) {
+            memcpy(p, &hdr->pose, sizeof(*p));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (hdr->pose_seq.load(std::memory_order_relaxed) == a) return 1;
+        }
+        // a broker that died mid-write leaves the word odd for good
+        if (tries == GLOVE_SHM_TRIES) return glove_shm_idle_ns(m) > GLOVE_SHM_STALE_NS ? -1 : 0;
+    }
+}
+
+const glove_shm_entry_t* glove_shm_peek(const glove_shm_t* m, uint64_t n)
+{
+    const glove_shm_slot_t* sl = &m->ring[n & m->mask];
+    return sl->seq.load(std::memory_order_acquire) == 2 * n + 2 ? &sl->e : NULL;
+}
+
+int glove_shm_held(const glove_shm_t* m, uint64_t n)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m->ring[n & m->mask].seq.load(std::memory_order_relaxed) == 2 * n + 2;
+}
+
+int glove_shm_read(const glove_shm_t* m, uint64_t from, glove_shm_entry_t* out, int max, uint64_t* next)
+{
+    uint64_t head = glove_shm_head(m);
+    uint64_t oldest = head > m->mask + 1 ? head - (m->mask + 1) : 0;
+    if (from < oldest) from = oldest;
+    int k = 0;
+    // a slot overwritten since head was read fails its check and is skipped
+    for (; k < max && from < head; from++) {
+        const glove_shm_entry_t* e = glove_shm_peek(m, from);
+        if (!e) continue;
+        out[k] = *e;
+        if (glove_shm_held(m, from)) k++;
+    }
+    *next = from;
+    return k;
+}
+
+int glove_shm_poll(glove_shm_t* m, int timeout_ms, glove_handoff_t* h)
+{
+    int64_t start = glove_monotonic_ns(), end = start + (int64_t)timeout_ms * 1000000;
+    for (;;) {
+        glove_shm_pose_t p;
+        int got = glove_shm_head(m) != m->seen ? glove_shm_latest(m, &p) : 0;
+        if (got < 0) return -1;
+        if (got && p.n != m->seen) {
+            glove_frame_t* f = glove_handoff_back(h);
+            memset(&f->trace, 0, sizeof(f->trace));
+            f->seq = (uint32_t)p.n;
+            f->t_us = p.t_us;
+            f->recv_ns = p.recv_ns;
+            f->nsensors = p.nsensors;
+            memcpy(f->q, p.q, sizeof(f->q));
+            memcpy(f->t_sensor_us, p.t_sensor_us, sizeof(f->t_sensor_us));
+            glove_handoff_publish(h);
+            int fed = (int)(p.n - m->seen);
+            m->seen = p.n;
+            return fed;
+        }
+        int64_t now = glove_monotonic_ns();
+        if (glove_shm_idle_ns(m) > GLOVE_SHM_STALE_NS) return -1;
+        if (now >= end) return 0;
+        // the next sample is usually milliseconds off: spin briefly, then
+        // sleep in steps short enough not to add to its age
+        if (now - start < GLOVE_SHM_SPIN_NS) continue;
+        int64_t nap = end - now < 500000 ? end - now : 500000;
+        struct timespec ts = { 0, (long)nap };
+        nanosleep(&ts, NULL);
+    }
+}
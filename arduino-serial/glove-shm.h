@@ -0,0 +1,148 @@
+//
+// glove-shm -- one glove, any number of local readers: fused samples in
+// POSIX shared memory
+//
+// A tty has one reader.  The broker (glove-tool broker) owns the serial
+// ports, runs the reader every viewer runs (glove-stream) and publishes
+// what it makes into a shared memory segment, /dev/shm/glove by default:
+//
+//   header     magic, layout sizes, the broker's pid and heartbeat, and
+//              head, the number of samples published so far
+//   pose       the newest frame: every sensor's fused, yaw corrected
+//              orientation, as glove_handoff_latest() would give it
+//   ring       the last SLOTS samples, each as decoded plus its sensor's
+//              orientation after it; sample n sits in slot n % SLOTS
+//
+// The broker is the only writer and clients map the segment read-only, so
+// a client can't hurt the broker or another client.  Nothing waits on
+// anything: the pose and every slot carry a seqlock word, 2n+1 while
+// sample n is written into it and 2n+2 once it is complete.  A reader
+// loads the word, reads, and loads it again; the read is good if both
+// loads are the 2n+2 it wanted.  Anything else was torn, not written yet
+// or already overwritten, and it reads again or moves on.  A slow client
+// loses samples that fell off the ring, never slows the broker.
+//
+// After glove_shm_open() a client makes no system calls and no copies
+// through the kernel: glove_shm_latest() and glove_shm_read() copy out of
+// the mapping into the caller's struct (the copy is what the seqlock
+// checks), glove_shm_peek() and glove_shm_held() read in place.  Only
+// waiting for the next sample sleeps, in glove_shm_poll().
+//
+// glove_shm_poll() is the drop-in for glove_stream_poll() in a viewer: it
+// puts the broker's pose into the viewer's handoff.  Fusion and yaw have
+// been done by the broker, once for everyone.
+//
+// Writer and readers must be built from the same glove-shm.h; the header
+// holds the sizes and glove_shm_open() refuses a segment that differs.
+// CLOCK_MONOTONIC is one clock for every process, so the broker's stamps
+// (recv_ns, pub_ns) compare with a reader's glove_monotonic_ns().
+//
+
+
+#ifndef __GLOVE_SHM_H__
+#define __GLOVE_SHM_H__
+
+#include <stddef.h>
+#include <atomic>
+
+#include "glove-stream.h"
+
+#define GLOVE_SHM_NAME          "/glove"
+#define GLOVE_SHM_MAGIC         "GLOVESHM"
+#define GLOVE_SHM_VERSION       1
+#define GLOVE_SHM_SLOTS         8192    // default ring, a power of two: 0.7 s of 12 sensors at 1 kHz
+#define GLOVE_SHM_BEAT_NS       100000000   // an idle broker still beats this often
+#define GLOVE_SHM_STALE_NS      1000000000  // no beat for this long: the broker is gone
+#define GLOVE_SHM_SPIN_NS       50000   // glove_shm_poll() spins this long before it sleeps
+#define GLOVE_SHM_TRIES         1000    // glove_shm_latest() reads a pose being written this often
+
+// the newest frame, a glove_frame_t without the trace
+typedef struct {
+    uint64_t     n;                     // samples published up to it
+    uint64_t     t_us;                  // newest sample's capture time
+    int64_t      recv_ns;               // when the broker read it
+    int64_t      pub_ns;                // when the broker published it
+    int          nsensors;
+    glove_quat_t q[GLOVE_MAX_SENSORS];  // body -> world, yaw corrected
+    uint64_t     t_sensor_us[GLOVE_MAX_SENSORS];
+} glove_shm_pose_t;
+
+// one sample of the ring, as a reader gets it
+typedef struct {
+    uint64_t       n;                   // its number, from 0
+    int64_t        pub_ns;
+    glove_sample_t s;                   // as decoded
+    glove_quat_t   q;                   // s.sensor's orientation after it, yaw corrected
+} glove_shm_entry_t;
+
+// in the segment
+typedef struct {
+    std::atomic<uint64_t> seq;          // seqlock word
+    glove_shm_entry_t     e;
+} glove_shm_slot_t;
+
+typedef struct {
+    char     magic[8];                  // GLOVE_SHM_MAGIC, written last
+    uint32_t version;
+    uint32_t slots;
+    uint32_t header_size, slot_size;    // as the broker was built
+    int32_t  pid;                       // the broker's
+    uint32_t reserved;
+    alignas(64) std::atomic<uint64_t> head; // samples published
+    std::atomic<int64_t>  beat_ns;      // broker's last publish or idle beat
+    alignas(64) std::atomic<uint64_t> pose_seq;
+    glove_shm_pose_t      pose;
+} glove_shm_header_t;
+
+struct glove_shm {
+    glove_shm_header_t* hdr;
+    glove_shm_slot_t*   ring;
+    uint32_t            mask;           // slots - 1
+    size_t              size;           // of the mapping
+    int                 writer;         // 1 for the broker
+    char                name[64];
+    uint64_t            seen;           // glove_shm_poll(): pose n last handed on
+};
+typedef struct glove_shm glove_shm_t;
+
+// broker: create the segment name (GLOVE_SHM_NAME if NULL) with slots ring
+// entries, a power of two.  A segment left by a broker that died is
+// replaced; -1 with errno EBUSY if its broker is still running
+int  glove_shm_create(glove_shm_t* m, const char* name, uint32_t slots);
+// one sample fed and the frame it made (glove_stream_feed() does this with
+// st->shm set); only the sample's hand of the pose is updated, so brokers
+// of two ports, one hand each, fill one pose
+void glove_shm_publish(glove_shm_t* m, const glove_sample_t* s, const glove_frame_t* f);
+// broker with nothing to publish: tell readers it is still there
+void glove_shm_beat(glove_shm_t* m);
+
+// client: map a broker's segment read-only; -1 if there is none (errno
+// ENOENT), or it isn't a glove segment of this build (EPROTO)
+int  glove_shm_open(glove_shm_t* m, const char* name);
+// both: unmap; the broker also removes the name
+void glove_shm_close(glove_shm_t* m);
+
+// samples published so far; the newest is head - 1
+uint64_t glove_shm_head(const glove_shm_t* m);
+// nanoseconds since the broker last published or beat
+int64_t  glove_shm_idle_ns(const glove_shm_t* m);
+
+// the newest pose: 1, or 0 before the first sample or if the broker
+// stayed mid-write for GLOVE_SHM_TRIES reads; -1 if it did and has gone
+// quiet for GLOVE_SHM_STALE_NS
+int  glove_shm_latest(const glove_shm_t* m, glove_shm_pose_t* p);
+// up to max samples from number from on, oldest first: returns how many
+// and sets *next to the number to ask for next time.  Samples the ring
+// has dropped are skipped; out[0].n says where it really started
+int  glove_shm_read(const glove_shm_t* m, uint64_t from, glove_shm_entry_t* out, int max, uint64_t* next);
+// zero copy: sample n in place, NULL if the ring doesn't hold it; what was
+// read from it is sample n only if glove_shm_held() still says 1 after
+const glove_shm_entry_t* glove_shm_peek(const glove_shm_t* m, uint64_t n);
+int  glove_shm_held(const glove_shm_t* m, uint64_t n);
+
+// viewer: wait up to timeout_ms for a newer pose and publish it into h as
+// a frame; returns the samples it covers, 0 on timeout, -1 once the broker
+// has gone quiet for GLOVE_SHM_STALE_NS
+int  glove_shm_poll(glove_shm_t* m, int timeout_ms, glove_handoff_t* h);
+
+#endif
@@ -0,0 +1,262 @@
+//
+// glove-skin -- both hands as one rigidly skinned mesh
+//
+
+#include "glove-skin.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// unit sphere: (stacks+1) rings of slices+1 vertices
+static void build_sphere(float* v, int slices, int stacks)
+{
+    for (int i = 0; i <= stacks; i++) {
+        float phi = GLOVE_PI * i / stacks;
+        for (int j = 0; j <= slices; j++, v += 6) {
+            float th = 2 * GLOVE_PI * j / slices;
+            v[0] = v[3] = sinf(phi) * cosf(th);
+            v[1] = v[4] = cosf(phi);
+            v[2] = v[5] = sinf(phi) * sinf(th);
+        }
+    }
+}
+
+static int sphere_indices(unsigned short* idx, int base, int slices, int stacks)
+{
+    int n = 0;
+    for (int i = 0; i < stacks; i++)
+        for (int j = 0; j < slices; j++) {
+            int a = base + i * (slices + 1) + j, b = a + slices + 1;
+            unsigned short t[6] = { (unsigned short)a, (unsigned short)(a + 1), (unsigned short)b,
+                                    (unsigned short)b, (unsigned short)(a + 1), (unsigned short)(b + 1) };
+            memcpy(idx + n, t, sizeof(t));
+            n += 6;
+        }
+    return n;
+}
+
+// unit cylinder, radius 1, y 0..1: side ring pairs, then the two caps
+static void build_cylinder(float* v, int slices)
+{
+    for (int j = 0; j <= slices; j++) {
+        float th = 2 * GLOVE_PI * j / slices, c = cosf(th), s = sinf(th);
+        float r[12] = { c, 0, s, c, 0, s,  c, 1, s, c, 0, s };
+        memcpy(v, r, sizeof(r));
+        v += 12;
+    }
+    for (int cap = 0; cap < 2; cap++) {
+        float y = (float)cap, ny = cap ? 1.0f : -1.0f;
+        float centre[6] = { 0, y, 0, 0, ny, 0 };
+        memcpy(v, centre, sizeof(centre));
+        v += 6;
+        for (int j = 0; j <= slices; j++, v += 6) {
+            float th = 2 * GLOVE_PI * j / slices;
+            float r[6] = { cosf(th), y, sinf(th), 0, ny, 0 };
+            memcpy(v, r, sizeof(r));
+        }
+    }
+}
+
+static int cylinder_indices(unsigned short* idx, int base, int slices)
+{
+    int n = 0;
+    for (int j = 0; j < slices; j++) {
+        int a = base + j * 2;
+        unsigned short t[6] = { (unsigned short)a, (unsigned short)(a + 2), (unsigned short)(a + 1),
+                                (unsigned short)(a + 1), (unsigned short)(a + 2), (unsigned short)(a + 3) };
+        memcpy(idx + n, t, sizeof(t));
+        n += 6;
+    }
+    for (int cap = 0; cap < 2; cap++) {
+        int centre = base + (slices + 1) * 2 + cap * (slices + 2);
+        for (int j = 0; j < slices; j++) {
+            int a = centre + 1 + j;
+            unsigned short t[3] = { (unsigned short)centre, (unsigned short)(cap ? a + 1 : a),
+                                    (unsigned short)(cap ? a : a + 1) };
+            memcpy(idx + n, t, sizeof(t));
+            n += 3;
+        }
+    }
+    return n;
+}
+
+int glove_skin_init(glove_skin_t* sk, int flags, int slices)
+{
+    memset(sk, 0, sizeof(*sk));
+    if (slices <= 0) slices = GLOVE_SKIN_SLICES;
+    if (slices < 3) slices = 3;
+    int stacks = slices * 2 / 3;
+    sk->flags = flags;
+    sk->min_change = GLOVE_SKIN_MIN_CHANGE;
+    sk->slices = slices;
+    sk->stacks = stacks;
+    sk->sphere_verts = (stacks + 1) * (slices + 1);
+    sk->cylinder_verts = (slices + 1) * 2 + (slices + 2) * 2;
+    int sphere_idx = stacks * slices * 6;
+    int cylinder_idx = slices * 6 + slices * 3 * 2;
+
+    sk->nverts = GLOVE_SKIN_HANDS * (GLOVE_KIN_BONES * sk->cylinder_verts + GLOVE_KIN_JOINTS * sk->sphere_verts);
+    sk->nindices = GLOVE_SKIN_HANDS * (GLOVE_KIN_BONES * cylinder_idx + GLOVE_KIN_JOINTS * sphere_idx);
+    sk->sphere = (float*)malloc(sk->sphere_verts * 6 * sizeof(float));
+    sk->cylinder = (float*)malloc(sk->cylinder_verts * 6 * sizeof(float));
+    sk->indices = (unsigned short*)malloc(sk->nindices * sizeof(unsigned short));
+    if (!sk->sphere || !sk->cylinder || !sk->indices || sk->nverts > 65536) {
+        glove_skin_free(sk);
+        return -1;
+    }
+    build_sphere(sk->sphere, slices, stacks);
+    build_cylinder(sk->cylinder, slices);
+
+    int v = 0, n = 0;
+    for (int h = 0; h < GLOVE_SKIN_HANDS; h++)
+        for (int k = 0; k < GLOVE_SKIN_PARTS; k++) {
+            sk->first[h * GLOVE_SKIN_PARTS + k] = v;
+            if (k < GLOVE_KIN_BONES) {
+                n += cylinder_indices(sk->indices + n, v, slices);
+                v += sk->cylinder_verts;
+            } else {
+                n += sphere_indices(sk->indices + n, v, slices, stacks);
+                v += sk->sphere_verts;
+            }
+        }
+    // swapping two axes mirrors the mesh, so the winding flips with it
+    if (flags & GLOVE_SKIN_Y_UP)
+        for (int i = 0; i < n; i += 3) {
+            unsigned short t = sk->indices[i + 1];
+            sk->indices[i + 1] = sk->indices[i + 2];
+            sk->indices[i + 2] = t;
+        }
+    return 0;
+}
+
+void glove_skin_free(glove_skin_t* sk)
+{
+    free(sk->sphere);
+    free(sk->cylinder);
+    free(sk->indices);
+    memset(sk, 0, sizeof(*sk));
+}
+
+void glove_skin_invalidate(glove_skin_t* sk)
+{
+    memset(sk->valid, 0, sizeof(sk->valid));
+}
+
+static int moved(const glove_skin_t* sk, int part, glove_vec3_t p, glove_quat_t q, glove_vec3_t size)
+{
+    if (!sk->valid[part]) return 1;
+    float e = sk->min_change;
+    glove_vec3_t dp = glove_vec3_sub(p, sk->last_p[part]);
+    glove_vec3_t ds = glove_vec3_sub(size, sk->last_size[part]);
+    glove_quat_t lq = sk->last_q[part];
+    return fabsf(dp.x) > e || fabsf(dp.y) > e || fabsf(dp.z) > e ||
+           fabsf(ds.x) > e || fabsf(ds.y) > e || fabsf(ds.z) > e ||
+           fabsf(q.w - lq.w) > e || fabsf(q.x - lq.x) > e ||
+           fabsf(q.y - lq.y) > e || fabsf(q.z - lq.z) > e;
+}
+
+// the unit mesh through a column-major model matrix; normals through its
+// inverse transpose, which for rotation * scale is column j / |column j|^2;
+// the box round the positions written into lo, hi
+static void transform(const float* unit, int n, const float m[16], int swap_yz,
+                      char* out, size_t stride, size_t pos_offset, size_t normal_offset,
+                      float lo[3], float hi[3])
+{
+    lo[0] = lo[1] = lo[2] = HUGE_VALF;
+    hi[0] = hi[1] = hi[2] = -HUGE_VALF;
+    float inv[3];
+    for (int j = 0; j < 3; j++) {
+        float l2 = m[j * 4] * m[j * 4] + m[j * 4 + 1] * m[j * 4 + 1] + m[j * 4 + 2] * m[j * 4 + 2];
+        inv[j] = l2 > 0 ? 1.0f / l2 : 0;
+    }
+    int y = swap_yz ? 2 : 1, z = swap_yz ? 1 : 2;
+    for (int i = 0; i < n; i++, unit += 6, out += stride) {
+        float* p = (float*)(out + pos_offset);
+        float* nr = (float*)(out + normal_offset);
+        p[0] = m[0] * unit[0] + m[4] * unit[1] + m[8]  * unit[2] + m[12];
+        p[y] = m[1] * unit[0] + m[5] * unit[1] + m[9]  * unit[2] + m[13];
+        p[z] = m[2] * unit[0] + m[6] * unit[1] + m[10] * unit[2] + m[14];
+        for (int k = 0; k < 3; k++) {
+            if (p[k] < lo[k]) lo[k] = p[k];
+            if (p[k] > hi[k]) hi[k] = p[k];
+        }
+        float a = unit[3] * inv[0], b = unit[4] * inv[1], c = unit[5] * inv[2];
+        float nx = m[0] * a + m[4] * b + m[8]  * c;
+        float ny = m[1] * a + m[5] * b + m[9]  * c;
+        float nz = m[2] * a + m[6] * b + m[10] * c;
+        float l = sqrtf(nx * nx + ny * ny + nz * nz);
+        l = l > 0 ? 1.0f / l : 0;
+        nr[0] = nx * l;
+        nr[y] = ny * l;
+        nr[z] = nz * l;
+    }
+}
+
+int glove_skin_update(glove_skin_t* sk, const glove_hand_pose_t* hands, int nhands,
+                      void* verts, size_t stride, size_t pos_offset, size_t normal_offset,
+                      glove_skin_stats_t* stats)
+{
+    glove_skin_stats_t st = { 0, 0, 0, 0 };
+    int swap = sk->flags & GLOVE_SKIN_Y_UP;
+    float m[16];
+    if (nhands > GLOVE_SKIN_HANDS) nhands = GLOVE_SKIN_HANDS;
+    if (!sk->sphere) nhands = 0;
+
+    for (int h = 0; h < nhands; h++)
+        for (int k = 0; k < GLOVE_SKIN_PARTS; k++) {
+            int part = h * GLOVE_SKIN_PARTS + k;
+            glove_vec3_t p, size;
+            glove_quat_t q;
+            if (k < GLOVE_KIN_BONES) {
+                const glove_bone_t* b = &hands[h].bones[k];
+                p = b->p;
+                q = b->q;
+                size = b->size;
+            } else {
+                float r = hands[h].joint_radius[k - GLOVE_KIN_BONES];
+                p = hands[h].joints[k - GLOVE_KIN_BONES];
+                q = glove_quat_identity();
+                size = glove_vec3(r, r, r);
+            }
+            if (!moved(sk, part, p, q, size)) continue;
+
+            int n;
+            const float* unit;
+            if (k < GLOVE_KIN_BONES) {
+                glove_kin_bone_matrix(&hands[h].bones[k], m);
+                unit = sk->cylinder;
+                n = sk->cylinder_verts;
+            } else {
+                glove_kin_joint_matrix(p, size.x, m);
+                unit = sk->sphere;
+                n = sk->sphere_verts;
+            }
+            int first = sk->first[part];
+            transform(unit, n, m, swap, (char*)verts + first * stride, stride, pos_offset, normal_offset,
+                      sk->lo[part], sk->hi[part]);
+            sk->last_p[part] = p;
+            sk->last_q[part] = q;
+            sk->last_size[part] = size;
+            sk->valid[part] = 1;
+
+            if (st.parts++ == 0) st.first_vert = first;
+            st.end_vert = first + n;
+            st.verts += n;
+        }
+    if (stats) *stats = st;
+    return st.parts;
+}
+
+int glove_skin_bounds(const glove_skin_t* sk, float lo[3], float hi[3])
+{
+    int any = 0;
+    for (int part = 0; part < GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS; part++) {
+        if (!sk->valid[part]) continue;
+        for (int k = 0; k < 3; k++) {
+            if (!any || sk->lo[part][k] < lo[k]) lo[k] = sk->lo[part][k];
+            if (!any || sk->hi[part][k] > hi[k]) hi[k] = sk->hi[part][k];
+        }
+        any = 1;
+    }
+    return any ? 0 : -1;
+}
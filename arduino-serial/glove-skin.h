@@ -0,0 +1,85 @@
+//
+// glove-skin -- both hands as one rigidly skinned mesh
+//
+// A scene graph with a node per bone and joint has to walk and recompute
+// 74 absolute transforms for two hands every frame, moved or not.
+// glove-skin keeps the hands as a single vertex array instead: every
+// bone (a unit cylinder, as glove-kinematics draws it) and joint (a unit
+// sphere) owns a fixed range of vertices.  glove_skin_update() rewrites
+// only the ranges whose part moved since it last wrote them, straight into
+// the caller's vertex buffer, so a viewer uploads one buffer and draws
+// one mesh for both hands.
+//
+// Vertices are written with any stride, as a position and a normal of
+// three floats each.  The output frame is glove-kinematics' (right
+// handed, Z up) or, with GLOVE_SKIN_Y_UP, Y and Z swapped for left
+// handed Y up viewers such as Irrlicht.
+//
+
+
+#ifndef __GLOVE_SKIN_H__
+#define __GLOVE_SKIN_H__
+
+#include <stddef.h>
+
+#include "glove-kinematics.h"
+
+#define GLOVE_SKIN_HANDS        2
+#define GLOVE_SKIN_PARTS        (GLOVE_KIN_BONES + GLOVE_KIN_JOINTS)    // per hand
+#define GLOVE_SKIN_SLICES       12      // default detail; spheres get 2/3 as many stacks
+#define GLOVE_SKIN_MIN_CHANGE   1e-5f   // metres, and quaternion components
+
+#define GLOVE_SKIN_Y_UP         1       // flag: write (x, z, y)
+
+typedef struct {
+    int   flags;
+    int   slices, stacks;               // detail of the unit meshes
+    float min_change;                   // smaller moves leave a part alone
+    int   nverts;                       // whole mesh, both hands
+    int   nindices;
+    unsigned short* indices;            // triangles, counter-clockwise outside
+                                        // in the output frame
+
+    // per part, hand by hand: bones then joints
+    int          first[GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS];
+    glove_vec3_t last_p[GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS];
+    glove_quat_t last_q[GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS];
+    glove_vec3_t last_size[GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS];
+    int          valid[GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS];
+    float        lo[GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS][3];    // bounds as last
+    float        hi[GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS][3];    // written, output frame
+
+    // the unit meshes, position then normal
+    int    sphere_verts, cylinder_verts;
+    float* sphere;
+    float* cylinder;
+} glove_skin_t;
+
+// what one glove_skin_update() did
+typedef struct {
+    int parts;                          // parts rewritten
+    int verts;                          // vertices rewritten
+    int first_vert, end_vert;           // the range they span, empty if none
+} glove_skin_stats_t;
+
+// builds the index buffer and part layout with round parts cut into
+// slices (0 for GLOVE_SKIN_SLICES); 0, or -1 out of memory or past 65536
+// vertices, sk then as glove_skin_free() leaves it
+int  glove_skin_init(glove_skin_t* sk, int flags, int slices);
+// empty: no vertices, and updates write nothing
+void glove_skin_free(glove_skin_t* sk);
+// the next update rewrites every part
+void glove_skin_invalidate(glove_skin_t* sk);
+
+// write the parts of hands[0..nhands) that moved into verts, sk->nverts
+// vertices of stride bytes with the position at pos_offset and the normal
+// at normal_offset; returns the number of parts written
+int  glove_skin_update(glove_skin_t* sk, const glove_hand_pose_t* hands, int nhands,
+                       void* verts, size_t stride, size_t pos_offset, size_t normal_offset,
+                       glove_skin_stats_t* stats);
+// the box around every part written so far, in the output frame, from
+// the part bounds kept by the updates rather than a pass over the
+// vertices; 0, or -1 if nothing has been written
+int  glove_skin_bounds(const glove_skin_t* sk, float lo[3], float hi[3]);
+
+#endif
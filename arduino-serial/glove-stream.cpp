@@ -0,0 +1,232 @@
+//
+// glove-stream -- live glove lines to fused hand orientations
+//
+
+#include "glove-stream.h"
+#include "glove-shm.h"
+
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#define GLOVE_HANDOFF_FRESH     4
+
+int64_t glove_monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void glove_handoff_init(glove_handoff_t* h)
+{
+    memset(h->slot, 0, sizeof(h->slot));
+    h->back = 0;
+    h->middle.store(1);
+    h->front = 2;
+    for (int i = 0; i < GLOVE_HANDOFF_SAMPLES; i++) h->sample_seq[i].store(0);
+}
+
+glove_frame_t* glove_handoff_back(glove_handoff_t* h)
+{
+    return &h->slot[h->back];
+}
+
+void glove_handoff_publish(glove_handoff_t* h)
+{
+    // release the filled slot, take whichever the reader isn't holding
+    h->back = h->middle.exchange(h->back | GLOVE_HANDOFF_FRESH, std::memory_order_acq_rel)
+              & ~GLOVE_HANDOFF_FRESH;
+}
+
+void glove_handoff_note(glove_handoff_t* h, int sensor)
+{
+    const glove_frame_t* f = &h->slot[h->back];
+    int i = f->seq & (GLOVE_HANDOFF_SAMPLES - 1);
+    h->sample_seq[i].store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    glove_handoff_sample_t* e = &h->sample[i];
+    e->seq = f->seq;
+    e->sensor = sensor;
+    e->t_us = f->t_sensor_us[sensor];
+    e->recv_ns = f->recv_ns;
+    e->q = f->q[sensor];
+    h->sample_seq[i].store(f->seq, std::memory_order_release);
+}
+
+int glove_handoff_samples(glove_handoff_t* h, uint32_t after, uint32_t upto,
+                          glove_handoff_sample_t* out, int max)
+{
+    if (upto - after > GLOVE_HANDOFF_SAMPLES) after = upto - GLOVE_HANDOFF_SAMPLES;
+    int k = 0;
+    // as glove_shm_read(): a slot overwritten while copied fails the recheck
+    for (uint32_t n = after + 1; k < max && n - after <= upto - after; n++) {
+        int i = n & (GLOVE_HANDOFF_SAMPLES - 1);
+        if (n == 0 || h->sample_seq[i].load(std::memory_order_acquire) != n) continue;
+        out[k] = h->sample[i];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (h->sample_seq[i].load(std::memory_order_relaxed) == n) k++;
+    }
+    return k;
+}
+
+int glove_handoff_latest(glove_handoff_t* h, const glove_frame_t** f)
+{
+    int fresh = 0;
+    if (h->middle.load(std::memory_order_relaxed) & GLOVE_HANDOFF_FRESH) {
+        h->front = h->middle.exchange(h->front, std::memory_order_acq_rel) & ~GLOVE_HANDOFF_FRESH;
+        fresh = 1;
+    }
+    *f = &h->slot[h->front];
+    return fresh;
+}
+
+void glove_stream_init(glove_stream_t* st)
+{
+    glove_yaw_params_t par;
+    memset(st, 0, sizeof(*st));
+    glove_yaw_defaults(&par);
+    for (int i = 0; i < GLOVE_MAX_SENSORS; i++) {
+        glove_fusion_init(&st->fusion[i], GLOVE_FUSION_ALPHA);
+        st->cur.q[i] = glove_quat_identity();
+    }
+    for (int k = 0; k < GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS; k++) {
+        glove_align_init(&st->align[k], GLOVE_HAND_SENSORS);
+        glove_yaw_init(&st->yaw[k], &par, GLOVE_HAND_SENSORS);
+    }
+}
+
+void glove_stream_recenter(glove_stream_t* st)
+{
+    for (int k = 0; k < GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS; k++)
+        glove_yaw_init(&st->yaw[k], &st->yaw[k].par, GLOVE_HAND_SENSORS);
+}
+
+void glove_stream_feed(glove_stream_t* st, const glove_sample_t* s, glove_handoff_t* h)
+{
+    if (s->sensor >= GLOVE_MAX_SENSORS) return;
+    int64_t fuse_ns = st->metrics && st->fused++ % GLOVE_METRICS_FUSION_EVERY == 0 ? glove_monotonic_ns() : 0;
+    glove_fusion_update(&st->fusion[s->sensor], s);
+    st->cur.q[s->sensor] = st->fusion[s->sensor].q;
+    st->cur.t_sensor_us[s->sensor] = s->t_us;
+    if (s->sensor >= st->cur.nsensors) st->cur.nsensors = s->sensor + 1;
+    st->cur.t_us = s->t_us;
+    st->cur.recv_ns = glove_monotonic_ns();
+    st->cur.seq++;
+
+    // traced: a sample fed without glove_stream_poll() (a replay) arrives
+    // and is parsed now
+    glove_trace_span_t sp;
+    if (st->trace) {
+        sp = st->span;
+        if (!sp.t[GLOVE_TRACE_ARRIVE]) {
+            sp.t[GLOVE_TRACE_ARRIVE] = sp.t[GLOVE_TRACE_PARSE] = glove_monotonic_ns();
+            glove_trace_glove(st->trace, &sp, s->t_us, 0);
+        }
+        sp.id = st->cur.seq;
+        sp.sensor = s->sensor;
+        memset(st->span.t, 0, sizeof(st->span.t));
+    }
+
+    // yaw sees the sample's hand once per aligned frame, every sensor at
+    // the newest time they have all reached; its offsets carry the
+    // correction and the fused orientations stay raw
+    int hand = s->sensor / GLOVE_HAND_SENSORS;
+    glove_sample_t hs = *s;
+    hs.sensor = s->sensor % GLOVE_HAND_SENSORS;
+    glove_align_update(&st->align[hand], &hs, st->cur.q[s->sensor]);
+    uint64_t frame_us = glove_align_frame_time(&st->align[hand]);
+    glove_quat_t aligned[GLOVE_HAND_SENSORS];
+    if (frame_us > st->yaw[hand].last_us && glove_align_resample(&st->align[hand], frame_us, aligned) == 0)
+        glove_yaw_update(&st->yaw[hand], frame_us, aligned);
+
+    glove_frame_t* f = glove_handoff_back(h);
+    *f = st->cur;
+    for (int k = 0; k < GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS; k++) {
+        const glove_yaw_t* y = &st->yaw[k];
+        for (int i = 1; i < GLOVE_HAND_SENSORS && k * GLOVE_HAND_SENSORS + i < f->nsensors; i++) {
+            glove_quat_t* q = &f->q[k * GLOVE_HAND_SENSORS + i];
+            *q = glove_quat_mul(glove_quat_axis_angle(glove_vec3(0, 0, 1), -y->offset[i]), *q);
+        }
+    }
+    if (st->trace) {
+        sp.t[GLOVE_TRACE_FUSE] = glove_monotonic_ns();
+        f->trace = sp;
+    }
+    if (fuse_ns) glove_metrics_observe(st->metrics, GLOVE_METRIC_FUSION, glove_monotonic_ns() - fuse_ns);
+    if (st->metrics) glove_metrics_add(st->metrics, GLOVE_METRIC_SAMPLES, 1);
+    if (st->shm) glove_shm_publish(st->shm, s, f);
+    glove_handoff_note(h, s->sensor);
+    glove_handoff_publish(h);
+    if (st->trace) glove_trace_sample(st->trace, &sp);
+}
+
+int glove_stream_poll(glove_stream_t* st, int fd, int timeout_ms, glove_handoff_t* h)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    int rc = poll(&pfd, 1, timeout_ms);
+    if (rc < 0) return errno == EINTR ? 0 : -1;
+    if (rc == 0) return 0;
+
+    char chunk[512];
+    int n = read(fd, chunk, sizeof(chunk));
+    if (n < 0) return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    if (n == 0) return -1;
+    int64_t arrive = st->trace ? glove_monotonic_ns() : 0;
+    if (st->metrics) {
+        // a short read emptied the driver; only a full one leaves a backlog
+        int queued = 0;
+        if (n == (int)sizeof(chunk)) ioctl(fd, FIONREAD, &queued);
+        glove_metrics_set(st->metrics, GLOVE_METRIC_QUEUE, queued);
+    }
+
+    int fed = 0;
+    for (int i = 0; i < n; i++) {
+        char c = chunk[i];
+        if (c != '\n') {
+            if (st->len < GLOVE_STREAM_LINE_MAX - 1) st->buf[st->len++] = c;
+            else st->len = GLOVE_STREAM_LINE_MAX;       // too long, drop it
+            continue;
+        }
+        if (st->len < GLOVE_STREAM_LINE_MAX) {
+            glove_sample_t s;
+            st->buf[st->len] = 0;
+            if (glove_sample_parse(st->buf, &s) == 0 && s.sensor + st->sensor_base < GLOVE_MAX_SENSORS) {
+                s.sensor += st->sensor_base;
+                s.t_us = glove_clock_unwrap(&st->clock, s.t_us);
+                if (st->trace) {
+                    // the send stamp wraps with micros() too, just after capture
+                    uint32_t sent;
+                    uint64_t sent_us = glove_sample_sent_us(st->buf, &sent) == 0
+                                       ? s.t_us + (uint32_t)(sent - (uint32_t)s.t_us) : 0;
+                    st->span.t[GLOVE_TRACE_ARRIVE] = arrive;
+                    st->span.t[GLOVE_TRACE_PARSE] = glove_monotonic_ns();
+                    glove_trace_glove(st->trace, &st->span, s.t_us, sent_us);
+                }
+                if (st->rec) glove_rec_write(st->rec, &s);
+                glove_stream_feed(st, &s, h);
+                fed++;
+            } else if (st->len > 0 && st->buf[0] != '#') {
+                st->bad_lines++;
+                if (st->metrics) glove_metrics_add(st->metrics, GLOVE_METRIC_LINE_ERRORS, 1);
+            }
+        } else {
+            st->bad_lines++;
+            if (st->metrics) glove_metrics_add(st->metrics, GLOVE_METRIC_LINE_ERRORS, 1);
+        }
+        st->len = 0;
+    }
+    return fed;
+}
+
+void glove_stream_drawn(glove_metrics_t* m, const glove_frame_t* f, uint32_t* last_seq)
+{
+    if (f->seq == *last_seq) return;
+    glove_metrics_add(m, GLOVE_METRIC_FRAMES, 1);
+    if (*last_seq && f->seq - *last_seq > 1) glove_metrics_add(m, GLOVE_METRIC_SKIPPED, f->seq - *last_seq - 1);
+    glove_metrics_observe(m, GLOVE_METRIC_AGE, glove_monotonic_ns() - f->recv_ns);
+    *last_seq = f->seq;
+}
@@ -0,0 +1,124 @@
+//
+// glove-stream -- live glove lines to fused hand orientations, off the
+// render thread
+//
+// A reader thread owns the serial fd and a glove_stream_t: it splits the
+// bytes into lines, fuses each sample and publishes the newest orientation
+// of every sensor into a glove_handoff_t.  The render thread takes the
+// latest frame from the handoff whenever it draws.
+//
+// Yaw drift is judged on whole hands at one instant: glove-align resamples
+// each hand to the latest time all its sensors have reached and
+// glove-yaw's offsets come from that.  The published frame keeps every
+// sensor's newest orientation, with those offsets applied.
+//
+// The handoff is a triple buffer for exactly one writer and one reader.
+// Neither side ever waits on the other: the writer always has a free slot,
+// the reader always gets the newest complete frame, and frames the reader
+// was too slow for are simply overwritten.  What those frames brought is
+// kept apart in a ring of the last HANDOFF_SAMPLES samples, for readers
+// that need every sample (glove-interp); same seqlock words as glove-shm.
+//
+// Other processes get the same frames through glove-shm: a broker sets
+// st->shm and every sample fed is published there as well.
+//
+
+
+#ifndef __GLOVE_STREAM_H__
+#define __GLOVE_STREAM_H__
+
+#include <atomic>
+
+#include "glove-align.h"
+#include "glove-fusion.h"
+#include "glove-metrics.h"
+#include "glove-record.h"
+#include "glove-trace.h"
+#include "glove-yaw.h"
+
+#define GLOVE_STREAM_LINE_MAX   256
+#define GLOVE_HAND_SENSORS      6       // Main, Thumb..Little
+#define GLOVE_HANDOFF_SAMPLES   256     // samples kept for glove_handoff_samples(), a power of two
+
+struct glove_shm;
+
+typedef struct {
+    uint32_t     seq;                   // published frames so far
+    uint64_t     t_us;                  // newest sample's capture time
+    int64_t      recv_ns;               // glove_monotonic_ns() when it was read
+    int          nsensors;
+    glove_quat_t q[GLOVE_MAX_SENSORS];  // body -> world, yaw corrected
+    uint64_t     t_sensor_us[GLOVE_MAX_SENSORS];    // capture time of each q
+    glove_trace_span_t trace;           // the newest sample's, when traced
+} glove_frame_t;
+
+// one sample as it went out in a frame
+typedef struct {
+    uint32_t     seq;                   // of the frame it brought
+    int          sensor;
+    uint64_t     t_us;                  // its capture time
+    int64_t      recv_ns;
+    glove_quat_t q;                     // its sensor's orientation, yaw corrected
+} glove_handoff_sample_t;
+
+typedef struct {
+    glove_frame_t    slot[3];
+    std::atomic<int> middle;            // slot index, | GLOVE_HANDOFF_FRESH
+    int              back;              // writer's
+    int              front;             // reader's
+    std::atomic<uint32_t>  sample_seq[GLOVE_HANDOFF_SAMPLES];  // seq in the slot, 0 while written
+    glove_handoff_sample_t sample[GLOVE_HANDOFF_SAMPLES];     // frame seq n in n % SAMPLES
+} glove_handoff_t;
+
+typedef struct {
+    int            len;                 // bytes of a partial line in buf
+    char           buf[GLOVE_STREAM_LINE_MAX];
+    uint64_t       clock;               // for glove_clock_unwrap()
+    glove_fusion_t fusion[GLOVE_MAX_SENSORS];
+    glove_align_t  align[GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS];  // feeds yaw, per hand
+    glove_yaw_t    yaw[GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS];
+    glove_frame_t  cur;
+    unsigned       bad_lines;
+    glove_rec_t*   rec;                 // if set, every decoded sample is appended
+    glove_trace_t* trace;               // if set, every sample is traced
+    glove_trace_span_t span;            // the sample being fed
+    glove_metrics_t* metrics;           // if set, the reader's metrics are kept
+    unsigned       fused;               // samples fed, for GLOVE_METRICS_FUSION_EVERY
+    struct glove_shm* shm;              // if set, every sample is published there (glove-shm)
+    int            sensor_base;         // added to each line's sensor: a glove per port, one hand each
+} glove_stream_t;
+
+// CLOCK_MONOTONIC in nanoseconds
+int64_t glove_monotonic_ns(void);
+
+void glove_handoff_init(glove_handoff_t* h);
+// writer: fill the slot glove_handoff_back() returns, then publish it
+glove_frame_t* glove_handoff_back(glove_handoff_t* h);
+void glove_handoff_publish(glove_handoff_t* h);
+// writer, before publishing: the back frame was made by one sample of
+// sensor; keep it for glove_handoff_samples()
+void glove_handoff_note(glove_handoff_t* h, int sensor);
+// reader: the newest published frame (all zero before the first one);
+// returns 1 if it was published since the previous call, else 0
+int  glove_handoff_latest(glove_handoff_t* h, const glove_frame_t** f);
+// reader: the noted samples of frames after seq after up to frame seq upto,
+// oldest first, at most max; returns how many.  Samples the ring has
+// dropped, or frames that were not noted (glove_shm_poll()), are skipped
+int  glove_handoff_samples(glove_handoff_t* h, uint32_t after, uint32_t upto,
+                           glove_handoff_sample_t* out, int max);
+
+void glove_stream_init(glove_stream_t* st);
+// one parsed sample: fuse it and publish the updated frame
+void glove_stream_feed(glove_stream_t* st, const glove_sample_t* s, glove_handoff_t* h);
+// wait up to timeout_ms for bytes on fd (opened with serialport_init), feed
+// every complete line and return how many samples went through; 0 on
+// timeout, -1 on a read error or end of file
+int  glove_stream_poll(glove_stream_t* st, int fd, int timeout_ms, glove_handoff_t* h);
+// reader thread: forget each hand's neutral finger splay and yaw offsets;
+// the next flat hand records them again
+void glove_stream_recenter(glove_stream_t* st);
+// render thread: f, from glove_handoff_latest(), is being drawn; counts it
+// into m if it is newer than *last_seq (the seq drawn before, 0 at first)
+void glove_stream_drawn(glove_metrics_t* m, const glove_frame_t* f, uint32_t* last_seq);
+
+#endif
@@ -0,0 +1,226 @@
+//
+// glove-synth -- deterministic fake glove sessions with ground truth
+//
+
+#include "glove-synth.h"
+
+#include <string.h>
+
+void glove_synth_defaults(glove_synth_params_t* par)
+{
+    par->rate_hz    = 100;
+    par->duration_s = 30;
+    par->sensors    = 6;
+    par->skew_us    = 1500;     // roughly one software-I2C read
+    par->rest_s     = 1.0f;
+    par->move_s     = 0.8f;
+    par->reach_m    = 0.2f;
+    par->turn_deg   = 40;
+    par->acc_noise  = 0.004f;
+    par->gyro_noise = 0.15f;
+    par->gyro_bias  = 0.5f;
+    par->acc_bias   = 0.01f;
+    par->acc_scale  = 0;
+    par->acc_cross  = 0;
+    par->flat_every = 0;
+    par->hold_s     = 3.0f;
+    par->seed       = 1;
+}
+
+// stateless hash -> [-1,1], so the pose at any t needs no history
+static float hash_unit(uint32_t seed, uint32_t k, uint32_t ch)
+{
+    uint32_t h = seed * 0x9E3779B1u ^ (k + 0x7F4A7C15u) * 0x85EBCA77u ^ ch * 0xC2B2AE3Du;
+    h ^= h >> 16; h *= 0x7FEB352Du;
+    h ^= h >> 15; h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return (h >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+// palm position target at the end of reach k: out on even, home on odd
+static glove_vec3_t reach_target(const glove_synth_params_t* par, int k)
+{
+    if (k < 0 || (k & 1)) return glove_vec3(0, 0, 0);
+    return glove_vec3(hash_unit(par->seed, k, 1) * par->reach_m,
+                      hash_unit(par->seed, k, 2) * par->reach_m,
+                      hash_unit(par->seed, k, 3) * par->reach_m);
+}
+
+static glove_quat_t turn_target(const glove_synth_params_t* par, int k)
+{
+    if (k < 0) return glove_quat_identity();
+    glove_vec3_t axis = glove_vec3(hash_unit(par->seed, k, 4),
+                                   hash_unit(par->seed, k, 5),
+                                   hash_unit(par->seed, k, 6));
+    return glove_quat_axis_angle(axis, hash_unit(par->seed, k, 7) * par->turn_deg * GLOVE_DEG2RAD);
+}
+
+static float flex_target(const glove_synth_params_t* par, int sensor, int k)
+{
+    if (k < 0) return 0;
+    if (par->flat_every > 0 && k % par->flat_every == par->flat_every - 1) return 0;
+    return (0.5f + 0.5f * hash_unit(par->seed, k, 16 + sensor)) * 70.0f * GLOVE_DEG2RAD;
+}
+
+// which reach we are in and how far along (minimum-jerk s, s'')
+static int segment(const glove_synth_params_t* par, double t, float* s, float* s2)
+{
+    double period = par->rest_s + par->move_s;
+    int k = (int)(t / period);
+    double in = t - k * period;
+    if (in < par->rest_s) {     // resting after reach k-1
+        *s = 1; *s2 = 0;
+        return k - 1;
+    }
+    float u = (float)((in - par->rest_s) / par->move_s);
+    *s  = u * u * u * (10 - 15 * u + 6 * u * u);
+    *s2 = (60 * u - 180 * u * u + 120 * u * u * u) / (par->move_s * par->move_s);
+    return k;
+}
+
+static void pose(const glove_synth_params_t* par, int sensor, double t,
+                 glove_quat_t* q, glove_vec3_t* p, glove_vec3_t* acc)
+{
+    float s, s2;
+    int k = segment(par, t, &s, &s2);
+    glove_vec3_t p0 = reach_target(par, k - 1), p1 = reach_target(par, k);
+    glove_vec3_t d = glove_vec3_sub(p1, p0);
+    *p = glove_vec3_add(p0, glove_vec3_scale(d, s));
+    if (acc) *acc = glove_vec3_scale(d, s2);
+
+    *q = glove_quat_slerp(turn_target(par, k - 1), turn_target(par, k), s);
+    if (sensor == GLOVE_PALM) return;
+
+    // fingers: fixed splay about the palm normal, then flex about x
+    float splay = ((sensor % 6) - 3) * 8.0f * GLOVE_DEG2RAD;
+    float flex = flex_target(par, sensor, k - 1) * (1 - s) + flex_target(par, sensor, k) * s;
+    *q = glove_quat_mul(*q, glove_quat_axis_angle(glove_vec3(0, 0, 1), splay));
+    *q = glove_quat_mul(*q, glove_quat_axis_angle(glove_vec3(1, 0, 0), flex));
+}
+
+void glove_synth_pose(const glove_synth_params_t* par, int sensor, double t,
+                      glove_quat_t* q, glove_vec3_t* p)
+{
+    pose(par, sensor, t, q, p, NULL);
+}
+
+// xorshift + Box-Muller, sequential so noise depends on sample order only
+static float gauss(uint32_t* st)
+{
+    float u[2];
+    for (int i = 0; i < 2; i++) {
+        uint32_t x = *st;
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        *st = x;
+        u[i] = (x >> 8) * (1.0f / 16777216.0f) + 1e-7f;
+    }
+    return sqrtf(-2.0f * logf(u[0])) * cosf(2.0f * GLOVE_PI * u[1]);
+}
+
+typedef void (*pose_fn)(const glove_synth_params_t* par, int sensor, double t,
+                        glove_quat_t* q, glove_vec3_t* p, glove_vec3_t* acc);
+
+// per-sensor accelerometer distortion, identity unless acc_scale/acc_cross
+static glove_vec3_t distort(const glove_synth_params_t* par, int sn, glove_vec3_t f)
+{
+    float d[9];
+    for (int i = 0; i < 9; i++)
+        d[i] = (i % 4 == 0 ? 1.0f + par->acc_scale * hash_unit(par->seed, sn, 120 + i)
+                           : par->acc_cross * hash_unit(par->seed, sn, 120 + i));
+    return glove_vec3(d[0] * f.x + d[1] * f.y + d[2] * f.z,
+                      d[3] * f.x + d[4] * f.y + d[5] * f.z,
+                      d[6] * f.x + d[7] * f.y + d[8] * f.z);
+}
+
+static int generate(const glove_synth_params_t* par, pose_fn fn, float duration_s,
+                    glove_session_t* ss)
+{
+    const double h = 0.0005;        // s, for the angular rate difference
+    const uint64_t t0_us = 1000000; // micros() is never 0 by the first read
+    uint32_t rng = par->seed * 2654435761u + 1;
+    int nframes = (int)(duration_s * par->rate_hz);
+
+    memset(ss, 0, sizeof(*ss));
+    for (int i = 0; i < nframes; i++) {
+        for (int sn = 0; sn < par->sensors; sn++) {
+            double t = i / par->rate_hz + sn * par->skew_us * 1e-6;
+            glove_quat_t q, qa, qb;
+            glove_vec3_t p, acc, pp;
+            fn(par, sn, t, &q, &p, &acc);
+            fn(par, sn, t - h, &qa, &pp, NULL);
+            fn(par, sn, t + h, &qb, &pp, NULL);
+
+            glove_vec3_t w = glove_quat_to_rotvec(glove_quat_mul(glove_quat_conj(qa), qb));
+            w = glove_vec3_scale(w, (float)(GLOVE_RAD2DEG / (2 * h)));
+            glove_vec3_t f = glove_vec3_scale(acc, 1.0f / GLOVE_GRAVITY);
+            f.z += 1.0f;
+            f = distort(par, sn, glove_quat_rotate(glove_quat_conj(q), f));
+
+            // truth for every sensor at the frame time too, so resampling
+            // to it can be scored without interpolating the truth
+            if (sn == 0 && par->skew_us != 0) {
+                for (int k = 1; k < par->sensors; k++) {
+                    glove_truth_t ft;
+                    ft.t_us = t0_us + (uint64_t)(t * 1e6 + 0.5);
+                    ft.sensor = (uint8_t)k;
+                    fn(par, k, t, &ft.q, &ft.p, NULL);
+                    if (glove_session_add_truth(ss, &ft) != 0) return -1;
+                }
+            }
+
+            glove_sample_t s;
+            glove_truth_t tr;
+            s.t_us = tr.t_us = t0_us + (uint64_t)(t * 1e6 + 0.5);
+            s.sensor = tr.sensor = (uint8_t)sn;
+            float fv[3] = { f.x, f.y, f.z }, wv[3] = { w.x, w.y, w.z };
+            for (int ax = 0; ax < 3; ax++) {
+                s.a[ax] = fv[ax] + par->acc_bias  * hash_unit(par->seed, sn, 100 + ax) + par->acc_noise  * gauss(&rng);
+                s.g[ax] = wv[ax] + par->gyro_bias * hash_unit(par->seed, sn, 110 + ax) + par->gyro_noise * gauss(&rng);
+            }
+            tr.q = q;
+            tr.p = p;
+            if (glove_session_add_truth(ss, &tr) != 0 || glove_session_add(ss, &s) != 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+int glove_synth_session(const glove_synth_params_t* par, glove_session_t* ss)
+{
+    return generate(par, pose, par->duration_s, ss);
+}
+
+// calibration run: six held poses, one turn between each, then a sweep
+static void calib_pose(const glove_synth_params_t* par, int sensor, double t,
+                       glove_quat_t* q, glove_vec3_t* p, glove_vec3_t* acc)
+{
+    static const glove_vec3_t up[6] = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+    };
+    const float turn_s = 1.0f;
+    float step = par->hold_s + turn_s;
+    int k = (int)(t / step);
+    *p = glove_vec3(0, 0, 0);
+    if (acc) *acc = *p;
+
+    if (k < 6) {
+        glove_quat_t a = glove_quat_between(up[k], glove_vec3(0, 0, 1));
+        float u = (float)((t - k * step - par->hold_s) / turn_s);
+        if (u <= 0 || k == 5) { *q = a; return; }
+        glove_quat_t b = glove_quat_between(up[k + 1], glove_vec3(0, 0, 1));
+        *q = glove_quat_slerp(a, b, u * u * (3 - 2 * u));
+        return;
+    }
+    // sweep: tumble slowly about a wandering axis, in place
+    float ts = (float)(t - 6 * step);
+    glove_vec3_t axis = glove_vec3(sinf(0.7f * ts), cosf(0.5f * ts), sinf(0.3f * ts + 1));
+    glove_quat_t start = glove_quat_between(up[5], glove_vec3(0, 0, 1));
+    *q = glove_quat_mul(start, glove_quat_axis_angle(axis, 0.8f * ts));
+}
+
+int glove_synth_calib_session(const glove_synth_params_t* par, float sweep_s,
+                              glove_session_t* ss)
+{
+    return generate(par, calib_pose, 6 * (par->hold_s + 1.0f) + sweep_s, ss);
+}
@@ -0,0 +1,47 @@
+//
+// glove-synth -- deterministic fake glove sessions with ground truth
+//
+// Until there is a shelf of real recordings, tools and tests replay these.
+// The palm alternates rests and minimum-jerk reaches (ending back where it
+// started), turning during each reach; fingers flex on top of the palm.
+// Sensors are captured one after the other like main.ino does, skew_us apart.
+//
+
+
+#ifndef __GLOVE_SYNTH_H__
+#define __GLOVE_SYNTH_H__
+
+#include "glove-sample.h"
+
+typedef struct {
+    float    rate_hz;       // reads per sensor per second
+    float    duration_s;
+    int      sensors;       // 1 = palm only, 6 = one hand
+    int      skew_us;       // delay between consecutive sensor reads
+    float    rest_s;        // still time between reaches
+    float    move_s;        // duration of one reach
+    float    reach_m;       // max reach per axis
+    float    turn_deg;      // max palm rotation per reach
+    float    acc_noise;     // g, stddev
+    float    gyro_noise;    // deg/s, stddev
+    float    gyro_bias;     // deg/s, max per-axis constant bias
+    float    acc_bias;      // g, max per-axis constant bias
+    float    acc_scale;     // max per-axis scale error (0.02 = 2%)
+    float    acc_cross;     // max cross-axis coupling
+    int      flat_every;    // every n-th reach ends with the hand flat, 0 = never
+    float    hold_s;        // calibration run: still time in each pose
+    uint32_t seed;
+} glove_synth_params_t;
+
+void glove_synth_defaults(glove_synth_params_t* par);
+int  glove_synth_session(const glove_synth_params_t* par, glove_session_t* ss);
+// still in each of the six calibration poses for par->hold_s, then
+// sweep_s of slow free rotation in place
+int  glove_synth_calib_session(const glove_synth_params_t* par, float sweep_s,
+                               glove_session_t* ss);
+
+// truth at any time, for tools that need it off the sample grid
+void glove_synth_pose(const glove_synth_params_t* par, int sensor, double t,
+                      glove_quat_t* q, glove_vec3_t* p);
+
+#endif
@@ -0,0 +1,1841 @@
+/*
+ * glove-tool
+ * ----------
+ *
+ * Offline companion to arduino-serial for the glove: makes synthetic
+ * sessions and replays recorded ones through the host pipeline stages,
+ * printing the numbers each stage is judged by.
+ *
+ * A session is what "arduino-serial -q -r" prints from the glove sketch,
+ * one "sensor:t_us:ax:ay:az:gx:gy:gz" line per read (see glove-sample.h).
+ *
+ *   ./glove-tool synth -d 60 > session.txt
+ *   ./glove-tool position session.txt
+ *   ./glove-tool predict -H 0,20,40,60 session.txt
+ *   ./glove-tool align session.txt
+ *   ./glove-tool yaw session.txt
+ *   ./glove-tool calib -p /dev/ttyUSB0 -b 115200 -o glove.cal
+ *   ./glove-tool skin session.txt
+ *   ./glove-tool interp -R 144 session.txt
+ *   ./glove-tool record -p /dev/ttyUSB0 -c glove.cal -o session.rec
+ *   ./glove-tool replay -x 4 -s 30 session.rec | ./glove-tool position -
+ *   ./glove-tool pack -m zstd -o session.pak session.rec
+ *   ./glove-tool trace -R 60 -o trace.json -p /dev/ttyUSB0
+ *   ./glove-tool metrics /tmp/glove.sock
+ *   ./glove-tool profile -p /dev/ttyUSB0 -t 30 -o profile.csv
+ *   ./glove-tool golden -a 0.98 golden/reach.txt
+ *   ./glove-tool broker -p /dev/ttyUSB0 -p /dev/ttyUSB1
+ *   ./glove-tool tap | ./glove-tool position -
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "arduino-serial-lib.h"
+#include "glove-sample.h"
+#include "glove-align.h"
+#include "glove-calib.h"
+#include "glove-codec.h"
+#include "glove-fusion.h"
+#include "glove-golden.h"
+#include "glove-interp.h"
+#include "glove-kinematics.h"
+#include "glove-metrics.h"
+#include "glove-position.h"
+#include "glove-profile.h"
+#include "glove-predict.h"
+#include "glove-record.h"
+#include "glove-replay.h"
+#include "glove-shm.h"
+#include "glove-skin.h"
+#include "glove-stream.h"
+#include "glove-synth.h"
+#include "glove-trace.h"
+#include "glove-yaw.h"
+
+//
+static void usage(void)
+{
+    printf("Usage: glove-tool <command> [OPTIONS] [session]\n"
+    "\n"
+    "Commands:\n"
+    "  synth                      Write a synthetic session with truth to stdout\n"
+    "      -r, --rate=hz          Reads per sensor per second (default 100)\n"
+    "      -d, --duration=secs    Length of the session (default 30)\n"
+    "      -n, --sensors=num      Sensors per frame (default 6)\n"
+    "      -k, --skew=usecs       Delay between sensor reads (default 1500)\n"
+    "      -S, --seed=num         Random seed (default 1)\n"
+    "      -C, --calib            Six-pose calibration run instead of reaches\n"
+    "      -w, --sweep=secs       Free rotation after the six poses (with -C)\n"
+    "          --scale=frac       Max accel scale error per axis (default 0)\n"
+    "          --cross=frac       Max accel cross-axis coupling (default 0)\n"
+    "      -F, --flat=num         Every num-th reach ends with the hand flat (default 0)\n"
+    "  position                   Replay a session through the position estimator\n"
+    "      -s, --sensor=num       Sensor to track (default 0, the palm)\n"
+    "      -v, --verbose          Print the estimate every 100 ms\n"
+    "  predict                    Orientation prediction error vs horizon\n"
+    "      -s, --sensor=num       Only this sensor (default all)\n"
+    "      -H, --horizons=ms,..   Horizons to report (default 0,10,20,30,40,60,80,100)\n"
+    "  align                      Finger-vs-palm error, as read vs resampled to one time\n"
+    "      -f, --fused            Use fused orientations instead of the truth rows\n"
+    "  yaw                        Finger splay error vs the palm, with and without glove-yaw\n"
+    "      -l, --limit=deg        Max splay from neutral (default 25)\n"
+    "  calib                      Fit accel correction from the six resting poses\n"
+    "      -p, --port=serialport  Read live from the glove instead of a session\n"
+    "      -b, --baud=baudrate    Baudrate for -p (default 115200)\n"
+    "      -o, --output=file      Write the calibration blob here\n"
+    "      -m, --min=num          Resting samples needed per pose (default 100)\n"
+    "      -w, --sweep            Also use free-rotation samples to refine\n"
+    "  skin                       Cost of skinning both hands per frame, moved parts vs all\n"
+    "      -e, --min-change=m     Parts that moved less are left alone (default 1e-5)\n"
+    "  interp                     Judder and lag at a display rate, newest sample vs interpolated\n"
+    "      -R, --render=hz        Display refresh rate (default 60)\n"
+    "      -D, --delays=ms,..     Interpolation delays to report (default 0,10,20,30,50,100)\n"
+    "      -c, --chunk=ms         USB hands lines over every this often (default 4)\n"
+    "  record                     Write samples to a binary recording (glove-record)\n"
+    "      -o, --output=file      Recording to write\n"
+    "      -p, --port=serialport  Record live from the glove instead of converting a session\n"
+    "      -b, --baud=baudrate    Baudrate for -p (default 115200)\n"
+    "      -c, --calib=file       Calibration blob to keep in the header\n"
+    "      -t, --time=secs        Stop after this long (with -p, default until Ctrl-C)\n"
+    "      -M, --metrics=socket   Serve the reader's metrics on this Unix socket (with -p)\n"
+    "  replay                     Play a recording back as text lines, paced by capture time\n"
+    "      -x, --speed=n          Multiple of real time, 0 for as fast as possible (default 1)\n"
+    "      -s, --start=secs       Seek this far into the recording first\n"
+    "      -t, --time=secs        Stop after this much recording time\n"
+    "      -i, --index            Print index and seek costs instead of playing\n"
+    "  pack                       Compression ratio and decode speed of packed recordings (glove-codec)\n"
+    "      -m, --method=name      varint, lz4, zstd or raw (default varint; lz4/zstd if built in)\n"
+    "      -o, --output=file      Also write the packed recording here\n"
+    "  trace                      Per-stage latency, glove read to present, through the live reader\n"
+    "      -p, --port=serialport  Trace the glove instead of a session played over an emulated link\n"
+    "      -b, --baud=baudrate    Baudrate for -p, and of the emulated link (default 115200, 0 no wire)\n"
+    "      -R, --render=hz        Frames drawn per second, presented on the next tick (default 60)\n"
+    "      -t, --time=secs        Stop after this long (default the session, or until Ctrl-C)\n"
+    "      -o, --output=file      Chrome trace JSON for chrome://tracing or ui.perfetto.dev\n"
+    "      -M, --metrics=socket   Serve the pipeline's metrics on this Unix socket\n"
+    "  metrics <socket>           Print the metrics a reader serves (glove-metrics)\n"
+    "  profile                    Chart the sketch's loop time by phase, from its #P lines (GLOVE_PROFILE)\n"
+    "      -p, --port=serialport  Read live from the glove instead of a text session\n"
+    "      -b, --baud=baudrate    Baudrate for -p (default 115200)\n"
+    "      -t, --time=secs        Stop after this long (with -p, default until Ctrl-C)\n"
+    "      -o, --output=file      Also write the frames as CSV\n"
+    "  golden                     Check fusion and kinematics against a golden trace (glove-golden)\n"
+    "      -g, --golden=file      Golden trace (default the session's name with .gold)\n"
+    "      -w, --write            Write the golden trace instead of checking against it\n"
+    "      -a, --alpha=weight     Fusion gyro weight (default 0.96, GY521's; MPU6050_tockn's is 0.98)\n"
+    "      -e, --error=deg        Fail if a stage's p95 error vs truth grows more (default 0.05),\n"
+    "                             or, without truth, if it drifts more from the golden trace\n"
+    "      -s, --speed=pct        Fail if ns per sample grows more (default 15, 0 not checked)\n"
+    "  broker                     Own the glove's ports and publish fused samples to shared memory (glove-shm)\n"
+    "      -p, --port=serialport  Glove port; a second -p is the other hand (default a session, emulated)\n"
+    "      -b, --baud=baudrate    Baudrate for -p, and of the emulated link (default 115200, 0 no wire)\n"
+    "      -n, --name=shm         Segment name (default /glove)\n"
+    "      -s, --slots=num        Samples the ring holds, a power of two (default 8192)\n"
+    "      -t, --time=secs        Stop after this long (default until Ctrl-C, or the session's end)\n"
+    "      -M, --metrics=socket   Serve the reader's metrics on this Unix socket\n"
+    "  tap                        Print a broker's new samples as text lines, their age on stderr\n"
+    "      -n, --name=shm         Segment name (default /glove)\n"
+    "      -t, --time=secs        Stop after this long (default until Ctrl-C or the broker stops)\n"
+    "      -P, --pose             Print the latest pose once instead\n"
+    "\n"
+    "Sessions are read from a file, or stdin when given as '-'; text, a recording or packed.\n"
+    "\n");
+    exit(EXIT_SUCCESS);
+}
+
+//
+static void error(const char* msg)
+{
+    fprintf(stderr, "%s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+static const char* session_arg(int argc, char* argv[])
+{
+    if (optind >= argc) error("no session given");
+    return argv[optind];
+}
+
+// text lines, a glove-record file or a packed one
+static int load_session(const char* path, glove_session_t* ss)
+{
+    if (strcmp(path, "-") != 0 && glove_rec_probe(path)) return glove_rec_load(path, ss, NULL);
+    if (strcmp(path, "-") != 0 && glove_codec_probe(path)) return glove_codec_load(path, ss, NULL);
+    return glove_session_load(path, ss);
+}
+
+//
+static int cmd_synth(int argc, char* argv[])
+{
+    glove_synth_params_t par;
+    glove_session_t ss;
+    int opt;
+    static struct option loptions[] = {
+        {"rate",     required_argument, 0, 'r'},
+        {"duration", required_argument, 0, 'd'},
+        {"sensors",  required_argument, 0, 'n'},
+        {"skew",     required_argument, 0, 'k'},
+        {"seed",     required_argument, 0, 'S'},
+        {"calib",    no_argument,       0, 'C'},
+        {"sweep",    required_argument, 0, 'w'},
+        {"scale",    required_argument, 0, 1},
+        {"cross",    required_argument, 0, 2},
+        {"flat",     required_argument, 0, 'F'},
+        {NULL,       0,                 0, 0}
+    };
+    int calib = 0;
+    float sweep_s = 0;
+
+    glove_synth_defaults(&par);
+    while ((opt = getopt_long(argc, argv, "r:d:n:k:S:Cw:F:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'r': par.rate_hz    = strtof(optarg, NULL); break;
+        case 'd': par.duration_s = strtof(optarg, NULL); break;
+        case 'n': par.sensors    = strtol(optarg, NULL, 10); break;
+        case 'k': par.skew_us    = strtol(optarg, NULL, 10); break;
+        case 'S': par.seed       = strtoul(optarg, NULL, 10); break;
+        case 'C': calib = 1; break;
+        case 'w': sweep_s = strtof(optarg, NULL); break;
+        case 1:   par.acc_scale  = strtof(optarg, NULL); break;
+        case 2:   par.acc_cross  = strtof(optarg, NULL); break;
+        case 'F': par.flat_every = strtol(optarg, NULL, 10); break;
+        default:  usage();
+        }
+    }
+    if (par.sensors < 1 || par.sensors > GLOVE_MAX_SENSORS) error("bad sensor count");
+    int rc = calib ? glove_synth_calib_session(&par, sweep_s, &ss)
+                   : glove_synth_session(&par, &ss);
+    if (rc != 0) error("out of memory");
+    printf("# glove-tool synth rate=%g duration=%g sensors=%d skew=%d seed=%u\n",
+           par.rate_hz, par.duration_s, par.sensors, par.skew_us, par.seed);
+    glove_session_write(stdout, &ss);
+    glove_session_free(&ss);
+    return 0;
+}
+
+//
+static int cmd_position(int argc, char* argv[])
+{
+    int sensor = GLOVE_PALM, verbose = 0, opt;
+    static struct option loptions[] = {
+        {"sensor",  required_argument, 0, 's'},
+        {"verbose", no_argument,       0, 'v'},
+        {NULL,      0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "s:v", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 's': sensor = strtol(optarg, NULL, 10); break;
+        case 'v': verbose = 1; break;
+        default:  usage();
+        }
+    }
+
+    glove_session_t ss;
+    if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+
+    glove_fusion_t fu;
+    glove_position_params_t par;
+    glove_position_t ps;
+    glove_fusion_init(&fu, GLOVE_FUSION_ALPHA);
+    glove_position_defaults(&par);
+    glove_position_init(&ps, &par);
+
+    // naive double integration on the same gravity-free accel, for scale
+    glove_vec3_t nv = glove_vec3(0, 0, 0), np = nv;
+    uint64_t first_us = 0, last_us = 0, next_print = 0;
+    glove_vec3_t p0_true = glove_vec3(0, 0, 0);
+    double err2 = 0, err_max = 0, conf_sum = 0;
+    int n = 0, nerr = 0;
+
+    for (int i = 0; i < ss.nsamples; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        if (s->sensor != sensor) continue;
+        glove_fusion_update(&fu, s);
+        glove_position_update(&ps, s, fu.q);
+
+        if (n > 0) {
+            float dt = (s->t_us - last_us) * 1e-6f;
+            glove_vec3_t aw = glove_quat_rotate(fu.q, glove_vec3(s->a[0], s->a[1], s->a[2]));
+            aw.z -= 1.0f;
+            nv = glove_vec3_add(nv, glove_vec3_scale(aw, GLOVE_GRAVITY * dt));
+            np = glove_vec3_add(np, glove_vec3_scale(nv, dt));
+        } else {
+            first_us = s->t_us;
+        }
+        last_us = s->t_us;
+        conf_sum += ps.confidence;
+        n++;
+
+        const glove_truth_t* tr = glove_session_truth_at(&ss, sensor, s->t_us);
+        if (tr) {
+            if (nerr == 0) p0_true = tr->p;
+            float e = glove_vec3_len(glove_vec3_sub(ps.p, glove_vec3_sub(tr->p, p0_true)));
+            err2 += e * e;
+            if (e > err_max) err_max = e;
+            nerr++;
+        }
+        if (verbose && s->t_us >= next_print) {
+            printf("%10.3f  p=%7.3f %7.3f %7.3f  conf=%.2f%s\n", (s->t_us - first_us) * 1e-6,
+                   ps.p.x, ps.p.y, ps.p.z, ps.confidence, ps.stationary ? "  still" : "");
+            next_print = s->t_us + 100000;
+        }
+    }
+    if (n == 0) error("no samples for that sensor");
+
+    printf("sensor:            %d (%s)\n", sensor, glove_sensor_name(sensor));
+    printf("samples:           %d over %.1f s\n", n, (last_us - first_us) * 1e-6);
+    printf("zupts:             %u\n", ps.zupts);
+    printf("mean confidence:   %.3f\n", conf_sum / n);
+    printf("home drift:        %.4f m (naive %.2f m)\n", glove_vec3_len(ps.p), glove_vec3_len(np));
+    if (nerr)
+        printf("error vs truth:    rms %.4f m, max %.4f m\n", sqrt(err2 / nerr), err_max);
+    glove_session_free(&ss);
+    return 0;
+}
+
+//
+static int cmp_float(const void* a, const void* b)
+{
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+// sorts v in place, returns the p-th percentile
+static float percentile(float* v, int n, float p)
+{
+    if (n == 0) return 0;
+    qsort(v, n, sizeof(float), cmp_float);
+    int i = (int)(p * (n - 1) + 0.5f);
+    return v[i];
+}
+
+static double mean(const float* v, int n)
+{
+    double sum = 0;
+    for (int i = 0; i < n; i++) sum += v[i];
+    return n ? sum / n : 0;
+}
+
+static int cmd_predict(int argc, char* argv[])
+{
+    int sensor = -1, opt;
+    int horizons[32] = { 0, 10, 20, 30, 40, 60, 80, 100 }, nh = 8;
+    static struct option loptions[] = {
+        {"sensor",   required_argument, 0, 's'},
+        {"horizons", required_argument, 0, 'H'},
+        {NULL,       0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "s:H:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 's': sensor = strtol(optarg, NULL, 10); break;
+        case 'H': {
+            // comma separated milliseconds, each a number >= 0
+            char* p = optarg;
+            for (nh = 0; nh < 32 && *p; nh++) {
+                char* end;
+                long ms = strtol(p, &end, 10);
+                if (end == p || ms < 0 || (*end && *end != ',')) usage();
+                horizons[nh] = (int)ms;
+                p = *end ? end + 1 : end;
+            }
+            if (nh == 0) usage();
+            break;
+        }
+        default: usage();
+        }
+    }
+
+    glove_session_t ss;
+    if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+
+    // fused orientation and predictor state after every sample
+    int n = ss.nsamples;
+    glove_quat_t*    q  = (glove_quat_t*)malloc(n * sizeof(glove_quat_t));
+    glove_predict_t* pr = (glove_predict_t*)malloc(n * sizeof(glove_predict_t));
+    float* e_hold = (float*)malloc(n * sizeof(float));
+    float* e_vel  = (float*)malloc(n * sizeof(float));
+    float* e_acc  = (float*)malloc(n * sizeof(float));
+    int*   next   = (int*)malloc(n * sizeof(int));
+    if (!q || !pr || !e_hold || !e_vel || !e_acc || !next) error("out of memory");
+
+    glove_fusion_t  fu[GLOVE_MAX_SENSORS];
+    glove_predict_t pd[GLOVE_MAX_SENSORS];
+    int last[GLOVE_MAX_SENSORS];
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) {
+        glove_fusion_init(&fu[k], GLOVE_FUSION_ALPHA);
+        glove_predict_init(&pd[k], GLOVE_PREDICT_HORIZON, 1);
+        last[k] = -1;
+    }
+    for (int i = 0; i < n; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        glove_fusion_update(&fu[s->sensor], s);
+        glove_predict_update(&pd[s->sensor], s);
+        q[i]  = fu[s->sensor].q;
+        pr[i] = pd[s->sensor];
+        next[i] = -1;
+        if (last[s->sensor] >= 0) next[last[s->sensor]] = i;
+        last[s->sensor] = i;
+    }
+
+    printf("# horizon_ms  hold_mean hold_p95   vel_mean  vel_p95   acc_mean  acc_p95   (degrees)\n");
+    for (int h = 0; h < nh; h++) {
+        uint64_t hus = (uint64_t)horizons[h] * 1000;
+        int ne = 0;
+        for (int i = 0; i < n; i++) {
+            const glove_sample_t* s = &ss.samples[i];
+            if (sensor >= 0 && s->sensor != sensor) continue;
+            // walk this sensor's chain to the pair bracketing t + h
+            uint64_t t = s->t_us + hus;
+            int j = i;
+            while (next[j] >= 0 && ss.samples[next[j]].t_us <= t) j = next[j];
+            if (next[j] < 0) continue;
+            int k = next[j];
+            float f = (float)(t - ss.samples[j].t_us) / (float)(ss.samples[k].t_us - ss.samples[j].t_us);
+            glove_quat_t ref = glove_quat_slerp(q[j], q[k], f);
+
+            glove_predict_t vel = pr[i];
+            vel.use_accel = 0;
+            e_hold[ne] = glove_quat_angle(q[i], ref) * GLOVE_RAD2DEG;
+            e_vel[ne]  = glove_quat_angle(glove_predict_by(&vel, q[i], hus * 1e-6f), ref) * GLOVE_RAD2DEG;
+            e_acc[ne]  = glove_quat_angle(glove_predict_by(&pr[i], q[i], hus * 1e-6f), ref) * GLOVE_RAD2DEG;
+            ne++;
+        }
+        double mh = mean(e_hold, ne), mv = mean(e_vel, ne), ma = mean(e_acc, ne);
+        printf("%12d  %9.3f %8.3f  %9.3f %8.3f  %9.3f %8.3f\n", horizons[h],
+               mh, percentile(e_hold, ne, 0.95f), mv, percentile(e_vel, ne, 0.95f),
+               ma, percentile(e_acc, ne, 0.95f));
+    }
+
+    free(q); free(pr); free(e_hold); free(e_vel); free(e_acc); free(next);
+    glove_session_free(&ss);
+    return 0;
+}
+
+//
+static int cmd_align(int argc, char* argv[])
+{
+    int fused = 0, opt;
+    static struct option loptions[] = {
+        {"fused", no_argument, 0, 'f'},
+        {NULL,    0,           0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "f", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'f': fused = 1; break;
+        default:  usage();
+        }
+    }
+
+    glove_session_t ss;
+    if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+    if (ss.ntruth == 0) error("session has no truth rows (use glove-tool synth)");
+    int nsensors = 0;
+    for (int i = 0; i < ss.nsamples; i++)
+        if (ss.samples[i].sensor >= nsensors) nsensors = ss.samples[i].sensor + 1;
+    if (nsensors < 2) error("need the palm and at least one finger");
+
+    // one error per finger per frame
+    int cap = ss.nsamples;
+    float* e_naive = (float*)malloc(cap * sizeof(float));
+    float* e_align = (float*)malloc(cap * sizeof(float));
+    int*   finger  = (int*)malloc(cap * sizeof(int));
+    if (!e_naive || !e_align || !finger) error("out of memory");
+
+    glove_fusion_t fu[GLOVE_MAX_SENSORS];
+    glove_align_t al;
+    glove_quat_t q[GLOVE_MAX_SENSORS];
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) glove_fusion_init(&fu[k], GLOVE_FUSION_ALPHA);
+    glove_align_init(&al, nsensors);
+
+    int ne = 0;
+    for (int i = 0; i < ss.nsamples; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        glove_quat_t qs;
+        glove_fusion_update(&fu[s->sensor], s);
+        if (fused) qs = fu[s->sensor].q;
+        else if (glove_session_truth_interp(&ss, s->sensor, s->t_us, &qs) != 0) continue;
+        glove_align_update(&al, s, qs);
+
+        // once per frame, when its last sensor is in
+        if (s->sensor != nsensors - 1) continue;
+        uint64_t t = glove_align_frame_time(&al);
+        if (t == 0 || glove_align_resample(&al, t, q) != 0) continue;
+        glove_quat_t tp, tf;
+        if (glove_session_truth_interp(&ss, GLOVE_PALM, t, &tp) != 0) continue;
+        for (int k = 1; k < nsensors; k++) {
+            if (glove_session_truth_interp(&ss, k, t, &tf) != 0) continue;
+            // relative pose, finger in palm frame; "naive" is each newest as read
+            glove_quat_t ref   = glove_quat_mul(glove_quat_conj(tp), tf);
+            glove_quat_t naive = glove_quat_mul(glove_quat_conj(al.q[GLOVE_PALM][1]), al.q[k][1]);
+            glove_quat_t rs    = glove_quat_mul(glove_quat_conj(q[GLOVE_PALM]), q[k]);
+            e_naive[ne] = glove_quat_angle(naive, ref) * GLOVE_RAD2DEG;
+            e_align[ne] = glove_quat_angle(rs, ref) * GLOVE_RAD2DEG;
+            finger[ne++] = k;
+        }
+    }
+
+    printf("# finger      naive_mean naive_p95  aligned_mean aligned_p95   (degrees, %s)\n",
+           fused ? "fused" : "truth at sample times");
+    float* a = (float*)malloc(cap * sizeof(float));
+    float* b = (float*)malloc(cap * sizeof(float));
+    if (!a || !b) error("out of memory");
+    for (int k = 1; k <= nsensors; k++) {
+        int n = 0;
+        for (int j = 0; j < ne; j++) {
+            if (k < nsensors && finger[j] != k) continue;
+            a[n] = e_naive[j];
+            b[n++] = e_align[j];
+        }
+        double ma = mean(a, n), mb = mean(b, n);
+        if (k < nsensors) printf("%d %-8s  ", k, glove_sensor_name(k));
+        else              printf("all         ");
+        printf("%10.3f %9.3f  %12.3f %11.3f\n", ma, percentile(a, n, 0.95f), mb, percentile(b, n, 0.95f));
+    }
+
+    free(a); free(b); free(e_naive); free(e_align); free(finger);
+    glove_session_free(&ss);
+    return 0;
+}
+
+//
+static int cmd_yaw(int argc, char* argv[])
+{
+    glove_yaw_params_t yp;
+    int opt;
+    static struct option loptions[] = {
+        {"limit", required_argument, 0, 'l'},
+        {NULL,    0,                 0, 0}
+    };
+    glove_yaw_defaults(&yp);
+    while ((opt = getopt_long(argc, argv, "l:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'l': yp.limit_deg = strtof(optarg, NULL); break;
+        default:  usage();
+        }
+    }
+
+    glove_session_t ss;
+    if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+    if (ss.ntruth == 0) error("session has no truth rows (use glove-tool synth)");
+    int nsensors = 0;
+    for (int i = 0; i < ss.nsamples; i++)
+        if (ss.samples[i].sensor >= nsensors) nsensors = ss.samples[i].sensor + 1;
+    if (nsensors < 2) error("need the palm and at least one finger");
+
+    // |splay error| per finger per frame, without and with the stage
+    int cap = ss.nsamples;
+    float* e_raw = (float*)malloc(cap * sizeof(float));
+    float* e_fix = (float*)malloc(cap * sizeof(float));
+    int*   finger = (int*)malloc(cap * sizeof(int));
+    if (!e_raw || !e_fix || !finger) error("out of memory");
+
+    glove_fusion_t fu[GLOVE_MAX_SENSORS];
+    glove_align_t al;
+    glove_yaw_t yaw;
+    glove_quat_t q[GLOVE_MAX_SENSORS], qc[GLOVE_MAX_SENSORS];
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) glove_fusion_init(&fu[k], GLOVE_FUSION_ALPHA);
+    glove_align_init(&al, nsensors);
+    glove_yaw_init(&yaw, &yp, nsensors);
+
+    float raw0[GLOVE_MAX_SENSORS], fix0[GLOVE_MAX_SENSORS];
+    int ne = 0, have0 = 0;
+    for (int i = 0; i < ss.nsamples; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        glove_fusion_update(&fu[s->sensor], s);
+        glove_align_update(&al, s, fu[s->sensor].q);
+        if (s->sensor != nsensors - 1) continue;
+        uint64_t t = glove_align_frame_time(&al);
+        if (t == 0 || glove_align_resample(&al, t, q) != 0) continue;
+        memcpy(qc, q, nsensors * sizeof(glove_quat_t));
+        glove_yaw_update(&yaw, t, qc);
+
+        glove_quat_t tp, tf;
+        if (glove_session_truth_interp(&ss, GLOVE_PALM, t, &tp) != 0) continue;
+        for (int k = 1; k < nsensors; k++) {
+            if (glove_session_truth_interp(&ss, k, t, &tf) != 0) continue;
+            float ref, raw, fix, flex;
+            glove_yaw_split(tp, tf, &ref, &flex);
+            glove_yaw_split(q[0], q[k], &raw, &flex);
+            glove_yaw_split(qc[0], qc[k], &fix, &flex);
+            // fusion starts every sensor at yaw 0, so score the change since
+            // the first frame: drift, not the unknowable initial splay
+            if (!have0) { raw0[k] = raw - ref; fix0[k] = fix - ref; }
+            e_raw[ne] = fabsf(remainderf(raw - ref - raw0[k], 2 * GLOVE_PI)) * GLOVE_RAD2DEG;
+            e_fix[ne] = fabsf(remainderf(fix - ref - fix0[k], 2 * GLOVE_PI)) * GLOVE_RAD2DEG;
+            finger[ne++] = k;
+        }
+        have0 = 1;
+    }
+
+    // "end" is the last tenth of the session, where drift has piled up
+    printf("# finger      before: mean    max    end   after: mean    max    end   (degrees of splay drift)\n");
+    for (int k = 1; k <= nsensors; k++) {
+        double sum[2] = { 0, 0 }, end[2] = { 0, 0 };
+        float mx[2] = { 0, 0 };
+        int n = 0, nend = 0;
+        for (int j = 0; j < ne; j++) {
+            if (k < nsensors && finger[j] != k) continue;
+            float e[2] = { e_raw[j], e_fix[j] };
+            for (int m = 0; m < 2; m++) {
+                sum[m] += e[m];
+                if (e[m] > mx[m]) mx[m] = e[m];
+                if (j >= ne - ne / 10) end[m] += e[m];
+            }
+            n++;
+            nend += j >= ne - ne / 10;
+        }
+        if (n == 0) continue;
+        if (nend == 0) nend = 1;
+        if (k < nsensors) printf("%d %-8s  ", k, glove_sensor_name(k));
+        else              printf("all         ");
+        printf("      %7.2f %6.2f %6.2f        %7.2f %6.2f %6.2f\n",
+               sum[0] / n, mx[0], end[0] / nend, sum[1] / n, mx[1], end[1] / nend);
+    }
+    printf("flat hand episodes: %u\n", yaw.flats);
+
+    free(e_raw); free(e_fix); free(finger);
+    glove_session_free(&ss);
+    return 0;
+}
+
+//
+static volatile sig_atomic_t stop_requested;
+
+static void on_sigint(int sig)
+{
+    stop_requested = 1;
+}
+
+// resting / sweeping classification for the calibration run
+typedef struct {
+    glove_calib_fit_t fit;
+    int               still_run;    // consecutive quiet samples
+    int               announced;    // poses already reported done
+} calib_sensor_t;
+
+#define CALIB_GYRO_STILL   5.0f     // deg/s
+#define CALIB_GYRO_SWEEP   20.0f
+#define CALIB_SETTLE       20       // quiet samples before a pose counts
+
+static void calib_feed(calib_sensor_t* cs, const glove_sample_t* s, int sweep, int min)
+{
+    float g = sqrtf(s->g[0] * s->g[0] + s->g[1] * s->g[1] + s->g[2] * s->g[2]);
+    float a = sqrtf(s->a[0] * s->a[0] + s->a[1] * s->a[1] + s->a[2] * s->a[2]);
+    if (g < CALIB_GYRO_STILL && a > 0.8f && a < 1.2f) {
+        // only near-aligned poses, the fit assumes gravity on one axis
+        int pose = glove_calib_pose(s->a);
+        if (++cs->still_run > CALIB_SETTLE && fabsf(s->a[pose / 2]) > 0.95f * a) {
+            glove_calib_fit_add_pose(&cs->fit, s->a);
+            if (cs->fit.pose_n[pose] == min && !(cs->announced & (1 << pose))) {
+                cs->announced |= 1 << pose;
+                fprintf(stderr, "sensor %d (%s): %s done\n", s->sensor,
+                        glove_sensor_name(s->sensor), glove_calib_pose_name(pose));
+            }
+        }
+        return;
+    }
+    cs->still_run = 0;
+    if (sweep && g > CALIB_GYRO_SWEEP && a > 0.8f && a < 1.2f)
+        glove_calib_fit_add_sweep(&cs->fit, s->a);
+}
+
+static int cmd_calib(int argc, char* argv[])
+{
+    const char* port = NULL;
+    const char* out = NULL;
+    int baud = 115200, min = 100, sweep = 0, opt;
+    static struct option loptions[] = {
+        {"port",   required_argument, 0, 'p'},
+        {"baud",   required_argument, 0, 'b'},
+        {"output", required_argument, 0, 'o'},
+        {"min",    required_argument, 0, 'm'},
+        {"sweep",  no_argument,       0, 'w'},
+        {NULL,     0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "p:b:o:m:w", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'p': port = optarg; break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'o': out  = optarg; break;
+        case 'm': min  = strtol(optarg, NULL, 10); break;
+        case 'w': sweep = 1; break;
+        default:  usage();
+        }
+    }
+
+    static calib_sensor_t cs[GLOVE_MAX_SENSORS];
+    int nsensors = 0;
+    for (int i = 0; i < GLOVE_MAX_SENSORS; i++) {
+        glove_calib_fit_init(&cs[i].fit);
+        cs[i].still_run = cs[i].announced = 0;
+    }
+
+    if (port) {
+        char buf[256];
+        glove_sample_t s;
+        int fd = serialport_init(port, baud);
+        if (fd == -1) error("couldn't open port");
+        fprintf(stderr, "rest the glove with each sensor axis pointing up in turn "
+                        "(+X -X +Y -Y +Z -Z)%s; Ctrl-C to finish\n",
+                sweep ? ", then turn it slowly in every direction" : "");
+        signal(SIGINT, on_sigint);
+        while (!stop_requested) {
+            if (serialport_read_until(fd, buf, '\n', sizeof(buf) - 1, 1000) != 0) continue;
+            if (glove_sample_parse(buf, &s) != 0) continue;
+            if (s.sensor >= nsensors) nsensors = s.sensor + 1;
+            calib_feed(&cs[s.sensor], &s, sweep, min);
+            int done = 1;
+            for (int i = 0; i < nsensors; i++)
+                done &= glove_calib_fit_complete(&cs[i].fit, min);
+            // keep sweeping until told to stop
+            if (done && !sweep) break;
+        }
+        serialport_close(fd);
+    } else {
+        glove_session_t ss;
+        if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+        for (int i = 0; i < ss.nsamples; i++) {
+            const glove_sample_t* s = &ss.samples[i];
+            if (s->sensor >= nsensors) nsensors = s->sensor + 1;
+            calib_feed(&cs[s->sensor], s, sweep, min);
+        }
+        glove_session_free(&ss);
+    }
+
+    glove_calib_t cal;
+    int failed = 0;
+    glove_calib_identity(&cal, nsensors);
+    printf("# sensor      poses  tilt err before -> after (deg)  sweep rms before -> after (g)\n");
+    for (int i = 0; i < nsensors; i++) {
+        glove_calib_fit_t* fit = &cs[i].fit;
+        glove_accel_cal_t* c = &cal.accel[i];
+        int poses = 0;
+        for (int p = 0; p < GLOVE_CALIB_POSES; p++) poses += fit->pose_n[p] >= min;
+        if (poses < GLOVE_CALIB_POSES || glove_calib_fit_solve(fit, c) != 0) {
+            printf("%d %-8s    %d/6    not enough poses, left uncorrected\n", i, glove_sensor_name(i), poses);
+            failed = 1;
+            continue;
+        }
+        glove_accel_cal_t ident;
+        memset(&ident, 0, sizeof(ident));
+        ident.m[0] = ident.m[4] = ident.m[8] = 1.0f;
+        printf("%d %-8s    6/6    %7.3f -> %7.3f               %7.4f -> %7.4f\n", i, glove_sensor_name(i),
+               glove_calib_pose_error(fit, NULL), glove_calib_pose_error(fit, c),
+               glove_calib_sweep_rms(fit, &ident), glove_calib_sweep_rms(fit, c));
+    }
+    if (!failed) {
+        // same numbers for pasting into the sketch: sensor.setAccelCalibration(m, b)
+        for (int i = 0; i < nsensors; i++) {
+            const glove_accel_cal_t* c = &cal.accel[i];
+            printf("// %s\n{ %.6f, %.6f, %.6f, %.6f, %.6f, %.6f, %.6f, %.6f, %.6f }, { %.6f, %.6f, %.6f }\n",
+                   glove_sensor_name(i), c->m[0], c->m[1], c->m[2], c->m[3], c->m[4], c->m[5],
+                   c->m[6], c->m[7], c->m[8], c->b[0], c->b[1], c->b[2]);
+        }
+    }
+    if (out && !failed && glove_calib_save(out, &cal) == 0)
+        printf("wrote %d bytes to %s\n", GLOVE_CALIB_HEADER + nsensors * GLOVE_CALIB_ENTRY, out);
+    for (int i = 0; i < GLOVE_MAX_SENSORS; i++) glove_calib_fit_free(&cs[i].fit);
+    return failed ? EXIT_FAILURE : 0;
+}
+
+//
+static int cmd_skin(int argc, char* argv[])
+{
+    glove_skin_t sk;
+    int opt;
+    static struct option loptions[] = {
+        {"min-change", required_argument, 0, 'e'},
+        {NULL,         0,                 0, 0}
+    };
+    if (glove_skin_init(&sk, GLOVE_SKIN_Y_UP, 0) != 0) error("out of memory");
+    while ((opt = getopt_long(argc, argv, "e:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'e': sk.min_change = strtof(optarg, NULL); break;
+        default:  usage();
+        }
+    }
+
+    glove_session_t ss;
+    if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+    int nsensors = 0;
+    for (int i = 0; i < ss.nsamples; i++)
+        if (ss.samples[i].sensor >= nsensors) nsensors = ss.samples[i].sensor + 1;
+    if (nsensors < GLOVE_HAND_SENSORS) error("session needs the palm and five fingers");
+
+    // Irrlicht's S3DVertex: position, normal, colour, texture coords
+    struct vertex { float pos[3], normal[3]; uint32_t color; float uv[2]; };
+    struct vertex* verts = (struct vertex*)calloc(sk.nverts, sizeof(struct vertex));
+    int nframes = ss.nsamples / nsensors + 1;
+    float* us_moved = (float*)malloc(nframes * sizeof(float));
+    float* us_all   = (float*)malloc(nframes * sizeof(float));
+    if (!verts || !us_moved || !us_all) error("out of memory");
+
+    // a one-glove session leaves the left hand resting, as the viewers do
+    glove_fusion_t fu[GLOVE_MAX_SENSORS];
+    glove_quat_t q[GLOVE_MAX_SENSORS];
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) {
+        glove_fusion_init(&fu[k], GLOVE_FUSION_ALPHA);
+        q[k] = glove_quat_identity();
+    }
+    glove_hand_pose_t hands[GLOVE_SKIN_HANDS];
+    int n = 0;
+    long parts = 0, nverts = 0;
+    for (int i = 0; i < ss.nsamples; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        glove_fusion_update(&fu[s->sensor], s);
+        q[s->sensor] = fu[s->sensor].q;
+        if (s->sensor != nsensors - 1) continue;
+        for (int h = 0; h < GLOVE_SKIN_HANDS; h++) {
+            int avail = nsensors - h * GLOVE_HAND_SENSORS;
+            glove_kin_hand(&q[h * GLOVE_HAND_SENSORS], avail < 0 ? 0 : avail,
+                           glove_vec3(h ? -0.12f : 0.12f, 0, 0), h, &hands[h]);
+        }
+
+        glove_skin_stats_t st;
+        int64_t t0 = glove_monotonic_ns();
+        glove_skin_update(&sk, hands, GLOVE_SKIN_HANDS, verts, sizeof(struct vertex),
+                          offsetof(struct vertex, pos), offsetof(struct vertex, normal), &st);
+        int64_t t1 = glove_monotonic_ns();
+        // same frame again from scratch, for comparison
+        glove_skin_invalidate(&sk);
+        glove_skin_update(&sk, hands, GLOVE_SKIN_HANDS, verts, sizeof(struct vertex),
+                          offsetof(struct vertex, pos), offsetof(struct vertex, normal), NULL);
+        int64_t t2 = glove_monotonic_ns();
+        if (n == 0) { t1 = t0; st.parts = st.verts = 0; }     // the first frame writes everything
+        us_moved[n] = (t1 - t0) * 1e-3f;
+        us_all[n]   = (t2 - t1) * 1e-3f;
+        parts += st.parts;
+        nverts += st.verts;
+        n++;
+    }
+    if (n == 0) error("no complete frames in the session");
+
+    printf("frames:             %d, %d hands, %d vertices, %d triangles\n",
+           n, GLOVE_SKIN_HANDS, sk.nverts, sk.nindices / 3);
+    printf("node per part:      %d nodes/frame\n", GLOVE_SKIN_HANDS * GLOVE_SKIN_PARTS);
+    printf("moved parts only:   %.1f parts/frame, %.0f vertices/frame\n", (double)parts / n, (double)nverts / n);
+    printf("# pass              mean_us  p50_us  p99_us\n");
+    double mm = mean(us_moved, n), ma = mean(us_all, n);
+    printf("moved parts      %10.2f %7.2f %7.2f\n", mm, percentile(us_moved, n, 0.5f), percentile(us_moved, n, 0.99f));
+    printf("all parts        %10.2f %7.2f %7.2f\n", ma, percentile(us_all, n, 0.5f), percentile(us_all, n, 0.99f));
+
+    free(verts); free(us_moved); free(us_all);
+    glove_skin_free(&sk);
+    glove_session_free(&ss);
+    return 0;
+}
+
+//
+static int cmd_interp(int argc, char* argv[])
+{
+    float hz = 60, chunk_ms = 4;
+    int delays[32] = { 0, 10, 20, 30, 50, 100 }, nd = 6, opt;
+    static struct option loptions[] = {
+        {"render", required_argument, 0, 'R'},
+        {"delays", required_argument, 0, 'D'},
+        {"chunk",  required_argument, 0, 'c'},
+        {NULL,     0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "R:D:c:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'R': hz = strtof(optarg, NULL); break;
+        case 'c': chunk_ms = strtof(optarg, NULL); break;
+        case 'D': {
+            char* p = optarg;
+            for (nd = 0; nd < 32 && *p; nd++) {
+                delays[nd] = strtol(p, &p, 10);
+                if (*p == ',') p++;
+            }
+            break;
+        }
+        default: usage();
+        }
+    }
+    if (hz <= 0 || chunk_ms <= 0) error("rate and chunk must be positive");
+
+    glove_session_t ss;
+    if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+    int n = ss.nsamples, nsensors = 0;
+    if (n < 2) error("session too short");
+    for (int i = 0; i < n; i++)
+        if (ss.samples[i].sensor >= nsensors) nsensors = ss.samples[i].sensor + 1;
+
+    // fused orientation after every sample, and when the host would read
+    // it: 2 ms on the wire, then whole USB chunks
+    glove_quat_t* qs     = (glove_quat_t*)malloc(n * sizeof(glove_quat_t));
+    int64_t*      arrive = (int64_t*)malloc(n * sizeof(int64_t));
+    int64_t chunk = (int64_t)(chunk_ms * 1e6f), period = (int64_t)(1e9f / hz);
+    int64_t start = (int64_t)ss.samples[0].t_us * 1000, end = (int64_t)ss.samples[n - 1].t_us * 1000;
+    int nrenders = (int)((end - start) / period) + 1;
+    float* judder = (float*)malloc(nrenders * nsensors * sizeof(float));
+    float* err    = (float*)malloc(nrenders * nsensors * sizeof(float));
+    if (!qs || !arrive || !judder || !err) error("out of memory");
+    glove_fusion_t fu[GLOVE_MAX_SENSORS];
+    for (int k = 0; k < GLOVE_MAX_SENSORS; k++) glove_fusion_init(&fu[k], GLOVE_FUSION_ALPHA);
+    for (int i = 0; i < n; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        glove_fusion_update(&fu[s->sensor], s);
+        qs[i] = fu[s->sensor].q;
+        arrive[i] = ((int64_t)s->t_us * 1000 + 2000000 + chunk - 1) / chunk * chunk;
+    }
+
+    printf("# %.0f Hz display, lines delivered every %.1f ms; judder is the change in\n"
+           "# per-frame rotation, error is against %s at display time (degrees)\n",
+           hz, chunk_ms, ss.ntruth ? "the truth" : "the fused orientation");
+    printf("# mode          late%%  judder_mean judder_p95  err_mean  err_p95\n");
+    // d == -1 draws the newest frame, as the viewers did
+    for (int d = -1; d < nd; d++) {
+        glove_interp_t ip;
+        glove_frame_t f;
+        glove_quat_t q[GLOVE_MAX_SENSORS], prev[GLOVE_MAX_SENSORS], ref;
+        float step[GLOVE_MAX_SENSORS];
+        glove_interp_init(&ip, d < 0 ? 0 : delays[d]);
+        memset(&f, 0, sizeof(f));
+        int next = 0, nj = 0, ne = 0, frames = 0;
+        for (int64_t r = start; r <= end; r += period) {
+            while (next < n && arrive[next] <= r) {
+                const glove_sample_t* s = &ss.samples[next];
+                f.q[s->sensor] = qs[next];
+                f.t_sensor_us[s->sensor] = f.t_us = s->t_us;
+                f.recv_ns = arrive[next];
+                if (s->sensor >= f.nsensors) f.nsensors = s->sensor + 1;
+                f.seq++;
+                if (d >= 0) glove_interp_push(&ip, &f);
+                next++;
+            }
+            if (f.nsensors < nsensors) continue;
+            if (d < 0) memcpy(q, f.q, sizeof(q));
+            else       glove_interp_at(&ip, r, q);
+            for (int k = 0; k < nsensors; k++) {
+                float st = frames ? glove_quat_angle(q[k], prev[k]) : 0;
+                if (frames > 1) judder[nj++] = fabsf(st - step[k]) * GLOVE_RAD2DEG;
+                step[k] = st;
+                prev[k] = q[k];
+                int have = ss.ntruth ? glove_session_truth_interp(&ss, k, r / 1000, &ref) == 0 : 0;
+                if (!ss.ntruth) {
+                    // the fused orientation the newest sample at r would give
+                    int j;
+                    for (j = next - 1; j >= 0 && ss.samples[j].sensor != k; j--) ;
+                    for (; j >= 0 && (int64_t)ss.samples[j].t_us * 1000 > r; j--) ;
+                    if (j >= 0 && ss.samples[j].sensor == k) { ref = qs[j]; have = 1; }
+                }
+                if (have) err[ne++] = glove_quat_angle(q[k], ref) * GLOVE_RAD2DEG;
+            }
+            frames++;
+        }
+
+        if (d < 0) printf("newest            -  ");
+        else       printf("delay %3d ms  %5.1f  ", delays[d], ip.renders ? 100.0 * ip.late / ip.renders : 0.0);
+        printf("%11.3f %10.3f  %8.3f %8.3f\n", mean(judder, nj), percentile(judder, nj, 0.95f),
+               mean(err, ne), percentile(err, ne, 0.95f));
+    }
+
+    free(qs); free(arrive); free(judder); free(err);
+    glove_session_free(&ss);
+    return 0;
+}
+
+//
+static int cmd_record(int argc, char* argv[])
+{
+    const char* port = NULL;
+    const char* out = NULL;
+    const char* calib = NULL;
+    const char* sock = NULL;
+    int baud = 115200, opt;
+    float secs = 0;
+    static struct option loptions[] = {
+        {"output",  required_argument, 0, 'o'},
+        {"port",    required_argument, 0, 'p'},
+        {"baud",    required_argument, 0, 'b'},
+        {"calib",   required_argument, 0, 'c'},
+        {"time",    required_argument, 0, 't'},
+        {"metrics", required_argument, 0, 'M'},
+        {NULL,      0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "o:p:b:c:t:M:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'o': out = optarg; break;
+        case 'p': port = optarg; break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'c': calib = optarg; break;
+        case 't': secs = strtof(optarg, NULL); break;
+        case 'M': sock = optarg; break;
+        default:  usage();
+        }
+    }
+    if (!out) error("no output given (-o)");
+
+    glove_calib_t cal;
+    if (calib && glove_calib_load(calib, &cal) != 0) error("couldn't load calibration");
+    glove_rec_t rec;
+    if (glove_rec_open(&rec, out, calib ? &cal : NULL) != 0) {
+        perror(out);
+        return EXIT_FAILURE;
+    }
+
+    if (port) {
+        // the same reader the viewers run, with the recorder hooked in
+        static glove_handoff_t handoff;
+        glove_stream_t st;
+        struct rusage ru;
+        int fd = serialport_init(port, baud);
+        if (fd == -1) error("couldn't open port");
+        glove_handoff_init(&handoff);
+        glove_stream_init(&st);
+        st.rec = &rec;
+        static glove_metrics_t metrics;
+        glove_metrics_init(&metrics);
+        if (sock) {
+            if (glove_metrics_serve(&metrics, sock) != 0) {
+                perror(sock);
+                return EXIT_FAILURE;
+            }
+            st.metrics = &metrics;
+        }
+        signal(SIGINT, on_sigint);
+        fprintf(stderr, "recording to %s; Ctrl-C to finish\n", out);
+        int64_t t0 = glove_monotonic_ns(), end = t0 + (int64_t)(secs * 1e9f);
+        while (!stop_requested && (secs <= 0 || glove_monotonic_ns() < end))
+            if (glove_stream_poll(&st, fd, 100, &handoff) < 0) {
+                fprintf(stderr, "lost %s\n", port);
+                break;
+            }
+        double elapsed = (glove_monotonic_ns() - t0) * 1e-9;
+        glove_metrics_close(&metrics);
+        serialport_close(fd);
+        getrusage(RUSAGE_SELF, &ru);
+        double cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+        printf("samples:   %llu in %.1f s (%.0f/s), %u bad lines\n", (unsigned long long)rec.nsamples,
+               elapsed, rec.nsamples / elapsed, st.bad_lines);
+        printf("cpu:       %.2f%% of one core, reading and parsing included\n", 100 * cpu / elapsed);
+    } else {
+        glove_session_t ss;
+        if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+        // every write timed: a chunk switch is the slow one
+        float* ns = (float*)malloc(ss.nsamples * sizeof(float));
+        if (!ns) error("out of memory");
+        for (int i = 0; i < ss.nsamples; i++) {
+            int64_t t0 = glove_monotonic_ns();
+            glove_rec_write(&rec, &ss.samples[i]);
+            ns[i] = (float)(glove_monotonic_ns() - t0);
+        }
+        double m = mean(ns, ss.nsamples);
+        printf("samples:   %llu in %u chunks\n", (unsigned long long)rec.nsamples, rec.nchunks);
+        printf("write:     mean %.0f ns, p99 %.0f ns, max %.0f us\n", m,
+               percentile(ns, ss.nsamples, 0.99f), percentile(ns, ss.nsamples, 1.0f) * 1e-3);
+        printf("12 x 1 kHz: %.3f%% of one core\n", m * 12000 * 1e-9 * 100);
+        free(ns);
+        glove_session_free(&ss);
+    }
+    if (rec.dropped) fprintf(stderr, "%u samples dropped (disk full?)\n", rec.dropped);
+    if (glove_rec_close(&rec) != 0) {
+        perror(out);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+//
+static int cmd_replay(int argc, char* argv[])
+{
+    float speed = 1, start = 0, secs = 0;
+    int index = 0, opt;
+    static struct option loptions[] = {
+        {"speed", required_argument, 0, 'x'},
+        {"start", required_argument, 0, 's'},
+        {"time",  required_argument, 0, 't'},
+        {"index", no_argument,       0, 'i'},
+        {NULL,    0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "x:s:t:i", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'x': speed = strtof(optarg, NULL); break;
+        case 's': start = strtof(optarg, NULL); break;
+        case 't': secs = strtof(optarg, NULL); break;
+        case 'i': index = 1; break;
+        default:  usage();
+        }
+    }
+
+    glove_replay_t rp;
+    int64_t t0 = glove_monotonic_ns();
+    if (glove_replay_open(&rp, session_arg(argc, argv)) != 0) error("couldn't open recording");
+    int64_t t1 = glove_monotonic_ns();
+    uint64_t first = glove_replay_first_us(&rp), last = glove_replay_last_us(&rp);
+
+    if (index) {
+        // seeks to random times, timed, then a few checked by a plain scan
+        const int nseek = 100000, ncheck = 50;
+        uint64_t span = last - first + 1, bad = 0;
+        srand(1);
+        int64_t t2 = glove_monotonic_ns();
+        for (int k = 0; k < nseek; k++)
+            glove_replay_seek(&rp, first + (uint64_t)((double)rand() / RAND_MAX * span));
+        int64_t t3 = glove_monotonic_ns();
+        for (int k = 0; k < ncheck; k++) {
+            uint64_t t = first + (uint64_t)((double)rand() / RAND_MAX * span), i = 0;
+            while (i < rp.n && glove_replay_record(&rp, i)->t_us < t) i++;
+            bad += glove_replay_seek(&rp, t) != i;
+        }
+        printf("records:   %llu over %.1f s\n", (unsigned long long)rp.n, (last - first) * 1e-6);
+        printf("index:     %llu entries, every %d records, %s in %.2f ms (open included)\n",
+               (unsigned long long)rp.nindex, GLOVE_REPLAY_STRIDE, rp.index_loaded ? "loaded" : "built",
+               (t1 - t0) * 1e-6);
+        printf("seek:      %.0f ns mean over %d, %llu of %d wrong\n", (double)(t3 - t2) / nseek, nseek,
+               (unsigned long long)bad, ncheck);
+        glove_replay_close(&rp);
+        return bad ? EXIT_FAILURE : 0;
+    }
+
+    glove_replay_set_speed(&rp, speed);
+    glove_replay_seek(&rp, first + (uint64_t)(start * 1e6f));
+    uint64_t end = secs > 0 ? first + (uint64_t)((start + secs) * 1e6f) : UINT64_MAX;
+    glove_sample_t s;
+    char buf[256];
+    signal(SIGINT, on_sigint);
+    int rc;
+    while (!stop_requested && (rc = glove_replay_next(&rp, 100, &s)) >= 0) {
+        if (rc == 0) continue;
+        if (s.t_us >= end) break;
+        glove_sample_format(&s, buf, sizeof(buf));
+        fputs(buf, stdout);
+        // paced output is for a pipe that reads as it goes
+        if (speed > 0) fflush(stdout);
+    }
+    glove_replay_close(&rp);
+    return 0;
+}
+
+//
+static int cmd_pack(int argc, char* argv[])
+{
+    const char* out = NULL;
+    int method = GLOVE_CODEC_VARINT, opt;
+    static struct option loptions[] = {
+        {"method", required_argument, 0, 'm'},
+        {"output", required_argument, 0, 'o'},
+        {NULL,     0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "m:o:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'm': method = glove_codec_method(optarg); break;
+        case 'o': out = optarg; break;
+        default:  usage();
+        }
+    }
+    if (method < 0) error("unknown method (-m)");
+    if (!glove_codec_available(method)) error("method not built in, see make LZ4=1 ZSTD=1");
+
+    // keep a recording's calibration in the packed file
+    const char* path = session_arg(argc, argv);
+    glove_session_t ss;
+    glove_calib_t cal;
+    int has_cal = strcmp(path, "-") != 0 && glove_rec_probe(path);
+    if ((has_cal ? glove_rec_load(path, &ss, &cal) : load_session(path, &ss)) != 0)
+        error("couldn't load session");
+    int n = ss.nsamples, nblocks = (n + GLOVE_CODEC_BLOCK - 1) / GLOVE_CODEC_BLOCK;
+
+    glove_codec_t c;
+    size_t max = glove_codec_bound(GLOVE_CODEC_BLOCK);
+    uint8_t* packed = (uint8_t*)malloc(nblocks * max);
+    glove_sample_t* back = (glove_sample_t*)malloc(n * sizeof(glove_sample_t));
+    if (!packed || !back || glove_codec_init(&c, method) != 0) error("out of memory");
+
+    size_t size = 0, text = 0;
+    int raw_blocks = 0;
+    int64_t t0 = glove_monotonic_ns();
+    for (int i = 0; i < n; i += GLOVE_CODEC_BLOCK) {
+        int m = n - i < GLOVE_CODEC_BLOCK ? n - i : GLOVE_CODEC_BLOCK;
+        long len = glove_codec_encode(&c, ss.samples + i, m, packed + size, max);
+        raw_blocks += packed[size + 4] == GLOVE_CODEC_RAW;
+        size += len;
+    }
+    double encode_s = (glove_monotonic_ns() - t0) * 1e-9;
+    for (int i = 0; i < n; i++) {
+        char buf[256];
+        text += glove_sample_format(&ss.samples[i], buf, sizeof(buf));
+    }
+
+    // decode the lot until it has taken a while, each path; MB/s are of
+    // 40 byte records out, what a recording holds
+    double decode_mbs[2] = { 0, 0 };
+    int bad = 0, simd = 0;
+    for (int path = 0; path < 2; path++) {
+        if (glove_codec_simd(path) != path) continue;
+        simd = path;
+        int64_t start = glove_monotonic_ns(), spent;
+        int rounds = 0;
+        do {
+            size_t at = 0;
+            for (int i = 0; i < n; ) {
+                int m;
+                long len = glove_codec_decode(&c, packed + at, size - at, back + i, &m);
+                if (len < 0) error("packed block didn't decode");
+                at += len;
+                i += m;
+            }
+            rounds++;
+            spent = glove_monotonic_ns() - start;
+        } while (spent < 200000000);
+        decode_mbs[path] = (double)rounds * n * sizeof(glove_rec_sample_t) / (spent * 1e-9) / 1e6;
+        for (int i = 0; i < n; i++) {
+            const glove_sample_t* a = &ss.samples[i];
+            const glove_sample_t* b = &back[i];
+            bad += a->t_us != b->t_us || a->sensor != b->sensor ||
+                   memcmp(a->a, b->a, sizeof(a->a)) != 0 || memcmp(a->g, b->g, sizeof(a->g)) != 0;
+        }
+    }
+
+    size_t rec = (size_t)n * sizeof(glove_rec_sample_t);
+    printf("samples:   %d in %d blocks of up to %d, %d stored plain\n", n, nblocks, GLOVE_CODEC_BLOCK, raw_blocks);
+    printf("recording: %zu bytes (%zu/read); text %zu bytes\n", rec, sizeof(glove_rec_sample_t), text);
+    printf("packed:    %s, %zu bytes, %.2f/read: %.1f:1 vs the recording, %.1f:1 vs text\n",
+           glove_codec_method_name(method), size, (double)size / n, (double)rec / size, (double)text / size);
+    printf("12 x 1 kHz: %.0f MB an hour\n", (double)size / n * 12000 * 3600 / 1e6);
+    printf("encode:    %.0f MB/s\n", rec / encode_s / 1e6);
+    printf("decode:    %.0f MB/s scalar", decode_mbs[0]);
+    if (simd) printf(", %.0f MB/s SSE", decode_mbs[1]);
+    printf(" (records out)\n");
+    printf("check:     %d of %d reads differ\n", bad, n * (simd + 1));
+
+    if (out && glove_codec_save(out, &ss, has_cal ? &cal : NULL, method) != 0) {
+        perror(out);
+        bad++;
+    }
+    glove_codec_simd(1);
+    glove_codec_free(&c);
+    free(packed);
+    free(back);
+    glove_session_free(&ss);
+    return bad ? EXIT_FAILURE : 0;
+}
+
+// Stands in for the glove and its serial link: the session's lines go
+// out at their capture times as a GLOVE_TRACE sketch prints them, send
+// stamp included, and are held for their bytes' time on the wire at
+// baud (0 for no wire).  A line waits for the one before it.
+static void emulate_glove(const glove_session_t* ss, int fd, int baud)
+{
+    int64_t start = glove_monotonic_ns(), wire_free = 0;
+    uint64_t t0 = ss->samples[0].t_us;
+    char buf[256];
+    for (int i = 0; i < ss->nsamples && !stop_requested; i++) {
+        const glove_sample_t* s = &ss->samples[i];
+        int64_t due = start + (int64_t)(s->t_us - t0) * 1000;
+        int64_t sent = due > wire_free ? due : wire_free;
+        int len = snprintf(buf, sizeof(buf), "%d:%u:%.4f:%.4f:%.4f:%.3f:%.3f:%.3f:%u\n", s->sensor,
+                           (uint32_t)s->t_us, s->a[0], s->a[1], s->a[2], s->g[0], s->g[1], s->g[2],
+                           (uint32_t)(s->t_us + (sent - due) / 1000));
+        wire_free = baud > 0 ? sent + (int64_t)len * 10 * 1000000000 / baud : sent;
+        struct timespec ts = { (time_t)(wire_free / 1000000000), (long)(wire_free % 1000000000) };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        if (write(fd, buf, len) != len) return;
+    }
+}
+
+//
+static int cmd_trace(int argc, char* argv[])
+{
+    const char* port = NULL;
+    const char* out = NULL;
+    const char* sock = NULL;
+    int baud = 115200, opt;
+    float hz = 60, secs = 0;
+    static struct option loptions[] = {
+        {"port",    required_argument, 0, 'p'},
+        {"baud",    required_argument, 0, 'b'},
+        {"render",  required_argument, 0, 'R'},
+        {"time",    required_argument, 0, 't'},
+        {"output",  required_argument, 0, 'o'},
+        {"metrics", required_argument, 0, 'M'},
+        {NULL,      0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "p:b:R:t:o:M:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'p': port = optarg; break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'R': hz = strtof(optarg, NULL); break;
+        case 't': secs = strtof(optarg, NULL); break;
+        case 'o': out = optarg; break;
+        case 'M': sock = optarg; break;
+        default:  usage();
+        }
+    }
+    if (hz <= 0) error("render rate must be positive");
+
+    int fd;
+    pid_t glove = -1;
+    signal(SIGINT, on_sigint);
+    if (port) {
+        fd = serialport_init(port, baud);
+        if (fd == -1) error("couldn't open port");
+    } else {
+        glove_session_t ss;
+        int fds[2];
+        if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+        if (pipe(fds) != 0 || (glove = fork()) < 0) error("couldn't start the glove emulator");
+        if (glove == 0) {
+            close(fds[0]);
+            emulate_glove(&ss, fds[1], baud);
+            _exit(0);
+        }
+        close(fds[1]);
+        fd = fds[0];
+        glove_session_free(&ss);
+    }
+
+    static glove_trace_t tr;
+    static glove_handoff_t handoff;
+    static glove_stream_t st;
+    glove_skin_t sk;
+    if (glove_trace_init(&tr, 0) != 0 || glove_skin_init(&sk, 0, 0) != 0) error("out of memory");
+    float* verts = (float*)malloc(sk.nverts * 6 * sizeof(float));
+    if (!verts) error("out of memory");
+    glove_handoff_init(&handoff);
+    glove_stream_init(&st);
+    st.trace = &tr;
+    static glove_metrics_t metrics;
+    glove_metrics_init(&metrics);
+    if (sock) {
+        if (glove_metrics_serve(&metrics, sock) != 0) error("couldn't serve the metrics");
+        st.metrics = &metrics;
+    }
+
+    // One thread, as a GUI loop with a reader would interleave: read until
+    // the next tick, then take the newest frame, pose and skin both hands
+    // (submit) and count it presented at the following tick, as a swap
+    // with vsync would be
+    glove_quat_t rest[GLOVE_HAND_SENSORS];
+    for (int i = 0; i < GLOVE_HAND_SENSORS; i++) rest[i] = glove_quat_identity();
+    glove_hand_pose_t hands[GLOVE_SKIN_HANDS];
+    glove_trace_span_t shown;
+    int pending = 0;
+    uint32_t last_id = 0, drawn_seq = 0;
+    int64_t period = (int64_t)(1e9f / hz), t0 = glove_monotonic_ns(), tick = t0 + period;
+    int64_t end = secs > 0 ? t0 + (int64_t)(secs * 1e9f) : INT64_MAX;
+    while (!stop_requested) {
+        int64_t now = glove_monotonic_ns();
+        if (now >= end) break;
+        if (now < tick) {
+            if (glove_stream_poll(&st, fd, (int)((tick - now + 999999) / 1000000), &handoff) < 0) break;
+            continue;
+        }
+        if (pending) {
+            shown.t[GLOVE_TRACE_PRESENT] = tick;
+            glove_trace_frame(&tr, &shown);
+            pending = 0;
+        }
+        const glove_frame_t* f;
+        glove_handoff_latest(&handoff, &f);
+        if (f->seq && f->trace.id != last_id) {
+            shown = f->trace;
+            shown.t[GLOVE_TRACE_TAKE] = glove_monotonic_ns();
+            if (sock) glove_stream_drawn(&metrics, f, &drawn_seq);
+            for (int h = 0; h < GLOVE_SKIN_HANDS; h++) {
+                int n = f->nsensors - h * GLOVE_HAND_SENSORS;
+                glove_kin_hand(n > 0 ? &f->q[h * GLOVE_HAND_SENSORS] : rest,
+                               n > GLOVE_HAND_SENSORS ? GLOVE_HAND_SENSORS : n > 0 ? n : GLOVE_HAND_SENSORS,
+                               glove_vec3(h ? -0.12f : 0.12f, 0, 0), h, &hands[h]);
+            }
+            glove_skin_update(&sk, hands, GLOVE_SKIN_HANDS, verts, 6 * sizeof(float), 0, 3 * sizeof(float), NULL);
+            shown.t[GLOVE_TRACE_SUBMIT] = glove_monotonic_ns();
+            last_id = shown.id;
+            pending = 1;
+        }
+        // a tick missed is a frame dropped
+        while (tick <= now) tick += period;
+    }
+    glove_metrics_close(&metrics);
+    if (glove > 0) {
+        kill(glove, SIGTERM);
+        waitpid(glove, NULL, 0);
+        close(fd);
+    } else {
+        serialport_close(fd);
+    }
+
+    printf("samples:   %llu, %u bad lines; frames: %llu at %.0f Hz%s\n", (unsigned long long)tr.nsamples,
+           st.bad_lines, (unsigned long long)tr.nframes, hz, port ? "" : ", link emulated");
+    glove_trace_report(&tr, stdout);
+    int rc = 0;
+    if (out && glove_trace_write_json(&tr, out) != 0) {
+        perror(out);
+        rc = EXIT_FAILURE;
+    }
+    free(verts);
+    glove_skin_free(&sk);
+    glove_trace_free(&tr);
+    return rc;
+}
+
+//
+static int cmd_metrics(int argc, char* argv[])
+{
+    if (optind >= argc) usage();
+    static char text[65536];
+    const char* path = argv[optind];
+    if (glove_metrics_scrape(path, text, sizeof(text)) < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    fputs(text, stdout);
+    return 0;
+}
+
+//
+#define PROFILE_BAR 50
+
+// one frame as a bar PROFILE_BAR wide, a letter per phase
+static void profile_row(const glove_profile_t* p, double t)
+{
+    static const char marks[] = "imf.o";
+    char bar[PROFILE_BAR + 1];
+    double at = 0;
+    int n = 0;
+    for (int ph = 0; ph < GLOVE_PROFILE_PHASES; ph++) {
+        // rounded at the running total, so the bar is always full width
+        at += glove_profile_share(p, ph) * PROFILE_BAR;
+        int end = ph == GLOVE_PROFILE_PHASES - 1 ? PROFILE_BAR : (int)(at + 0.5);
+        while (n < end && n < PROFILE_BAR) bar[n++] = marks[ph];
+    }
+    bar[n] = 0;
+    printf("%8.2f %6u %8.2f %8.2f %6.2f  %s\n", t, p->loops,
+           p->loops ? p->loop_us * 1e-3 / p->loops : 0.0, p->max_loop_us * 1e-3,
+           100 * glove_profile_overhead(p), bar);
+}
+
+static int cmd_profile(int argc, char* argv[])
+{
+    const char* port = NULL;
+    const char* out = NULL;
+    int baud = 115200, opt;
+    float secs = 0;
+    static struct option loptions[] = {
+        {"port",   required_argument, 0, 'p'},
+        {"baud",   required_argument, 0, 'b'},
+        {"time",   required_argument, 0, 't'},
+        {"output", required_argument, 0, 'o'},
+        {NULL,     0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "p:b:t:o:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'p': port = optarg; break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 't': secs = strtof(optarg, NULL); break;
+        case 'o': out = optarg; break;
+        default:  usage();
+        }
+    }
+
+    FILE* fp = NULL;
+    int fd = -1;
+    if (port) {
+        fd = serialport_init(port, baud);
+        if (fd == -1) error("couldn't open port");
+        signal(SIGINT, on_sigint);
+        fprintf(stderr, "reading %s; Ctrl-C to finish\n", port);
+    } else {
+        const char* path = session_arg(argc, argv);
+        fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+        if (!fp) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+    }
+    FILE* csv = NULL;
+    if (out) {
+        if (!(csv = fopen(out, "w"))) {
+            perror(out);
+            return EXIT_FAILURE;
+        }
+        fprintf(csv, "t_s,loops,loop_us,max_loop_us,i2c_us,math_us,format_us,idle_us,other_us,probe_us\n");
+    }
+
+    printf("#    t s  loops  loop ms   max ms probe%%  i=i2c m=math f=format .=idle o=other\n");
+    char line[256];
+    glove_profile_t p, sum;
+    memset(&sum, 0, sizeof(sum));
+    uint64_t clock = 0, t0 = 0;
+    int frames = 0;
+    int64_t end = glove_monotonic_ns() + (int64_t)(secs * 1e9f);
+    while (!stop_requested && (secs <= 0 || !port || glove_monotonic_ns() < end)) {
+        if (port) {
+            if (serialport_read_until(fd, line, '\n', sizeof(line) - 1, 1000) != 0) continue;
+        } else if (!fgets(line, sizeof(line), fp)) {
+            break;
+        }
+        if (glove_profile_parse(line, &p) != 0) continue;
+        // the sketch's micros(), as on sample lines
+        uint64_t t = glove_clock_unwrap(&clock, p.t_us);
+        if (frames++ == 0) t0 = t;
+        profile_row(&p, (t - t0) * 1e-6);
+        fflush(stdout);
+        if (csv) {
+            fprintf(csv, "%.3f,%u,%llu,%u", (t - t0) * 1e-6, p.loops,
+                    (unsigned long long)p.loop_us, p.max_loop_us);
+            for (int ph = 0; ph < GLOVE_PROFILE_PHASES; ph++)
+                fprintf(csv, ",%llu", (unsigned long long)p.us[ph]);
+            fprintf(csv, ",%llu\n", (unsigned long long)p.probe_us);
+        }
+        glove_profile_add(&sum, &p);
+    }
+    if (port) serialport_close(fd);
+    else if (fp != stdin) fclose(fp);
+    if (csv) fclose(csv);
+    if (frames == 0) error("no #P lines; is the sketch built with GLOVE_PROFILE?");
+
+    printf("\n# phase     us/loop   share\n");
+    for (int ph = 0; ph < GLOVE_PROFILE_PHASES; ph++)
+        printf("%-8s  %9.1f  %5.1f%%\n", glove_profile_phase_name(ph),
+               sum.loops ? (double)sum.us[ph] / sum.loops : 0.0, 100 * glove_profile_share(&sum, ph));
+    printf("loops:    %u over %d frames, %.2f ms mean, %.2f ms max\n", sum.loops, frames,
+           sum.loops ? sum.loop_us * 1e-3 / sum.loops : 0.0, sum.max_loop_us * 1e-3);
+    double over = glove_profile_overhead(&sum);
+    printf("probe:    %.3f%% of loop time, spread over the phases (budget %.0f%%)\n",
+           100 * over, 100 * GLOVE_PROFILE_BUDGET);
+    return over > GLOVE_PROFILE_BUDGET ? EXIT_FAILURE : 0;
+}
+
+//
+static int cmd_golden(int argc, char* argv[])
+{
+    static const char* stages[] = { "fusion", "kinematics" };
+    const char* gold = NULL;
+    int write = 0, opt;
+    float alpha = GLOVE_FUSION_ALPHA, max_err = 0.05f, max_slower = 15;
+    static struct option loptions[] = {
+        {"golden", required_argument, 0, 'g'},
+        {"write",  no_argument,       0, 'w'},
+        {"alpha",  required_argument, 0, 'a'},
+        {"error",  required_argument, 0, 'e'},
+        {"speed",  required_argument, 0, 's'},
+        {NULL,     0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "g:wa:e:s:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'g': gold = optarg; break;
+        case 'w': write = 1; break;
+        case 'a': alpha = strtof(optarg, NULL); break;
+        case 'e': max_err = strtof(optarg, NULL); break;
+        case 's': max_slower = strtof(optarg, NULL); break;
+        default:  usage();
+        }
+    }
+    const char* path = session_arg(argc, argv);
+    static char gold_path[1024];
+    if (!gold) {
+        if (strcmp(path, "-") == 0) error("reading stdin: say where the golden trace is (-g)");
+        // session.txt -> session.gold
+        const char* slash = strrchr(path, '/');
+        const char* dot = strrchr(path, '.');
+        int n = dot && (!slash || dot > slash) ? (int)(dot - path) : (int)strlen(path);
+        snprintf(gold_path, sizeof(gold_path), "%.*s.gold", n, path);
+        gold = gold_path;
+    }
+
+    glove_session_t ss;
+    glove_golden_t now, golden;
+    if (load_session(path, &ss) != 0) error("couldn't load session");
+    if (glove_golden_run(&ss, alpha, &now) != 0) error("out of memory");
+    now.ns_per_sample = glove_golden_time(&ss, alpha, GLOVE_GOLDEN_RUNS, &now.ref_ns);
+
+    if (write) {
+        char comment[256];
+        snprintf(comment, sizeof(comment), "glove-tool golden -w: fusion and kinematics of %.200s", path);
+        if (glove_golden_save(gold, &now, comment) != 0) {
+            perror(gold);
+            return EXIT_FAILURE;
+        }
+        printf("wrote %s: %d fused samples, %d frames, alpha %.3f, %.1f ns/sample\n",
+               gold, now.nfused, now.nframes, alpha, now.ns_per_sample);
+        glove_golden_free(&now);
+        glove_session_free(&ss);
+        return 0;
+    }
+
+    glove_golden_cmp_t c;
+    if (glove_golden_load(gold, &golden) != 0) {
+        fprintf(stderr, "%s: not a golden trace\n", gold);
+        return EXIT_FAILURE;
+    }
+    if (glove_golden_compare(&ss, &golden, &now, &c) != 0)
+        error("golden trace doesn't line up with the session (made from another one?)");
+
+    int failed = 0;
+    printf("# %s: alpha %.3f then, %.3f now (degrees)\n", gold, golden.alpha, alpha);
+    printf("# stage        drift: mean      p95      max    vs truth p95: then      now    delta\n");
+    for (int st = 0; st < GLOVE_GOLDEN_STAGES; st++) {
+        const glove_golden_err_t* d = &c.drift[st];
+        printf("%-12s  %11.4f %8.4f %8.4f", stages[st], d->mean, d->p95, d->max);
+        if (c.truth_now[st].n) {
+            double delta = c.truth_now[st].p95 - c.truth_then[st].p95;
+            printf("  %19.4f %8.4f %+8.4f", c.truth_then[st].p95, c.truth_now[st].p95, delta);
+            if (delta > max_err) {
+                printf("  worse");
+                failed = 1;
+            }
+        } else {
+            printf("  %19s %8s %8s", "-", "-", "-");
+            if (d->p95 > max_err) {
+                printf("  changed");
+                failed = 1;
+            }
+        }
+        printf("\n");
+    }
+    double slower = 100 * glove_golden_slower(&golden, &now);
+    printf("speed:        %.1f -> %.1f ns/sample, %+.1f%% against the reference loop",
+           golden.ns_per_sample, now.ns_per_sample, slower);
+    if (max_slower > 0 && slower > max_slower) {
+        printf("  slower");
+        failed = 1;
+    }
+    printf("\n");
+    if (failed) fprintf(stderr, "%s: regression past -e %.3g deg / -s %.3g%%\n", path, max_err, max_slower);
+
+    glove_golden_free(&golden);
+    glove_golden_free(&now);
+    glove_session_free(&ss);
+    return failed ? EXIT_FAILURE : 0;
+}
+
+//
+static int cmd_broker(int argc, char* argv[])
+{
+    const char* ports[GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS];
+    const char* name = NULL;
+    const char* sock = NULL;
+    int nports = 0, baud = 115200, slots = GLOVE_SHM_SLOTS, opt;
+    float secs = 0;
+    static struct option loptions[] = {
+        {"port",    required_argument, 0, 'p'},
+        {"baud",    required_argument, 0, 'b'},
+        {"name",    required_argument, 0, 'n'},
+        {"slots",   required_argument, 0, 's'},
+        {"time",    required_argument, 0, 't'},
+        {"metrics", required_argument, 0, 'M'},
+        {NULL,      0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "p:b:n:s:t:M:", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'p':
+            if (nports == GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS) error("one port per hand");
+            ports[nports++] = optarg;
+            break;
+        case 'b': baud = strtol(optarg, NULL, 10); break;
+        case 'n': name = optarg; break;
+        case 's': slots = strtol(optarg, NULL, 10); break;
+        case 't': secs = strtof(optarg, NULL); break;
+        case 'M': sock = optarg; break;
+        default:  usage();
+        }
+    }
+
+    int fd[GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS];
+    pid_t glove = -1;
+    signal(SIGINT, on_sigint);
+    signal(SIGTERM, on_sigint);
+    for (int k = 0; k < nports; k++) {
+        fd[k] = serialport_init(ports[k], baud);
+        if (fd[k] == -1) error("couldn't open port");
+    }
+    if (nports == 0) {
+        // no glove: the session over an emulated link, as trace does
+        glove_session_t ss;
+        int fds[2];
+        if (load_session(session_arg(argc, argv), &ss) != 0) error("couldn't load session");
+        if (pipe(fds) != 0 || (glove = fork()) < 0) error("couldn't start the glove emulator");
+        if (glove == 0) {
+            close(fds[0]);
+            emulate_glove(&ss, fds[1], baud);
+            _exit(0);
+        }
+        close(fds[1]);
+        fd[nports++] = fds[0];
+        glove_session_free(&ss);
+    }
+
+    static glove_shm_t shm;
+    if (glove_shm_create(&shm, name, slots) != 0) {
+        perror(name ? name : GLOVE_SHM_NAME);
+        return EXIT_FAILURE;
+    }
+    // a reader per port, the second port's glove as the left hand
+    static glove_handoff_t handoff[GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS];
+    static glove_stream_t st[GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS];
+    static glove_metrics_t metrics;
+    glove_metrics_init(&metrics);
+    if (sock && glove_metrics_serve(&metrics, sock) != 0) error("couldn't serve the metrics");
+    struct pollfd pfd[GLOVE_MAX_SENSORS / GLOVE_HAND_SENSORS];
+    for (int k = 0; k < nports; k++) {
+        glove_handoff_init(&handoff[k]);
+        glove_stream_init(&st[k]);
+        st[k].shm = &shm;
+        st[k].sensor_base = k * GLOVE_HAND_SENSORS;
+        if (sock) st[k].metrics = &metrics;
+        pfd[k].fd = fd[k];
+        pfd[k].events = POLLIN;
+    }
+    fprintf(stderr, "publishing to /dev/shm%s, %d slots; Ctrl-C to stop\n", shm.name, slots);
+
+    int64_t t0 = glove_monotonic_ns(), end = secs > 0 ? t0 + (int64_t)(secs * 1e9f) : INT64_MAX;
+    int live = 1;
+    while (live && !stop_requested && glove_monotonic_ns() < end) {
+        int rc = poll(pfd, nports, GLOVE_SHM_BEAT_NS / 1000000);
+        if (rc <= 0) {
+            glove_shm_beat(&shm);
+            continue;
+        }
+        for (int k = 0; k < nports; k++) {
+            if (!pfd[k].revents) continue;
+            if (glove_stream_poll(&st[k], fd[k], 0, &handoff[k]) < 0) {
+                if (glove < 0) fprintf(stderr, "lost %s\n", ports[k]);
+                live = 0;
+            }
+        }
+    }
+    double elapsed = (glove_monotonic_ns() - t0) * 1e-9;
+    uint64_t published = glove_shm_head(&shm);
+    unsigned bad = 0;
+    for (int k = 0; k < nports; k++) bad += st[k].bad_lines;
+    glove_shm_close(&shm);
+    glove_metrics_close(&metrics);
+    if (glove > 0) {
+        kill(glove, SIGTERM);
+        waitpid(glove, NULL, 0);
+        close(fd[0]);
+    } else {
+        for (int k = 0; k < nports; k++) serialport_close(fd[k]);
+    }
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    double cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+    printf("samples:   %llu published in %.1f s (%.0f/s), %u bad lines\n", (unsigned long long)published,
+           elapsed, published / elapsed, bad);
+    printf("cpu:       %.2f%% of one core, reading and fusion included\n", 100 * cpu / elapsed);
+    return 0;
+}
+
+//
+static int cmd_tap(int argc, char* argv[])
+{
+    const char* name = NULL;
+    int pose = 0, opt;
+    float secs = 0;
+    static struct option loptions[] = {
+        {"name", required_argument, 0, 'n'},
+        {"time", required_argument, 0, 't'},
+        {"pose", no_argument,       0, 'P'},
+        {NULL,   0,                 0, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "n:t:P", loptions, NULL)) != -1) {
+        switch (opt) {
+        case 'n': name = optarg; break;
+        case 't': secs = strtof(optarg, NULL); break;
+        case 'P': pose = 1; break;
+        default:  usage();
+        }
+    }
+
+    static glove_shm_t shm;
+    if (glove_shm_open(&shm, name) != 0) {
+        perror(name ? name : GLOVE_SHM_NAME);
+        return EXIT_FAILURE;
+    }
+    if (pose) {
+        glove_shm_pose_t p;
+        int got = glove_shm_latest(&shm, &p);
+        if (got < 0) error("broker gone");
+        if (got == 0) error("nothing published yet");
+        printf("# sample %llu, t_us %llu, %.3f ms old\n", (unsigned long long)p.n,
+               (unsigned long long)p.t_us, (glove_monotonic_ns() - p.recv_ns) * 1e-6);
+        for (int i = 0; i < p.nsensors; i++)
+            printf("%2d %-8s %8.5f %8.5f %8.5f %8.5f\n", i, glove_sensor_name(i),
+                   p.q[i].w, p.q[i].x, p.q[i].y, p.q[i].z);
+        glove_shm_close(&shm);
+        return 0;
+    }
+
+    // new samples as text lines, for any tool that reads a session; the
+    // age of each, publish to read, is kept for the summary
+    static glove_shm_entry_t batch[256];
+    float* age = NULL;
+    int nage = 0, cap = 0;
+    uint64_t next = glove_shm_head(&shm), lost = 0;
+    char buf[256];
+    signal(SIGINT, on_sigint);
+    signal(SIGPIPE, on_sigint);
+    int64_t end = secs > 0 ? glove_monotonic_ns() + (int64_t)(secs * 1e9f) : INT64_MAX;
+    while (!stop_requested && glove_monotonic_ns() < end) {
+        uint64_t from = next;
+        int n = glove_shm_read(&shm, from, batch, 256, &next);
+        if (n == 0) {
+            if (glove_shm_idle_ns(&shm) > GLOVE_SHM_STALE_NS) {
+                fprintf(stderr, "broker gone\n");
+                break;
+            }
+            struct timespec ts = { 0, 200000 };
+            nanosleep(&ts, NULL);
+            continue;
+        }
+        int64_t now = glove_monotonic_ns();
+        lost += next - from - n;
+        if (nage + n > cap) {
+            cap = cap ? 2 * cap : 65536;
+            if (!(age = (float*)realloc(age, cap * sizeof(float)))) error("out of memory");
+        }
+        for (int i = 0; i < n; i++) {
+            age[nage++] = (float)(now - batch[i].pub_ns);
+            glove_sample_format(&batch[i].s, buf, sizeof(buf));
+            fputs(buf, stdout);
+        }
+        fflush(stdout);
+    }
+    glove_shm_close(&shm);
+    if (nage)
+        fprintf(stderr, "tapped %d samples, %llu lost; age when read: median %.0f us, p99 %.0f us\n",
+                nage, (unsigned long long)lost, percentile(age, nage, 0.5f) * 1e-3,
+                percentile(age, nage, 0.99f) * 1e-3);
+    free(age);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) usage();
+    const char* cmd = argv[1];
+    // let getopt see the command's own options
+    argc--; argv++;
+    if (strcmp(cmd, "synth") == 0)    return cmd_synth(argc, argv);
+    if (strcmp(cmd, "position") == 0) return cmd_position(argc, argv);
+    if (strcmp(cmd, "predict") == 0)  return cmd_predict(argc, argv);
+    if (strcmp(cmd, "align") == 0)    return cmd_align(argc, argv);
+    if (strcmp(cmd, "yaw") == 0)      return cmd_yaw(argc, argv);
+    if (strcmp(cmd, "calib") == 0)    return cmd_calib(argc, argv);
+    if (strcmp(cmd, "skin") == 0)     return cmd_skin(argc, argv);
+    if (strcmp(cmd, "interp") == 0)   return cmd_interp(argc, argv);
+    if (strcmp(cmd, "record") == 0)   return cmd_record(argc, argv);
+    if (strcmp(cmd, "replay") == 0)   return cmd_replay(argc, argv);
+    if (strcmp(cmd, "pack") == 0)     return cmd_pack(argc, argv);
+    if (strcmp(cmd, "trace") == 0)    return cmd_trace(argc, argv);
+    if (strcmp(cmd, "metrics") == 0)  return cmd_metrics(argc, argv);
+    if (strcmp(cmd, "profile") == 0)  return cmd_profile(argc, argv);
+    if (strcmp(cmd, "golden") == 0)   return cmd_golden(argc, argv);
+    if (strcmp(cmd, "broker") == 0)   return cmd_broker(argc, argv);
+    if (strcmp(cmd, "tap") == 0)      return cmd_tap(argc, argv);
+    usage();
+    return 0;
+}
@@ -0,0 +1,228 @@
+//
+// glove-trace -- where a sample's latency goes
+//
+
+#include "glove-trace.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 0..31 ns exact, then 16 buckets per power of two
+static int bucket_of(int64_t ns)
+{
+    if (ns < 32) return ns < 0 ? 0 : (int)ns;
+    int e = 63 - __builtin_clzll((unsigned long long)ns) - 4;      // ns >> e is 16..31
+    int b = (e + 1) * 16 + (int)((ns >> e) - 16);
+    return b < GLOVE_TRACE_BUCKETS ? b : GLOVE_TRACE_BUCKETS - 1;
+}
+
+static double bucket_mid_ns(int b)
+{
+    if (b < 32) return b;
+    int e = b / 16 - 1;
+    return (b % 16 + 16.5) * (double)(1ll << e);
+}
+
+static void hist_add(glove_trace_hist_t* h, int64_t ns)
+{
+    h->bucket[bucket_of(ns)]++;
+    h->count++;
+    if (ns > h->max_ns) h->max_ns = ns;
+}
+
+static double hist_percentile_ms(const glove_trace_hist_t* h, double p)
+{
+    // a bucket's middle can lie past the largest value it holds
+    uint64_t want = (uint64_t)(p * h->count), seen = 0;
+    for (int b = 0; b < GLOVE_TRACE_BUCKETS; b++)
+        if ((seen += h->bucket[b]) > want) return fmin(bucket_mid_ns(b), (double)h->max_ns) * 1e-6;
+    return h->max_ns * 1e-6;
+}
+
+// stage k against the latest earlier stage the span passed
+static int64_t stage_ns(const glove_trace_span_t* sp, int k)
+{
+    if (!sp->t[k]) return -1;
+    for (int j = k - 1; j >= 0; j--)
+        if (sp->t[j]) return sp->t[k] - sp->t[j];
+    return -1;
+}
+
+static void add_stages(glove_trace_t* tr, const glove_trace_span_t* sp, int from, int to)
+{
+    for (int k = from; k <= to; k++) {
+        int64_t ns = stage_ns(sp, k);
+        if (ns >= 0) hist_add(&tr->hist[k], ns);
+    }
+}
+
+int glove_trace_init(glove_trace_t* tr, int depth)
+{
+    memset(tr, 0, sizeof(*tr));
+    tr->depth = depth > 0 ? depth : GLOVE_TRACE_DEPTH;
+    tr->samples = (glove_trace_span_t*)calloc(tr->depth, sizeof(glove_trace_span_t));
+    tr->frames = (glove_trace_span_t*)calloc(tr->depth, sizeof(glove_trace_span_t));
+    if (!tr->samples || !tr->frames) {
+        glove_trace_free(tr);
+        return -1;
+    }
+    return 0;
+}
+
+void glove_trace_free(glove_trace_t* tr)
+{
+    free(tr->samples);
+    free(tr->frames);
+    tr->samples = tr->frames = NULL;
+}
+
+void glove_trace_glove(glove_trace_t* tr, glove_trace_span_t* sp, uint64_t t_us, uint64_t sent_us)
+{
+    // the later glove stamp is the one closer to arrival
+    int64_t arrive = sp->t[GLOVE_TRACE_ARRIVE];
+    int64_t off = arrive - (int64_t)(sent_us ? sent_us : t_us) * 1000;
+    int64_t crept = tr->offset_ns + (int64_t)((arrive - tr->offset_at_ns) * GLOVE_TRACE_SLEW);
+    // a second late is no backlog: the glove restarted, its clock with it
+    if (tr->offset_at_ns == 0 || off > crept + 1000000000) tr->offset_ns = off;
+    else tr->offset_ns = off < crept ? off : crept;
+    tr->offset_at_ns = arrive;
+
+    sp->t[GLOVE_TRACE_CAPTURE] = (int64_t)t_us * 1000 + tr->offset_ns;
+    sp->t[GLOVE_TRACE_SEND] = sent_us ? (int64_t)sent_us * 1000 + tr->offset_ns : 0;
+}
+
+void glove_trace_sample(glove_trace_t* tr, const glove_trace_span_t* sp)
+{
+    add_stages(tr, sp, GLOVE_TRACE_SEND, GLOVE_TRACE_FUSE);
+    tr->samples[tr->nsamples++ % tr->depth] = *sp;
+}
+
+void glove_trace_frame(glove_trace_t* tr, const glove_trace_span_t* sp)
+{
+    add_stages(tr, sp, GLOVE_TRACE_TAKE, GLOVE_TRACE_PRESENT);
+    if (sp->t[GLOVE_TRACE_CAPTURE] && sp->t[GLOVE_TRACE_PRESENT])
+        hist_add(&tr->hist[0], sp->t[GLOVE_TRACE_PRESENT] - sp->t[GLOVE_TRACE_CAPTURE]);
+    tr->frames[tr->nframes++ % tr->depth] = *sp;
+}
+
+void glove_trace_report(const glove_trace_t* tr, FILE* fp)
+{
+    static const char* names[GLOVE_TRACE_STAGES] = {
+        "capture -> present", "capture -> send", "-> arrive", "arrive -> parse",
+        "parse -> fuse", "fuse -> take", "take -> submit", "submit -> present"
+    };
+    fprintf(fp, "%-20s %9s %9s %9s %9s\n", "stage", "n", "p50 ms", "p99 ms", "max ms");
+    for (int i = 1; i <= GLOVE_TRACE_STAGES; i++) {
+        int k = i % GLOVE_TRACE_STAGES;                 // the total last
+        const glove_trace_hist_t* h = &tr->hist[k];
+        if (!h->count) continue;
+        const char* name = names[k];
+        if (k == GLOVE_TRACE_ARRIVE) name = tr->hist[GLOVE_TRACE_SEND].count ? "send -> arrive" : "capture -> arrive";
+        fprintf(fp, "%-20s %9llu %9.3f %9.3f %9.3f\n", name, (unsigned long long)h->count,
+                hist_percentile_ms(h, 0.5), hist_percentile_ms(h, 0.99), h->max_ns * 1e-6);
+    }
+    if (!tr->hist[0].count) fprintf(fp, "(no frames traced)\n");
+}
+
+//
+// Chrome trace JSON
+//
+
+// the kept part of a ring, oldest first
+static void kept(const glove_trace_t* tr, uint64_t n, uint64_t* first, uint64_t* count)
+{
+    *count = n < (uint64_t)tr->depth ? n : tr->depth;
+    *first = n - *count;
+}
+
+static void event(FILE* fp, int* comma, const char* ph, const char* name, int tid, int64_t ns, int64_t base)
+{
+    fprintf(fp, "%s{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f",
+            *comma ? ",\n" : "", ph, name, tid, (ns - base) * 1e-3);
+    *comma = 1;
+}
+
+// slices and async slices with an end not stamped are left out
+static void slice(FILE* fp, int* comma, const char* name, int tid, int64_t from, int64_t to,
+                  int64_t base, uint32_t id)
+{
+    if (!from || !to) return;
+    event(fp, comma, "X", name, tid, from, base);
+    fprintf(fp, ",\"dur\":%.3f,\"args\":{\"id\":%u}}", (to - from) * 1e-3, id);
+}
+
+// an async slice on the sample's own track, scoped by cat
+static void async(FILE* fp, int* comma, const char* cat, const char* name, int64_t from, int64_t to,
+                  int64_t base, uint32_t id)
+{
+    if (!from || !to) return;
+    event(fp, comma, "b", name, 1, from, base);
+    fprintf(fp, ",\"cat\":\"%s\",\"id\":%u}", cat, id);
+    event(fp, comma, "e", name, 1, to, base);
+    fprintf(fp, ",\"cat\":\"%s\",\"id\":%u}", cat, id);
+}
+
+int glove_trace_write_json(const glove_trace_t* tr, const char* path)
+{
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) return -1;
+
+    uint64_t s0, ns, f0, nf;
+    kept(tr, tr->nsamples, &s0, &ns);
+    kept(tr, tr->nframes, &f0, &nf);
+    // time 0 is the earliest stamp kept; the frames ring may reach back
+    // past the samples ring, and a frame drawn before any sample has no
+    // capture
+    int64_t base = INT64_MAX;
+    for (uint64_t i = 0; i < ns + nf; i++) {
+        const int64_t* t = i < ns ? tr->samples[(s0 + i) % tr->depth].t
+                                  : tr->frames[(f0 + i - ns) % tr->depth].t;
+        for (int k = 0; k < GLOVE_TRACE_STAGES; k++)
+            if (t[k] && t[k] < base) base = t[k];
+    }
+    if (base == INT64_MAX) base = 0;
+
+    int comma = 0;
+    static const char* threads[] = { "glove", "reader", "render" };
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int t = 0; t < 3; t++) {
+        fprintf(fp, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                comma ? ",\n" : "", t + 1, threads[t]);
+        comma = 1;
+    }
+
+    // samples: glove to published, the reader's work, and a flow arrow
+    // from publishing to the frame that draws them
+    for (uint64_t i = 0; i < ns; i++) {
+        const glove_trace_span_t* sp = &tr->samples[(s0 + i) % tr->depth];
+        const int64_t* t = sp->t;
+        char name[32];
+        snprintf(name, sizeof(name), "sensor %d", sp->sensor);
+        async(fp, &comma, "sample", name, t[GLOVE_TRACE_CAPTURE], t[GLOVE_TRACE_FUSE], base, sp->id);
+        if (t[GLOVE_TRACE_SEND]) {
+            async(fp, &comma, "sample", "firmware", t[GLOVE_TRACE_CAPTURE], t[GLOVE_TRACE_SEND], base, sp->id);
+            async(fp, &comma, "sample", "link", t[GLOVE_TRACE_SEND], t[GLOVE_TRACE_ARRIVE], base, sp->id);
+        } else {
+            async(fp, &comma, "sample", "firmware + link", t[GLOVE_TRACE_CAPTURE], t[GLOVE_TRACE_ARRIVE], base, sp->id);
+        }
+        slice(fp, &comma, "parse", 2, t[GLOVE_TRACE_ARRIVE], t[GLOVE_TRACE_PARSE], base, sp->id);
+        slice(fp, &comma, "fuse", 2, t[GLOVE_TRACE_PARSE], t[GLOVE_TRACE_FUSE], base, sp->id);
+        event(fp, &comma, "s", "handoff", 2, t[GLOVE_TRACE_FUSE], base);
+        fprintf(fp, ",\"cat\":\"handoff\",\"id\":%u}", sp->id);
+    }
+    // frames: the render thread's work, and the whole way for their sample
+    for (uint64_t i = 0; i < nf; i++) {
+        const glove_trace_span_t* sp = &tr->frames[(f0 + i) % tr->depth];
+        const int64_t* t = sp->t;
+        slice(fp, &comma, "draw", 3, t[GLOVE_TRACE_TAKE], t[GLOVE_TRACE_SUBMIT], base, sp->id);
+        slice(fp, &comma, "present", 3, t[GLOVE_TRACE_SUBMIT], t[GLOVE_TRACE_PRESENT], base, sp->id);
+        if (t[GLOVE_TRACE_CAPTURE] && t[GLOVE_TRACE_TAKE]) {
+            event(fp, &comma, "f", "handoff", 3, t[GLOVE_TRACE_TAKE], base);
+            fprintf(fp, ",\"cat\":\"handoff\",\"id\":%u,\"bp\":\"e\"}", sp->id);
+        }
+        async(fp, &comma, "frame", "capture to present", t[GLOVE_TRACE_CAPTURE], t[GLOVE_TRACE_PRESENT], base, sp->id);
+    }
+    fprintf(fp, "\n]}\n");
+    return fclose(fp) == 0 ? 0 : -1;
+}
@@ -0,0 +1,96 @@
+//
+// glove-trace -- where a sample's latency goes, from the IMU read to
+// the frame that shows it
+//
+// Every sample gets a span: the time it passed each stage, on
+// glove_monotonic_ns().  The reader thread stamps arrival (read()
+// returned its bytes), parse and fuse (published to the handoff) and
+// records the span.  The frame it goes out in carries a copy, so the
+// render thread adds take (picked up from the handoff), submit (draw
+// calls issued) and present (swap or glFinish() returned) for the newest
+// sample of each frame it draws, and records that.  The span's id is the
+// frame seq the sample was published as.
+//
+// The glove stamps capture with its own micros().  Built with
+// GLOVE_TRACE, the sketch also ends each line with the micros() at which
+// it had queued the line for Serial ("...:gz:sent_us").  Both are put on
+// the host clock by the smallest arrival-minus-glove offset seen,
+// creeping up as glove-interp's does for the resonator's drift.  So the
+// link stage is measured against the quickest line: its spread (Serial
+// backlog, USB polling, the reader's wakeup) shows, the fixed wire time
+// doesn't.  A 50 byte line takes 4.3 ms at 115200 baud.
+//
+// Whole-run histograms give each stage's p50/p99.  The last DEPTH spans
+// of each thread are kept for a Chrome trace JSON file, which
+// chrome://tracing and ui.perfetto.dev open.  Recording a span is a
+// copy and a few adds: no locks, no allocation, one writer per field.
+//
+
+
+#ifndef __GLOVE_TRACE_H__
+#define __GLOVE_TRACE_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+// stages, in the order a sample passes them
+#define GLOVE_TRACE_CAPTURE     0       // IMU read, glove clock
+#define GLOVE_TRACE_SEND        1       // line queued for Serial, glove clock (GLOVE_TRACE sketches)
+#define GLOVE_TRACE_ARRIVE      2       // read() returned it
+#define GLOVE_TRACE_PARSE       3
+#define GLOVE_TRACE_FUSE        4       // fused and published
+#define GLOVE_TRACE_TAKE        5       // render thread took the frame
+#define GLOVE_TRACE_SUBMIT      6       // draw calls issued
+#define GLOVE_TRACE_PRESENT     7       // swap / glFinish() returned
+#define GLOVE_TRACE_STAGES      8
+
+#define GLOVE_TRACE_DEPTH       65536   // spans kept per thread for the JSON
+#define GLOVE_TRACE_BUCKETS     1024    // 16 per octave of nanoseconds
+#define GLOVE_TRACE_SLEW        0.01f   // clock offset creep, as GLOVE_INTERP_SLEW
+
+typedef struct {
+    uint32_t id;                        // frame seq the sample went out as
+    uint8_t  sensor;
+    int64_t  t[GLOVE_TRACE_STAGES];     // glove_monotonic_ns(), 0 if not passed
+} glove_trace_span_t;
+
+typedef struct {
+    uint64_t count;
+    int64_t  max_ns;
+    uint32_t bucket[GLOVE_TRACE_BUCKETS];
+} glove_trace_hist_t;
+
+typedef struct {
+    int                 depth;
+    // reader thread
+    int64_t             offset_ns;      // monotonic = glove us * 1000 + offset
+    int64_t             offset_at_ns;
+    glove_trace_span_t* samples;        // ring of the last depth samples
+    uint64_t            nsamples;
+    // render thread
+    glove_trace_span_t* frames;         // ... and frames
+    uint64_t            nframes;
+    // hist[k]: the stage before k (that was stamped) to k; hist[0] is
+    // capture to present.  SEND..FUSE are the reader's, the rest the
+    // render thread's
+    glove_trace_hist_t  hist[GLOVE_TRACE_STAGES];
+} glove_trace_t;
+
+// depth spans per thread (0 for GLOVE_TRACE_DEPTH); 0, or -1 out of memory
+int  glove_trace_init(glove_trace_t* tr, int depth);
+void glove_trace_free(glove_trace_t* tr);
+
+// reader: capture (and send, 0 if the line had none) in glove
+// microseconds onto sp, whose ARRIVE is stamped
+void glove_trace_glove(glove_trace_t* tr, glove_trace_span_t* sp, uint64_t t_us, uint64_t sent_us);
+// reader: a sample was published
+void glove_trace_sample(glove_trace_t* tr, const glove_trace_span_t* sp);
+// render thread: a frame's newest sample, TAKE..PRESENT stamped
+void glove_trace_frame(glove_trace_t* tr, const glove_trace_span_t* sp);
+
+// per-stage count, p50, p99 and max, once both threads are done
+void glove_trace_report(const glove_trace_t* tr, FILE* fp);
+// the kept spans as Chrome trace JSON; 0, or -1 with errno set
+int  glove_trace_write_json(const glove_trace_t* tr, const char* path);
+
+#endif
@@ -0,0 +1,80 @@
+//
+// glove-yaw -- keep finger yaw from drifting against the palm
+//
+
+#include "glove-yaw.h"
+
+#include <string.h>
+
+#define MIN_UPRIGHT     0.3f    // palm normal . world up, below this don't correct
+
+void glove_yaw_defaults(glove_yaw_params_t* par)
+{
+    par->limit_deg  = 25.0f;
+    par->flat_deg   = 12.0f;
+    par->tau_s      = 20.0f;
+    par->flat_tau_s = 0.3f;
+}
+
+void glove_yaw_init(glove_yaw_t* y, const glove_yaw_params_t* par, int nsensors)
+{
+    // par may be y's own, to start over with the same parameters
+    glove_yaw_params_t p = *par;
+    memset(y, 0, sizeof(*y));
+    y->par = p;
+    y->nsensors = nsensors;
+}
+
+static float wrap_pi(float a)
+{
+    while (a >  GLOVE_PI) a -= 2 * GLOVE_PI;
+    while (a < -GLOVE_PI) a += 2 * GLOVE_PI;
+    return a;
+}
+
+void glove_yaw_split(glove_quat_t palm, glove_quat_t finger, float* splay, float* flex)
+{
+    // swing-twist about palm z: the twist keeps only the z part
+    glove_quat_t r = glove_quat_mul(glove_quat_conj(palm), finger);
+    if (r.w < 0) r = glove_quat(-r.w, -r.x, -r.y, -r.z);
+    *splay = 2.0f * atan2f(r.z, r.w);
+    glove_quat_t twist = glove_quat_axis_angle(glove_vec3(0, 0, 1), *splay);
+    *flex = glove_quat_angle(twist, r);
+}
+
+void glove_yaw_update(glove_yaw_t* y, uint64_t t_us, glove_quat_t* q)
+{
+    const glove_vec3_t up = glove_vec3(0, 0, 1);
+    float dt = y->last_us && t_us > y->last_us ? (t_us - y->last_us) * 1e-6f : 0;
+    y->last_us = t_us;
+
+    float splay[GLOVE_MAX_SENSORS], flex;
+    int flat = y->nsensors > 1;
+    for (int k = 1; k < y->nsensors; k++) {
+        q[k] = glove_quat_mul(glove_quat_axis_angle(up, -y->offset[k]), q[k]);
+        glove_yaw_split(q[0], q[k], &splay[k], &flex);
+        if (flex > y->par.flat_deg * GLOVE_DEG2RAD) flat = 0;
+    }
+    if (flat && !y->flat) y->flats++;
+    y->flat = flat;
+    if (flat && !y->have_neutral) {
+        for (int k = 1; k < y->nsensors; k++) y->neutral[k] = splay[k];
+        y->have_neutral = 1;
+    }
+
+    // a world-up rotation shows up as splay scaled by how upright the palm is
+    float upright = glove_quat_rotate(q[0], up).z;
+    if (fabsf(upright) < MIN_UPRIGHT) return;
+
+    float gain = 1.0f - expf(-dt / (flat ? y->par.flat_tau_s : y->par.tau_s));
+    float limit = y->par.limit_deg * GLOVE_DEG2RAD;
+    for (int k = 1; k < y->nsensors; k++) {
+        float e = wrap_pi(splay[k] - y->neutral[k]);
+        float fix = e * gain;
+        if (e >  limit) fix += (e - limit) * (1 - gain);
+        if (e < -limit) fix += (e + limit) * (1 - gain);
+        fix /= upright;
+        y->offset[k] = wrap_pi(y->offset[k] + fix);
+        q[k] = glove_quat_mul(glove_quat_axis_angle(up, -fix), q[k]);
+    }
+}
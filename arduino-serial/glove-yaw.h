@@ -0,0 +1,55 @@
+//
+// glove-yaw -- keep finger yaw from drifting against the palm
+//
+// GY521::read() sets _yaw = _gaz and MPU6050::update() angleZ = angleGyroZ:
+// with no magnetometer, yaw is the integrated gyro and walks off without
+// bound, each sensor at its own rate.  Absolute yaw can't be helped, but
+// the fingers' yaw relative to the palm can, because anatomy limits it:
+//
+//  - a finger's splay (twist about the palm normal, after taking out its
+//    flex) stays within limit_deg of its neutral splay; anything beyond
+//    is drift and is removed at once
+//  - inside that band it is pulled weakly towards neutral (tau_s), since
+//    fingers spend most of their time near it
+//  - when the whole hand is flat the splay *is* neutral, so the pull is
+//    strong (flat_tau_s); the first flat hand also records the neutral
+//
+// The correction is a per-finger rotation about world up, the axis the
+// drift is about.  A few quaternion products per finger per frame.
+//
+
+
+#ifndef __GLOVE_YAW_H__
+#define __GLOVE_YAW_H__
+
+#include "glove-sample.h"
+
+typedef struct {
+    float limit_deg;        // max splay away from neutral
+    float flat_deg;         // max flex of every finger for a flat hand
+    float tau_s;            // pull towards neutral, hand not flat
+    float flat_tau_s;       // pull towards neutral, hand flat
+} glove_yaw_params_t;
+
+typedef struct {
+    glove_yaw_params_t par;
+    int      nsensors;
+    float    offset[GLOVE_MAX_SENSORS];     // rad about world up, applied to each finger
+    float    neutral[GLOVE_MAX_SENSORS];    // rad, splay of the flat hand
+    int      have_neutral;
+    int      flat;                          // hand flat at the last update
+    unsigned flats;                         // flat hand episodes seen
+    uint64_t last_us;
+} glove_yaw_t;
+
+void glove_yaw_defaults(glove_yaw_params_t* par);
+void glove_yaw_init(glove_yaw_t* y, const glove_yaw_params_t* par, int nsensors);
+// q[0] is the palm, q[1..nsensors-1] the fingers, all at frame time t_us
+// (see glove-align); fingers are corrected in place
+void glove_yaw_update(glove_yaw_t* y, uint64_t t_us, glove_quat_t* q);
+
+// finger orientation split relative to the palm: splay (twist about the
+// palm normal) and flex (what is left), both in radians
+void glove_yaw_split(glove_quat_t palm, glove_quat_t finger, float* splay, float* flex);
+
+#endif
@@ -0,0 +1,1277 @@
+//
+//    FILE: unit_test_001.cpp
+// PURPOSE: unit tests for the host glove pipeline (glove-*.cpp)
+//          run with "make test" in arduino-serial/
+//
+
+// supported assertions
+// ----------------------------
+// assertEqual(expected, actual)
+// assertLess(expected, actual)
+// assertMore(expected, actual)
+// assertEqualFloat(expected, actual, epsilon)
+// assertTrue(actual)
+// assertFalse(actual)
+
+#include "unittest.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "../glove-sample.h"
+#include "../glove-align.h"
+#include "../glove-calib.h"
+#include "../glove-codec.h"
+#include "../glove-fusion.h"
+#include "../glove-golden.h"
+#include "../glove-interp.h"
+#include "../glove-kinematics.h"
+#include "../glove-lod.h"
+#include "../glove-metrics.h"
+#include "../glove-pick.h"
+#include "../glove-position.h"
+#include "../glove-profile.h"
+#include "../glove-predict.h"
+#include "../glove-record.h"
+#include "../glove-replay.h"
+#include "../glove-shm.h"
+#include "../glove-skin.h"
+#include "../glove-stream.h"
+#include "../glove-synth.h"
+#include "../glove-trace.h"
+#include "../glove-yaw.h"
+
+
+unittest(test_sample_parse)
+{
+    glove_sample_t s;
+    char buf[128];
+    assertEqual(0, glove_sample_parse("3:1200345:0.01:-0.02:0.99:1.5:-2.25:0.5\n", &s));
+    assertEqual(3, s.sensor);
+    assertEqual(1200345ULL, s.t_us);
+    assertEqualFloat(0.99, s.a[2], 1e-6);
+    assertEqualFloat(-2.25, s.g[1], 1e-6);
+
+    glove_sample_format(&s, buf, sizeof(buf));
+    glove_sample_t r;
+    assertEqual(0, glove_sample_parse(buf, &r));
+    assertEqual(s.t_us, r.t_us);
+
+    assertEqual(-1, glove_sample_parse("Started\n", &s));
+    assertEqual(-1, glove_sample_parse("12.5:3.0:1.0\n", &s));   // old GX:GY:GZ lines
+}
+
+
+unittest(test_fusion_tilt)
+{
+    // lying on its side: gravity on +y, held still
+    glove_fusion_t f;
+    glove_sample_t s;
+    memset(&s, 0, sizeof(s));
+    s.a[1] = 1.0f;
+    glove_fusion_init(&f, GLOVE_FUSION_ALPHA);
+    for (int i = 0; i < 200; i++) {
+        s.t_us = 1000000 + i * 10000;
+        glove_fusion_update(&f, &s);
+    }
+    glove_vec3_t up = glove_quat_rotate(f.q, glove_vec3(0, 1, 0));
+    assertEqualFloat(1.0, up.z, 1e-3);
+}
+
+
+unittest(test_fusion_follows_synth)
+{
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_synth_defaults(&par);
+    par.sensors = 1;
+    par.duration_s = 20;
+    assertEqual(0, glove_synth_session(&par, &ss));
+
+    glove_fusion_t f;
+    glove_fusion_init(&f, GLOVE_FUSION_ALPHA);
+    float worst_tilt = 0;
+    for (int i = 0; i < ss.nsamples; i++) {
+        glove_fusion_update(&f, &ss.samples[i]);
+        glove_vec3_t up_est  = glove_quat_rotate(glove_quat_conj(f.q), glove_vec3(0, 0, 1));
+        glove_vec3_t up_true = glove_quat_rotate(glove_quat_conj(ss.truth[i].q), glove_vec3(0, 0, 1));
+        float e = acosf(fminf(1.0f, glove_vec3_dot(up_est, up_true))) * GLOVE_RAD2DEG;
+        if (i > 100 && e > worst_tilt) worst_tilt = e;
+    }
+    assertLess(worst_tilt, 5.0f);
+    glove_session_free(&ss);
+}
+
+
+unittest(test_position_zupt_bounds_drift)
+{
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_synth_defaults(&par);
+    par.sensors = 1;
+    par.duration_s = 2 * (par.rest_s + par.move_s) * 8 + par.rest_s;   // ends at home
+    assertEqual(0, glove_synth_session(&par, &ss));
+
+    glove_fusion_t f;
+    glove_position_params_t pp;
+    glove_position_t ps;
+    glove_fusion_init(&f, GLOVE_FUSION_ALPHA);
+    glove_position_defaults(&pp);
+    glove_position_init(&ps, &pp);
+    for (int i = 0; i < ss.nsamples; i++) {
+        glove_fusion_update(&f, &ss.samples[i]);
+        glove_position_update(&ps, &ss.samples[i], f.q);
+    }
+    assertTrue(ps.stationary);
+    assertEqual(17u, ps.zupts);         // initial rest + one per reach
+    assertEqualFloat(1.0, ps.confidence, 1e-6);
+    assertLess(glove_vec3_len(ps.p), 0.10f);
+    glove_session_free(&ss);
+
+    // an hour of hard shaking at 1 kHz, then still: the detector's sums
+    // must not have drifted
+    glove_sample_t s;
+    memset(&s, 0, sizeof(s));
+    uint32_t rng = 1;
+    int still = 0;
+    for (int run = 0; run < 2; run++) {
+        glove_position_init(&ps, &pp);
+        for (int i = 0; i < 3600000; i++) {
+            rng = rng * 1664525u + 1013904223u;
+            s.t_us = 1000000 + (uint64_t)i * 1000;
+            s.a[0] = (rng >> 8) * (16.0f / 16777216.0f);
+            s.a[2] = 1.0f + (rng & 0xff) * (3.0f / 256.0f);
+            glove_position_update(&ps, &s, glove_quat_identity());
+        }
+        // a tremor just past acc_thresh is motion, a steady 1 g is still
+        s.a[0] = 0;
+        for (int i = 0; i < 2 * GLOVE_POS_WINDOW; i++) {
+            s.t_us += 1000;
+            s.a[2] = i & 1 ? 1.03f : 0.97f;
+            glove_position_update(&ps, &s, glove_quat_identity());
+        }
+        still += !ps.stationary;
+        s.a[2] = 1.0f;
+        for (int i = 0; i < 2 * GLOVE_POS_WINDOW; i++) {
+            s.t_us += 1000;
+            glove_position_update(&ps, &s, glove_quat_identity());
+        }
+        still += ps.stationary;
+    }
+    assertEqual(4, still);
+}
+
+
+unittest(test_predict_constant_rate)
+{
+    // 90 deg/s about z: 40 ms ahead is 3.6 degrees further on
+    glove_predict_t p;
+    glove_sample_t s;
+    memset(&s, 0, sizeof(s));
+    s.a[2] = 1.0f;
+    s.g[2] = 90.0f;
+    glove_predict_init(&p, 0.040f, 1);
+    for (int i = 0; i < 10; i++) {
+        s.t_us = 1000000 + i * 10000;
+        glove_predict_update(&p, &s);
+    }
+    glove_quat_t q = glove_predict(&p, glove_quat_identity());
+    assertEqualFloat(3.6, glove_quat_angle(q, glove_quat_identity()) * GLOVE_RAD2DEG, 1e-3);
+    q = glove_predict_at(&p, glove_quat_identity(), s.t_us + 20000);
+    assertEqualFloat(1.8, glove_quat_angle(q, glove_quat_identity()) * GLOVE_RAD2DEG, 1e-3);
+}
+
+
+unittest(test_calib_six_pose)
+{
+    // 3% scale and 2% cross-axis error, fit it back out
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_synth_defaults(&par);
+    par.sensors = 1;
+    par.gyro_noise = par.gyro_bias = 0;
+    par.acc_scale = 0.03f;
+    par.acc_cross = 0.02f;
+    assertEqual(0, glove_synth_calib_session(&par, 0, &ss));
+
+    glove_calib_fit_t fit;
+    glove_calib_fit_init(&fit);
+    for (int i = 0; i < ss.nsamples; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        float g = s->g[0] * s->g[0] + s->g[1] * s->g[1] + s->g[2] * s->g[2];
+        if (g < 0.01f) glove_calib_fit_add_pose(&fit, s->a);
+    }
+    assertTrue(glove_calib_fit_complete(&fit, 200));
+    assertMore(glove_calib_pose_error(&fit, NULL), 0.5f);
+
+    glove_calib_t cal, back;
+    uint8_t blob[GLOVE_CALIB_HEADER + GLOVE_CALIB_ENTRY];
+    glove_calib_identity(&cal, 1);
+    assertEqual(0, glove_calib_fit_solve(&fit, &cal.accel[0]));
+    assertLess(glove_calib_pose_error(&fit, &cal.accel[0]), 0.05f);
+
+    assertEqual((int)sizeof(blob), glove_calib_to_blob(&cal, blob, sizeof(blob)));
+    assertEqual(0, glove_calib_from_blob(&back, blob, sizeof(blob)));
+    assertEqual(0, memcmp(&cal.accel[0], &back.accel[0], sizeof(glove_accel_cal_t)));
+    blob[4] = 2;
+    assertEqual(-1, glove_calib_from_blob(&back, blob, sizeof(blob)));
+    glove_calib_fit_free(&fit);
+    glove_session_free(&ss);
+}
+
+
+unittest(test_clock_unwrap)
+{
+    uint64_t last = 0;
+    assertEqual(4294000000ull, glove_clock_unwrap(&last, 4294000000ull));
+    assertEqual(4295967296ull, glove_clock_unwrap(&last, 1000000));    // micros() wrapped
+    assertEqual(4295967000ull, glove_clock_unwrap(&last, 999704));     // a little out of order
+    assertEqual(5000000000ull, glove_clock_unwrap(&last, 5000000000ull));
+
+    // sensors interleaved on one link: late stamps from either side of a wrap
+    last = 0;
+    assertEqual(4294967290ull, glove_clock_unwrap(&last, 4294967290ull));
+    assertEqual(4294967306ull, glove_clock_unwrap(&last, 10));
+    assertEqual(4294967291ull, glove_clock_unwrap(&last, 4294967291ull));
+    assertEqual(4294967306ull, last);
+    assertEqual(4294967301ull, glove_clock_unwrap(&last, 5));
+    assertEqual(4294967310ull, glove_clock_unwrap(&last, 14));
+    assertEqual(4294967295ull, glove_clock_unwrap(&last, 4294967295ull));
+    assertEqual(4294967310ull, last);
+}
+
+
+unittest(test_align_reduces_skew_error)
+{
+    // fast wrist turns, sensors read 1.5 ms apart: compare each finger
+    // against the palm as read and resampled to the frame time
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_synth_defaults(&par);
+    par.duration_s = 10;
+    par.move_s = 0.4f;
+    par.turn_deg = 90;
+    assertEqual(0, glove_synth_session(&par, &ss));
+
+    glove_align_t al;
+    glove_quat_t q[6];
+    double naive = 0, aligned = 0;
+    int n = 0;
+    glove_align_init(&al, par.sensors);
+    for (int i = 0; i < ss.nsamples; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        glove_quat_t qs;
+        glove_vec3_t p;
+        glove_synth_pose(&par, s->sensor, (s->t_us - 1000000) * 1e-6, &qs, &p);
+        glove_align_update(&al, s, qs);
+        if (s->sensor != par.sensors - 1) continue;
+        uint64_t t = glove_align_frame_time(&al);
+        if (t == 0) continue;
+        assertEqual(0, glove_align_resample(&al, t, q));
+
+        glove_quat_t tp, tf;
+        glove_synth_pose(&par, GLOVE_PALM, (t - 1000000) * 1e-6, &tp, &p);
+        for (int k = 1; k < par.sensors; k++) {
+            glove_synth_pose(&par, k, (t - 1000000) * 1e-6, &tf, &p);
+            glove_quat_t ref = glove_quat_mul(glove_quat_conj(tp), tf);
+            naive   += glove_quat_angle(glove_quat_mul(glove_quat_conj(al.q[0][1]), al.q[k][1]), ref);
+            aligned += glove_quat_angle(glove_quat_mul(glove_quat_conj(q[0]), q[k]), ref);
+            n++;
+        }
+    }
+    assertMore(n, 4000);
+    naive   *= GLOVE_RAD2DEG / n;
+    aligned *= GLOVE_RAD2DEG / n;
+    assertMore(naive, 0.2);
+    assertLess(aligned, naive / 10);
+    glove_session_free(&ss);
+}
+
+
+unittest(test_yaw_split)
+{
+    // finger = palm * splay about z * flex about x, as glove-synth builds it
+    glove_quat_t palm = glove_quat_axis_angle(glove_vec3(1, 2, 3), 0.7f);
+    glove_quat_t rel = glove_quat_mul(glove_quat_axis_angle(glove_vec3(0, 0, 1), 0.2f),
+                                      glove_quat_axis_angle(glove_vec3(1, 0, 0), 1.1f));
+    float splay, flex;
+    glove_yaw_split(palm, glove_quat_mul(palm, rel), &splay, &flex);
+    assertEqualFloat(0.2, splay, 1e-4);
+    assertEqualFloat(1.1, flex, 1e-4);
+}
+
+
+unittest(test_yaw_bounds_finger_drift)
+{
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_synth_defaults(&par);
+    par.duration_s = 60;
+    par.flat_every = 6;
+    assertEqual(0, glove_synth_session(&par, &ss));
+
+    glove_yaw_params_t yp;
+    glove_fusion_t fu[6];
+    glove_align_t al;
+    glove_yaw_t yaw;
+    glove_quat_t q[6];
+    float raw0[6], fix0[6], splay, flex;
+    double before = 0, after = 0;
+    int n = 0;
+    glove_yaw_defaults(&yp);
+    glove_yaw_init(&yaw, &yp, 6);
+    glove_align_init(&al, 6);
+    for (int k = 0; k < 6; k++) glove_fusion_init(&fu[k], GLOVE_FUSION_ALPHA);
+    for (int i = 0; i < ss.nsamples; i++) {
+        const glove_sample_t* s = &ss.samples[i];
+        glove_fusion_update(&fu[s->sensor], s);
+        glove_align_update(&al, s, fu[s->sensor].q);
+        if (s->sensor != 5) continue;
+        uint64_t t = glove_align_frame_time(&al);
+        if (t == 0) continue;
+        glove_align_resample(&al, t, q);
+        float raw[6];
+        for (int k = 1; k < 6; k++) glove_yaw_split(q[0], q[k], &raw[k], &flex);
+        glove_yaw_update(&yaw, t, q);
+
+        glove_quat_t tp, tf;
+        glove_vec3_t p;
+        glove_synth_pose(&par, 0, (t - 1000000) * 1e-6, &tp, &p);
+        for (int k = 1; k < 6; k++) {
+            glove_synth_pose(&par, k, (t - 1000000) * 1e-6, &tf, &p);
+            float ref;
+            glove_yaw_split(tp, tf, &ref, &flex);
+            glove_yaw_split(q[0], q[k], &splay, &flex);
+            // drift since the first frame, last 10 s only
+            if (n == 0) { raw0[k] = raw[k] - ref; fix0[k] = splay - ref; }
+            if (t < 51000000) continue;
+            before += fabsf(remainderf(raw[k] - ref - raw0[k], 2 * GLOVE_PI));
+            after  += fabsf(remainderf(splay - ref - fix0[k], 2 * GLOVE_PI));
+        }
+        n++;
+    }
+    assertMore(yaw.flats, 5u);
+    assertMore(before * GLOVE_RAD2DEG / (5 * 1000), 5.0);
+    assertLess(after, before / 4);
+    glove_session_free(&ss);
+}
+
+
+unittest(test_kinematics_flat_and_curled)
+{
+    glove_quat_t q[6];
+    glove_hand_pose_t hand;
+    for (int k = 0; k < 6; k++) q[k] = glove_quat_identity();
+    glove_kin_hand(q, 6, glove_vec3(0, 0, 0), 0, &hand);
+    // flat hand: index tip straight out along +y
+    glove_vec3_t tip = hand.joints[1 + 1 * 4 + 3];
+    assertEqualFloat(-0.028, tip.x, 1e-6);
+    assertEqualFloat(0.090 + 0.040 + 0.024 + 0.019, tip.y, 1e-6);
+    assertEqualFloat(0.0, tip.z, 1e-6);
+
+    // bone matrix takes the unit cylinder's top to the bone's end
+    float m[16];
+    const glove_bone_t* b = &hand.bones[1 + 1 * 3];
+    glove_kin_bone_matrix(b, m);
+    glove_vec3_t pip = hand.joints[1 + 1 * 4 + 1];
+    assertEqualFloat(pip.x, m[4] + m[12], 1e-6);
+    assertEqualFloat(pip.y, m[5] + m[13], 1e-6);
+    assertEqualFloat(pip.z, m[6] + m[14], 1e-6);
+
+    // index flexed 60 degrees: the middle and distal bones curl further
+    q[2] = glove_quat_axis_angle(glove_vec3(1, 0, 0), 60 * GLOVE_DEG2RAD);
+    glove_kin_hand(q, 6, glove_vec3(0, 0, 0), 0, &hand);
+    glove_vec3_t dir = glove_quat_rotate(hand.bones[1 + 1 * 3 + 2].q, glove_vec3(0, 1, 0));
+    float curl = acosf(dir.y) * GLOVE_RAD2DEG;
+    assertEqualFloat(60 * (1 + 0.8 + 0.55), curl, 0.01);
+    assertMore(hand.joints[1 + 1 * 4 + 3].z, 0.03f);
+    // the left hand mirrors the layout
+    glove_kin_hand(q, 6, glove_vec3(0, 0, 0), 1, &hand);
+    assertEqualFloat(0.028, hand.joints[1 + 1 * 4].x, 1e-6);
+}
+
+
+unittest(test_stream_handoff)
+{
+    glove_handoff_t h;
+    const glove_frame_t* f;
+    glove_handoff_init(&h);
+    assertEqual(0, glove_handoff_latest(&h, &f));
+    assertEqual(0u, f->seq);
+    // the reader only ever sees the newest frame, once
+    for (uint32_t i = 1; i <= 3; i++) {
+        glove_handoff_back(&h)->seq = i;
+        glove_handoff_publish(&h);
+    }
+    assertEqual(1, glove_handoff_latest(&h, &f));
+    assertEqual(3u, f->seq);
+    assertEqual(0, glove_handoff_latest(&h, &f));
+    assertEqual(3u, f->seq);
+
+    // lines split across reads, a comment, junk and a CRLF ending
+    int fds[2];
+    assertEqual(0, pipe(fds));
+    glove_stream_t st;
+    glove_stream_init(&st);
+    glove_handoff_init(&h);
+    const char* a = "# hello\n0:1000:0:0:1:0:0:0\n1:1500:0:0:1:0:0:0\r\n2:20";
+    const char* b = "00:0:0:1:0:0:0\njunk\n";
+    assertTrue(write(fds[1], a, strlen(a)) > 0);
+    assertEqual(2, glove_stream_poll(&st, fds[0], 100, &h));
+    assertEqual(1, glove_handoff_latest(&h, &f));
+    assertEqual(2, f->nsensors);
+    assertTrue(write(fds[1], b, strlen(b)) > 0);
+    assertEqual(1, glove_stream_poll(&st, fds[0], 100, &h));
+    assertEqual(1, glove_handoff_latest(&h, &f));
+    assertEqual(3u, f->seq);
+    assertEqual(3, f->nsensors);
+    assertEqual((uint64_t)2000, f->t_us);
+    assertEqual(1u, st.bad_lines);
+    assertEqual(0, glove_stream_poll(&st, fds[0], 10, &h));
+    close(fds[1]);
+    assertEqual(-1, glove_stream_poll(&st, fds[0], 100, &h));
+    close(fds[0]);
+}
+
+
+unittest(test_stream_recenter)
+{
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_synth_defaults(&par);
+    par.duration_s = 2;
+    assertEqual(0, glove_synth_session(&par, &ss));
+    static glove_stream_t st;
+    static glove_handoff_t h;
+    glove_yaw_params_t defaults;
+    glove_yaw_defaults(&defaults);
+    glove_stream_init(&st);
+    glove_handoff_init(&h);
+
+    // recentering mid-session keeps the parameters and the fingers sane
+    for (int i = 0; i < ss.nsamples / 2; i++) glove_stream_feed(&st, &ss.samples[i], &h);
+    glove_stream_recenter(&st);
+    assertEqual(0, memcmp(&defaults, &st.yaw[0].par, sizeof(defaults)));
+    assertEqual(0, st.yaw[0].have_neutral);
+    for (int i = ss.nsamples / 2; i < ss.nsamples; i++) glove_stream_feed(&st, &ss.samples[i], &h);
+    const glove_frame_t* f;
+    glove_handoff_latest(&h, &f);
+    assertEqual(GLOVE_HAND_SENSORS, f->nsensors);
+    // yaw ran on the aligned hand: at the last time all six had reached,
+    // the palm's read, not the newest sample's
+    assertEqual(f->t_sensor_us[0], st.yaw[0].last_us);
+    assertTrue(st.yaw[0].last_us < f->t_us);
+    for (int i = 0; i < f->nsensors; i++) {
+        assertTrue(isfinite(f->q[i].w) && isfinite(f->q[i].x));
+        assertTrue(isfinite(f->q[i].y) && isfinite(f->q[i].z));
+        assertEqualFloat(1.0f, glove_quat_dot(f->q[i], f->q[i]), 1e-3);
+    }
+    glove_session_free(&ss);
+}
+
+
+unittest(test_trace_stages)
+{
+    static glove_trace_t tr;
+    static glove_handoff_t h;
+    static glove_stream_t st;
+    const glove_frame_t* f;
+    assertEqual(0, glove_trace_init(&tr, 4));
+    glove_handoff_init(&h);
+    glove_stream_init(&st);
+    st.trace = &tr;
+
+    // GLOVE_TRACE lines end with the send stamp; both arrive in one read,
+    // so the later-sent line sets the clock offset: it left at arrival
+    int fds[2];
+    assertEqual(0, pipe(fds));
+    const char* a = "0:1000:0:0:1:0:0:0:1400\n1:2000:0:0:1:0:0:0:2100\n";
+    assertTrue(write(fds[1], a, strlen(a)) > 0);
+    assertEqual(2, glove_stream_poll(&st, fds[0], 100, &h));
+    assertEqual(2u, (unsigned)tr.nsamples);
+    const glove_trace_span_t* sp = &tr.samples[1];
+    assertEqual(1, sp->sensor);
+    assertEqual((int64_t)100000, sp->t[GLOVE_TRACE_SEND] - sp->t[GLOVE_TRACE_CAPTURE]);
+    assertEqual(sp->t[GLOVE_TRACE_SEND], sp->t[GLOVE_TRACE_ARRIVE]);
+    assertTrue(sp->t[GLOVE_TRACE_ARRIVE] <= sp->t[GLOVE_TRACE_PARSE]);
+    assertTrue(sp->t[GLOVE_TRACE_PARSE] <= sp->t[GLOVE_TRACE_FUSE]);
+    assertEqual((uint64_t)2, tr.hist[GLOVE_TRACE_SEND].count);
+    assertEqual((uint64_t)2, tr.hist[GLOVE_TRACE_FUSE].count);
+
+    // the render side: the frame carries its newest sample's span
+    assertEqual(1, glove_handoff_latest(&h, &f));
+    glove_trace_span_t fr = f->trace;
+    assertEqual(f->seq, fr.id);
+    fr.t[GLOVE_TRACE_TAKE] = glove_monotonic_ns();
+    fr.t[GLOVE_TRACE_SUBMIT] = fr.t[GLOVE_TRACE_TAKE] + 1000000;
+    fr.t[GLOVE_TRACE_PRESENT] = fr.t[GLOVE_TRACE_TAKE] + 16000000;
+    glove_trace_frame(&tr, &fr);
+    assertEqual((uint64_t)1, tr.hist[0].count);
+    assertEqual((uint64_t)1, tr.hist[GLOVE_TRACE_PRESENT].count);
+    assertEqual((int64_t)15000000, tr.hist[GLOVE_TRACE_PRESENT].max_ns);
+    assertTrue(tr.hist[0].max_ns >= 16000000);
+
+    // lines without the stamp still trace, capture straight to arrival;
+    // the ring keeps the last depth samples
+    const char* b = "0:3000:0:0:1:0:0:0\n1:3500:0:0:1:0:0:0\n0:4000:0:0:1:0:0:0\n";
+    assertTrue(write(fds[1], b, strlen(b)) > 0);
+    assertEqual(3, glove_stream_poll(&st, fds[0], 100, &h));
+    assertEqual(5u, (unsigned)tr.nsamples);
+    assertEqual((int64_t)0, tr.samples[4 % 4].t[GLOVE_TRACE_SEND]);
+    assertEqual((uint64_t)2, tr.hist[GLOVE_TRACE_SEND].count);
+    assertEqual((uint64_t)5, tr.hist[GLOVE_TRACE_ARRIVE].count);
+    close(fds[1]);
+    close(fds[0]);
+
+    // a frame drawn before any sample has only the render thread's stamps
+    glove_trace_span_t early;
+    memset(&early, 0, sizeof(early));
+    early.t[GLOVE_TRACE_TAKE] = tr.samples[1].t[GLOVE_TRACE_CAPTURE] - 5000000;
+    early.t[GLOVE_TRACE_SUBMIT] = early.t[GLOVE_TRACE_TAKE] + 1000000;
+    early.t[GLOVE_TRACE_PRESENT] = early.t[GLOVE_TRACE_TAKE] + 2000000;
+    glove_trace_frame(&tr, &early);
+
+    assertEqual(0, glove_trace_write_json(&tr, "test/trace.json"));
+    FILE* fp = fopen("test/trace.json", "r");
+    static char buf[65536];
+    size_t n = fp ? fread(buf, 1, sizeof(buf) - 1, fp) : 0;
+    buf[n] = 0;
+    assertEqual(0, strncmp(buf, "{\"displayTimeUnit\"", 18));
+    // nothing before time 0, which is that frame's take
+    assertTrue(strstr(buf, "\"ts\":-") == NULL);
+    assertTrue(strstr(buf, "\"name\":\"draw\",\"pid\":1,\"tid\":3,\"ts\":0.000,") != NULL);
+    // the flow leaves the reader where the fuse slice ends
+    double fuse_ts, fuse_dur, flow_ts;
+    const char* fu = strstr(buf, "\"name\":\"fuse\"");
+    const char* fl = strstr(buf, "\"ph\":\"s\"");
+    assertTrue(fu && sscanf(fu, "\"name\":\"fuse\",\"pid\":1,\"tid\":2,\"ts\":%lf,\"dur\":%lf", &fuse_ts, &fuse_dur) == 2);
+    assertTrue(fl && sscanf(fl, "\"ph\":\"s\",\"name\":\"handoff\",\"pid\":1,\"tid\":2,\"ts\":%lf", &flow_ts) == 1);
+    assertEqualFloat(fuse_ts + fuse_dur, flow_ts, 0.002);
+    if (fp) fclose(fp);
+    unlink("test/trace.json");
+    glove_trace_free(&tr);
+}
+
+
+
+unittest(test_interp_irregular_samples)
+{
+    // one sensor turning about z at 90 deg/s, read at uneven times and
+    // delivered 5 ms later, some lines held up to 25 ms by the USB
+    const float rate = 90 * GLOVE_DEG2RAD;
+    const int ms[] = { 0, 70, 100, 180, 200, 300, 310, 420 };
+    const int held[] = { 0, 20, 0, 0, 25, 0, 0, 10 };
+    glove_interp_t ip;
+    glove_frame_t f;
+    glove_quat_t q[GLOVE_MAX_SENSORS];
+    memset(&f, 0, sizeof(f));
+    glove_interp_init(&ip, 150);
+
+    const int64_t base = 1000000000;
+    int next = 0;
+    float err = 0;
+    // render at 144 Hz
+    for (int64_t r = base; r < base + 420000000; r += 6944444) {
+        while (next < 8 && base + (ms[next] + 5 + held[next]) * 1000000LL <= r) {
+            uint64_t t_us = 1000000 + ms[next] * 1000;
+            f.seq++;
+            f.nsensors = 1;
+            f.t_us = f.t_sensor_us[0] = t_us;
+            f.recv_ns = base + (ms[next] + 5 + held[next]) * 1000000LL;
+            f.q[0] = glove_quat_axis_angle(glove_vec3(0, 0, 1), rate * ms[next] * 1e-3f);
+            glove_interp_push(&ip, &f);
+            glove_interp_push(&ip, &f);         // the same frame twice is one sample
+            next++;
+        }
+        if (r < base + 155000000) continue;     // the first sample isn't due yet
+        assertEqual(1, glove_interp_at(&ip, r, q));
+        // offset is 5 ms: the pose shown is the one from r - 155 ms
+        float want = rate * (r - base - 155000000) * 1e-9f;
+        float e = glove_quat_angle(q[0], glove_quat_axis_angle(glove_vec3(0, 0, 1), want)) * GLOVE_RAD2DEG;
+        if (e > err) err = e;
+    }
+    assertTrue(err < 0.1f);
+    assertEqual(0u, ip.late);
+
+    // no delay: every render runs past the newest sample and says so
+    glove_interp_set_delay(&ip, 0);
+    assertEqual(0, glove_interp_at(&ip, base + 500000000LL, q));
+    assertEqual(1u, ip.late);
+    assertTrue(glove_quat_angle(q[0], f.q[0]) < 1e-4f);
+}
+
+
+unittest(test_interp_takes_every_sample)
+{
+    // 100 Hz into the stream, painted at 20 Hz: taking the handoff's ring
+    // the interpolator sees all five samples of each paint, not the last
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_synth_defaults(&par);
+    par.sensors = 1;
+    par.duration_s = 4;
+    assertEqual(0, glove_synth_session(&par, &ss));
+    static glove_stream_t st;
+    static glove_handoff_t h;
+    glove_interp_t every, last;
+    const glove_frame_t* f;
+    glove_stream_init(&st);
+    glove_handoff_init(&h);
+    glove_interp_init(&every, 50);
+    glove_interp_init(&last, 50);
+    for (int i = 0; i < 20; i++) {
+        glove_stream_feed(&st, &ss.samples[i], &h);
+        if (i % 5 != 4) continue;
+        glove_handoff_latest(&h, &f);
+        glove_interp_take(&every, &h, f);
+        glove_interp_push(&last, f);
+    }
+    assertEqual(20, every.n[0]);
+    assertEqual(4, last.n[0]);
+    assertEqual(ss.samples[19].t_us, every.t[0][every.head[0]]);
+    assertEqual(ss.samples[3].t_us, every.t[0][3]);
+
+    // more than the ring holds between paints: the newest it still has
+    for (int i = 20; i < 20 + GLOVE_HANDOFF_SAMPLES + 10; i++) glove_stream_feed(&st, &ss.samples[i], &h);
+    glove_handoff_latest(&h, &f);
+    glove_interp_take(&every, &h, f);
+    assertEqual(GLOVE_INTERP_DEPTH, every.n[0]);
+    assertEqual(f->seq, every.seq);
+    assertEqual(ss.samples[19 + GLOVE_HANDOFF_SAMPLES + 10].t_us, every.t[0][every.head[0]]);
+    glove_session_free(&ss);
+}
+
+
+unittest(test_record_roundtrip)
+{
+    const char* path = "test/record.tmp";
+    glove_calib_t cal, back;
+    glove_calib_identity(&cal, 2);
+    cal.accel[1].b[2] = 0.25f;
+
+    // more than two chunks' worth
+    glove_rec_t rec;
+    glove_sample_t s;
+    memset(&s, 0, sizeof(s));
+    int n = (int)GLOVE_REC_PER_CHUNK * 2 + 100;
+    assertEqual(0, glove_rec_open(&rec, path, &cal));
+    for (int i = 0; i < n; i++) {
+        s.t_us = 1000 + i * 83;
+        s.sensor = i % 12;
+        s.a[2] = (float)i;
+        s.g[0] = -(float)i;
+        assertEqual(0, glove_rec_write(&rec, &s));
+    }
+    assertEqual(3u, rec.nchunks);
+    assertEqual(0, glove_rec_close(&rec));
+    assertEqual(1, glove_rec_probe(path));
+
+    glove_session_t ss;
+    assertEqual(0, glove_rec_load(path, &ss, &back));
+    assertEqual(n, ss.nsamples);
+    assertEqual(2, back.count);
+    assertEqual(0.25f, back.accel[1].b[2]);
+    int same = 1;
+    for (int i = 0; i < n; i++)
+        same &= ss.samples[i].t_us == (uint64_t)(1000 + i * 83) && ss.samples[i].sensor == i % 12 &&
+                ss.samples[i].a[2] == (float)i && ss.samples[i].g[0] == -(float)i;
+    assertTrue(same);
+    glove_session_free(&ss);
+
+    // cut off in the middle of a record, as a crash would leave it
+    assertEqual(0, truncate(path, GLOVE_REC_HEADER + 2 * GLOVE_REC_CHUNK + sizeof(glove_rec_chunk_t) + 50 * 40 + 17));
+    assertEqual(0, glove_rec_load(path, &ss, NULL));
+    assertEqual((int)GLOVE_REC_PER_CHUNK * 2 + 50, ss.nsamples);
+    glove_session_free(&ss);
+
+    // the serial reader records what it decodes, clock unwrapped
+    int fds[2];
+    glove_handoff_t h;
+    glove_stream_t st;
+    assertEqual(0, pipe(fds));
+    glove_handoff_init(&h);
+    glove_stream_init(&st);
+    assertEqual(0, glove_rec_open(&rec, path, NULL));
+    st.rec = &rec;
+    const char* a = "0:4294967000:0:0:1:0:0:0\njunk\n1:200:0:0:1:5:0:0\n";
+    assertTrue(write(fds[1], a, strlen(a)) > 0);
+    assertEqual(2, glove_stream_poll(&st, fds[0], 100, &h));
+    assertEqual(0, glove_rec_close(&rec));
+    close(fds[0]);
+    close(fds[1]);
+    assertEqual(0, glove_rec_load(path, &ss, &back));
+    assertEqual(2, ss.nsamples);
+    assertEqual(0, back.count);
+    assertEqual((uint64_t)4294967296ULL + 200, ss.samples[1].t_us);
+    assertEqual(5.0f, ss.samples[1].g[0]);
+    glove_session_free(&ss);
+    unlink(path);
+    assertEqual(0, glove_rec_probe(path));
+}
+
+
+unittest(test_record_survives_full_disk)
+{
+    const char* path = "test/full.tmp";
+    const char* idx = "test/full.tmp.idx";
+    unlink(idx);
+    // room for the first preallocation and nothing after it
+    struct rlimit was, lim;
+    getrlimit(RLIMIT_FSIZE, &was);
+    lim = was;
+    lim.rlim_cur = GLOVE_REC_HEADER + GLOVE_REC_PREALLOC;
+    void (*xfsz)(int) = signal(SIGXFSZ, SIG_IGN);
+    assertEqual(0, setrlimit(RLIMIT_FSIZE, &lim));
+
+    glove_rec_t rec;
+    glove_sample_t s;
+    memset(&s, 0, sizeof(s));
+    int fit = (int)GLOVE_REC_PER_CHUNK * (GLOVE_REC_PREALLOC / GLOVE_REC_CHUNK);
+    assertEqual(0, glove_rec_open(&rec, path, NULL));
+    int failed = 0;
+    for (int i = 0; i < fit + 10; i++) {
+        s.t_us = 1000 + i;
+        failed += glove_rec_write(&rec, &s) != 0;
+    }
+    assertEqual(10, failed);
+    assertEqual(10u, rec.dropped);
+    assertEqual(0, glove_rec_close(&rec));
+    setrlimit(RLIMIT_FSIZE, &was);
+    signal(SIGXFSZ, xfsz);
+
+    // what fitted is all there, to load and to replay
+    glove_session_t ss;
+    assertEqual(0, glove_rec_load(path, &ss, NULL));
+    assertEqual(fit, ss.nsamples);
+    assertEqual((uint64_t)(1000 + fit - 1), ss.samples[fit - 1].t_us);
+    glove_session_free(&ss);
+    glove_replay_t rp;
+    assertEqual(0, glove_replay_open(&rp, path));
+    assertEqual((uint64_t)fit, rp.n);
+    glove_replay_close(&rp);
+    unlink(path);
+    unlink(idx);
+}
+
+
+unittest(test_replay_seek_and_pace)
+{
+    const char* path = "test/replay.tmp";
+    const char* idx = "test/replay.tmp.idx";
+    unlink(idx);
+    // three sensors every 1 ms, the last read 0.2 ms before the first
+    glove_rec_t rec;
+    glove_sample_t s;
+    memset(&s, 0, sizeof(s));
+    int n = 3000;
+    assertEqual(0, glove_rec_open(&rec, path, NULL));
+    for (int i = 0; i < n; i++) {
+        s.sensor = i % 3;
+        s.t_us = 1000000 + (i / 3) * 1000 + (s.sensor == 2 ? -200 : s.sensor * 100);
+        glove_rec_write(&rec, &s);
+    }
+    assertEqual(0, glove_rec_close(&rec));
+
+    glove_replay_t rp;
+    assertEqual(0, glove_replay_open(&rp, path));
+    assertEqual((uint64_t)n, rp.n);
+    assertEqual(0, rp.index_loaded);
+    assertEqual((uint64_t)1000000, glove_replay_first_us(&rp));
+    // the first record that gets to 1.5 s, whichever order the reads came in
+    assertEqual((uint64_t)1500, glove_replay_seek(&rp, 1500000));
+    assertEqual((uint64_t)1501, glove_replay_seek(&rp, 1500050));
+    assertEqual((uint64_t)0, glove_replay_seek(&rp, 0));
+    assertEqual((uint64_t)n, glove_replay_seek(&rp, 9000000));
+    glove_replay_close(&rp);
+    assertEqual(0, glove_replay_open(&rp, path));
+    assertEqual(1, rp.index_loaded);
+    assertEqual((uint64_t)1500, glove_replay_seek(&rp, 1500000));
+
+    // into the same stream the serial reader feeds; flat out, in batches
+    glove_stream_t st;
+    glove_handoff_t h;
+    const glove_frame_t* f;
+    glove_stream_init(&st);
+    glove_handoff_init(&h);
+    glove_replay_set_speed(&rp, 0);
+    int total = 0, rc;
+    while ((rc = glove_replay_poll(&rp, &st, 10, &h)) > 0) {
+        assertTrue(rc <= GLOVE_REPLAY_BATCH);
+        total += rc;
+    }
+    assertEqual(-1, rc);
+    assertEqual(n - 1500, total);
+    assertEqual(1, glove_handoff_latest(&h, &f));
+    assertEqual(3, f->nsensors);
+    assertEqual((uint64_t)1998800, f->t_us);       // the last read, sensor 2
+
+    // 100 ms of recording at 10x is 10 ms
+    glove_replay_seek(&rp, 1100000);
+    glove_replay_set_speed(&rp, 10);
+    int64_t t0 = glove_monotonic_ns();
+    while (rp.pos < 1500) glove_replay_poll(&rp, &st, 10, &h);
+    int64_t ms = (glove_monotonic_ns() - t0) / 1000000;
+    assertTrue(ms >= 9 && ms < 100);
+    glove_replay_close(&rp);
+    unlink(path);
+    unlink(idx);
+}
+
+
+unittest(test_codec_roundtrip)
+{
+    // what the sketch prints, parsed: 4 and 3 decimals, some "-0.000"
+    glove_session_t ss;
+    memset(&ss, 0, sizeof(ss));
+    for (int i = 0; i < GLOVE_CODEC_BLOCK + 500; i++) {
+        char line[128];
+        int k = i % 12;
+        snprintf(line, sizeof(line), "%d:%d:%.4f:%.4f:%.4f:%.3f:%s:%.3f", k, 1000 * (i / 12) + 80 * k - (k == 5) * 900,
+                 0.01f * k + 0.0003f * (i % 7), -1.0f, 0.98f - 0.0001f * i, 12.5f * k - 0.25f * (i % 9),
+                 i % 5 ? "-0.000" : "0.125", -0.001f * i);
+        glove_sample_t s;
+        assertEqual(0, glove_sample_parse(line, &s));
+        glove_session_add(&ss, &s);
+    }
+    // one value the sketch couldn't have printed
+    ss.samples[GLOVE_CODEC_BLOCK + 10].a[1] = 1.0f / 3;
+
+    glove_codec_t c;
+    glove_sample_t back[GLOVE_CODEC_BLOCK];
+    static uint8_t buf[2][32 + GLOVE_CODEC_BLOCK * 40];
+    assertEqual(0, glove_codec_init(&c, GLOVE_CODEC_VARINT));
+    assertEqual(glove_codec_bound(GLOVE_CODEC_BLOCK), sizeof(buf[0]));
+    long len = glove_codec_encode(&c, ss.samples, GLOVE_CODEC_BLOCK, buf[0], sizeof(buf[0]));
+    long raw = glove_codec_encode(&c, ss.samples + GLOVE_CODEC_BLOCK, 500, buf[1], sizeof(buf[1]));
+    assertLess(len, GLOVE_CODEC_BLOCK * 40 / 2);
+    assertEqual(GLOVE_CODEC_VARINT, buf[0][4]);
+    assertEqual(4, buf[0][5]);
+    assertEqual(3, buf[0][6]);
+    assertEqual(GLOVE_CODEC_RAW, buf[1][4]);
+    assertEqual(32 + 500 * 40, raw);
+
+    // both decode paths give back every bit, -0.0 included
+    for (int simd = 0; simd < 2; simd++) {
+        int n = 0, same = 1;
+        glove_codec_simd(simd);
+        assertEqual(len, glove_codec_decode(&c, buf[0], len, back, &n));
+        assertEqual(GLOVE_CODEC_BLOCK, n);
+        for (int i = 0; i < n; i++)
+            same &= back[i].t_us == ss.samples[i].t_us && back[i].sensor == ss.samples[i].sensor &&
+                    memcmp(back[i].a, ss.samples[i].a, sizeof(back[i].a)) == 0 &&
+                    memcmp(back[i].g, ss.samples[i].g, sizeof(back[i].g)) == 0;
+        assertTrue(same);
+        assertTrue(signbit(back[1].g[1]));
+    }
+    glove_codec_simd(1);
+
+    // short or damaged blocks are refused, not read past
+    int n;
+    assertEqual(-1, glove_codec_decode(&c, buf[0], len - 1, back, &n));
+    buf[0][40] = 0xff;
+    assertEqual(-1, glove_codec_decode(&c, buf[0], len, back, &n));
+    glove_codec_free(&c);
+
+    // a packed file reads back as the session, calibration and all
+    const char* path = "test/codec.tmp";
+    glove_calib_t cal, cal_back;
+    glove_calib_identity(&cal, 2);
+    cal.accel[0].b[1] = -0.5f;
+    glove_session_t loaded;
+    assertEqual(0, glove_codec_save(path, &ss, &cal, GLOVE_CODEC_VARINT));
+    assertEqual(1, glove_codec_probe(path));
+    assertEqual(0, glove_codec_load(path, &loaded, &cal_back));
+    assertEqual(ss.nsamples, loaded.nsamples);
+    assertEqual(-0.5f, cal_back.accel[0].b[1]);
+    assertEqual(1.0f / 3, loaded.samples[GLOVE_CODEC_BLOCK + 10].a[1]);
+    assertEqual(ss.samples[ss.nsamples - 1].t_us, loaded.samples[ss.nsamples - 1].t_us);
+    glove_session_free(&loaded);
+    unlink(path);
+    glove_session_free(&ss);
+}
+
+
+unittest(test_metrics_scrape)
+{
+    static glove_metrics_t m;
+    static glove_handoff_t h;
+    static glove_stream_t st;
+    const glove_frame_t* f;
+    glove_metrics_init(&m);
+    glove_handoff_init(&h);
+    glove_stream_init(&st);
+    st.metrics = &m;
+
+    int fds[2];
+    assertEqual(0, pipe(fds));
+    const char* a = "0:1000:0:0:1:0:0:0\ngarbage\n1:1500:0:0:1:0:0:0\n2:2000:0:0:1:0:0:0\n";
+    assertTrue(write(fds[1], a, strlen(a)) > 0);
+    assertEqual(3, glove_stream_poll(&st, fds[0], 100, &h));
+    close(fds[1]);
+    close(fds[0]);
+    assertEqual((uint64_t)3, m.metric[GLOVE_METRIC_SAMPLES].value.load());
+    assertEqual((uint64_t)1, m.metric[GLOVE_METRIC_LINE_ERRORS].value.load());
+    // the first sample is timed, then one in FUSION_EVERY
+    uint64_t timed = 0;
+    for (int b = 0; b <= GLOVE_METRICS_BUCKETS; b++) timed += m.metric[GLOVE_METRIC_FUSION].bucket[b].load();
+    assertEqual((uint64_t)1, timed);
+
+    // the renderer drew seq 1, then only 3: one skipped
+    uint32_t last = 0;
+    assertEqual(1, glove_handoff_latest(&h, &f));
+    glove_frame_t early = *f;
+    early.seq = 1;
+    glove_stream_drawn(&m, &early, &last);
+    glove_stream_drawn(&m, f, &last);
+    glove_stream_drawn(&m, f, &last);
+    assertEqual(3u, last);
+    assertEqual((uint64_t)2, m.metric[GLOVE_METRIC_FRAMES].value.load());
+    assertEqual((uint64_t)1, m.metric[GLOVE_METRIC_SKIPPED].value.load());
+
+    // served and scraped as text; histograms cumulative up to +Inf
+    char text[8192];
+    assertEqual(0, glove_metrics_serve(&m, "test/metrics.sock"));
+    // a client that hangs up before the answer costs nothing, SIGPIPE included
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, "test/metrics.sock");
+    int c = socket(AF_UNIX, SOCK_STREAM, 0);
+    assertEqual(0, connect(c, (struct sockaddr*)&addr, sizeof(addr)));
+    close(c);
+    assertTrue(glove_metrics_scrape("test/metrics.sock", text, sizeof(text)) > 0);
+    glove_metrics_close(&m);
+    assertEqual(-1, access("test/metrics.sock", F_OK));
+    assertTrue(strstr(text, "# TYPE glove_samples_total counter\nglove_samples_total 3\n") != NULL);
+    assertTrue(strstr(text, "glove_frames_skipped_total 1\n") != NULL);
+    assertTrue(strstr(text, "glove_sample_age_seconds_bucket{le=\"+Inf\"} 2\n") != NULL);
+    assertTrue(strstr(text, "glove_sample_age_seconds_count 2\n") != NULL);
+    assertEqual(glove_metrics_format(&m, text, sizeof(text)), (int)strlen(text));
+    assertEqual(-1, glove_metrics_scrape("test/metrics.sock", text, sizeof(text)));
+
+    // a path that is not a socket is left alone
+    FILE* fp = fopen("test/metrics.txt", "w");
+    assertTrue(fp != NULL);
+    fclose(fp);
+    assertEqual(-1, glove_metrics_serve(&m, "test/metrics.txt"));
+    assertEqual(EEXIST, errno);
+    assertEqual(0, access("test/metrics.txt", F_OK));
+    unlink("test/metrics.txt");
+}
+
+
+unittest(test_pick_nearest)
+{
+    // identity mvp: the ray through the centre pixel runs along +z from z=-1
+    static const float identity[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+    glove_pick_t p;
+    glove_ray_t ray;
+    glove_hit_t hit;
+    glove_pick_init(&p);
+    glove_pick_add_triangle(&p, 7, glove_vec3(-1, -1, 0), glove_vec3(1, -1, 0), glove_vec3(0, 1, 0));
+    glove_pick_add_sphere(&p, 3, glove_vec3(0, 0, -0.5f), 0.1f);
+    assertEqual(0, glove_pick_ray_from_screen(identity, 50, 50, 100, 100, &ray));
+    assertEqualFloat(-1.0, ray.o.z, 1e-6);
+    assertEqualFloat(1.0, ray.d.z, 1e-6);
+    assertEqual(3, glove_pick_ray(&p, &ray, &hit));
+    assertEqualFloat(0.4, hit.t, 1e-5);
+    // off the sphere, onto the triangle; past its edge, nothing
+    assertEqual(0, glove_pick_ray_from_screen(identity, 50, 70, 100, 100, &ray));
+    assertEqual(7, glove_pick_ray(&p, &ray, &hit));
+    assertEqualFloat(0.0, hit.p.z, 1e-5);
+    // the triangle winds counter-clockwise seen from +z, so the ray sees its back
+    p.cull_back = 1;
+    assertEqual(-1, glove_pick_ray(&p, &ray, &hit));
+    assertEqual(0, glove_pick_ray_from_screen(identity, 95, 5, 100, 100, &ray));
+    assertEqual(-1, glove_pick_ray(&p, &ray, &hit));
+
+    // a flat hand's index tip, from the pixel over it
+    glove_quat_t q[6];
+    glove_hand_pose_t hand;
+    for (int k = 0; k < 6; k++) q[k] = glove_quat_identity();
+    glove_kin_hand(q, 6, glove_vec3(0, 0, 0), 0, &hand);
+    glove_pick_init(&p);
+    assertEqual(0, glove_pick_add_hand(&p, 100, &hand, 0.002f));
+    glove_vec3_t tip = hand.joints[1 + 1 * 4 + 3];
+    glove_pick_ray_from_screen(identity, (tip.x + 1) * 500, (1 - tip.y) * 500, 1000, 1000, &ray);
+    assertEqual(100 + 1 + 1 * 4 + 3, glove_pick_ray(&p, &ray, NULL));
+}
+
+
+unittest(test_skin_moved_parts)
+{
+    glove_skin_t sk;
+    glove_quat_t q[6];
+    glove_hand_pose_t hands[2];
+    glove_skin_stats_t st;
+    for (int k = 0; k < 6; k++) q[k] = glove_quat_identity();
+    glove_kin_hand(q, 6, glove_vec3(0.12f, 0, 0), 0, &hands[0]);
+    glove_kin_hand(q, 6, glove_vec3(-0.12f, 0, 0), 1, &hands[1]);
+    assertEqual(0, glove_skin_init(&sk, 0, 0));
+    float* v = (float*)calloc(sk.nverts, 6 * sizeof(float));
+    float lo[3], hi[3];
+    assertEqual(-1, glove_skin_bounds(&sk, lo, hi));
+
+    // first update writes everything, the same pose again nothing
+    assertEqual(2 * GLOVE_SKIN_PARTS, glove_skin_update(&sk, hands, 2, v, 24, 0, 12, &st));
+    assertEqual(sk.nverts, st.verts);
+    assertEqual(0, glove_skin_bounds(&sk, lo, hi));
+    for (int k = 0; k < 3; k++) {
+        float l = v[k], h = v[k];
+        for (int i = 1; i < sk.nverts; i++) {
+            if (v[i * 6 + k] < l) l = v[i * 6 + k];
+            if (v[i * 6 + k] > h) h = v[i * 6 + k];
+        }
+        assertEqualFloat(l, lo[k], 1e-6);
+        assertEqualFloat(h, hi[k], 1e-6);
+    }
+    assertEqual(0, glove_skin_update(&sk, hands, 2, v, 24, 0, 12, &st));
+    assertEqual(0, st.verts);
+
+    // the index tip's sphere: its top vertex is the joint plus the radius on y
+    int tip = GLOVE_KIN_BONES + 1 + 1 * 4 + 3;
+    const float* top = v + sk.first[tip] * 6;
+    glove_vec3_t j = hands[0].joints[1 + 1 * 4 + 3];
+    assertEqualFloat(j.x, top[0], 1e-6);
+    assertEqualFloat(j.y + hands[0].joint_radius[1 + 1 * 4 + 3], top[1], 1e-6);
+    assertEqualFloat(1.0, top[4], 1e-6);
+
+    // flexing the right index moves its 3 bones and 3 joints past the base
+    q[2] = glove_quat_axis_angle(glove_vec3(1, 0, 0), 30 * GLOVE_DEG2RAD);
+    glove_kin_hand(q, 6, glove_vec3(0.12f, 0, 0), 0, &hands[0]);
+    assertEqual(6, glove_skin_update(&sk, hands, 2, v, 24, 0, 12, &st));
+    assertLess(st.end_vert, sk.first[GLOVE_SKIN_PARTS] + 1);
+    // and the bent finger leaves the slab the flat hands filled
+    float flat_lo = lo[2], flat_hi = hi[2];
+    glove_skin_bounds(&sk, lo, hi);
+    assertTrue(lo[2] < flat_lo - 0.005f || hi[2] > flat_hi + 0.005f);
+    glove_skin_free(&sk);
+
+    // Y up: y and z swap
+    assertEqual(0, glove_skin_init(&sk, GLOVE_SKIN_Y_UP, 0));
+    glove_skin_update(&sk, hands, 2, v, 24, 0, 12, NULL);
+    j = hands[0].joints[1 + 1 * 4 + 3];
+    assertEqualFloat(j.y + hands[0].joint_radius[1 + 1 * 4 + 3], v[sk.first[tip] * 6 + 2], 1e-6);
+    assertEqualFloat(1.0, v[sk.first[tip] * 6 + 5], 1e-6);
+    glove_skin_free(&sk);
+
+    // too fine for 16 bit indices: nothing to draw, nothing to write
+    assertEqual(-1, glove_skin_init(&sk, 0, 200));
+    assertEqual(0, sk.nverts);
+    assertEqual(0, glove_skin_update(&sk, hands, 2, v, 24, 0, 12, &st));
+    assertEqual(0, st.verts);
+    free(v);
+}
+
+
+unittest(test_lod_sheds_and_restores)
+{
+    glove_lod_t l;
+    glove_lod_change_t ch;
+    glove_lod_init(&l, 20);
+    assertEqual(0, glove_lod_add(&l, "map", 2));
+    assertEqual(1, glove_lod_add(&l, "hand", 1));
+
+    // over budget: the map goes first, all the way, then the hand
+    int changes = 0, last = -1;
+    for (int i = 0; i < 10 * GLOVE_LOD_SETTLE; i++)
+        if (glove_lod_frame(&l, 40, &ch)) {
+            assertEqual(changes < 2 ? 0 : 1, ch.knob);
+            assertEqual(ch.from + 1, ch.to);
+            changes++;
+            last = i;
+        }
+    assertEqual(3, changes);
+    assertLess(last, 4 * GLOVE_LOD_SETTLE);
+    assertEqual(2, glove_lod_level(&l, 0));
+    assertEqual(1, glove_lod_level(&l, 1));
+
+    // well under: the hand comes back first, and not straight away
+    int first = -1;
+    for (int i = 0; i < 1000 && first < 0; i++)
+        if (glove_lod_frame(&l, 5, &ch)) first = i;
+    assertEqual(1, ch.knob);
+    assertEqual(0, ch.to);
+    assertMore(first, GLOVE_LOD_RESTORE_HOLD - 1);
+
+    // that restore didn't fit: shed it again and hold off twice as long
+    for (int i = 0; i < 2 * GLOVE_LOD_SETTLE; i++) glove_lod_frame(&l, 40, &ch);
+    assertEqual(1, glove_lod_level(&l, 1));
+    assertEqual(2 * GLOVE_LOD_RESTORE_HOLD, l.hold);
+
+    // in the band between headroom and budget nothing moves
+    for (int i = 0; i < 2000; i++) assertEqual(0, glove_lod_frame(&l, 16, &ch));
+}
+
+
+
+unittest(test_profile_parse)
+{
+    glove_profile_t p, sum;
+    glove_sample_t s;
+    const char* line = "#P:4000000:10:1000500:100120:9000:3000:4500:980000:40\n";
+    assertEqual(0, glove_profile_parse(line, &p));
+    // a comment to the sample readers
+    assertEqual(-1, glove_sample_parse(line, &s));
+    assertEqual((uint64_t)4000000, p.t_us);
+    assertEqual(10u, p.loops);
+    assertEqual(100120u, p.max_loop_us);
+    assertEqual((uint64_t)9000, p.us[GLOVE_PROFILE_I2C]);
+    assertEqual((uint64_t)980000, p.us[GLOVE_PROFILE_IDLE]);
+    assertEqual((uint64_t)4000, p.us[GLOVE_PROFILE_OTHER]);
+    assertEqualFloat(0.98, glove_profile_share(&p, GLOVE_PROFILE_IDLE), 0.001);
+    assertLess(glove_profile_overhead(&p), GLOVE_PROFILE_BUDGET);
+
+    memset(&sum, 0, sizeof(sum));
+    glove_profile_add(&sum, &p);
+    glove_profile_add(&sum, &p);
+    assertEqual(20u, sum.loops);
+    assertEqual((uint64_t)80, sum.probe_us);
+    assertEqualFloat(glove_profile_share(&p, GLOVE_PROFILE_I2C), glove_profile_share(&sum, GLOVE_PROFILE_I2C), 1e-9);
+
+    // short, or not a profile line
+    assertEqual(-1, glove_profile_parse("#P:4000000:10:1000500\n", &p));
+    assertEqual(-1, glove_profile_parse("#T:0:1000:1:0:0:0:0:0:0\n", &p));
+    assertEqual(-1, glove_profile_parse("0:1000:0:0:1:0:0:0\n", &p));
+}
+
+
+
+unittest(test_golden_catches_filter_change)
+{
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_golden_t golden, same, changed, back;
+    glove_golden_cmp_t c;
+    glove_synth_defaults(&par);
+    par.duration_s = 3;
+    assertEqual(0, glove_synth_session(&par, &ss));
+
+    assertEqual(0, glove_golden_run(&ss, GLOVE_FUSION_ALPHA, &golden));
+    // six sensors, every 4th sample of each, every 4th frame
+    assertEqual((ss.nsamples / 6 + 3) / 4 * 6, golden.nfused);
+    assertTrue(golden.nframes > 0);
+    assertEqual(0, glove_golden_save("test/golden.gold", &golden, "test"));
+    assertEqual(0, glove_golden_load("test/golden.gold", &back));
+    unlink("test/golden.gold");
+    assertEqual(golden.nframes, back.nframes);
+    assertEqualFloat(GLOVE_FUSION_ALPHA, back.alpha, 1e-6);
+
+    // the same filter: nothing moves past the file's five decimals
+    assertEqual(0, glove_golden_run(&ss, GLOVE_FUSION_ALPHA, &same));
+    assertEqual(0, glove_golden_compare(&ss, &back, &same, &c));
+    assertLess(c.drift[GLOVE_GOLDEN_FUSION].max, 0.01);
+    assertLess(c.drift[GLOVE_GOLDEN_KIN].max, 0.01);
+    assertEqualFloat(c.truth_then[GLOVE_GOLDEN_FUSION].p95, c.truth_now[GLOVE_GOLDEN_FUSION].p95, 0.01);
+    assertLess(c.truth_now[GLOVE_GOLDEN_FUSION].p95, 5.0);
+
+    // trusting the accelerometer ten times as much shows, and is worse
+    assertEqual(0, glove_golden_run(&ss, 0.6f, &changed));
+    assertEqual(0, glove_golden_compare(&ss, &back, &changed, &c));
+    assertMore(c.drift[GLOVE_GOLDEN_FUSION].p95, 0.1);
+    assertMore(c.truth_now[GLOVE_GOLDEN_FUSION].p95, c.truth_then[GLOVE_GOLDEN_FUSION].p95);
+
+    // a trace from another session doesn't line up
+    changed.nframes--;
+    assertEqual(-1, glove_golden_compare(&ss, &back, &changed, &c));
+    changed.nframes++;
+
+    glove_golden_free(&golden);
+    glove_golden_free(&same);
+    glove_golden_free(&changed);
+    glove_golden_free(&back);
+    glove_session_free(&ss);
+}
+
+
+
+unittest(test_shm_fan_out)
+{
+    glove_synth_params_t par;
+    glove_session_t ss;
+    glove_synth_defaults(&par);
+    par.duration_s = 1;
+    assertEqual(0, glove_synth_session(&par, &ss));
+
+    char name[64];
+    snprintf(name, sizeof(name), "/glove-test-%d", (int)getpid());
+    static glove_shm_t broker, client;
+    assertEqual(0, glove_shm_create(&broker, name, 16));
+    // one broker per segment
+    static glove_shm_t second;
+    assertEqual(-1, glove_shm_create(&second, name, 16));
+    assertEqual(EBUSY, errno);
+    assertEqual(0, glove_shm_open(&client, name));
+    glove_shm_pose_t p;
+    assertEqual(0, glove_shm_latest(&client, &p));
+
+    // the broker's stream publishes every sample it feeds
+    static glove_stream_t st;
+    static glove_handoff_t h;
+    glove_stream_init(&st);
+    glove_handoff_init(&h);
+    st.shm = &broker;
+    for (int i = 0; i < 40; i++) glove_stream_feed(&st, &ss.samples[i], &h);
+    const glove_frame_t* f;
+    glove_handoff_latest(&h, &f);
+    assertEqual(40, (int)glove_shm_head(&client));
+    assertEqual(1, glove_shm_latest(&client, &p));
+    assertEqual(40, (int)p.n);
+    assertEqual(f->nsensors, p.nsensors);
+    assertEqual(ss.samples[39].t_us, p.t_us);
+    for (int i = 0; i < f->nsensors; i++) assertEqualFloat(f->q[i].w, p.q[i].w, 1e-6);
+
+    // the ring keeps the last 16
+    glove_shm_entry_t e[64];
+    uint64_t next;
+    assertEqual(16, glove_shm_read(&client, 0, e, 64, &next));
+    assertEqual(24, (int)e[0].n);
+    assertEqual(40, (int)next);
+    assertEqual(ss.samples[24].t_us, e[0].s.t_us);
+    assertEqual(ss.samples[39].sensor, e[15].s.sensor);
+    assertEqual(0, glove_shm_read(&client, next, e, 64, &next));
+
+    // read in place, then overwritten: held() says the read is no good
+    const glove_shm_entry_t* in = glove_shm_peek(&client, 39);
+    assertTrue(in != NULL);
+    assertEqual(1, glove_shm_held(&client, 39));
+    assertTrue(glove_shm_peek(&client, 40) == NULL);
+    for (int i = 40; i < 56; i++) glove_stream_feed(&st, &ss.samples[i], &h);
+    assertEqual(0, glove_shm_held(&client, 39));
+    assertTrue(glove_shm_peek(&client, 39) == NULL);
+
+    // a viewer gets the pose as a frame, once
+    static glove_handoff_t view;
+    glove_handoff_init(&view);
+    assertEqual(56, glove_shm_poll(&client, 0, &view));
+    assertEqual(0, glove_shm_poll(&client, 0, &view));
+    assertEqual(1, glove_handoff_latest(&view, &f));
+    assertEqual(56, (int)f->seq);
+
+    // a broker stopped mid-publish: readers give up instead of spinning,
+    // and say it is gone once its heartbeat is stale
+    broker.hdr->pose_seq.store(2 * 56 + 1);
+    glove_shm_beat(&broker);
+    assertEqual(0, glove_shm_latest(&client, &p));
+    broker.hdr->head.store(57);
+    assertEqual(0, glove_shm_poll(&client, 0, &view));
+    broker.hdr->beat_ns.store(glove_monotonic_ns() - 2 * GLOVE_SHM_STALE_NS);
+    assertEqual(-1, glove_shm_latest(&client, &p));
+    assertEqual(-1, glove_shm_poll(&client, 0, &view));
+
+    glove_shm_close(&client);
+    glove_shm_close(&broker);
+    assertEqual(-1, glove_shm_open(&client, name));
+    assertEqual(ENOENT, errno);
+    glove_session_free(&ss);
+}
+
+
+unittest_main()
+
+// -- END OF FILE --
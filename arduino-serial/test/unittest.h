@@ -0,0 +1,62 @@
+//
+//    FILE: unittest.h
+// PURPOSE: just enough of the arduino_ci unittest() / assertXXX() macros
+//          to run the host glove pipeline tests with plain make
+//          https://github.com/Arduino-CI/arduino_ci/blob/master/REFERENCE.md
+//
+
+#ifndef __GLOVE_UNITTEST_H__
+#define __GLOVE_UNITTEST_H__
+
+#include <stdio.h>
+#include <math.h>
+
+struct unittest_case {
+    const char*    name;
+    void         (*fn)(void);
+    unittest_case* next;
+    static unittest_case*& head() { static unittest_case* h = 0; return h; }
+    static int&            failures() { static int f = 0; return f; }
+    unittest_case(const char* n, void (*f)(void)) : name(n), fn(f), next(0)
+    {
+        // keep declaration order
+        unittest_case** p = &head();
+        while (*p) p = &(*p)->next;
+        *p = this;
+    }
+};
+
+#define unittest(name) \
+    static void unittest_##name(void); \
+    static unittest_case unittest_reg_##name(#name, unittest_##name); \
+    static void unittest_##name(void)
+
+#define unittest_fail_(fmt, a, b) do { \
+    fprintf(stderr, "  %s:%d: " fmt "\n", __FILE__, __LINE__, a, b); \
+    unittest_case::failures()++; } while (0)
+
+#define assertTrue(x)          do { if (!(x)) unittest_fail_("%s %s", "expected true:", #x); } while (0)
+#define assertFalse(x)         do { if (x) unittest_fail_("%s %s", "expected false:", #x); } while (0)
+#define assertEqual(e, a)      do { if (!((e) == (a))) unittest_fail_("%s != %s", #e, #a); } while (0)
+#define assertLess(e, a)       do { if (!((e) < (a))) unittest_fail_("%s >= %s", #e, #a); } while (0)
+#define assertMore(e, a)       do { if (!((e) > (a))) unittest_fail_("%s <= %s", #e, #a); } while (0)
+#define assertEqualFloat(e, a, eps) \
+    do { if (fabs((double)(e) - (double)(a)) > (eps)) \
+        unittest_fail_("%g != %g", (double)(e), (double)(a)); } while (0)
+
+#define unittest_main() \
+int main() \
+{ \
+    int failed = 0; \
+    for (unittest_case* c = unittest_case::head(); c; c = c->next) { \
+        int before = unittest_case::failures(); \
+        c->fn(); \
+        int bad = unittest_case::failures() != before; \
+        printf("%s %s\n", bad ? "FAIL" : "ok  ", c->name); \
+        failed += bad; \
+    } \
+    printf("%d failed\n", failed); \
+    return failed ? 1 : 0; \
+}
+
+#endif
@@ -1,7 +1,7 @@
 //
 //    FILE: GY521.cpp
 //  AUTHOR: Rob Tillaart
-// VERSION: 0.2.3
+// VERSION: 0.2.5
 // PURPOSE: Arduino library for I2C GY521 accelerometer-gyroscope sensor
 //     URL: https://github.com/RobTillaart/GY521
 //
@@ -17,6 +17,8 @@
 //  0.2.2   2021-01-24  add interface part to readme.md 
 //                      add GY521_registers.h
 //  0.2.3   2021-01-26  align version numbers (oops)
+//  0.2.4   2026-10-19  add setAccelCalibration (scale + misalignment)
+//  0.2.5   2026-10-19  add lastReadMicros + GY521_profile.h
 //
 //  0.3.3   2021-07-05  fix #22 improve maths
  //  0.3.0   2021-04-07  fix #18 acceleration error correction (kudo's to Merkxic)
@@ -76,6 +78,28 @@ void GY521::reset()
   _yaw   = 0;
 }
 
+void GY521::setAccelCalibration(const float m[9], const float b[3])
+{
+  for (uint8_t i = 0; i < 9; i++) _cal[i] = m[i];
+  for (uint8_t i = 0; i < 3; i++) _cal[9 + i] = b[i];
+  _accelCal = true;
+}
+
+// "GCAL", version, count, 2 reserved, then count x 12 floats little endian
+bool GY521::setAccelCalibration(const uint8_t * blob, uint8_t index)
+{
+  if (blob[0] != 'G' || blob[1] != 'C' || blob[2] != 'A' || blob[3] != 'L') return false;
+  if (blob[4] != 1 || index >= blob[5]) return false;
+  const uint8_t * p = blob + 8 + index * 48;
+  for (uint8_t i = 0; i < 12; i++, p += 4)
+  {
+    uint32_t u = p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    memcpy(&_cal[i], &u, 4);
+  }
+  _accelCal = true;
+  return true;
+}
+
 bool GY521::wakeup()
 {
   SWire.beginTransmission(_address);
@@ -116,6 +140,7 @@ _lastTime = now;
 
   // time interval
   now = micros();
+  _readMicros = now;
   float duration = (now - _lastMicros) * 1e-6;   // time in seconds.
   _lastTime = now;
 
@@ -128,7 +153,15 @@ _lastTime = now;
   _ax += axe;
   _ay += aye;
   _az += aze;
-  
+
+  if (_accelCal)
+  {
+    float x = _ax, y = _ay, z = _az;
+    _ax = _cal[0] * x + _cal[1] * y + _cal[2] * z + _cal[9];
+    _ay = _cal[3] * x + _cal[4] * y + _cal[5] * z + _cal[10];
+    _az = _cal[6] * x + _cal[7] * y + _cal[8] * z + _cal[11];
+  }
+
   // prepare for Pitch Roll Yaw
   float _ax2 = _ax * _ax;
   float _ay2 = _ay * _ay;
@@ -2,7 +2,7 @@
 //
 //    FILE: GY521.h
 //  AUTHOR: Rob Tillaart
-// VERSION: 0.2.3
+// VERSION: 0.2.5
 // PURPOSE: Arduino library for I2C GY521 accelerometer-gyroscope sensor
 //     URL: https://github.com/RobTillaart/GY521
 //
@@ -15,7 +15,7 @@
 #include "SWire.h"
 
 
-#define GY521_LIB_VERSION           (F("0.2.3"))
+#define GY521_LIB_VERSION           (F("0.2.5"))
 
 
 #ifndef GY521_THROTTLE_TIME
@@ -81,6 +81,9 @@ public:
 
   // last time sensor is actually read.
   uint32_t lastTime()    { return _lastTime; };
+  // micros() at the end of the last read's I2C transfer; the rest of
+  // read() is math (see GY521_profile.h)
+  uint32_t lastReadMicros() { return _readMicros; };
 
   // generic worker to get access to all functionality
   uint8_t  setRegister(uint8_t reg, uint8_t value);
@@ -92,6 +95,14 @@ public:
   float    axe = 0, aye = 0, aze = 0;  // accelerometer errors
   float    gxe = 0, gye = 0, gze = 0;  // gyro errors
 
+  // full accelerometer correction a = M a + b, applied after axe..aze.
+  // m is 3x3 row major, from "glove-tool calib" in arduino-serial/.
+  void     setAccelCalibration(const float m[9], const float b[3]);
+  // same, taken from entry index of a "GCAL" blob; false if it isn't one
+  bool     setAccelCalibration(const uint8_t * blob, uint8_t index);
+  void     clearAccelCalibration()       { _accelCal = false; };
+  bool     hasAccelCalibration()         { return _accelCal; };
+
 
 private:
   uint8_t  _address;                // I2C address
@@ -99,12 +110,15 @@ private:
   uint16_t _throttleTime = GY521_THROTTLE_TIME;
   uint32_t _lastTime = 0;           // to measure duration for math & throttle
     uint32_t _lastMicros = 0;    
+  uint32_t _readMicros = 0;
   int16_t  _error = GY521_OK;       // initially everything is OK
 
   uint8_t  _afs = 0;                // sensitivity factor
   float    _raw2g = 1.0/16384.0;    // raw data to gravity g's
   float    _ax, _ay, _az;           // accelerometer raw
   float    _aax, _aay, _aaz;        // accelerometer processed
+  float    _cal[12];                // M row major, then b
+  bool     _accelCal = false;
 
   uint8_t  _gfs = 0;
   float    _raw2dps = 1.0/131.0;
@@ -0,0 +1,127 @@
+#pragma once
+//
+//    FILE: GY521_profile.h
+// VERSION: 0.2.5
+// PURPOSE: where a glove sketch's loop time goes
+//
+// Define GLOVE_PROFILE before including this and the sketch sums, per
+// loop(), the microseconds spent in
+//
+//   i2c      GY521::read()'s transfer
+//   math     the rest of read(): scaling, calibration, angles
+//   format   printing the sample lines
+//   idle     delay() and waiting for the next period
+//
+// and every GY521_PROFILE_EVERY ms sends the sums as one line:
+//
+//   #P:t_us:loops:loop_us:max_loop_us:i2c_us:math_us:format_us:idle_us:probe_us
+//
+// The leading '#' makes it a comment to anything that reads samples, so it
+// shares the link with them.  Loop time outside the phases is "other" (the
+// gesture code).  probe_us is what profiling cost over the period: its
+// extra micros() calls, at the cost measured in profileBegin(), and
+// printing the previous #P line.  glove-tool profile in arduino-serial/
+// decodes and charts the lines.
+//
+// Without GLOVE_PROFILE every call below is empty.
+//
+
+
+#include "GY521.h"
+
+
+#ifndef GY521_PROFILE_EVERY
+#define GY521_PROFILE_EVERY         1000   // milliseconds
+#endif
+
+#define GY521_PROF_I2C              0
+#define GY521_PROF_MATH             1
+#define GY521_PROF_FORMAT           2
+#define GY521_PROF_IDLE             3
+#define GY521_PROF_PHASES           4
+
+
+#ifdef GLOVE_PROFILE
+
+static uint32_t _profUs[GY521_PROF_PHASES];
+static uint32_t _profLoops, _profLoopUs, _profMaxLoop;
+static uint32_t _profLoopStart, _profSent;
+static uint32_t _profStamps;          // extra micros() calls this period
+static uint16_t _profStampNs;         // cost of one
+static uint32_t _profPrintUs;         // printing the last #P line
+
+
+// a micros() that profiling added, counted toward probe_us
+static inline uint32_t profileStamp()
+{
+  _profStamps++;
+  return micros();
+}
+
+static inline void profileAdd(uint8_t phase, uint32_t us)
+{
+  _profUs[phase] += us;
+}
+
+// split a read() timed from start to done at the end of its transfer
+static inline void profileRead(GY521 &sensor, int16_t rv, uint32_t start, uint32_t done)
+{
+  if (rv != GY521_OK) return;         // throttled or failed: other
+  _profUs[GY521_PROF_I2C] += sensor.lastReadMicros() - start;
+  _profUs[GY521_PROF_MATH] += done - sensor.lastReadMicros();
+}
+
+// last thing in setup()
+static inline void profileBegin()
+{
+  uint32_t start = micros();
+  for (uint8_t i = 0; i < 64; i++) micros();
+  _profStampNs = (uint16_t)((micros() - start) * 1000UL / 65);
+  _profSent = _profLoopStart = micros();
+}
+
+// first thing in every loop(): closes the last one, and sends a line
+// once a period
+static inline void profileLoop()
+{
+  uint32_t now = profileStamp();
+  uint32_t loopUs = now - _profLoopStart;
+  _profLoopUs += loopUs;
+  if (loopUs > _profMaxLoop) _profMaxLoop = loopUs;
+  _profLoops++;
+  _profLoopStart = now;
+  if (now - _profSent < GY521_PROFILE_EVERY * 1000UL) return;
+
+  Serial.print(F("#P:"));
+  Serial.print(now);
+  Serial.print(':');
+  Serial.print(_profLoops);
+  Serial.print(':');
+  Serial.print(_profLoopUs);
+  Serial.print(':');
+  Serial.print(_profMaxLoop);
+  for (uint8_t p = 0; p < GY521_PROF_PHASES; p++)
+  {
+    Serial.print(':');
+    Serial.print(_profUs[p]);
+    _profUs[p] = 0;
+  }
+  Serial.print(':');
+  Serial.println(_profStamps * _profStampNs / 1000UL + _profPrintUs);
+  _profLoops = _profLoopUs = _profMaxLoop = _profStamps = 0;
+  _profSent = now;
+  // counted in the next loop too, as other
+  _profPrintUs = micros() - now;
+}
+
+#else
+
+static inline uint32_t profileStamp() { return 0; }
+static inline void profileAdd(uint8_t, uint32_t) {}
+static inline void profileRead(GY521 &, int16_t, uint32_t, uint32_t) {}
+static inline void profileBegin() {}
+static inline void profileLoop() {}
+
+#endif
+
+// -- END OF FILE --
@@ -14,9 +14,13 @@ TEMPLATE = app
 
 
 SOURCES += main.cpp\
-        tetrahedron.cpp
+        tetrahedron.cpp \
+        tetrahedronscene.cpp \
+        ../../arduino-serial/glove-pick.cpp
 
 HEADERS  += tetrahedron.h \
+    tetrahedronscene.h \
+    ../../arduino-serial/glove-pick.h \
     arduino/arduino.h
 
 FORMS    += tetrahedron.ui
@@ -7,14 +7,6 @@ Tetrahedron::Tetrahedron(QWidget *parent) :
 {
     ui->setupUi(this);
     setFormat(QGLFormat(QGL::DoubleBuffer | QGL::DepthBuffer));
-
-    rotationX = -21.0;
-    rotationY = -57.0;
-    rotationZ = 0.0;
-    faceColors[0] = Qt::red;
-    faceColors[1] = Qt::green;
-    faceColors[2] = Qt::blue;
-    faceColors[3] = Qt::yellow;
 }
 
 Tetrahedron::~Tetrahedron()
@@ -35,45 +27,14 @@ void Tetrahedron::resizeGL(int width, int height)
     glViewport(0, 0, width, height);
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
-    GLfloat x = GLfloat(width) / height;
-    glFrustum(-x, +x, -1.0, +1.0, 4.0, 15.0);
+    TetrahedronScene::frustum(width, height);
     glMatrixMode(GL_MODELVIEW);
 }
 
 void Tetrahedron::paintGL()
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    draw();
-}
-
-void Tetrahedron::draw()
-{
-    static const GLfloat P1[3] = { 0.0, -1.0, +2.0 };
-    static const GLfloat P2[3] = { +1.73205081, -1.0, -1.0 };
-    static const GLfloat P3[3] = { -1.73205081, -1.0, -1.0 };
-    static const GLfloat P4[3] = { 0.0, +2.0, 0.0 };
-
-    static const GLfloat * const coords[4][3] = {
-        { P1, P2, P3 }, { P1, P3, P4 }, { P1, P4, P2 }, { P2, P4, P3 }
-    };
-
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glTranslatef(0.0, 0.0, -10.0);
-    glRotatef(rotationX, 1.0, 0.0, 0.0);
-    glRotatef(rotationY, 0.0, 1.0, 0.0);
-    glRotatef(rotationZ, 0.0, 0.0, 1.0);
-
-    for (int i = 0; i < 4; ++i) {
-        glLoadName(i);
-        glBegin(GL_TRIANGLES);
-        qglColor(faceColors[i]);
-        for (int j = 0; j < 3; ++j) {
-            glVertex3f(coords[i][j][0], coords[i][j][1],
-                       coords[i][j][2]);
-        }
-        glEnd();
-    }
+    scene.draw();
 }
 
 void Tetrahedron::mousePressEvent(QMouseEvent *event)
@@ -86,12 +47,12 @@ void Tetrahedron::mouseMoveEvent(QMouseEvent *event)
     GLfloat dx = GLfloat(event->x() - lastPos.x()) / width();
     GLfloat dy = GLfloat(event->y() - lastPos.y()) / height();
     if (event->buttons() & Qt::LeftButton) {
-        rotationX += 180 * dy;
-        rotationY += 180 * dx;
+        scene.rotationX += 180 * dy;
+        scene.rotationY += 180 * dx;
         updateGL();
     } else if (event->buttons() & Qt::RightButton) {
-        rotationX += 180 * dy;
-        rotationZ += 180 * dx;
+        scene.rotationX += 180 * dy;
+        scene.rotationZ += 180 * dx;
         updateGL();
     }
     lastPos = event->pos();
@@ -101,9 +62,12 @@ void Tetrahedron::mouseDoubleClickEvent(QMouseEvent *event)
 {
     int face = faceAtPosition(event->pos());
     if (face != -1) {
-        QColor color = QColorDialog::getColor(faceColors[face], this);
+        GLfloat *rgb = scene.faceColors[face];
+        QColor color = QColorDialog::getColor(QColor::fromRgbF(rgb[0], rgb[1], rgb[2]), this);
         if (color.isValid()) {
-            faceColors[face] = color;
+            rgb[0] = color.redF();
+            rgb[1] = color.greenF();
+            rgb[2] = color.blueF();
             updateGL();
         }
     }
@@ -111,31 +75,5 @@ void Tetrahedron::mouseDoubleClickEvent(QMouseEvent *event)
 
 int Tetrahedron::faceAtPosition(const QPoint &pos)
 {
-    const int MaxSize = 512;
-    GLuint buffer[MaxSize];
-    GLint viewport[4];
-
-    makeCurrent();
-
-    glGetIntegerv(GL_VIEWPORT, viewport);
-    glSelectBuffer(MaxSize, buffer);
-    glRenderMode(GL_SELECT);
-
-    glInitNames();
-    glPushName(0);
-
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluPickMatrix(GLdouble(pos.x()), GLdouble(viewport[3] - pos.y()),
-                  5.0, 5.0, viewport);
-    GLfloat x = GLfloat(width()) / height();
-    glFrustum(-x, x, -1.0, 1.0, 4.0, 15.0);
-    draw();
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-
-    if (!glRenderMode(GL_RENDER))
-        return -1;
-    return buffer[3];
+    return scene.faceAt(pos.x(), pos.y(), width(), height());
 }
@@ -5,6 +5,7 @@
 #include <QWidget>
 #include <QGLWidget>
 #include "glut.h"
+#include "tetrahedronscene.h"
 
 namespace Ui {
 class Tetrahedron;
@@ -28,13 +29,9 @@ protected:
     
 private:
     Ui::Tetrahedron *ui;
-    void draw();
     int faceAtPosition(const QPoint &pos);
 
-    GLfloat rotationX;
-    GLfloat rotationY;
-    GLfloat rotationZ;
-    QColor faceColors[4];
+    TetrahedronScene scene;
     QPoint lastPos;
 };
 
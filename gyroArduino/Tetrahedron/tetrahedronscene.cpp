@@ -0,0 +1,116 @@
+#include "tetrahedronscene.h"
+
+#include <math.h>
+
+static const GLfloat P1[3] = { 0.0, -1.0, +2.0 };
+static const GLfloat P2[3] = { +1.73205081, -1.0, -1.0 };
+static const GLfloat P3[3] = { -1.73205081, -1.0, -1.0 };
+static const GLfloat P4[3] = { 0.0, +2.0, 0.0 };
+
+static const GLfloat * const coords[4][3] = {
+    { P1, P2, P3 }, { P1, P3, P4 }, { P1, P4, P2 }, { P2, P4, P3 }
+};
+
+// out = a * b, column-major
+static void multiply(const GLfloat a[16], const GLfloat b[16], GLfloat out[16])
+{
+    GLfloat r[16];
+    for (int c = 0; c < 4; ++c)
+        for (int i = 0; i < 4; ++i)
+            r[c * 4 + i] = a[i] * b[c * 4] + a[4 + i] * b[c * 4 + 1]
+                         + a[8 + i] * b[c * 4 + 2] + a[12 + i] * b[c * 4 + 3];
+    for (int i = 0; i < 16; ++i)
+        out[i] = r[i];
+}
+
+// m = m * glRotatef(deg, axis) for a unit coordinate axis
+static void rotate(GLfloat m[16], GLfloat deg, int axis)
+{
+    GLfloat c = cosf(deg * GLOVE_DEG2RAD), s = sinf(deg * GLOVE_DEG2RAD);
+    int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    GLfloat r[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 };
+    r[u * 4 + u] = c;
+    r[u * 4 + v] = s;
+    r[v * 4 + u] = -s;
+    r[v * 4 + v] = c;
+    multiply(m, r, m);
+}
+
+TetrahedronScene::TetrahedronScene()
+{
+    static const GLfloat colors[4][3] = {
+        { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 1, 1, 0 }
+    };
+    rotationX = -21.0;
+    rotationY = -57.0;
+    rotationZ = 0.0;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 3; ++j)
+            faceColors[i][j] = colors[i][j];
+
+    // the faces wind inwards and Tetrahedron culls back faces, so what
+    // shows (and gets picked) is the inside of the far faces
+    glove_pick_init(&pick);
+    pick.cull_back = 1;
+    for (int i = 0; i < 4; ++i)
+        glove_pick_add_triangle(&pick, i,
+                                glove_vec3(coords[i][0][0], coords[i][0][1], coords[i][0][2]),
+                                glove_vec3(coords[i][1][0], coords[i][1][1], coords[i][1][2]),
+                                glove_vec3(coords[i][2][0], coords[i][2][1], coords[i][2][2]));
+}
+
+void TetrahedronScene::frustum(int width, int height)
+{
+    GLfloat x = GLfloat(width) / height;
+    glFrustum(-x, +x, -1.0, +1.0, 4.0, 15.0);
+}
+
+void TetrahedronScene::draw() const
+{
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glTranslatef(0.0, 0.0, -10.0);
+    glRotatef(rotationX, 1.0, 0.0, 0.0);
+    glRotatef(rotationY, 0.0, 1.0, 0.0);
+    glRotatef(rotationZ, 0.0, 0.0, 1.0);
+
+    for (int i = 0; i < 4; ++i) {
+        glLoadName(i);
+        glBegin(GL_TRIANGLES);
+        glColor3fv(faceColors[i]);
+        for (int j = 0; j < 3; ++j) {
+            glVertex3f(coords[i][j][0], coords[i][j][1],
+                       coords[i][j][2]);
+        }
+        glEnd();
+    }
+}
+
+void TetrahedronScene::modelViewProjection(int width, int height, GLfloat m[16]) const
+{
+    // glFrustum(-x, +x, -1, +1, 4, 15) of frustum(), then draw()'s modelview
+    const GLfloat n = 4.0, f = 15.0;
+    GLfloat x = GLfloat(width) / height;
+    GLfloat p[16] = {
+        n / x, 0, 0, 0,
+        0, n, 0, 0,
+        0, 0, -(f + n) / (f - n), -1,
+        0, 0, -2 * f * n / (f - n), 0
+    };
+    GLfloat t[16] = { 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,-10,1 };
+    multiply(p, t, m);
+    rotate(m, rotationX, 0);
+    rotate(m, rotationY, 1);
+    rotate(m, rotationZ, 2);
+}
+
+int TetrahedronScene::faceAt(int x, int y, int width, int height) const
+{
+    GLfloat mvp[16];
+    glove_ray_t ray;
+    modelViewProjection(width, height, mvp);
+    // through the pixel's centre
+    if (glove_pick_ray_from_screen(mvp, x + 0.5f, y + 0.5f, width, height, &ray) < 0)
+        return -1;
+    return glove_pick_ray(&pick, &ray, NULL);
+}
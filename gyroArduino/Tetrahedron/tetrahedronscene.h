@@ -0,0 +1,33 @@
+#ifndef TETRAHEDRONSCENE_H
+#define TETRAHEDRONSCENE_H
+
+#include <GL/gl.h>
+
+#include "../../arduino-serial/glove-pick.h"
+
+// What Tetrahedron draws, without Qt, so it can also be rendered
+// offscreen (HappyHands/bench/render-bench) and picked without GL.
+class TetrahedronScene
+{
+public:
+    TetrahedronScene();
+
+    // glFrustum for a width x height viewport, on the current matrix
+    static void frustum(int width, int height);
+    void draw() const;
+    // the projection and modelview draw() sets up, as one column-major
+    // matrix, computed without a GL context
+    void modelViewProjection(int width, int height, GLfloat m[16]) const;
+    // face under window pixel (x, y) of a width x height view, or -1
+    int faceAt(int x, int y, int width, int height) const;
+
+    GLfloat rotationX;
+    GLfloat rotationY;
+    GLfloat rotationZ;
+    GLfloat faceColors[4][3];
+
+private:
+    glove_pick_t pick;              // the faces, in model space
+};
+
+#endif // TETRAHEDRONSCENE_H
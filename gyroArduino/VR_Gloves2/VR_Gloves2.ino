@@ -1,8 +1,13 @@
 //#include <HardwareSerial.h>
 //#include <HID.h>
 #include "GY521.h"
+// send where loop time goes as a "#P:" line once a second, for
+// glove-tool profile; see GY521_profile.h
+//#define GLOVE_PROFILE
+#include "GY521_profile.h"
 
 long timer = 0;
+uint32_t idleFrom;
 
 GY521 Main(0x68);//, Thumb(0x68), Point(0x68), Middle(0x68), Ring(0x68), Little(0x68);
 uint32_t counter = 0;
@@ -118,6 +123,8 @@ Wire.begin();
   // try moving hand certain ammount or distance to calibrate ?
   
   delay(100);
+  profileBegin();
+  idleFrom = profileStamp();
 }
 
 
@@ -186,6 +193,9 @@ void loop()
 {
   
   if (millis() - timer > 500) {
+    // one profiled loop per period; the spinning in between is idle
+    profileAdd(GY521_PROF_IDLE, profileStamp() - idleFrom);
+    profileLoop();
     uint32_t start = micros();
   //  then = start;
   float x = 0;
@@ -202,7 +212,9 @@ void loop()
  // delay(SensitivtyFactor);
   for (int i = 0; i < avg; i++)
   {
-    Main.read();
+    uint32_t readStart = profileStamp();
+    int16_t rv = Main.read();
+    profileRead(Main, rv, readStart, profileStamp());
     
     xa = xa + Main.getAngleX();
     ya = ya + Main.getAngleY();
@@ -263,6 +275,7 @@ void loop()
   Serial.print("z=");
   Serial.println(z);
 #endif
+  uint32_t printStart = profileStamp();
   #define mprinta
   #ifdef mprinta
   //gyro rotation axis
@@ -320,6 +333,8 @@ void loop()
   #endif
   
  // #define mprint2
+  profileAdd(GY521_PROF_FORMAT, profileStamp() - printStart);
+
   #ifdef mprint2
   Serial.print("ax=");
   Serial.print(arx);
@@ -396,6 +411,7 @@ void loop()
     Little.read();
   */
     timer = millis();
+    idleFrom = profileStamp();
   }
 
 }
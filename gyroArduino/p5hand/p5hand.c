@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
 
@@ -11,6 +12,7 @@
 #include <GL/glut.h>
 
 #include "p5glove.h"
+#include "p5hand.h"
 
 #define WORLD_SIZE 5.0
 #define WORLD_SCALE 10.0
@@ -28,11 +30,84 @@ static int d_ref_hand=1;
 static int d_position=1;
 static int d_rotation=0;
 
+/* Geometry cache: display lists built once by render_init(), drawn with
+ * per-instance transforms.  Unit sphere and cylinder (radius 1, the
+ * cylinder 1 long on +Z), the inside-out world sphere, and one list per
+ * printable stroke character for the labels.
+ */
+#define LABEL_FIRST	32
+#define LABEL_LAST	126
+
+static GLuint list_sphere=0;
+static GLuint list_cylinder=0;
+static GLuint list_world=0;
+static GLuint list_glyphs=0;
+
+/* Filled by the sampler (render_next) or whoever embeds the view */
+double p5hand_led[P5HAND_LEDS][3];
+double p5hand_position[3];
+
+void render_show(int axes, int hand)
+{
+	d_ref_axes=axes;
+	d_ref_hand=hand;
+}
+
+static void render_build_lists(void)
+{
+	GLUquadricObj *obj;
+	int c;
+
+	obj=gluNewQuadric();
+	gluQuadricDrawStyle(obj,GLU_SMOOTH);
+
+	list_sphere=glGenLists(3);
+	list_cylinder=list_sphere+1;
+	list_world=list_sphere+2;
+
+	gluQuadricOrientation(obj,GLU_OUTSIDE);
+	glNewList(list_sphere,GL_COMPILE);
+	gluSphere(obj,1.0,10,10);
+	glEndList();
+
+	glNewList(list_cylinder,GL_COMPILE);
+	gluCylinder(obj,1.0,1.0,1.0,10,1);
+	glEndList();
+
+	gluQuadricOrientation(obj,GLU_INSIDE);
+	glNewList(list_world,GL_COMPILE);
+	gluSphere(obj,WORLD_SIZE,10,10);
+	glEndList();
+
+	gluDeleteQuadric(obj);
+
+	/* Each glyph list ends with the glyph's advance, like
+	 * glutStrokeCharacter() itself, so a label is one glCallLists()
+	 */
+	list_glyphs=glGenLists(LABEL_LAST-LABEL_FIRST+1);
+	for (c=LABEL_FIRST;c <= LABEL_LAST;c++) {
+		glNewList(list_glyphs+c-LABEL_FIRST,GL_COMPILE);
+		glutStrokeCharacter(GLUT_STROKE_ROMAN,c);
+		glEndList();
+	}
+}
+
+void render_release(void)
+{
+	if (list_sphere)
+		glDeleteLists(list_sphere,3);
+	if (list_glyphs)
+		glDeleteLists(list_glyphs,LABEL_LAST-LABEL_FIRST+1);
+	list_sphere=list_cylinder=list_world=list_glyphs=0;
+}
+
 void render_init(void)
 {
-	GLfloat fogColor[4]= {0.7, 0.7, 0.7, 1.0};
 	GLfloat light_pos[4]={0.0, WORLD_SIZE, 0.0, 1.0};
 
+	render_release();
+	render_build_lists();
+
 	glClearColor(0.0, 0.0, 0.0, 0.0);
 	glShadeModel(GL_SMOOTH);
 
@@ -76,16 +151,15 @@ void render_label(GLdouble size, const char *string)
 	glPushMatrix();
 	glTranslated(+size/2,size,0);
 	glScaled(0.001,0.001,0.001);
-	while (*string)
-		glutStrokeCharacter(GLUT_STROKE_ROMAN,*(string++));
+	glListBase(list_glyphs-LABEL_FIRST);
+	glCallLists(strlen(string),GL_UNSIGNED_BYTE,string);
+	glListBase(0);
 	glPopMatrix();
 }
 
 void render_cylinder(GLdouble diameter,const GLdouble p1[3],const GLdouble p2[3],const char *label)
 {
 	GLdouble v[3],dist,ax,r[3];
-	GLUquadricObj *obj;
-	int is_z=0;
 
 	v[0]=p2[0]-p1[0];
 	v[1]=p2[1]-p1[1];
@@ -99,38 +173,40 @@ void render_cylinder(GLdouble diameter,const GLdouble p1[3],const GLdouble p2[3]
 	v[1] /= dist;
 	v[2] /= dist;
 
-	/* Compute angle and rotation axis */
+	/* Compute angle and rotation axis: gluCylinder runs along +Z */
 	//ax=180.0/M_PI * acos(p5glove_dot(z_front,v));
 	//p5glove_plane(z_front,zero,v,r);
-
-	obj=gluNewQuadric();
-	gluQuadricDrawStyle(obj,GLU_SMOOTH);
-	gluQuadricOrientation(obj,GLU_OUTSIDE);
+	ax=180.0/M_PI * acos(v[2]);
+	r[0]=-v[1];
+	r[1]=v[0];
+	r[2]=0.0;
+	if (r[0] == 0.0 && r[1] == 0.0)
+		r[0]=1.0;
 
 	/* Fun fun. Draw a cylinder between two points.
 	 */
 	glPushMatrix();
 	glPushMatrix();
 	glTranslated(p1[0],p1[1],p1[2]);
-	gluSphere(obj,diameter,10,10);
+	glPushMatrix();
+	glScaled(diameter,diameter,diameter);
+	glCallList(list_sphere);
+	glPopMatrix();
 	glRotated(ax, r[0], r[1], r[2]);
-	gluCylinder(obj,diameter,diameter,dist,10,1);
+	glScaled(diameter,diameter,dist);
+	glCallList(list_cylinder);
 	glPopMatrix();
 	glTranslated(p2[0],p2[1],p2[2]);
-	gluSphere(obj,diameter,10,10);
 	render_label(diameter,label);
+	glScaled(diameter,diameter,diameter);
+	glCallList(list_sphere);
 	glPopMatrix();
-
-	gluDeleteQuadric(obj);
 }
 
 void render_world(void)
 {
-	 GLUquadricObj *obj;
 	 int mode=GL_FRONT;
 
-
-	 obj=gluNewQuadric();
 	 glMaterialfv(mode,GL_AMBIENT,ambient);
 	 glMaterialfv(mode,GL_DIFFUSE,diffuse);
 	 glMaterialfv(mode,GL_SPECULAR,specular);
@@ -139,16 +215,13 @@ void render_world(void)
 
 	 glPushMatrix();
 	 glTranslatef(0.0,0.0,0.0);
-	 gluQuadricDrawStyle(obj,GLU_SMOOTH);
-	 gluQuadricOrientation(obj,GLU_INSIDE);
-
-	 gluSphere(obj,WORLD_SIZE,10,10);
+	 glCallList(list_world);
 	 glPopMatrix();
-
-	 gluDeleteQuadric(obj);
 }
 
+#ifndef P5HAND_NO_MAIN
 static P5Glove glove=NULL;
+#endif
 
 static GLfloat ambient_ir[4]={0.0, 0.2, 0.2, 1.0};
 static GLfloat diffuse_ir[4]={0.0, 0.8, 0.8, 1.0};
@@ -157,14 +230,9 @@ void render_hand(void)
 {
 	int i;
 	int mode=GL_FRONT;
-	GLUquadricObj *obj;
 
-	obj=gluNewQuadric();
-	gluQuadricDrawStyle(obj,GLU_SMOOTH);
-	gluQuadricOrientation(obj,GLU_OUTSIDE);
-
-	for (i=0;i < 8;i++) {
-		double pos[3];
+	for (i=0;i < P5HAND_LEDS;i++) {
+		const double *pos=p5hand_led[i];
 		char label[2]={0,0};
 		double size = 0.05;
 		//p5glove_reference_led(glove,i,pos);
@@ -186,12 +254,11 @@ void render_hand(void)
 		glTranslated(pos[0]*WORLD_SCALE,pos[1]*WORLD_SCALE,pos[2]*WORLD_SCALE);
 		label[0]='0'+i;
 		render_label(size,label);
-		gluSphere(obj,size,10,10);
+		glScaled(size,size,size);
+		glCallList(list_sphere);
 
 		glPopMatrix();
 	}
-
-	gluDeleteQuadric(obj);
 }
 
 void render_axes(void)
@@ -211,9 +278,8 @@ void render_axes(void)
 
 void render_objs(void)
 {
-	int i,j;
 	int mode=GL_FRONT;
-	double pos[3],angle;
+	double pos[3]={0.0, 1.0, 0.0},angle=0.0;
 
 	glMaterialfv(mode,GL_AMBIENT,ambient_ir);
 
@@ -221,7 +287,7 @@ void render_objs(void)
 
 	if (d_position) {
 		//p5glove_get_position(glove, pos);
-		glTranslated(pos[0]*WORLD_SCALE,pos[1]*WORLD_SCALE,pos[2]*WORLD_SCALE);
+		glTranslated(p5hand_position[0]*WORLD_SCALE,p5hand_position[1]*WORLD_SCALE,p5hand_position[2]*WORLD_SCALE);
 	}
 
 	if (d_rotation) {
@@ -238,7 +304,7 @@ void render_objs(void)
 
 static double yaw=0.0,tilt=0.0,pitch=0.0;
 
-void render_display(void)
+void render_frame(void)
 {
 	glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
@@ -259,15 +325,17 @@ void render_display(void)
 
 	/* Draw samples here */
 	render_objs();
+}
 
+void render_display(void)
+{
+	render_frame();
 	glutSwapBuffers();
 }
 
 
 void render_next(void)
 {
-	int err;
-
 	/* Get samples here */
 	//err=p5glove_sample(glove, 100);
 
@@ -316,6 +384,7 @@ void render_keyboard(unsigned char key, int x, int y)
 	}
 }
 
+#ifndef P5HAND_NO_MAIN
 int main(int argc,char **argv)
 {
 	printf("Keys:\n"
@@ -351,3 +420,4 @@ int main(int argc,char **argv)
 
     return 0;
 }
+#endif
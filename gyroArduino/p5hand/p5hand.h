@@ -0,0 +1,33 @@
+/*
+ * p5hand render entry points, for embedding the view without GLUT's
+ * main loop (HappyHands/bench/render-bench builds it with
+ * -DP5HAND_NO_MAIN)
+ */
+
+#ifndef P5HAND_H
+#define P5HAND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define P5HAND_LEDS	8
+
+/* Glove LED and position in p5glove units, set before each frame */
+extern double p5hand_led[P5HAND_LEDS][3];
+extern double p5hand_position[3];
+
+/* Needs the GL context current; builds the geometry cache */
+void render_init(void);
+/* Frees the geometry cache while the context is still current */
+void render_release(void);
+void render_reshape(int w,int h);
+/* render_display() without the buffer swap */
+void render_frame(void);
+void render_show(int axes,int hand);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* P5HAND_H */
@@ -0,0 +1,91 @@
+#include "handmesh.h"
+
+#include <stddef.h>
+#include <string.h>
+
+using namespace irr;
+
+HandMesh::HandMesh(scene::ISceneManager *smgr, f32 scale, scene::ISceneNode *parent)
+    : m_nhands(0), m_buffer(0), m_mesh(0), m_node(0)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    memset(&m_skin, 0, sizeof(m_skin));
+    m_buffer = new scene::SMeshBuffer();
+    if (!build(0))
+        return;
+    // vertices change every frame, the triangles only with the detail
+    m_buffer->setHardwareMappingHint(scene::EHM_STREAM, scene::EBT_VERTEX);
+    m_buffer->setHardwareMappingHint(scene::EHM_STATIC, scene::EBT_INDEX);
+
+    m_mesh = new scene::SMesh();
+    m_mesh->addMeshBuffer(m_buffer);
+    m_node = smgr->addMeshSceneNode(m_mesh, parent);
+    if (m_node) {
+        m_node->setScale(core::vector3df(scale, scale, scale));
+        // normals are unit length in metres, the node scales them
+        m_node->setMaterialFlag(video::EMF_NORMALIZE_NORMALS, true);
+        // glove-skin mirrors Z up to Y up; don't depend on which winding
+        // the driver calls front
+        m_node->setMaterialFlag(video::EMF_BACK_FACE_CULLING, false);
+    }
+}
+
+HandMesh::~HandMesh()
+{
+    // the scene manager owns the node
+    if (m_mesh) m_mesh->drop();
+    if (m_buffer) m_buffer->drop();
+    glove_skin_free(&m_skin);
+}
+
+// on failure the mesh and skin of the old detail stay
+bool HandMesh::build(int slices)
+{
+    glove_skin_t skin;
+    if (glove_skin_init(&skin, GLOVE_SKIN_Y_UP, slices) != 0)
+        return false;
+    glove_skin_free(&m_skin);
+    m_skin = skin;
+    m_buffer->Vertices.set_used(m_skin.nverts);
+    for (int i = 0; i < m_skin.nverts; ++i) {
+        m_buffer->Vertices[i].Color = video::SColor(255, 235, 200, 170);
+        m_buffer->Vertices[i].TCoords.set(0, 0);
+    }
+    m_buffer->Indices.set_used(m_skin.nindices);
+    memcpy(m_buffer->Indices.pointer(), m_skin.indices, m_skin.nindices * sizeof(u16));
+    m_buffer->setDirty(scene::EBT_VERTEX_AND_INDEX);
+    return true;
+}
+
+bool HandMesh::setDetail(int slices)
+{
+    if (!m_node || !build(slices))
+        return false;
+    if (m_nhands)
+        update(m_pose, m_nhands);
+    return true;
+}
+
+int HandMesh::update(const glove_hand_pose_t *hands, int nhands)
+{
+    if (!m_node)
+        return 0;
+    if (nhands > GLOVE_SKIN_HANDS) nhands = GLOVE_SKIN_HANDS;
+    if (hands != m_pose)
+        memcpy(m_pose, hands, nhands * sizeof(glove_hand_pose_t));
+    m_nhands = nhands;
+
+    int parts = glove_skin_update(&m_skin, hands, nhands, m_buffer->Vertices.pointer(),
+                                  sizeof(video::S3DVertex), offsetof(video::S3DVertex, Pos),
+                                  offsetof(video::S3DVertex, Normal), &m_stats);
+    float lo[3], hi[3];
+    if (parts && glove_skin_bounds(&m_skin, lo, hi) == 0) {
+        m_buffer->setDirty(scene::EBT_VERTEX);
+        // from the per part bounds glove-skin kept, not another pass
+        // over every vertex
+        core::aabbox3df box(lo[0], lo[1], lo[2], hi[0], hi[1], hi[2]);
+        m_buffer->setBoundingBox(box);
+        m_mesh->setBoundingBox(box);
+    }
+    return parts;
+}
@@ -0,0 +1,44 @@
+#ifndef HANDMESH_H
+#define HANDMESH_H
+
+#include <irrlicht.h>
+
+#include "../arduino-serial/glove-skin.h"
+
+// Both hands as a single mesh scene node, skinned on the CPU by
+// glove-skin.  update() applies a whole frame of kinematics output in
+// one pass and rewrites only the bones and joints that moved; nothing
+// else in the scene graph is touched, so drawAll() walks one node for
+// the hands instead of one per bone.
+class HandMesh
+{
+public:
+    // glove-kinematics works in metres, scale is scene units per metre
+    HandMesh(irr::scene::ISceneManager *smgr, irr::f32 scale, irr::scene::ISceneNode *parent = 0);
+    ~HandMesh();
+
+    bool ok() const { return m_node != 0; }
+    irr::scene::IMeshSceneNode *node() const { return m_node; }
+
+    // returns the number of bones and joints rewritten
+    int update(const glove_hand_pose_t *hands, int nhands);
+    const glove_skin_stats_t &stats() const { return m_stats; }
+
+    // rebuild with round parts cut into this many slices (0 for the
+    // default) and re-skin the last pose
+    bool setDetail(int slices);
+    int detail() const { return m_skin.slices; }
+
+private:
+    bool build(int slices);
+
+    glove_skin_t m_skin;
+    glove_skin_stats_t m_stats;
+    glove_hand_pose_t m_pose[GLOVE_SKIN_HANDS];
+    int m_nhands;
+    irr::scene::SMeshBuffer *m_buffer;
+    irr::scene::SMesh *m_mesh;
+    irr::scene::IMeshSceneNode *m_node;
+};
+
+#endif // HANDMESH_H
@@ -55,18 +55,22 @@
 #include <getopt.h>
 
 #include "arduino-serial-lib.h"
+#include "../arduino-serial/glove-stream.h"
+#include "../arduino-serial/glove-lod.h"
+#include "../arduino-serial/glove-interp.h"
+#include "../arduino-serial/glove-replay.h"
+#include "../arduino-serial/glove-shm.h"
+#include "handmesh.h"
 
 #include <irrlicht.h>
 #include <iostream>
 using namespace irr;
 
-#include <sstream>
-#include <string>
-#include <vector>
+#include <atomic>
+#include <thread>
+#include <wchar.h>
 using namespace std;
 
-float GX,GY,GZ;
-float AX,AY,AZ;
 //
 void usage(void)
 {
@@ -86,6 +90,11 @@ void usage(void)
     "  -e  --eolchar=char         Specify EOL char for reads (default '\\n')\n"
     "  -t  --timeout=millis       Timeout for reads in millisecs (default 5000)\n"
     "  -q  --quiet                Don't print out as much info\n"
+    "  -D  --interp=millis        Draw the hands this far behind, interpolated (default 30)\n"
+    "  -P  --play=file            Play a glove-record file instead of a port (before -r)\n"
+    "  -T  --trace=file           Trace each sample to the screen, write Chrome trace JSON on exit\n"
+    "  -M  --metrics=socket       Serve Prometheus metrics on this Unix socket\n"
+    "  -B  --broker=shm           Take a glove-tool broker's frames instead of a port (before -r)\n"
     "\n"
     "Note: Order is important. Set '-b' baudrate before opening port'-p'. \n"
     "      Used to make series of actions: '-d 2000 -s hello -d 100 -r' \n"
@@ -108,15 +117,16 @@ const char *argv1[]={"appname","-b","9600","-p","/dev/ttyUSB0","-r","null"};
 }
 int main()
 {
-char *argv[]={"appname","-b","9600","-p","/dev/ttyUSB0","-r","null"};
+char *argv[]={"appname","-b","115200","-p","/dev/ttyUSB0","-D","30","-r","null"};
 
 //int argc = sizeof(argv1) / sizeof(char*) – 1;
 int argc = sizeof(argv) / sizeof(char*) -1;
 
 	// create device and exit if creation failed
 
+	// vsync: the render loop runs at display rate, not flat out
 	IrrlichtDevice *device =
-		createDevice(video::EDT_OPENGL, core::dimension2d<u32>(640, 480));
+		createDevice(video::EDT_OPENGL, core::dimension2d<u32>(640, 480), 16, false, false, true);
 
 	if (device == 0)
 		return 1; // could not create selected driver.
@@ -138,7 +148,7 @@ int argc = sizeof(argv) / sizeof(char*) -1;
     if (node)
 		node->setPosition(core::vector3df(-1300,-144,-1249));
 
-	smgr->addCameraSceneNodeFPS();
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNodeFPS();
 //		device->getCursorControl()->setVisible(false);
 
     const int buf_max = 256;
@@ -149,6 +159,11 @@ int argc = sizeof(argv) / sizeof(char*) -1;
     char quiet=0;
     char eolchar = '\n';
     int timeout = 100;
+    float interpMs = GLOVE_INTERP_DELAY_MS;
+    const char* playPath = NULL;
+    const char* tracePath = NULL;
+    const char* metricsPath = NULL;
+    const char* brokerName = NULL;
     char buf[buf_max];
     int rc,n;
 
@@ -172,11 +187,16 @@ int argc = sizeof(argv) / sizeof(char*) -1;
         {"eolchar",    required_argument, 0, 'e'},
         {"timeout",    required_argument, 0, 't'},
         {"quiet",      no_argument,       0, 'q'},
+        {"interp",     required_argument, 0, 'D'},
+        {"play",       required_argument, 0, 'P'},
+        {"trace",      required_argument, 0, 'T'},
+        {"metrics",    required_argument, 0, 'M'},
+        {"broker",     required_argument, 0, 'B'},
         {NULL,         0,                 0, 0}
     };
 
     while(1) {
-        opt = getopt_long (argc, argv, "hp:b:s:S:i:rFn:d:qe:t:",
+        opt = getopt_long (argc, argv, "hp:b:s:S:i:rFn:d:qe:t:D:P:T:M:B:",
                            loptions, &option_index);
         if (opt==-1) break;
         switch (opt) {
@@ -188,6 +208,22 @@ int argc = sizeof(argv) / sizeof(char*) -1;
             eolchar = optarg[0];
             if(!quiet) printf("eolchar set to '%c'\n",eolchar);
             break;
+        case 'D':
+            interpMs = strtof(optarg,NULL);
+            if( !quiet ) printf("interpolation delay %.0f millisecs\n",interpMs);
+            break;
+        case 'P':
+            playPath = optarg;
+            break;
+        case 'T':
+            tracePath = optarg;
+            break;
+        case 'M':
+            metricsPath = optarg;
+            break;
+        case 'B':
+            brokerName = optarg;
+            break;
         case 't':
             timeout = strtol(optarg,NULL,10);
             if( !quiet ) printf("timeout set to %d millisecs\n",timeout);
@@ -239,99 +275,188 @@ int argc = sizeof(argv) / sizeof(char*) -1;
             if(rc==-1) error("error writing");
             break;
         case 'r':{ //run loop
+            if( fd == -1 && !playPath && !brokerName ) error("serial port not opened");
+	// a recording plays back at real time through the same stream
+	static glove_replay_t replay;
+	if (playPath && glove_replay_open(&replay, playPath) != 0) error("couldn't open recording");
+	// -B: another process owns the glove and publishes fused frames
+	static glove_shm_t broker;
+	if (brokerName && glove_shm_open(&broker, brokerName) != 0) error("no glove broker running");
 
-         scene::ISceneNode* cube = smgr->addCubeSceneNode();
-
-	while(device->run())
-	{
-
-            if( fd == -1 ) error("serial port not opened");
-            memset(buf,0,buf_max);  //
-            serialport_read_until(fd, buf, eolchar, buf_max, timeout);
-           // if( !quiet )
-            // printf("read string:");
+	// Both hands are one skinned mesh node, 100 units to the metre.  A
+	// new frame runs the kinematics and rewrites the bones that moved in
+	// one pass; between frames the hands cost drawAll() nothing extra.
+	HandMesh hands(smgr, 100.0f);
+	if (!hands.ok()) error("couldn't build the hand mesh");
+	hands.node()->setPosition(core::vector3df(0,10,10));
+	smgr->setAmbientLight(video::SColorf(0.3f,0.3f,0.3f));
+	smgr->addLightSceneNode(camera, core::vector3df(0,0,0), video::SColorf(1.0f,1.0f,1.0f), 400.0f);
 
-
-           /// printf("%s", buf);
+	glove_quat_t rest[GLOVE_HAND_SENSORS];
+	for (int i = 0; i < GLOVE_HAND_SENSORS; i++) rest[i] = glove_quat_identity();
+	glove_hand_pose_t pose[GLOVE_SKIN_HANDS];
+	for (int h = 0; h < GLOVE_SKIN_HANDS; h++)
+		glove_kin_hand(rest, GLOVE_HAND_SENSORS, glove_vec3(h ? -0.12f : 0.12f, 0, 0), h, &pose[h]);
+	hands.update(pose, GLOVE_SKIN_HANDS);
 
-
-	//core::string tester = &buf;
-	//if (buf !=""){
-	//printf("%s",buf);
-	//std::string test(buf);
-  // irr::core::stringc test2( test.c_str());
-	//printf("%stest\n",test.c_str());
-	//printf("%stest2\n",test2.c_str());
+	// The reader thread owns fd from here on.  It fuses every line and
+	// hands the newest orientations over (glove-stream), so the loop
+	// below runs at display rate and never waits for the glove.
+	static glove_handoff_t handoff;
+	glove_handoff_init(&handoff);
+	// Samples come at 10..100 Hz and unevenly, frames at display rate:
+	// draw the hands interpMs behind, slerped between samples, so they
+	// move on every frame instead of jumping when a sample lands.
+	static glove_interp_t interp;
+	glove_interp_init(&interp, interpMs);
+	bool interpMoving = false;
+	// -T: the newest sample of each drawn frame is followed to the swap
+	static glove_trace_t trace;
+	if (tracePath && glove_trace_init(&trace, 0) != 0) error("out of memory");
+	glove_trace_span_t span;
+	// -M: counters and histograms for a scraper; the loop counts frames drawn
+	static glove_metrics_t metrics;
+	glove_metrics_init(&metrics);
+	if (metricsPath && glove_metrics_serve(&metrics, metricsPath) != 0) error("couldn't serve the metrics");
+	uint32_t drawnSeq = 0;
+	std::atomic<bool> quit(false), lost(false);
+	std::thread reader([&]() {
+		glove_stream_t st;
+		glove_stream_init(&st);
+		if (tracePath) st.trace = &trace;
+		if (metricsPath) st.metrics = &metrics;
+		while (!quit)
+			if ((brokerName ? glove_shm_poll(&broker, 50, &handoff)
+			     : playPath ? glove_replay_poll(&replay, &st, 50, &handoff)
+			                : glove_stream_poll(&st, fd, 50, &handoff)) < 0) { lost = true; break; }
+	});
 
-std::string::size_type sz;
+	// Frame budget: the kiosk holds 30 fps.  glove-lod sheds the knobs
+	// below in order when frames run long and puts them back, latest
+	// first, once there is room again.  Every turn is logged.
+	const f32 budgetMs = 1000.0f / 30;
+	// octree node size: smaller nodes cull tighter for more draw calls
+	static const s32 octreePolys[] = { 1024, 512, 256, 128 };
+	static const f32 farValue[] = { 3000, 2000, 1200, 700 };
+	static const int handSlices[] = { 12, 8, 6 };
+	glove_lod_t lod;
+	glove_lod_init(&lod, budgetMs);
+	// the octree culls its nodes by the camera's box unless told to use the frustum
+	const int lodCulling = glove_lod_add(&lod, "map-culling", 1);
+	const int lodOctree = glove_lod_add(&lod, "map-octree", 3);
+	const int lodFar = glove_lod_add(&lod, "map-far", 3);
+	const int lodHands = glove_lod_add(&lod, "hand-detail", 2);
+	camera->setFarValue(farValue[0]);
 
-//https://www.codegrepper.com/code-examples/cpp/c%2B%2B+print+vector+of+strings
-	char split_with=':';
-    vector<string> words;
-    //words.push_back("test");
-    string token;
-    stringstream ss(buf);
-    while(getline(ss , token , split_with)) words.push_back(token);
+	u32 then = device->getTimer()->getRealTime();
+	u32 lastCaption = 0;
+	f32 frameMs = 0;
 
-	for(int i = 0; i < words.size(); i++)
+	while(device->run())
 	{
-	///	std::cout << i << words[i] << std::endl;
-		if (i==0){
-            if  ( (atof(words[i].c_str()) >= 0.01) || (atof(words[i].c_str()) <= -0.01)){
-             GX=atof(words[i].c_str());
-	   /// printf("0%f : thisspot\n",atof(words[i].c_str() ));
+		u32 now = device->getTimer()->getRealTime();
+		frameMs += ((now - then) - frameMs) * 0.1f;	// smoothed
+		then = now;
 
-           // GX=stof(words[i].substr(sz));
-           // GX=stof(words[i],&sz);
-           // GX=atof(words[i]);
-           } else{
-           		//  printf("!");
-           };
+		const glove_frame_t* f;
+		bool fresh = glove_handoff_latest(&handoff, &f);
+		bool traced = tracePath && fresh;
+		if (traced)
+		{
+			span = f->trace;
+			span.t[GLOVE_TRACE_TAKE] = glove_monotonic_ns();
 		}
-		if (i==1){
-            GY=atof(words[i].c_str());
-		  //      printf("1%f : thisspot\n",atof(words[i].c_str() ));
+		// every sample since the last frame, not just the newest
+		glove_interp_take(&interp, &handoff, f);
+		glove_quat_t q[GLOVE_MAX_SENSORS];
+		bool moving = glove_interp_at(&interp, glove_monotonic_ns(), q);
+		// one more update after the last step lands exactly on the newest
+		if (fresh || moving || interpMoving)
+		{
+			// a hand without its sensors (one glove) stays at rest
+			for (int h = 0; h < GLOVE_SKIN_HANDS; h++)
+			{
+				int n = f->nsensors - h * GLOVE_HAND_SENSORS;
+				glove_kin_hand(n > 0 ? &q[h * GLOVE_HAND_SENSORS] : rest,
+				               n > GLOVE_HAND_SENSORS ? GLOVE_HAND_SENSORS : n,
+				               glove_vec3(h ? -0.12f : 0.12f, 0, 0), h, &pose[h]);
+			}
+			hands.update(pose, GLOVE_SKIN_HANDS);
 		}
-		if (i==2){
-		            GZ=atof(words[i].c_str()); //comment out rotation here to see it more like a joystick
-		    //          printf("2%f : thisspot\n",atof(words[i].c_str() ));
-		}
-        //***** alternate method *******
-		//std::cout << myVector.at(i) << std::endl;
-	}
-
+		interpMoving = moving;
 
-        int lastFPS = -1;
-
-		if (device->isWindowActive())
-		{
+		if (device->isWindowActive())
+		{
 			driver->beginScene(true, true, video::SColor(255,200,200,200));
-//todo put values and math here
-         cube->setPosition(core::vector3df(0,10,10));
-            cube->setScale(core::vector3df(1,1,1));
-            cube->setRotation(core::vector3df(-GX,-GZ,-GY));
+			smgr->drawAll();
+			if (metricsPath && f->seq) glove_stream_drawn(&metrics, f, &drawnSeq);
+			if (traced) span.t[GLOVE_TRACE_SUBMIT] = glove_monotonic_ns();
+			driver->endScene();
+			if (traced)
+			{
+				span.t[GLOVE_TRACE_PRESENT] = glove_monotonic_ns();
+				glove_trace_frame(&trace, &span);
+			}
 
+			glove_lod_change_t ch;
+			if (glove_lod_frame(&lod, (f32)(device->getTimer()->getRealTime() - now), &ch))
+			{
+				if (ch.knob == lodOctree && mesh)
+				{
+					// minimalPolysPerNode is fixed at construction
+					if (node) node->remove();
+					node = smgr->addOctreeSceneNode(mesh->getMesh(0), 0, -1, octreePolys[ch.to]);
+					if (node) node->setPosition(core::vector3df(-1300,-144,-1249));
+				}
+				if ((ch.knob == lodCulling || ch.knob == lodOctree) && node)
+					node->setAutomaticCulling(glove_lod_level(&lod, lodCulling) ? scene::EAC_FRUSTUM_BOX : scene::EAC_BOX);
+				if (ch.knob == lodFar)
+					camera->setFarValue(farValue[ch.to]);
+				if (ch.knob == lodHands)
+					hands.setDetail(handSlices[ch.to]);
+				printf("lod: %s %d -> %d (frame %.1f ms, target %.1f ms)\n",
+				       lod.knob[ch.knob].name, ch.from, ch.to, lod.smoothed_ms, budgetMs);
+			}
 
-			smgr->drawAll();
-			driver->endScene();
-
-			int fps = driver->getFPS();
-
-			if (lastFPS != fps)
-			{
-				core::stringw str = L"Irrlicht Engine - Quake 3 Map example [";
-				str += driver->getName();
-				str += "] FPS:";
-				str += fps;
-
-				device->setWindowCaption(str.c_str());
-				lastFPS = fps;
-			}
-		}
-		else
-			device->yield();
-            }
-        }
+			if (now - lastCaption >= 250)
+			{
+				// sample age: how old the newest reading is; the hands on
+				// screen are the interpolation delay older than that
+				wchar_t tmp[128];
+				if (lost)
+					swprintf(tmp, 128, playPath ? L"] frame %.1f ms, end of recording"
+					                            : L"] frame %.1f ms, glove lost", frameMs);
+				else if (f->seq == 0)
+					swprintf(tmp, 128, L"] frame %.1f ms, no samples yet", frameMs);
+				else
+					swprintf(tmp, 128, L"] frame %.1f ms, sample age %.1f ms, +%.0f ms smoothing (%.1f%% late)",
+					         frameMs, (glove_monotonic_ns() - f->recv_ns) * 1e-6, interpMs,
+					         interp.renders ? 100.0 * interp.late / interp.renders : 0.0);
+				core::stringw str = L"Irrlicht Engine - Quake 3 Map example [";
+				str += driver->getName();
+				str += tmp;
+
+				device->setWindowCaption(str.c_str());
+				lastCaption = now;
+			}
+		}
+		else
+			device->yield();
+	}
+
+	quit = true;
+	reader.join();
+	if (playPath) glove_replay_close(&replay);
+	if (brokerName) glove_shm_close(&broker);
+	glove_metrics_close(&metrics);
+	if (tracePath)
+	{
+		glove_trace_report(&trace, stdout);
+		if (glove_trace_write_json(&trace, tracePath) != 0) perror(tracePath);
+		glove_trace_free(&trace);
+	}
+	device->drop();
+        }
             break;
         case 'F':
             if( fd == -1 ) error("serial port not opened");
@@ -6,6 +6,59 @@ GY521 Main(0x68), Thumb(0x68), Point(0x68), Middle(0x68), Ring(0x68), Little(0x6
 uint32_t counter = 0;
 
 int SensitivtyFactor = 100;
+
+// print every read as "sensor:t_us:ax:ay:az:gx:gy:gz" for the host tools
+// in arduino-serial/ (glove-tool).  The sensors are read one after the
+// other, so each line carries its own capture time; the host resamples
+// them to a common frame time.
+#define GLOVE_STREAM
+// also end each line with the micros() it was queued for Serial at,
+// ":sent_us", for glove-tool trace and the viewers' --trace
+//#define GLOVE_TRACE
+// send where loop time goes (I2C, math, printing, delay) as a "#P:" line
+// once a second, for glove-tool profile; see GY521_profile.h
+//#define GLOVE_PROFILE
+#include "GY521_profile.h"
+
+// read one sensor, stamping the middle of its I2C transfer
+uint32_t readSensor(uint8_t id, GY521 &sensor)
+{
+  uint32_t start = micros();
+  int16_t rv = sensor.read();
+  uint32_t done = micros();
+  uint32_t stamp = start + (done - start) / 2;
+  profileRead(sensor, rv, start, done);
+#ifdef GLOVE_STREAM
+  if (rv == GY521_OK)
+  {
+    Serial.print(id);
+    Serial.print(':');
+    Serial.print(stamp);
+    Serial.print(':');
+    Serial.print(sensor.getAccelX(), 4);
+    Serial.print(':');
+    Serial.print(sensor.getAccelY(), 4);
+    Serial.print(':');
+    Serial.print(sensor.getAccelZ(), 4);
+    Serial.print(':');
+    Serial.print(sensor.getGyroX(), 3);
+    Serial.print(':');
+    Serial.print(sensor.getGyroY(), 3);
+    Serial.print(':');
+#ifdef GLOVE_TRACE
+    Serial.print(sensor.getGyroZ(), 3);
+    Serial.print(':');
+    // print() blocks while the TX buffer is full, so this is after the
+    // backlog ahead of the line
+    Serial.println(micros());
+#else
+    Serial.println(sensor.getGyroZ(), 3);
+#endif
+  }
+  profileAdd(GY521_PROF_FORMAT, profileStamp() - done);
+#endif
+  return stamp;
+}
 void CallibrateSensors()
 {
   Main.axe = Thumb.axe = Point.axe = Middle.axe = Ring.axe = Little.axe = 0;
@@ -55,7 +108,7 @@ void setup() {
   //Callibrate all values
   CallibrateSensors();
   Main.read();
-
+  profileBegin();
 }
 int IX = Main.getAngleX();
 int IZ = Main.getAngleZ();
@@ -68,8 +121,11 @@ int MIZ = Middle.getAngleZ();
 
 void loop()
 {
+  profileLoop();
+  uint32_t idle = profileStamp();
   delay(SensitivtyFactor);
-  Main.read();
+  profileAdd(GY521_PROF_IDLE, profileStamp() - idle);
+  readSensor(0, Main);
   int x = Main.getAngleX();
   int z = Main.getAngleZ();
   int rz = IZ - z;
@@ -103,22 +159,22 @@ void loop()
       Serial.println("-6, 0, 0");
   }
 
-  Thumb.read();
-  Point.read();
-  int z = Point.getAngleZ();
-  int rz = PIZ - z;
-  if (abs(rz)>PIZ)
+  readSensor(1, Thumb);
+  readSensor(2, Point);
+  int pz = Point.getAngleZ();
+  int prz = PIZ - pz;
+  if (abs(prz)>PIZ)
   {
-    Serial.print("Mouse.click(MOUSE_LEFT)")
+    Serial.println("Mouse.click(MOUSE_LEFT)");
   }
-  Middle.read();
-  int z = Middle.getAngleZ();
-  int rz = MIZ - z;
-  if ((abs(rz)>MIZ)
+  readSensor(3, Middle);
+  int mz = Middle.getAngleZ();
+  int mrz = MIZ - mz;
+  if (abs(mrz)>MIZ)
   {
-    Serial.print("Mouse.click(MOUSE_RIGHT)")
+    Serial.println("Mouse.click(MOUSE_RIGHT)");
   }
-  Ring.read();
-  Little.read();
+  readSensor(4, Ring);
+  readSensor(5, Little);
 
 }